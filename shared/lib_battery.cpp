@@ -117,6 +117,34 @@ void capacity_t::copy(capacity_t * capacity)
 	_prev_charge = capacity->_prev_charge;
 	_charge = capacity->_charge;
 }
+void capacity_t::save_state(capacity_state &state) const
+{
+	state.q0 = _q0;
+	state.qmax = _qmax;
+	state.qmax_thermal = _qmax_thermal;
+	state.I = _I;
+	state.I_loss = _I_loss;
+	state.SOC = _SOC;
+	state.DOD = _DOD;
+	state.DOD_prev = _DOD_prev;
+	state.chargeChange = _chargeChange;
+	state.prev_charge = _prev_charge;
+	state.charge = _charge;
+}
+void capacity_t::restore_state(const capacity_state &state)
+{
+	_q0 = state.q0;
+	_qmax = state.qmax;
+	_qmax_thermal = state.qmax_thermal;
+	_I = state.I;
+	_I_loss = state.I_loss;
+	_SOC = state.SOC;
+	_DOD = state.DOD;
+	_DOD_prev = state.DOD_prev;
+	_chargeChange = state.chargeChange;
+	_prev_charge = state.prev_charge;
+	_charge = state.charge;
+}
 void capacity_t::check_charge_change()
 {
 	_charge = NO_CHARGE;
@@ -242,6 +270,18 @@ void capacity_kibam_t::copy(capacity_t * capacity)
 	_q20 = tmp->_q20;
 	_I20 = tmp->_I20;
 }
+void capacity_kibam_t::save_state(capacity_state &state) const
+{
+	capacity_t::save_state(state);
+	state.q1_0 = _q1_0;
+	state.q2_0 = _q2_0;
+}
+void capacity_kibam_t::restore_state(const capacity_state &state)
+{
+	capacity_t::restore_state(state);
+	_q1_0 = state.q1_0;
+	_q2_0 = state.q2_0;
+}
 
 void capacity_kibam_t::replace_battery()
 {
@@ -495,6 +535,18 @@ void voltage_t::copy(voltage_t * voltage)
 	// doesn't change;
 	//_batt_voltage_matrix = voltage->_batt_voltage_matrix;
 }
+void voltage_t::save_state(voltage_state &state) const
+{
+	state.cell_voltage = _cell_voltage;
+	state.R = _R;
+	state.R_battery = _R_battery;
+}
+void voltage_t::restore_state(const voltage_state &state)
+{
+	_cell_voltage = state.cell_voltage;
+	_R = state.R;
+	_R_battery = state.R_battery;
+}
 double voltage_t::battery_voltage(){ return _num_cells_series*_cell_voltage; }
 double voltage_t::battery_voltage_nominal(){ return _num_cells_series * _cell_voltage_nominal; }
 double voltage_t::cell_voltage(){ return _cell_voltage; }
@@ -694,6 +746,16 @@ void voltage_vanadium_redox_t::copy(voltage_t * voltage)
 	_F = tmp->_F;
 	_C0 = tmp->_C0;
 }
+void voltage_vanadium_redox_t::save_state(voltage_state &state) const
+{
+	voltage_t::save_state(state);
+	state.I = _I;
+}
+void voltage_vanadium_redox_t::restore_state(const voltage_state &state)
+{
+	voltage_t::restore_state(state);
+	_I = state.I;
+}
 void voltage_vanadium_redox_t::updateVoltage(capacity_t * capacity, thermal_t * thermal, double )
 {
 
@@ -774,6 +836,22 @@ void lifetime_t::copy(lifetime_t * lifetime)
 	_replacement_scheduled = lifetime->_replacement_scheduled;
 	_q = lifetime->_q;
 }
+void lifetime_t::save_state(lifetime_state &state) const
+{
+	_lifetime_cycle->save_state(state.cycle);
+	_lifetime_calendar->save_state(state.calendar);
+	state.replacements = _replacements;
+	state.replacement_scheduled = _replacement_scheduled;
+	state.q = _q;
+}
+void lifetime_t::restore_state(const lifetime_state &state)
+{
+	_lifetime_cycle->restore_state(state.cycle);
+	_lifetime_calendar->restore_state(state.calendar);
+	_replacements = state.replacements;
+	_replacement_scheduled = state.replacement_scheduled;
+	_q = state.q;
+}
 double lifetime_t::capacity_percent(){ return _q; }
 double lifetime_t::capacity_percent_cycle() { return _lifetime_cycle->capacity_percent(); }
 double lifetime_t::capacity_percent_calendar() { return _lifetime_calendar->capacity_percent(); }
@@ -833,6 +911,8 @@ lifetime_cycle_t::lifetime_cycle_t(const util::matrix_t<double> &batt_lifetime_m
 		_cycles_vect.push_back(batt_lifetime_matrix.at(i,1));
 		_capacities_vect.push_back(batt_lifetime_matrix.at(i, 2));
 	}
+	build_DOD_grid();
+
 	// initialize other member variables
 	_nCycles = 0;
 	_Dlt = 0;
@@ -867,6 +947,39 @@ void lifetime_cycle_t::copy(lifetime_cycle_t * lifetime_cycle)
 	_Range = lifetime_cycle->_Range;
 	_average_range = lifetime_cycle->_average_range;
 }
+void lifetime_cycle_t::save_state(lifetime_cycle_state &state) const
+{
+	state.nCycles = _nCycles;
+	state.q = _q;
+	state.Dlt = _Dlt;
+	state.jlt = _jlt;
+	state.Xlt = _Xlt;
+	state.Ylt = _Ylt;
+	state.Range = _Range;
+	state.average_range = _average_range;
+
+	// the residue is normally a handful of peaks, only an unusually long one spills to the heap
+	state.n_peaks = _Peaks.size();
+	if (state.n_peaks <= lifetime_cycle_state::MAX_PEAKS)
+		std::copy(_Peaks.begin(), _Peaks.end(), state.peaks);
+	else
+		state.peaks_overflow.assign(_Peaks.begin(), _Peaks.end());
+}
+void lifetime_cycle_t::restore_state(const lifetime_cycle_state &state)
+{
+	_nCycles = state.nCycles;
+	_q = state.q;
+	_Dlt = state.Dlt;
+	_jlt = state.jlt;
+	_Xlt = state.Xlt;
+	_Ylt = state.Ylt;
+	_Range = state.Range;
+	_average_range = state.average_range;
+
+	// assign reuses the existing capacity of _Peaks
+	const double * peaks = (state.n_peaks <= lifetime_cycle_state::MAX_PEAKS) ? state.peaks : &state.peaks_overflow[0];
+	_Peaks.assign(peaks, peaks + state.n_peaks);
+}
 double lifetime_cycle_t::estimateCycleDamage()
 {
 	// Initialize assuming 50% DOD
@@ -959,18 +1072,16 @@ int lifetime_cycle_t::rainflow_compareRanges()
 		_nCycles++;
 
 		// the capacity percent cannot increase
-		if (bilinear(_average_range, _nCycles) <= _q)
-			_q = bilinear(_average_range, _nCycles);
+		double q = bilinear(_average_range, _nCycles);
+		if (q <= _q)
+			_q = q;
 
 		if (_q < 0)
 			_q = 0.;
 		
-		// discard peak & valley of Y
-		double save = _Peaks[_jlt]; 
-		_Peaks.pop_back(); 
-		_Peaks.pop_back();
-		_Peaks.pop_back();
-		_Peaks.push_back(save);
+		// discard peak & valley of Y, in place so the residue never reallocates
+		_Peaks[_jlt - 2] = _Peaks[_jlt];
+		_Peaks.resize(_jlt - 1);
 		_jlt -= 2;
 		// stay in while loop
 		retCode = LT_RERANGE;
@@ -995,126 +1106,146 @@ double lifetime_cycle_t::cycle_range(){ return _Range; }
 double lifetime_cycle_t::average_range() { return _average_range; }
 double lifetime_cycle_t::capacity_percent() { return _q; }
 
-double lifetime_cycle_t::bilinear(double DOD, int cycle_number)
+void lifetime_cycle_t::build_DOD_grid()
 {
-	/*
-	Work could be done to make this simpler
-	Current idea is to interpolate first along the C = f(n) curves for each DOD to get C_DOD_, C_DOD_+ 
-	Then interpolate C_, C+ to get C at the DOD of interest
-	*/
+	// sorted unique DOD levels, and the positive levels which bound the brackets
+	std::vector<double> D_unique(_DOD_vect);
+	std::sort(D_unique.begin(), D_unique.end());
+	D_unique.erase(std::unique(D_unique.begin(), D_unique.end()), D_unique.end());
+	_DOD_interpolate = (D_unique.size() > 1);
+
+	_DOD_breaks.clear();
+	for (size_t i = 0; i < D_unique.size(); i++)
+	{
+		if (D_unique[i] > 0)
+			_DOD_breaks.push_back(D_unique[i]);
+	}
 
-	std::vector<double> D_unique_vect;
+	// every DOD in (_DOD_breaks[j-1], _DOD_breaks[j]] shares the same pair of bounding curves
+	_DOD_grid.resize(_DOD_breaks.size() + 1);
+	for (size_t j = 0; j < _DOD_grid.size(); j++)
+	{
+		_DOD_grid[j].D_lo = (j > 0) ? _DOD_breaks[j - 1] : 0.;
+		_DOD_grid[j].D_hi = (j < _DOD_breaks.size() && _DOD_breaks[j] < 100) ? _DOD_breaks[j] : 100.;
+		DOD_bracket_tables(_DOD_grid[j]);
+	}
+}
+
+void lifetime_cycle_t::DOD_bracket_tables(DOD_bracket &bracket)
+{
 	std::vector<double> C_n_low_vect;
-	std::vector<double> D_high_vect;
 	std::vector<double> C_n_high_vect;
 	std::vector<int> low_indices;
 	std::vector<int> high_indices;
 	double D = 0.;
-	size_t n = 0;
-	double C = 100;
 
-	// get unique values of D
-	D_unique_vect.push_back(_DOD_vect[0]);
-	for (int i = 0; i < (int)_DOD_vect.size(); i++){
-		bool contained = false;
-		for (int j = 0; j < (int)D_unique_vect.size(); j++){
-			if (_DOD_vect[i] == D_unique_vect[j]){
-				contained = true;
-				break;
-			}
-		}
-		if (!contained){
-			D_unique_vect.push_back(_DOD_vect[i]);
-		}
-	}
-	n = D_unique_vect.size();
+	// Seperate table into bins
+	double D_min = 100.;
+	double D_max = 0.;
 
-	if (n > 1)
+	for (int i = 0; i < (int)_DOD_vect.size(); i++)
 	{
-		// get where DOD is bracketed [D_lo, DOD, D_hi]
-		double D_lo = 0;
-		double D_hi = 100;
+		D = _DOD_vect[i];
+		if (D == bracket.D_lo)
+			low_indices.push_back(i);
+		else if (D == bracket.D_hi)
+			high_indices.push_back(i);
+
+		if (D < D_min){ D_min = D; }
+		else if (D > D_max){ D_max = D; }
+	}
 
-		for (int i = 0; i < (int)_DOD_vect.size(); i++)
+	// if we're out of the bounds, just make the upper bound equal to the highest input
+	if (high_indices.size() == 0)
+	{
+		for (int i = 0; i != (int)_DOD_vect.size(); i++)
 		{
-			D = _DOD_vect[i];
-			if (D < DOD && D > D_lo)
-				D_lo = D;
-			else if (D >= DOD && D < D_hi)
-				D_hi = D;
+			if (_DOD_vect[i] == D_max)
+				high_indices.push_back(i);
 		}
+	}
 
-		// Seperate table into bins
-		double D_min = 100.;
-		double D_max = 0.;
-		
-		for (int i = 0; i < (int)_DOD_vect.size(); i++)
-		{
-			D = _DOD_vect[i];
-			if (D == D_lo)
-				low_indices.push_back(i);
-			else if (D == D_hi)
-				high_indices.push_back(i);
+	size_t n_rows_lo = low_indices.size();
+	size_t n_rows_hi = high_indices.size();
+	size_t n_cols = 2;
 
-			if (D < D_min){ D_min = D; }
-			else if (D > D_max){ D_max = D; }
+	// If we aren't bounded, fill in values
+	if (n_rows_lo == 0)
+	{
+		// Assumes 0% DOD
+		for (int i = 0; i < (int)n_rows_hi; i++)
+		{
+			C_n_low_vect.push_back(0. + i * 500); // cycles
+			C_n_low_vect.push_back(100.); // 100 % capacity
 		}
-
-		// if we're out of the bounds, just make the upper bound equal to the highest input
-		if (high_indices.size() == 0)
+	}
+	else
+	{
+		for (int i = 0; i < (int)n_rows_lo; i++)
 		{
-			for (int i = 0; i != (int)_DOD_vect.size(); i++)
-			{
-				if (_DOD_vect[i] == D_max)
-					high_indices.push_back(i);
-			}
+			C_n_low_vect.push_back(_cycles_vect[low_indices[i]]);
+			C_n_low_vect.push_back(_capacities_vect[low_indices[i]]);
 		}
+	}
+	for (int i = 0; i < (int)n_rows_hi; i++)
+	{
+		C_n_high_vect.push_back(_cycles_vect[high_indices[i]]);
+		C_n_high_vect.push_back(_capacities_vect[high_indices[i]]);
+	}
+	n_rows_lo = C_n_low_vect.size() / n_cols;
+	n_rows_hi = C_n_high_vect.size() / n_cols;
 
-		size_t n_rows_lo = low_indices.size();
-		size_t n_rows_hi = high_indices.size();
-		size_t n_cols = 2;
+	// the upper curve is read with as many rows as the lower curve, never more than it has
+	if (n_rows_hi > n_rows_lo)
+		n_rows_hi = n_rows_lo;
 
-		// If we aren't bounded, fill in values
-		if (n_rows_lo == 0)
-		{
-			// Assumes 0% DOD
-			for (int i = 0; i < (int)n_rows_hi; i++)
-			{
-				C_n_low_vect.push_back(0. + i * 500); // cycles
-				C_n_low_vect.push_back(100.); // 100 % capacity
-			}
-		}
-		
-		if (n_rows_lo != 0)
+	// an empty curve is left as a single row, which doesn't interpolate
+	C_n_low_vect.resize(std::max(n_rows_lo, (size_t)1) * n_cols, 0.);
+	C_n_high_vect.resize(std::max(n_rows_hi, (size_t)1) * n_cols, 0.);
+	bracket.C_n_low = util::matrix_t<double>(n_rows_lo, n_cols, &C_n_low_vect);
+	bracket.C_n_high = util::matrix_t<double>(n_rows_hi, n_cols, &C_n_high_vect);
+}
+
+double lifetime_cycle_t::bilinear(double DOD, int cycle_number)
+{
+	/*
+	Interpolate first along the C = f(n) curves for the DOD levels bracketing DOD to get C_DOD_, C_DOD_+
+	Then interpolate C_, C+ to get C at the DOD of interest
+	The bracketing curves are found in the grid built at construction
+	*/
+	double C = 100;
+
+	if (_DOD_interpolate)
+	{
+		double C_Dlo, C_Dhi, D_lo, D_hi;
+		if (DOD > 0)
 		{
-			for (int i = 0; i < (int)n_rows_lo; i++)
-			{
-				C_n_low_vect.push_back(_cycles_vect[low_indices[i]]);
-				C_n_low_vect.push_back(_capacities_vect[low_indices[i]]);
-			}
+			const DOD_bracket &bracket = _DOD_grid[std::lower_bound(_DOD_breaks.begin(), _DOD_breaks.end(), DOD) - _DOD_breaks.begin()];
+			D_lo = bracket.D_lo;
+			D_hi = bracket.D_hi;
+			C_Dlo = util::linterp_col(bracket.C_n_low, 0, cycle_number, 1);
+			C_Dhi = util::linterp_col(bracket.C_n_high, 0, cycle_number, 1);
 		}
-		if (n_rows_hi != 0)
+		else
 		{
-			for (int i = 0; i < (int)n_rows_hi; i++)
+			// zero DOD, only reached on construction and replacement
+			DOD_bracket bracket;
+			bracket.D_lo = 0;
+			bracket.D_hi = 100;
+			for (int i = 0; i < (int)_DOD_vect.size(); i++)
 			{
-				C_n_high_vect.push_back(_cycles_vect[high_indices[i]]);
-				C_n_high_vect.push_back(_capacities_vect[high_indices[i]]);
+				double D = _DOD_vect[i];
+				if (D < DOD && D > bracket.D_lo)
+					bracket.D_lo = D;
+				else if (D >= DOD && D < bracket.D_hi)
+					bracket.D_hi = D;
 			}
+			DOD_bracket_tables(bracket);
+			D_lo = bracket.D_lo;
+			D_hi = bracket.D_hi;
+			C_Dlo = util::linterp_col(bracket.C_n_low, 0, cycle_number, 1);
+			C_Dhi = util::linterp_col(bracket.C_n_high, 0, cycle_number, 1);
 		}
-		n_rows_lo = C_n_low_vect.size() / n_cols;
-		n_rows_hi = C_n_high_vect.size() / n_cols;
-
-		if (n_rows_lo == 0 || n_rows_hi == 0)
-		{
-			// need a safeguard here
-		}
-
-		util::matrix_t<double> C_n_low(n_rows_lo, n_cols, &C_n_low_vect);
-		util::matrix_t<double> C_n_high(n_rows_lo, n_cols, &C_n_high_vect);
-
-		// Compute C(D_lo, n), C(D_hi, n)
-		double C_Dlo = util::linterp_col(C_n_low, 0, cycle_number, 1);
-		double C_Dhi = util::linterp_col(C_n_high, 0, cycle_number, 1);
 
 		if (C_Dlo < 0.)
 			C_Dlo = 0.;
@@ -1192,6 +1323,22 @@ void lifetime_calendar_t::copy(lifetime_calendar_t * lifetime_calendar)
 	_b = lifetime_calendar->_b;
 	_c = lifetime_calendar->_c;
 }
+void lifetime_calendar_t::save_state(lifetime_calendar_state &state) const
+{
+	state.day_age_of_battery = _day_age_of_battery;
+	state.last_idx = _last_idx;
+	state.q = _q;
+	state.dq_old = _dq_old;
+	state.dq_new = _dq_new;
+}
+void lifetime_calendar_t::restore_state(const lifetime_calendar_state &state)
+{
+	_day_age_of_battery = state.day_age_of_battery;
+	_last_idx = state.last_idx;
+	_q = state.q;
+	_dq_old = state.dq_old;
+	_dq_new = state.dq_new;
+}
 double lifetime_calendar_t::capacity_percent() { return _q; }
 double lifetime_calendar_t::runLifetimeCalendarModel(size_t idx, double T, double SOC)
 {
@@ -1313,6 +1460,18 @@ void thermal_t::copy(thermal_t * thermal)
 	_capacity_percent = thermal->_capacity_percent;
 	_T_max = thermal->_T_max;
 }
+void thermal_t::save_state(thermal_state &state) const
+{
+	state.T_battery = _T_battery;
+	state.capacity_percent = _capacity_percent;
+	state.R = _R;
+}
+void thermal_t::restore_state(const thermal_state &state)
+{
+	_T_battery = state.T_battery;
+	_capacity_percent = state.capacity_percent;
+	_R = state.R;
+}
 void thermal_t::replace_battery(size_t lifetimeIndex)
 { 
 	_T_battery = _T_room[util::yearOneIndex(_dt_hour, lifetimeIndex)];
@@ -1449,6 +1608,8 @@ void losses_t::copy(losses_t * losses)
 	_idle_loss = losses->_idle_loss;
 	_full_loss = losses->_full_loss;*/
 }
+void losses_t::save_state(losses_state &state) const { state.nCycle = _nCycle; }
+void losses_t::restore_state(const losses_state &state) { _nCycle = state.nCycle; }
 
 void losses_t::replace_battery(){ _nCycle = 0; }
 double losses_t::getLoss(size_t indexFirstYear) { return _full_loss[indexFirstYear]; }
@@ -1531,6 +1692,26 @@ void battery_t::copy(const battery_t * battery)
 	_last_idx = battery->_last_idx;
 }
 
+void battery_t::save_state(battery_state &state) const
+{
+	_capacity->save_state(state.capacity);
+	_voltage->save_state(state.voltage);
+	_thermal->save_state(state.thermal);
+	_lifetime->save_state(state.lifetime);
+	_losses->save_state(state.losses);
+	state.last_idx = _last_idx;
+}
+
+void battery_t::restore_state(const battery_state &state)
+{
+	_capacity->restore_state(state.capacity);
+	_voltage->restore_state(state.voltage);
+	_thermal->restore_state(state.thermal);
+	_lifetime->restore_state(state.lifetime);
+	_losses->restore_state(state.losses);
+	_last_idx = state.last_idx;
+}
+
 void battery_t::delete_clone()
 {
 	if (_capacity) delete _capacity;
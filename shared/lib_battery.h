@@ -55,6 +55,100 @@ protected:
 	std::vector<int> count;
 };
 
+/*
+Checkpoints of the mutable state of each battery submodel.
+These are plain data which can be saved and restored without allocation, and are used by the
+dispatch iteration in place of copying a whole battery.  Parameters which don't change after
+construction are not included.
+*/
+struct capacity_state
+{
+	double q0;
+	double qmax;
+	double qmax_thermal;
+	double I;
+	double I_loss;
+	double SOC;
+	double DOD;
+	double DOD_prev;
+	bool chargeChange;
+	int prev_charge;
+	int charge;
+
+	// kibam only
+	double q1_0;
+	double q2_0;
+};
+
+struct voltage_state
+{
+	double cell_voltage;
+	double R;
+	double R_battery;
+
+	// vanadium redox only
+	double I;
+};
+
+struct lifetime_cycle_state
+{
+	enum { MAX_PEAKS = 64 };
+
+	int nCycles;
+	double q;
+	double Dlt;
+	int jlt;
+	double Xlt;
+	double Ylt;
+	double Range;
+	double average_range;
+
+	// rainflow residue, stored inline unless it exceeds MAX_PEAKS
+	size_t n_peaks;
+	double peaks[MAX_PEAKS];
+	std::vector<double> peaks_overflow;
+};
+
+struct lifetime_calendar_state
+{
+	int day_age_of_battery;
+	size_t last_idx;
+	double q;
+	double dq_old;
+	double dq_new;
+};
+
+struct lifetime_state
+{
+	lifetime_cycle_state cycle;
+	lifetime_calendar_state calendar;
+	int replacements;
+	bool replacement_scheduled;
+	double q;
+};
+
+struct thermal_state
+{
+	double T_battery;
+	double capacity_percent;
+	double R;
+};
+
+struct losses_state
+{
+	int nCycle;
+};
+
+struct battery_state
+{
+	capacity_state capacity;
+	voltage_state voltage;
+	thermal_state thermal;
+	lifetime_state lifetime;
+	losses_state losses;
+	size_t last_idx;
+};
+
 /*
 Base class from which capacity models derive
 Note, all capacity models are based on the capacity of one battery
@@ -73,6 +167,10 @@ public:
 	// shallow copy from capacity to this
 	virtual void copy(capacity_t *);
 
+	// checkpoint and restore the mutable state
+	virtual void save_state(capacity_state &) const;
+	virtual void restore_state(const capacity_state &);
+
 	// virtual destructor
 	virtual ~capacity_t(){};
 	
@@ -141,6 +239,9 @@ public:
 	// copy from capacity to this
 	void copy(capacity_t *);
 
+	void save_state(capacity_state &) const;
+	void restore_state(const capacity_state &);
+
 	void updateCapacity(double &I, double dt);
 	void updateCapacityForThermal(double capacity_percent);
 	void updateCapacityForLifetime(double capacity_percent);
@@ -225,6 +326,10 @@ public:
 	// copy from voltage to this
 	virtual void copy(voltage_t *);
 
+	// checkpoint and restore the mutable state
+	virtual void save_state(voltage_state &) const;
+	virtual void restore_state(const voltage_state &);
+
 
 	virtual ~voltage_t(){};
 
@@ -335,6 +440,9 @@ public:
 	// copy from voltage to this
 	void copy(voltage_t *);
 
+	void save_state(voltage_state &) const;
+	void restore_state(const voltage_state &);
+
 	void updateVoltage(capacity_t * capacity, thermal_t * thermal, double dt);
 
 protected:
@@ -369,6 +477,10 @@ public:
 	/// copy from lifetime_cycle to this
 	void copy(lifetime_cycle_t *);
 
+	/// checkpoint and restore the rainflow state
+	void save_state(lifetime_cycle_state &) const;
+	void restore_state(const lifetime_cycle_state &);
+
 	/// return q, the effective capacity percent
 	double runCycleLifetime(double DOD);
 
@@ -391,12 +503,28 @@ protected:
 	int rainflow_compareRanges();
 	double bilinear(double DOD, int cycle_number);
 
+	// capacity vs cycle curves bounding a range of DOD, (D_lo, D_hi]
+	struct DOD_bracket
+	{
+		double D_lo;
+		double D_hi;
+		util::matrix_t<double> C_n_low;
+		util::matrix_t<double> C_n_high;
+	};
+	void build_DOD_grid();
+	void DOD_bracket_tables(DOD_bracket &bracket);
+
 	util::matrix_t<double> _cycles_vs_DOD;
 	util::matrix_t<double> _batt_lifetime_matrix;
 	std::vector<double> _DOD_vect;
 	std::vector<double> _cycles_vect;
 	std::vector<double> _capacities_vect;
 
+	// lookup grid for bilinear, built once at construction
+	bool _DOD_interpolate;				// table has more than one DOD level
+	std::vector<double> _DOD_breaks;	// sorted positive DOD levels
+	std::vector<DOD_bracket> _DOD_grid;	// bracket j covers (_DOD_breaks[j-1], _DOD_breaks[j]]
+
 
 	int _nCycles;
 	double _q;				// relative capacity %
@@ -431,6 +559,10 @@ public:
 	// copy from lifetime_calendar to this
 	void copy(lifetime_calendar_t *);
 
+	// checkpoint and restore the mutable state
+	void save_state(lifetime_calendar_state &) const;
+	void restore_state(const lifetime_calendar_state &);
+
 	/// Given the index of the simulation, the tempertature and SOC, return the effective capacity percent
 	double runLifetimeCalendarModel(size_t idx, double T, double SOC);
 
@@ -491,6 +623,10 @@ public:
 	// copy lifetime to this
 	void copy(lifetime_t *);
 
+	// checkpoint and restore the mutable state, including the cycle and calendar models
+	void save_state(lifetime_state &) const;
+	void restore_state(const lifetime_state &);
+
 	void runLifetimeModels(size_t idx, capacity_t *, double T_battery);
 
 	/// Return the relative capacity percentage of nominal (%)
@@ -545,6 +681,10 @@ public:
 	// copy thermal to this
 	void copy(thermal_t *);
 
+	// checkpoint and restore the mutable state
+	void save_state(thermal_state &) const;
+	void restore_state(const thermal_state &);
+
 	void updateTemperature(double I, double R, double dt, size_t lifetimeIndex);
 	void replace_battery(size_t lifetimeIndex);
 
@@ -622,6 +762,10 @@ public:
 	/// Copy input losses to this object
 	void copy(losses_t *);
 
+	/// Checkpoint and restore the mutable state
+	void save_state(losses_state &) const;
+	void restore_state(const losses_state &);
+
 	/// Run the losses model at the present simulation index (for year 1 only)
 	void run_losses(size_t lifetimeIndex);
 
@@ -665,6 +809,10 @@ public:
 	// copy members from battery to this
 	void copy(const battery_t * battery);
 
+	// checkpoint the mutable state of all submodels, and restore it without reallocating anything
+	void save_state(battery_state &) const;
+	void restore_state(const battery_state &);
+
 	// virtual destructor, does nothing as no memory allocated in constructor
 	virtual ~battery_t();
 
@@ -27,7 +27,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <math.h>
 #include <algorithm>
-#include <numeric>
+#include <deque>
 
 /*
 Dispatch base class
@@ -48,9 +48,9 @@ dispatch_t::dispatch_t(battery_t * Battery, double dt_hour, double SOC_min, doub
 	m_batteryPower->powerBatteryDischargeMax = Pd_max;
 	m_batteryPower->meterPosition = battMeterPosition;
 
-	// initalize Battery and a copy of the Battery for iteration
+	// initalize Battery and a checkpoint of its state for iteration
 	_Battery = Battery;
-	_Battery_initial = new battery_t(*_Battery);
+	_Battery->save_state(_Battery_checkpoint);
 
 	// Call the dispatch init method
 	init(_Battery, dt_hour, current_choice, t_min, mode);
@@ -85,7 +85,7 @@ dispatch_t::dispatch_t(const dispatch_t& dispatch)
 	m_batteryPower = m_batteryPowerFlow->getBatteryPower();
 
 	_Battery = new battery_t(*dispatch._Battery);
-	_Battery_initial = new battery_t(*dispatch._Battery_initial);
+	_Battery_checkpoint = dispatch._Battery_checkpoint;
 	init(_Battery, dispatch._dt_hour, dispatch._current_choice, dispatch._t_min, dispatch._mode);
 }
 
@@ -93,7 +93,7 @@ dispatch_t::dispatch_t(const dispatch_t& dispatch)
 void dispatch_t::copy(const dispatch_t * dispatch)
 {
 	_Battery->copy(dispatch->_Battery);
-	_Battery_initial->copy(dispatch->_Battery_initial);
+	_Battery_checkpoint = dispatch->_Battery_checkpoint;
 	init(_Battery, dispatch->_dt_hour,  dispatch->_current_choice, dispatch->_t_min, dispatch->_mode);
 
 	// can't create shallow copy of unique ptr
@@ -103,19 +103,16 @@ void dispatch_t::copy(const dispatch_t * dispatch)
 }
 void dispatch_t::delete_clone()
 {
-	// need to delete both, since allocated memory for both in deep copy 
+	// allocated memory for the battery in deep copy
 	if (_Battery) delete _Battery;
-	if (_Battery_initial) delete _Battery_initial;
 }
 dispatch_t::~dispatch_t()
 {
 	// original _Battery doesn't need deleted, since was a pointer passed in
-	_Battery_initial->delete_clone();
-	delete _Battery_initial;
 }
 void dispatch_t::finalize(size_t idx, double &I)
 {
-	_Battery->copy(_Battery_initial);
+	_Battery->restore_state(_Battery_checkpoint);
 	m_batteryPower->powerBatteryDC = 0;
 	m_batteryPower->powerBatteryAC = 0;
 	m_batteryPower->powerGridToBattery = 0;
@@ -192,7 +189,7 @@ bool dispatch_t::check_constraints(double &I, size_t count)
 	// reset
 	if (iterate)
 	{
-		_Battery->copy(_Battery_initial);
+		_Battery->restore_state(_Battery_checkpoint);
 		m_batteryPower->powerBatteryDC = 0;
 		m_batteryPower->powerBatteryAC = 0;
 		m_batteryPower->powerGridToBattery = 0;
@@ -324,7 +321,7 @@ void dispatch_t::runDispatch(size_t year, size_t hour_of_year, size_t step)
 	double I = current_controller(_Battery->battery_voltage_nominal());
 
 	// Setup battery iteration
-	_Battery_initial->copy(_Battery);
+	_Battery->save_state(_Battery_checkpoint);
 	bool iterate = true;
 	size_t count = 0;
 	size_t lifetimeIndex = util::lifetimeIndex(year, hour_of_year, step, static_cast<size_t>(1 / _dt_hour));
@@ -551,7 +548,7 @@ bool dispatch_manual_t::check_constraints(double &I, size_t count)
 		// reset
 		if (iterate)
 		{
-			_Battery->copy(_Battery_initial);
+			_Battery->restore_state(_Battery_checkpoint);
 			m_batteryPower->powerBatteryDC = 0;
 			m_batteryPower->powerBatteryAC = 0;
 			m_batteryPower->powerGridToBattery = 0;
@@ -596,6 +593,74 @@ void dispatch_manual_t::SOC_controller()
 		_charging = _prev_charging;
 }
 
+void forecast_window_t::compute_extrema(const std::vector<double> & series, size_t width, size_t stride)
+{
+	_stride = std::max(stride, (size_t)1);
+	width = std::max(width, (size_t)1);
+	_max.clear();
+	_min.clear();
+
+	// indices of candidate extrema in the current window, values decreasing (max) or increasing (min) from the front
+	std::deque<size_t> candidates_max;
+	std::deque<size_t> candidates_min;
+	for (size_t j = 0; j < series.size(); j++)
+	{
+		while (!candidates_max.empty() && series[candidates_max.back()] <= series[j])
+			candidates_max.pop_back();
+		candidates_max.push_back(j);
+
+		while (!candidates_min.empty() && series[candidates_min.back()] >= series[j])
+			candidates_min.pop_back();
+		candidates_min.push_back(j);
+
+		if (j + 1 < width)
+			continue;
+
+		// drop candidates which have left the window [start, j]
+		size_t start = j + 1 - width;
+		if (candidates_max.front() < start)
+			candidates_max.pop_front();
+		if (candidates_min.front() < start)
+			candidates_min.pop_front();
+
+		if (start % _stride == 0)
+		{
+			_max.push_back(series[candidates_max.front()]);
+			_min.push_back(series[candidates_min.front()]);
+		}
+	}
+}
+
+void forecast_window_t::compute_sum(const std::vector<double> & series, size_t width, size_t stride)
+{
+	_stride = std::max(stride, (size_t)1);
+	width = std::max(width, (size_t)1);
+	_sum.clear();
+
+	double sum = 0;
+	for (size_t j = 0; j < series.size(); j++)
+	{
+		sum += series[j];
+		if (j >= width)
+			sum -= series[j - width];
+
+		if (j + 1 < width)
+			continue;
+
+		// resum from scratch once per window length so the running sum can't drift over long series
+		size_t start = j + 1 - width;
+		if (start > 0 && start % width == 0)
+		{
+			sum = 0;
+			for (size_t i = start; i <= j; i++)
+				sum += series[i];
+		}
+
+		if (start % _stride == 0)
+			_sum.push_back(sum);
+	}
+}
+
 dispatch_automatic_t::dispatch_automatic_t(
 	battery_t * Battery,
 	double dt_hour,
@@ -660,6 +725,10 @@ void dispatch_automatic_t::init_with_pointer(const dispatch_automatic_t * tmp)
 	_look_ahead_hours = tmp->_look_ahead_hours;
 	_d_index_update = tmp->_d_index_update;
 	_index_last_updated = tmp->_index_last_updated;
+
+	// the optimizer holds no state between windows other than its warm start, so keep an existing one
+	if (tmp->m_dispatchOptimizer && !m_dispatchOptimizer)
+		m_dispatchOptimizer.reset(new dispatch_opt_t(*tmp->m_dispatchOptimizer));
 }
 
 // deep copy from dispatch to this
@@ -680,9 +749,31 @@ void dispatch_automatic_t::copy(const dispatch_t * dispatch)
 
 void dispatch_automatic_t::update_pv_data(std::vector<double> P_pv_dc){ _P_pv_dc = P_pv_dc;}
 void dispatch_automatic_t::set_custom_dispatch(std::vector<double> P_batt_dc) { _P_battery_use = P_batt_dc; }
+void dispatch_automatic_t::set_optimizer_timeout(double timeout)
+{
+	if (m_dispatchOptimizer)
+		m_dispatchOptimizer->solver_params.timeout = timeout;
+}
 int dispatch_automatic_t::get_mode(){ return _mode; }
 double dispatch_automatic_t::power_batt_target() { return m_batteryPower->powerBatteryTarget; };
 
+void dispatch_automatic_t::set_optimizer_limits()
+{
+	dispatch_opt_t::s_params & params = m_dispatchOptimizer->params;
+
+	// [kWh] - usable energy, consistent with the peak shaving energy estimate
+	double E_nominal = _Battery->battery_voltage() * _Battery->battery_charge_maximum() * util::watt_to_kilowatt;
+	params.dt_hour = _dt_hour;
+	params.E_min = E_nominal * m_batteryPower->stateOfChargeMin * 0.01;
+	params.E_max = E_nominal * m_batteryPower->stateOfChargeMax * 0.01;
+	params.E_init = std::fmin(std::fmax(E_nominal * _Battery->battery_soc() * 0.01, params.E_min), params.E_max);
+	params.P_charge_max = m_batteryPower->powerBatteryChargeMax;
+	params.P_discharge_max = m_batteryPower->powerBatteryDischargeMax;
+	params.can_pv_charge = m_batteryPower->canPVCharge;
+	params.can_grid_charge = m_batteryPower->canGridCharge;
+	params.can_clip_charge = m_batteryPower->canClipCharge;
+}
+
 void dispatch_automatic_t::dispatch(size_t year,
 	size_t hour_of_year,
 	size_t step)
@@ -814,7 +905,7 @@ bool dispatch_automatic_t::check_constraints(double &I, size_t count)
 		// reset
 		if (iterate)
 		{
-			_Battery->copy(_Battery_initial);
+			_Battery->restore_state(_Battery_checkpoint);
 			m_batteryPower->powerBatteryDC = 0;
 			m_batteryPower->powerBatteryAC = 0;
 			m_batteryPower->powerGridToBattery = 0;
@@ -860,6 +951,9 @@ dispatch_automatic_behind_the_meter_t::dispatch_automatic_behind_the_meter_t(
 		grid.push_back(grid_point(0., 0, 0));
 		sorted_grid.push_back(grid[ii]);
 	}
+
+	if (_mode == dispatch_t::OPTIMIZED_LOOK_AHEAD)
+		m_dispatchOptimizer.reset(new dispatch_opt_t(dispatch_opt_t::MINIMIZE_PEAK));
 }
 
 void dispatch_automatic_behind_the_meter_t::init_with_pointer(const dispatch_automatic_behind_the_meter_t* tmp)
@@ -927,15 +1021,19 @@ void dispatch_automatic_behind_the_meter_t::update_dispatch(size_t hour_of_year,
 			// setup vectors
 			initialize(hour_of_year);
 
-			// compute grid power, sort highest to lowest
-			sort_grid(p, debug, idx);
+			// fall back to the peak shaving scheme if the optimization fails
+			if (!m_dispatchOptimizer || !optimize_dispatch(idx))
+			{
+				// compute grid power, sort highest to lowest
+				sort_grid(p, debug, idx);
 
-			// Peak shaving scheme
-			compute_energy(p, debug, E_max);
-			target_power(p, debug, E_max, idx);
+				// Peak shaving scheme
+				compute_energy(p, debug, E_max);
+				target_power(p, debug, E_max, idx);
 
-			// Set battery power profile
-			set_battery_power(p, debug);
+				// Set battery power profile
+				set_battery_power(p, debug);
+			}
 		}
 		// save for extraction
 		_P_target_current = _P_target_use[_day_index];
@@ -1203,6 +1301,55 @@ void dispatch_automatic_behind_the_meter_t::set_battery_power(FILE *p, bool debu
 	}
 }
 
+bool dispatch_automatic_behind_the_meter_t::optimize_dispatch(size_t idx)
+{
+	set_optimizer_limits();
+	dispatch_opt_t::s_params & params = m_dispatchOptimizer->params;
+	dispatch_opt_t::s_forecast & forecast = m_dispatchOptimizer->forecast;
+
+	// convert between battery DC power and AC power at the meter, as in set_battery_power
+	if (m_batteryPower->connectionMode == m_batteryPower->AC_CONNECTED) {
+		params.eta_discharge = m_batteryPower->singlePointEfficiencyDCToAC;
+		params.eta_pv_charge = m_batteryPower->singlePointEfficiencyACToDC;
+		params.eta_grid_charge = m_batteryPower->singlePointEfficiencyACToDC;
+	}
+	else {
+		params.eta_discharge = m_batteryPower->singlePointEfficiencyDCToDC * m_batteryPower->singlePointEfficiencyACToDC;
+		params.eta_pv_charge = m_batteryPower->singlePointEfficiencyDCToDC;
+		params.eta_grid_charge = m_batteryPower->singlePointEfficiencyDCToDC * m_batteryPower->singlePointEfficiencyACToDC;
+	}
+
+	// no tariff is available here, so only the peak is priced.  The small cycling cost and end value
+	// keep the battery from cycling without reducing the peak, and leave it charged for the next day
+	params.can_clip_charge = false;
+	params.cycle_cost = 1e-4;
+	params.value_end = 1e-5;
+	params.peak_cost = 1.;
+	params.peak_min = _P_target_month;
+
+	forecast.P_load.resize(_num_steps);
+	forecast.P_pv.resize(_num_steps);
+	for (size_t i = 0; i != _num_steps; i++)
+	{
+		double P_grid = _P_load_dc[idx + i] - _P_pv_dc[idx + i];
+		forecast.P_load[i] = P_grid;
+		forecast.P_pv[i] = std::fmax(0, -P_grid);
+		grid[i] = grid_point(P_grid, i / _steps_per_hour, i % _steps_per_hour);
+	}
+
+	if (!m_dispatchOptimizer->optimize(_num_steps))
+		return false;
+
+	double P_target = *std::max_element(m_dispatchOptimizer->outputs.P_grid.begin(), m_dispatchOptimizer->outputs.P_grid.end());
+	_P_target_month = std::fmax(_P_target_month, P_target);
+	for (size_t i = 0; i != _num_steps; i++)
+	{
+		_P_battery_use[i] = m_dispatchOptimizer->outputs.P_battery[i];
+		_P_target_use[i] = _P_target_month;
+	}
+	return true;
+}
+
 dispatch_automatic_front_of_meter_t::dispatch_automatic_front_of_meter_t(
 	battery_t * Battery,
 	double dt_hour,
@@ -1258,6 +1405,9 @@ dispatch_automatic_front_of_meter_t::dispatch_automatic_front_of_meter_t(
 	}
 	
 	setup_cost_forecast_vector();
+
+	if (_mode == dispatch_t::FOM_OPTIMIZED_LOOK_AHEAD)
+		m_dispatchOptimizer.reset(new dispatch_opt_t(dispatch_opt_t::MAXIMIZE_REVENUE));
 }
 dispatch_automatic_front_of_meter_t::~dispatch_automatic_front_of_meter_t(){ /* NOTHING TO DO */}
 void dispatch_automatic_front_of_meter_t::init_with_pointer(const dispatch_automatic_front_of_meter_t* tmp)
@@ -1265,6 +1415,8 @@ void dispatch_automatic_front_of_meter_t::init_with_pointer(const dispatch_autom
 	_look_ahead_hours = tmp->_look_ahead_hours;
 	_inverter_paco = tmp->_inverter_paco;
 	_ppa_price_rt_series = tmp->_ppa_price_rt_series;
+	m_priceForecast = tmp->m_priceForecast;
+	_P_battery_opt = tmp->_P_battery_opt;
 
 	m_battReplacementCostPerKWH = tmp->m_battReplacementCostPerKWH;
 	m_etaPVCharge = tmp->m_etaPVCharge;
@@ -1291,6 +1443,9 @@ void dispatch_automatic_front_of_meter_t::setup_cost_forecast_vector()
 		ppa_price_series.push_back(_ppa_price_rt_series[i]);
 	}
 	_ppa_price_rt_series = ppa_price_series;
+
+	// forecast windows start on the hour
+	m_priceForecast.compute_extrema(_ppa_price_rt_series, _look_ahead_hours * _steps_per_hour, _steps_per_hour);
 }
 
 // deep copy from dispatch to this
@@ -1320,7 +1475,7 @@ void dispatch_automatic_front_of_meter_t::dispatch(size_t year,
 	dispatch_automatic_t::dispatch(year, hour_of_year, step);
 }
 
-void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, size_t , size_t lifetimeIndex)
+void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, size_t step, size_t lifetimeIndex)
 {
 	// Initialize
 	m_batteryPower->powerBatteryDC = 0;
@@ -1343,102 +1498,115 @@ void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, s
 			/*! Cost to cycle the battery at all, using maximum DOD or user input */
 			costToCycle();
 			 
-			// Compute forecast variables which don't change from year to year
-			size_t idx_year1 = hour_of_year * _steps_per_hour;
-			size_t idx_lookahead = _look_ahead_hours * _steps_per_hour;
-			auto max_ppa_cost = std::max_element(_ppa_price_rt_series.begin() + idx_year1, _ppa_price_rt_series.begin() + idx_year1 + idx_lookahead);
-			auto min_ppa_cost = std::min_element(_ppa_price_rt_series.begin() + idx_year1, _ppa_price_rt_series.begin() + idx_year1 + idx_lookahead);
-			double ppa_cost = _ppa_price_rt_series[idx_year1];
-
-			/*! Cost to purchase electricity from the utility */
-			double usage_cost = ppa_cost;
-			if (m_utilityRateCalculator) {
-				usage_cost = m_utilityRateCalculator->getEnergyRate(hour_of_year);
+			// plan over the look ahead, otherwise use the rule-based dispatch
+			if (m_dispatchOptimizer && optimize_dispatch(hour_of_year, step, lifetimeIndex)) {
+				powerBattery = _P_battery_opt[0];
 			}
+			else {
+				_P_battery_opt.clear();
+
+				// Compute forecast variables which don't change from year to year
+				size_t idx_year1 = hour_of_year * _steps_per_hour;
+				double max_ppa_cost = m_priceForecast.max(idx_year1);
+				double min_ppa_cost = m_priceForecast.min(idx_year1);
+				double ppa_cost = _ppa_price_rt_series[idx_year1];
+
+				/*! Cost to purchase electricity from the utility */
+				double usage_cost = ppa_cost;
+				if (m_utilityRateCalculator) {
+					usage_cost = m_utilityRateCalculator->getEnergyRate(hour_of_year);
+				}
 
-			// Compute forecast variables which potentially do change from year to year
-			double energyToStoreClipped = 0;
-			if (_P_cliploss_dc.size() > lifetimeIndex + _look_ahead_hours) {
-				energyToStoreClipped = std::accumulate(_P_cliploss_dc.begin() + lifetimeIndex, _P_cliploss_dc.begin() + lifetimeIndex + _look_ahead_hours * _steps_per_hour, 0.0f) * _dt_hour;
-			}
+				// Compute forecast variables which potentially do change from year to year
+				double energyToStoreClipped = 0;
+				// keeps the previous end-of-data test, which skips the last full window at hourly steps;
+				// has_sum only adds the guard against windows that run past the data at subhourly steps
+				if (_P_cliploss_dc.size() > lifetimeIndex + _look_ahead_hours && m_cliplossForecast.has_sum(lifetimeIndex)) {
+					energyToStoreClipped = m_cliplossForecast.sum(lifetimeIndex) * _dt_hour;
+				}
 
-			/*! Economic benefit of charging from the grid in current time step to discharge sometime in next X hours ($/kWh)*/
-			double benefitToGridCharge = *max_ppa_cost * m_etaDischarge - usage_cost / m_etaGridCharge - m_cycleCost;
+				/*! Economic benefit of charging from the grid in current time step to discharge sometime in next X hours ($/kWh)*/
+				double benefitToGridCharge = max_ppa_cost * m_etaDischarge - usage_cost / m_etaGridCharge - m_cycleCost;
 
-			/*! Economic benefit of charging from regular PV in current time step to discharge sometime in next X hours ($/kWh)*/
-			double benefitToPVCharge = *max_ppa_cost * m_etaDischarge - ppa_cost / m_etaPVCharge - m_cycleCost;
+				/*! Economic benefit of charging from regular PV in current time step to discharge sometime in next X hours ($/kWh)*/
+				double benefitToPVCharge = max_ppa_cost * m_etaDischarge - ppa_cost / m_etaPVCharge - m_cycleCost;
 
-			/*! Economic benefit of charging from clipped PV in current time step to discharge sometime in the next X hours (clipped PV is free) ($/kWh) */
-			double benefitToClipCharge = *max_ppa_cost * m_etaDischarge - m_cycleCost;
+				/*! Economic benefit of charging from clipped PV in current time step to discharge sometime in the next X hours (clipped PV is free) ($/kWh) */
+				double benefitToClipCharge = max_ppa_cost * m_etaDischarge - m_cycleCost;
 
-			/*! Economic benefit of discharging in current time step ($/kWh) */
-			double benefitToDischarge = ppa_cost * m_etaDischarge - m_cycleCost;
+				/*! Economic benefit of discharging in current time step ($/kWh) */
+				double benefitToDischarge = ppa_cost * m_etaDischarge - m_cycleCost;
 
-			/*! Energy need to charge the battery (kWh) */
-			double energyNeededToFillBattery = _Battery->battery_energy_to_fill(m_batteryPower->stateOfChargeMax);
+				/*! Energy need to charge the battery (kWh) */
+				double energyNeededToFillBattery = _Battery->battery_energy_to_fill(m_batteryPower->stateOfChargeMax);
 
-			/* Booleans to assist decisions */
-			bool highDischargeValuePeriod = ppa_cost == *max_ppa_cost;
-			bool highChargeValuePeriod = ppa_cost == *min_ppa_cost;
-			bool excessAcCapacity = _inverter_paco > m_batteryPower->powerPVThroughSharedInverter;
-			bool batteryHasDischargeCapacity = _Battery->battery_soc() >= m_batteryPower->stateOfChargeMin + 1.0;
+				/* Booleans to assist decisions */
+				bool highDischargeValuePeriod = ppa_cost == max_ppa_cost;
+				bool highChargeValuePeriod = ppa_cost == min_ppa_cost;
+				bool excessAcCapacity = _inverter_paco > m_batteryPower->powerPVThroughSharedInverter;
+				bool batteryHasDischargeCapacity = _Battery->battery_soc() >= m_batteryPower->stateOfChargeMin + 1.0;
 
-			// Always Charge if PV is clipping 
-			if (m_batteryPower->canClipCharge && m_batteryPower->powerPVClipped > 0 && benefitToClipCharge > 0)
-			{
-				powerBattery = -m_batteryPower->powerPVClipped;
-			}
+				// Always Charge if PV is clipping 
+				if (m_batteryPower->canClipCharge && m_batteryPower->powerPVClipped > 0 && benefitToClipCharge > 0)
+				{
+					powerBattery = -m_batteryPower->powerPVClipped;
+				}
 
-			// Increase charge from PV if it is more valuable later than selling now
-			if (m_batteryPower->canPVCharge && benefitToPVCharge > 0 && highChargeValuePeriod && m_batteryPower->powerPV > 0)
-			{
-				// leave EnergyToStoreClipped capacity in battery
-				if (m_batteryPower->canClipCharge)
+				// Increase charge from PV if it is more valuable later than selling now
+				if (m_batteryPower->canPVCharge && benefitToPVCharge > 0 && highChargeValuePeriod && m_batteryPower->powerPV > 0)
 				{
-					if (energyToStoreClipped < energyNeededToFillBattery)
+					// leave EnergyToStoreClipped capacity in battery
+					if (m_batteryPower->canClipCharge)
 					{
-						double energyCanCharge = (energyNeededToFillBattery - energyToStoreClipped);
-						if (energyCanCharge <= m_batteryPower->powerPV * _dt_hour)
-							powerBattery = -std::fmax(energyCanCharge / _dt_hour, m_batteryPower->powerPVClipped);
-						else
-							powerBattery = -std::fmax(m_batteryPower->powerPV, m_batteryPower->powerPVClipped);
+						if (energyToStoreClipped < energyNeededToFillBattery)
+						{
+							double energyCanCharge = (energyNeededToFillBattery - energyToStoreClipped);
+							if (energyCanCharge <= m_batteryPower->powerPV * _dt_hour)
+								powerBattery = -std::fmax(energyCanCharge / _dt_hour, m_batteryPower->powerPVClipped);
+							else
+								powerBattery = -std::fmax(m_batteryPower->powerPV, m_batteryPower->powerPVClipped);
 
-						energyNeededToFillBattery = std::fmax(0, energyNeededToFillBattery + (powerBattery * _dt_hour));
-					}
+							energyNeededToFillBattery = std::fmax(0, energyNeededToFillBattery + (powerBattery * _dt_hour));
+						}
 
+					}
+					// otherwise, don't reserve capacity for clipping
+					else {
+						powerBattery = -m_batteryPower->powerPV;
+					}
 				}
-				// otherwise, don't reserve capacity for clipping
-				else {
-					powerBattery = -m_batteryPower->powerPV;
-				}
-			}
 
-			// Also charge from grid if it is valuable to do so, still leaving EnergyToStoreClipped capacity in battery
-			if (m_batteryPower->canGridCharge && benefitToGridCharge > 0 && highChargeValuePeriod && energyNeededToFillBattery > 0)
-			{
-				// leave EnergyToStoreClipped capacity in battery
-				if (m_batteryPower->canClipCharge)
+				// Also charge from grid if it is valuable to do so, still leaving EnergyToStoreClipped capacity in battery
+				if (m_batteryPower->canGridCharge && benefitToGridCharge > 0 && highChargeValuePeriod && energyNeededToFillBattery > 0)
 				{
-					if (energyToStoreClipped < energyNeededToFillBattery)
+					// leave EnergyToStoreClipped capacity in battery
+					if (m_batteryPower->canClipCharge)
 					{
-						double energyCanCharge = (energyNeededToFillBattery - energyToStoreClipped);
-						powerBattery -= energyCanCharge / _dt_hour;
+						if (energyToStoreClipped < energyNeededToFillBattery)
+						{
+							double energyCanCharge = (energyNeededToFillBattery - energyToStoreClipped);
+							powerBattery -= energyCanCharge / _dt_hour;
+						}
 					}
+					else
+						powerBattery = -energyNeededToFillBattery / _dt_hour;
 				}
-				else
-					powerBattery = -energyNeededToFillBattery / _dt_hour;
-			}
 
-			// Discharge if we are in a high-price period and have battery and inverter capacity
-			if (highDischargeValuePeriod && benefitToDischarge > 0 && excessAcCapacity && batteryHasDischargeCapacity) {
-				if (m_batteryPower->connectionMode == BatteryPower::DC_CONNECTED) {
-					powerBattery = _inverter_paco - m_batteryPower->powerPV;
-				}
-				else {
-					powerBattery = _inverter_paco;
+				// Discharge if we are in a high-price period and have battery and inverter capacity
+				if (highDischargeValuePeriod && benefitToDischarge > 0 && excessAcCapacity && batteryHasDischargeCapacity) {
+					if (m_batteryPower->connectionMode == BatteryPower::DC_CONNECTED) {
+						powerBattery = _inverter_paco - m_batteryPower->powerPV;
+					}
+					else {
+						powerBattery = _inverter_paco;
+					}
 				}
 			}
 		}
+		// follow the plan between updates
+		else if (lifetimeIndex > _index_last_updated && lifetimeIndex - _index_last_updated < _P_battery_opt.size()) {
+			powerBattery = _P_battery_opt[lifetimeIndex - _index_last_updated];
+		}
 		// save for extraction
 		m_batteryPower->powerBatteryTarget = powerBattery;
 	}
@@ -1451,6 +1619,54 @@ void dispatch_automatic_front_of_meter_t::update_dispatch(size_t hour_of_year, s
 	m_batteryPower->powerBatteryDC = m_batteryPower->powerBatteryTarget;
 }
 
+bool dispatch_automatic_front_of_meter_t::optimize_dispatch(size_t hour_of_year, size_t step, size_t lifetimeIndex)
+{
+	size_t n_steps = _look_ahead_hours * _steps_per_hour;
+	size_t idx_year1 = hour_of_year * _steps_per_hour + step;
+
+	set_optimizer_limits();
+	dispatch_opt_t::s_params & params = m_dispatchOptimizer->params;
+	dispatch_opt_t::s_forecast & forecast = m_dispatchOptimizer->forecast;
+	params.eta_pv_charge = m_etaPVCharge;
+	params.eta_grid_charge = m_etaGridCharge;
+	params.eta_discharge = m_etaDischarge;
+	params.cycle_cost = m_cycleCost;
+
+	forecast.P_pv.resize(n_steps);
+	forecast.P_clip.resize(n_steps);
+	forecast.P_discharge_max.resize(n_steps);
+	forecast.price_sell.resize(n_steps);
+	forecast.price_buy.resize(n_steps);
+	for (size_t i = 0; i != n_steps; i++)
+	{
+		// the current step is known, the rest of the window is forecast
+		double P_pv = m_batteryPower->powerPV;
+		double P_clip = m_batteryPower->powerPVClipped;
+		if (i > 0) {
+			P_pv = lifetimeIndex + i < _P_pv_dc.size() ? _P_pv_dc[lifetimeIndex + i] : 0;
+			P_clip = lifetimeIndex + i < _P_cliploss_dc.size() ? _P_cliploss_dc[lifetimeIndex + i] : 0;
+		}
+		forecast.P_pv[i] = P_pv;
+		forecast.P_clip[i] = P_clip;
+
+		// discharge shares the inverter with PV if DC-connected
+		forecast.P_discharge_max[i] = params.P_discharge_max;
+		if (m_batteryPower->connectionMode == BatteryPower::DC_CONNECTED)
+			forecast.P_discharge_max[i] = std::fmax(0, _inverter_paco - P_pv);
+
+		forecast.price_sell[i] = _ppa_price_rt_series[idx_year1 + i];
+		forecast.price_buy[i] = forecast.price_sell[i];
+		if (m_utilityRateCalculator)
+			forecast.price_buy[i] = m_utilityRateCalculator->getEnergyRate(((idx_year1 + i) / _steps_per_hour) % 8760);
+	}
+
+	if (!m_dispatchOptimizer->optimize(n_steps))
+		return false;
+
+	_P_battery_opt = m_dispatchOptimizer->outputs.P_battery;
+	return true;
+}
+
 void dispatch_automatic_front_of_meter_t::update_cliploss_data(double_vec P_cliploss)
 {
 	_P_cliploss_dc = P_cliploss;
@@ -1458,6 +1674,8 @@ void dispatch_automatic_front_of_meter_t::update_cliploss_data(double_vec P_clip
 	// append to end to allow for look-ahead
 	for (size_t i = 0; i != _look_ahead_hours * _steps_per_hour; i++)
 		_P_cliploss_dc.push_back(P_cliploss[i]);
+
+	m_cliplossForecast.compute_sum(_P_cliploss_dc, _look_ahead_hours * _steps_per_hour);
 }
 
 void dispatch_automatic_front_of_meter_t::costToCycle()
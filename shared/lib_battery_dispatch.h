@@ -24,6 +24,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 #include "lib_battery.h"
+#include "lib_battery_dispatch_opt.h"
 
 
 #ifndef __LIB_BATTERY_DISPATCH_H__
@@ -47,8 +48,8 @@ class dispatch_t
 {
 public:
 
-	enum FOM_MODES { FOM_LOOK_AHEAD, FOM_LOOK_BEHIND, FOM_FORECAST, FOM_CUSTOM_DISPATCH, FOM_MANUAL };
-	enum BTM_MODES { LOOK_AHEAD, LOOK_BEHIND, MAINTAIN_TARGET, CUSTOM_DISPATCH, MANUAL };
+	enum FOM_MODES { FOM_LOOK_AHEAD, FOM_LOOK_BEHIND, FOM_FORECAST, FOM_CUSTOM_DISPATCH, FOM_MANUAL, FOM_OPTIMIZED_LOOK_AHEAD };
+	enum BTM_MODES { LOOK_AHEAD, LOOK_BEHIND, MAINTAIN_TARGET, CUSTOM_DISPATCH, MANUAL, OPTIMIZED_LOOK_AHEAD };
 	enum METERING { BEHIND, FRONT };
 	enum PV_PRIORITY { MEET_LOAD, CHARGE_BATTERY };
 	enum CURRENT_CHOICE { RESTRICT_POWER, RESTRICT_CURRENT, RESTRICT_BOTH };
@@ -143,14 +144,16 @@ protected:
 	bool restrict_power(double &I);
 
 	battery_t * _Battery;
-	battery_t * _Battery_initial;
+
+	// state of _Battery at the start of the step, restored between dispatch iterations
+	battery_state _Battery_checkpoint;
 
 	double _dt_hour;
 
 	/** 
 	The dispatch mode. 
-	For behind-the-meter dispatch: 0 = LOOK_AHEAD, 1 = LOOK_BEHIND, 2 = MAINTAIN_TARGET, 3 = MANUAL
-	For front-of-meter dispatch: 0 = LOOK_AHEAD, 1 = LOOK_BEHIND, 2 = INPUT FORECAST, 3 = MANUAL
+	For behind-the-meter dispatch: 0 = LOOK_AHEAD, 1 = LOOK_BEHIND, 2 = MAINTAIN_TARGET, 3 = CUSTOM_DISPATCH, 4 = MANUAL, 5 = OPTIMIZED_LOOK_AHEAD
+	For front-of-meter dispatch: 0 = LOOK_AHEAD, 1 = LOOK_BEHIND, 2 = INPUT FORECAST, 3 = CUSTOM_DISPATCH, 4 = MANUAL, 5 = OPTIMIZED_LOOK_AHEAD
 	*/
 	int _mode; 
 
@@ -284,6 +287,40 @@ struct byGrid
 };
 typedef std::vector<grid_point> grid_vec;
 
+/*! Look-ahead window statistics of a forecast series */
+class forecast_window_t
+{
+	/**
+	Maximum, minimum and sum of a forecast series (price, PV, load, clipping) over the window [i, i + width),
+	for every window start i which is a multiple of stride.  Computed in a single pass with monotonic deques
+	and a running sum, so dispatch updates read the window statistics in constant time instead of rescanning
+	the look-ahead window at every update.
+	*/
+public:
+	forecast_window_t() : _stride(1) {}
+
+	/*! Compute the maximum and minimum over each window */
+	void compute_extrema(const std::vector<double> & series, size_t width, size_t stride = 1);
+
+	/*! Compute the sum over each window */
+	void compute_sum(const std::vector<double> & series, size_t width, size_t stride = 1);
+
+	/*! Window statistics by window start index, which must be a multiple of stride */
+	double max(size_t start) const { return _max[start / _stride]; }
+	double min(size_t start) const { return _min[start / _stride]; }
+	double sum(size_t start) const { return _sum[start / _stride]; }
+
+	/*! Whether the window at start fits within the series */
+	bool has_extrema(size_t start) const { return start / _stride < _max.size(); }
+	bool has_sum(size_t start) const { return start / _stride < _sum.size(); }
+
+protected:
+	size_t _stride;
+	std::vector<double> _max;
+	std::vector<double> _min;
+	std::vector<double> _sum;
+};
+
 /*! Automated dispatch base class */
 class dispatch_automatic_t : public dispatch_t
 {
@@ -338,6 +375,9 @@ public:
 	/*! Pass in the user-defined dispatch power vector */
 	virtual void set_custom_dispatch(std::vector<double> P_batt_dc);
 
+	/*! Set the time limit for each solve of the optimized look ahead modes [s] */
+	void set_optimizer_timeout(double timeout);
+
 	/* Check constraints and re-dispatch if needed */
 	virtual bool check_constraints(double &I, size_t count);
 
@@ -352,6 +392,9 @@ protected:
 	/*! Return the dispatch mode */
 	int get_mode();
 
+	/*! Set the battery power and energy limits of the optimizer from the current battery state */
+	void set_optimizer_limits();
+
 	/*! Full time-series of PV production [kW] */
 	double_vec _P_pv_dc;		
 	
@@ -396,6 +439,9 @@ protected:
 
 	/*! The hours to look ahead in the simulation [hour] */
 	size_t _look_ahead_hours;
+
+	/*! Linear program for the optimized look ahead modes, null otherwise */
+	std::unique_ptr<dispatch_opt_t> m_dispatchOptimizer;
 };
 
 /*! Automated dispatch class for behind-the-meter connections */
@@ -471,6 +517,9 @@ protected:
 	void set_battery_power(FILE *p, bool debug);
 	void check_new_month(size_t hour_of_year, size_t step);
 
+	/*! Set the battery and target powers for the next 24 hours from the optimizer, returns false if no solution was found */
+	bool optimize_dispatch(size_t idx);
+
 	/*! Full time-series of loads [kW] */
 	double_vec _P_load_dc;
 
@@ -566,6 +615,9 @@ protected:
 	void init_with_pointer(const dispatch_automatic_front_of_meter_t* tmp);
 	void setup_cost_forecast_vector();
 
+	/*! Plan the battery power over the look ahead from the optimizer, returns false if no solution was found */
+	bool optimize_dispatch(size_t hour_of_year, size_t step, size_t lifetimeIndex);
+
 	/*! Full clipping loss due to AC power limits vector */
 	double_vec _P_cliploss_dc;
 
@@ -575,6 +627,13 @@ protected:
 	/*! Market real time and forecast prices */
 	std::vector<double> _ppa_price_rt_series;
 
+	/*! Look-ahead price extrema by hour of year, and clipping loss energy by lifetime index */
+	forecast_window_t m_priceForecast;
+	forecast_window_t m_cliplossForecast;
+
+	/*! Optimized battery power from the last dispatch update over the look ahead [kW] */
+	double_vec _P_battery_opt;
+
 	/*! Utility rate information */
 	std::unique_ptr<UtilityRateCalculator> m_utilityRateCalculator;
 
@@ -0,0 +1,278 @@
+/**
+BSD-3-Clause
+Copyright 2019 Alliance for Sustainable Energy, LLC
+Redistribution and use in source and binary forms, with or without modification, are permitted provided 
+that the following conditions are met :
+1.	Redistributions of source code must retain the above copyright notice, this list of conditions 
+and the following disclaimer.
+2.	Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+and the following disclaimer in the documentation and/or other materials provided with the distribution.
+3.	Neither the name of the copyright holder nor the names of its contributors may be used to endorse 
+or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER, CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES 
+DEPARTMENT OF ENERGY, NOR ANY OF THEIR EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "lib_battery_dispatch_opt.h"
+#include "lp_lib.h"
+
+dispatch_opt_t::s_params::s_params()
+{
+	dt_hour = 1.;
+	P_charge_max = P_discharge_max = 0.;
+	E_min = E_max = E_init = 0.;
+	eta_pv_charge = eta_grid_charge = eta_discharge = 1.;
+	cycle_cost = 0.;
+	peak_cost = 1.;
+	peak_min = 0.;
+	value_end = -1.;
+	can_pv_charge = can_grid_charge = can_clip_charge = false;
+}
+
+dispatch_opt_t::dispatch_opt_t(int objective) :
+	_objective(objective), _n_steps(0), _lp(0)
+{
+	outputs.objective = 0.;
+	outputs.solve_state = NOMEMORY;
+	outputs.solve_time = 0.;
+}
+
+dispatch_opt_t::dispatch_opt_t(const dispatch_opt_t& opt) :
+	params(opt.params), forecast(opt.forecast), solver_params(opt.solver_params), outputs(opt.outputs),
+	_objective(opt._objective), _n_steps(0), _lp(0), _basis(opt._basis)
+{
+}
+
+dispatch_opt_t::~dispatch_opt_t()
+{
+	if (_lp)
+		delete_lp(_lp);
+}
+
+int dispatch_opt_t::n_vars() const
+{
+	// grid import and export at each step, plus the peak import
+	if (_objective == MINIMIZE_PEAK)
+		return (int)(8 * _n_steps + 1);
+	return (int)(6 * _n_steps);
+}
+
+void dispatch_opt_t::build_model()
+{
+	/**
+	Rows, in order, each over the window:
+		energy balance:	e[t] - e[t-1] - dt*(c_pv[t] + c_grid[t] + c_clip[t]) + dt*d[t] = 0, with e[-1] = E_init on the right hand side
+		charge limit:	c_pv[t] + c_grid[t] + c_clip[t] - P_charge_max*y[t] <= 0
+		discharge limit:	d[t] + P_discharge_max[t]*y[t] <= P_discharge_max[t]
+	with the binary y[t] = 1 when charging, and behind the meter:
+		grid balance:	g_imp[t] - g_exp[t] - c_pv[t]/eta_pv - c_grid[t]/eta_grid + eta_d*d[t] = P_load[t]
+		peak:			peak - g_imp[t] >= 0
+	Only the structure is set here, coefficients which depend on the inputs are set in update_model
+	*/
+	if (_lp)
+		delete_lp(_lp);
+	_basis.clear();
+
+	int nt = (int)_n_steps;
+	_lp = make_lp(0, n_vars());
+	set_verbose(_lp, 0);
+	set_minim(_lp);
+	set_add_rowmode(_lp, TRUE);
+
+	REAL row[7];
+	int col[7];
+	for (int t = 0; t < nt; t++)
+	{
+		int i = 0;
+		row[i] = 1.;	col[i++] = this->col(ENERGY, t);
+		if (t > 0)
+		{
+			row[i] = -1.;	col[i++] = this->col(ENERGY, t - 1);
+		}
+		row[i] = -1.;	col[i++] = this->col(CHARGE_PV, t);
+		row[i] = -1.;	col[i++] = this->col(CHARGE_GRID, t);
+		row[i] = -1.;	col[i++] = this->col(CHARGE_CLIP, t);
+		row[i] = 1.;	col[i++] = this->col(DISCHARGE, t);
+		add_constraintex(_lp, i, row, col, EQ, 0.);
+	}
+	for (int t = 0; t < nt; t++)
+	{
+		row[0] = 1.;	col[0] = this->col(CHARGE_PV, t);
+		row[1] = 1.;	col[1] = this->col(CHARGE_GRID, t);
+		row[2] = 1.;	col[2] = this->col(CHARGE_CLIP, t);
+		row[3] = -1.;	col[3] = this->col(CHARGING, t);
+		add_constraintex(_lp, 4, row, col, LE, 0.);
+	}
+	for (int t = 0; t < nt; t++)
+	{
+		row[0] = 1.;	col[0] = this->col(DISCHARGE, t);
+		row[1] = 1.;	col[1] = this->col(CHARGING, t);
+		add_constraintex(_lp, 2, row, col, LE, 0.);
+		set_binary(_lp, this->col(CHARGING, t), TRUE);
+	}
+	if (_objective == MINIMIZE_PEAK)
+	{
+		for (int t = 0; t < nt; t++)
+		{
+			row[0] = 1.;	col[0] = this->col(GRID_IMPORT, t);
+			row[1] = -1.;	col[1] = this->col(GRID_EXPORT, t);
+			row[2] = -1.;	col[2] = this->col(CHARGE_PV, t);
+			row[3] = -1.;	col[3] = this->col(CHARGE_GRID, t);
+			row[4] = 1.;	col[4] = this->col(DISCHARGE, t);
+			add_constraintex(_lp, 5, row, col, EQ, 0.);
+		}
+		for (int t = 0; t < nt; t++)
+		{
+			row[0] = 1.;	col[0] = n_vars();
+			row[1] = -1.;	col[1] = this->col(GRID_IMPORT, t);
+			add_constraintex(_lp, 2, row, col, GE, 0.);
+		}
+	}
+	set_add_rowmode(_lp, FALSE);
+}
+
+void dispatch_opt_t::update_model()
+{
+	int nt = (int)_n_steps;
+	double dt = params.dt_hour;
+	double eta_pv = std::max(params.eta_pv_charge, 1e-3);
+	double eta_grid = std::max(params.eta_grid_charge, 1e-3);
+	double eta_d = params.eta_discharge;
+
+	// value of energy left in the battery at the end of the window
+	double value_end = params.value_end;
+	if (value_end < 0)
+	{
+		value_end = 0.;
+		if (!forecast.price_sell.empty())
+		{
+			double price_min = *std::min_element(forecast.price_sell.begin(), forecast.price_sell.begin() + nt);
+			value_end = std::max(0., eta_d * price_min - params.cycle_cost);
+		}
+	}
+
+	std::vector<REAL> obj(n_vars() + 1, 0.);
+	for (int t = 0; t < nt; t++)
+	{
+		double sell = forecast.price_sell.empty() ? 0. : forecast.price_sell[t];
+		double buy = forecast.price_buy.empty() ? sell : forecast.price_buy[t];
+		double pv = forecast.P_pv.empty() ? 0. : std::max(0., forecast.P_pv[t]);
+		double clip = forecast.P_clip.empty() ? 0. : std::max(0., forecast.P_clip[t]);
+		double P_discharge_max = params.P_discharge_max;
+		if (!forecast.P_discharge_max.empty())
+			P_discharge_max = std::max(0., std::min(P_discharge_max, forecast.P_discharge_max[t]));
+
+		// the charging and discharging terms of the energy balance, the rest of the row is fixed
+		set_mat(_lp, t + 1, col(CHARGE_PV, t), -dt);
+		set_mat(_lp, t + 1, col(CHARGE_GRID, t), -dt);
+		set_mat(_lp, t + 1, col(CHARGE_CLIP, t), -dt);
+		set_mat(_lp, t + 1, col(DISCHARGE, t), dt);
+		set_rh(_lp, t + 1, t == 0 ? params.E_init : 0.);
+		set_mat(_lp, nt + t + 1, col(CHARGING, t), -params.P_charge_max);
+		set_mat(_lp, 2 * nt + t + 1, col(CHARGING, t), P_discharge_max);
+		set_rh(_lp, 2 * nt + t + 1, P_discharge_max);
+
+		set_bounds(_lp, col(CHARGE_PV, t), 0., params.can_pv_charge ? std::min(eta_pv * pv, params.P_charge_max) : 0.);
+		set_bounds(_lp, col(CHARGE_GRID, t), 0., params.can_grid_charge ? params.P_charge_max : 0.);
+		set_bounds(_lp, col(CHARGE_CLIP, t), 0., params.can_clip_charge ? std::min(clip, params.P_charge_max) : 0.);
+		set_bounds(_lp, col(DISCHARGE, t), 0., P_discharge_max);
+		set_bounds(_lp, col(ENERGY, t), params.E_min, params.E_max);
+
+		if (_objective == MINIMIZE_PEAK)
+		{
+			double load = forecast.P_load.empty() ? 0. : forecast.P_load[t];
+			set_mat(_lp, 3 * nt + t + 1, col(CHARGE_PV, t), -1. / eta_pv);
+			set_mat(_lp, 3 * nt + t + 1, col(CHARGE_GRID, t), -1. / eta_grid);
+			set_mat(_lp, 3 * nt + t + 1, col(DISCHARGE, t), eta_d);
+			set_rh(_lp, 3 * nt + t + 1, load);
+			set_bounds(_lp, col(GRID_IMPORT, t), 0., get_infinite(_lp));
+			set_bounds(_lp, col(GRID_EXPORT, t), 0., get_infinite(_lp));
+
+			// PV charging is free, it would otherwise be exported
+			obj[col(GRID_IMPORT, t)] = dt * buy;
+			obj[col(GRID_EXPORT, t)] = -dt * sell;
+			obj[col(DISCHARGE, t)] = dt * params.cycle_cost;
+		}
+		else
+		{
+			// PV and grid charging are valued at what the energy would have sold or cost at the meter
+			obj[col(CHARGE_PV, t)] = dt * sell / eta_pv;
+			obj[col(CHARGE_GRID, t)] = dt * buy / eta_grid;
+			obj[col(DISCHARGE, t)] = -dt * (sell * eta_d - params.cycle_cost);
+		}
+	}
+	obj[col(ENERGY, nt - 1)] = -value_end;
+	if (_objective == MINIMIZE_PEAK)
+	{
+		set_bounds(_lp, n_vars(), std::max(0., params.peak_min), get_infinite(_lp));
+		obj[n_vars()] = params.peak_cost;
+	}
+	set_obj_fn(_lp, obj.data());
+}
+
+bool dispatch_opt_t::optimize(size_t n_steps)
+{
+	outputs.P_battery.clear();
+	outputs.P_grid.clear();
+	outputs.objective = 0.;
+	outputs.solve_time = 0.;
+	if (n_steps == 0)
+	{
+		outputs.solve_state = INFEASIBLE;
+		return false;
+	}
+
+	if (!_lp || n_steps != _n_steps)
+	{
+		_n_steps = n_steps;
+		std::vector<int> basis = _basis;
+		build_model();
+		// a basis carried over from a copy is only valid for the same window length
+		if (basis.size() == (size_t)(1 + get_Nrows(_lp) + get_Ncolumns(_lp)))
+			_basis = basis;
+	}
+	update_model();
+
+	if (!_basis.empty())
+		set_basis(_lp, _basis.data(), TRUE);
+	// zero would disable the limit, so any positive timeout is at least one second
+	set_timeout(_lp, std::max(1L, (long)std::ceil(solver_params.timeout)));
+
+	int ret = solve(_lp);
+	outputs.solve_state = ret;
+	outputs.solve_time = time_elapsed(_lp);
+
+	if (ret != OPTIMAL && ret != SUBOPTIMAL)
+	{
+		// start the next window from scratch
+		_basis.clear();
+		default_basis(_lp);
+		return false;
+	}
+
+	_basis.resize(1 + get_Nrows(_lp) + get_Ncolumns(_lp));
+	get_basis(_lp, _basis.data(), TRUE);
+
+	std::vector<REAL> vars(get_Ncolumns(_lp));
+	get_variables(_lp, vars.data());
+	outputs.objective = get_objective(_lp);
+	outputs.P_battery.resize(n_steps);
+	for (size_t t = 0; t < n_steps; t++)
+	{
+		outputs.P_battery[t] = vars[col(DISCHARGE, t) - 1] - vars[col(CHARGE_PV, t) - 1]
+			- vars[col(CHARGE_GRID, t) - 1] - vars[col(CHARGE_CLIP, t) - 1];
+		if (_objective == MINIMIZE_PEAK)
+			outputs.P_grid.push_back(vars[col(GRID_IMPORT, t) - 1] - vars[col(GRID_EXPORT, t) - 1]);
+	}
+	return true;
+}
@@ -0,0 +1,131 @@
+/**
+BSD-3-Clause
+Copyright 2019 Alliance for Sustainable Energy, LLC
+Redistribution and use in source and binary forms, with or without modification, are permitted provided 
+that the following conditions are met :
+1.	Redistributions of source code must retain the above copyright notice, this list of conditions 
+and the following disclaimer.
+2.	Redistributions in binary form must reproduce the above copyright notice, this list of conditions 
+and the following disclaimer in the documentation and/or other materials provided with the distribution.
+3.	Neither the name of the copyright holder nor the names of its contributors may be used to endorse 
+or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE 
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER, CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES 
+DEPARTMENT OF ENERGY, NOR ANY OF THEIR EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+OR CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __LIB_BATTERY_DISPATCH_OPT_H__
+#define __LIB_BATTERY_DISPATCH_OPT_H__
+
+#include <cstddef>
+#include <vector>
+
+// lp_solve problem context, defined in lp_lib.h
+struct _lprec;
+
+/*! Mixed integer linear program for battery dispatch over a look-ahead window */
+class dispatch_opt_t
+{
+	/**
+	Finds the battery power profile over a look-ahead window which either maximizes market revenue (front of meter)
+	or minimizes the peak grid demand and energy cost (behind the meter), subject to the battery power and
+	state-of-charge limits.  The model is built once for the window length and only its coefficients are updated
+	between windows, and the final basis of each solve is used to warm start the next one.  Solve time is limited by
+	solver_params.timeout, and the caller is expected to fall back to rule-based dispatch if no solution is found.
+
+	Battery powers are DC, positive for discharge.  Charging and discharging efficiencies convert between the battery
+	and the meter, so they enter through the value of energy and the grid balance rather than the energy balance.
+	A binary variable at each step selects charging or discharging.  Without it, charging and discharging at once 
+	would burn energy in round trip losses, which pays whenever prices are negative or grid energy is cheaper than the
+	value of discharged energy, and the net battery power would not match the plan's cost.
+	*/
+public:
+	enum OBJECTIVE { MAXIMIZE_REVENUE, MINIMIZE_PEAK };
+
+	dispatch_opt_t(int objective);
+
+	/*! Deep copy, the solver context is rebuilt on the next solve */
+	dispatch_opt_t(const dispatch_opt_t& opt);
+
+	/*! Not assignable, since the solver context is owned */
+	dispatch_opt_t& operator=(const dispatch_opt_t&) = delete;
+
+	~dispatch_opt_t();
+
+	struct s_params
+	{
+		double dt_hour;				// [hr] - timestep
+		double P_charge_max;		// [kW] - maximum charge power
+		double P_discharge_max;		// [kW] - maximum discharge power
+		double E_min;				// [kWh] - energy at minimum state of charge
+		double E_max;				// [kWh] - energy at maximum state of charge
+		double E_init;				// [kWh] - energy at the start of the window
+		double eta_pv_charge;		// [0-1] - efficiency of charging from PV
+		double eta_grid_charge;		// [0-1] - efficiency of charging from the grid
+		double eta_discharge;		// [0-1] - efficiency of discharging
+		double cycle_cost;			// [$/kWh] - cost of battery degradation per kWh discharged
+		double peak_cost;			// [$/kW] - cost of the peak grid demand in the window (MINIMIZE_PEAK)
+		double peak_min;			// [kW] - peak grid demand already incurred, below which there is no benefit to shaving (MINIMIZE_PEAK)
+		double value_end;			// [$/kWh] - value of energy left at the end of the window, if negative taken from the minimum sell price
+		bool can_pv_charge;
+		bool can_grid_charge;
+		bool can_clip_charge;
+
+		s_params();
+	} params;
+
+	/*! Forecast over the window, each of length n_steps */
+	struct s_forecast
+	{
+		std::vector<double> P_pv;			// [kW] - PV power available to charge
+		std::vector<double> P_clip;			// [kW] - clipped PV power available to charge
+		std::vector<double> P_load;			// [kW] - electric load (MINIMIZE_PEAK)
+		std::vector<double> P_discharge_max;// [kW] - discharge limit, for example from the inverter, optional
+		std::vector<double> price_sell;		// [$/kWh] - value of energy delivered
+		std::vector<double> price_buy;		// [$/kWh] - cost of energy from the grid
+	} forecast;
+
+	struct s_solver_params
+	{
+		double timeout;				// [s] - maximum time for one solve, rounded up to whole seconds since lp_solve takes a long
+		s_solver_params() : timeout(5.) {}
+	} solver_params;
+
+	struct s_outputs
+	{
+		std::vector<double> P_battery;	// [kW] - optimal battery power, discharge > 0
+		std::vector<double> P_grid;		// [kW] - grid import less export (MINIMIZE_PEAK)
+		double objective;				// [$] - optimal cost over the window
+		int solve_state;				// lp_solve return code
+		double solve_time;				// [s]
+	} outputs;
+
+	/*! Solve the window described by params and forecast, returns true if a solution was found */
+	bool optimize(size_t n_steps);
+
+protected:
+
+	// variables at each step
+	enum VARS { CHARGE_PV, CHARGE_GRID, CHARGE_CLIP, DISCHARGE, ENERGY, CHARGING, GRID_IMPORT, GRID_EXPORT };
+
+	int col(int var, size_t t) const { return (int)(var * _n_steps + t + 1); }
+	int n_vars() const;
+
+	void build_model();
+	void update_model();
+
+	int _objective;
+	size_t _n_steps;
+	_lprec * _lp;
+
+	// final basis of the last successful solve, used to warm start the next
+	std::vector<int> _basis;
+};
+
+#endif
@@ -47,6 +47,7 @@ cec6par_module_t::cec6par_module_t( )
 {
 	Area = Vmp = Imp = Voc = Isc = alpha_isc = beta_voc 
 		= a = Il = Io = Rs = Rsh = Adj = std::numeric_limits<double>::quiet_NaN();
+	UseLambertW = false;
 }
 double air_mass_modifier( double Zenith_deg, double Elev_m, double a[5] )
 {
@@ -57,7 +58,8 @@ double air_mass_modifier( double Zenith_deg, double Elev_m, double a[5] )
 	return f1 > 0.0 ? f1 : 0.0;
 }
 
-bool cec6par_module_t::operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &out )
+void cec6par_module_t::operating_parameters( pvinput_t &input, double TcellC, pvoutput_t &out, double &G_total, double &Geff_total, 
+	double &T_cell, double &IL_oper, double &IO_oper, double &A_oper, double &Rsh_oper )
 {
 	double muIsc = alpha_isc * (1-Adj/100);
 	//double muVoc = beta_voc * (1+Adj/100);
@@ -65,7 +67,7 @@ bool cec6par_module_t::operator() ( pvinput_t &input, double TcellC, double opvo
 	/* initialize output first */
 	out.Power = out.Voltage = out.Current = out.Efficiency = out.Voc_oper = out.Isc_oper= out.AOIModifier = 0.0;
 	
-	double G_front, G_total, Geff_front_total, Geff_total;
+	double G_front, Geff_front_total;
 
 	if( input.radmode != 3){ // Determine if the model needs to skip the cover effects (will only be skipped if the user is using POA reference cell data) 
 		G_front = input.Ibeam + input.Idiff + input.Ignd;
@@ -105,48 +107,131 @@ bool cec6par_module_t::operator() ( pvinput_t &input, double TcellC, double opvo
 
 	}
 
-	double T_cell = input.Tdry + 273.15;
+	T_cell = input.Tdry + 273.15;
 	if ( Geff_total >= 1.0 ) 
 	{
 		T_cell = TcellC + 273.15; // want cell temp in kelvin
 
 		// calculation of IL and IO at operating conditions
-		double IL_oper = Geff_total/I_ref *( Il + muIsc*(T_cell-Tc_ref) );
+		IL_oper = Geff_total/I_ref *( Il + muIsc*(T_cell-Tc_ref) );
 		if (IL_oper < 0.0) IL_oper = 0.0;
 		
 		double EG = eg0 * (1-0.0002677*(T_cell-Tc_ref));
-		double IO_oper = Io * pow(T_cell/Tc_ref, 3) * exp( 1/KB*(eg0/Tc_ref - EG/T_cell) );
-		double A_oper = a * T_cell / Tc_ref;
-		double Rsh_oper = Rsh*(I_ref/Geff_total);
-			
-		double V_oc = openvoltage_5par( Voc, A_oper, IL_oper, IO_oper, Rsh_oper );
-		double I_sc = IL_oper/(1+Rs/Rsh_oper);
-		
-		double P, V, I;
-		
-		if ( opvoltage < 0 )
-		{
+		IO_oper = Io * pow(T_cell/Tc_ref, 3) * exp( 1/KB*(eg0/Tc_ref - EG/T_cell) );
+		A_oper = a * T_cell / Tc_ref;
+		Rsh_oper = Rsh*(I_ref/Geff_total);
+	}
+}
+
+void cec6par_module_t::solve_operating_point( double T_cell, double G_total, double IL_oper, double IO_oper, double A_oper, double Rsh_oper,
+	double opvoltage, pvoutput_t &out )
+{
+	double V_oc = UseLambertW ? openvoltage_5par_lambertw( A_oper, IL_oper, IO_oper, Rsh_oper )
+		: openvoltage_5par( Voc, A_oper, IL_oper, IO_oper, Rsh_oper );
+	double I_sc = IL_oper/(1+Rs/Rsh_oper);
+	
+	double P, V, I;
+	
+	if ( opvoltage < 0 )
+	{
+		if ( UseLambertW )
+			P = maxpower_5par_lambertw( V_oc, A_oper, IL_oper, IO_oper, Rs, Rsh_oper, &V, &I );
+		else
 			P = maxpower_5par( V_oc, A_oper, IL_oper, IO_oper, Rs, Rsh_oper, &V, &I );			
+	}
+	else
+	{ // calculate power at specified operating voltage
+		V = opvoltage;
+		if (V >= V_oc) I = 0;
+		else if ( UseLambertW ) I = current_5par_lambertw( V, A_oper, IL_oper, IO_oper, Rs, Rsh_oper );
+		else I = current_5par( V, 0.9*IL_oper, A_oper, IL_oper, IO_oper, Rs, Rsh_oper );
+
+		P = V*I;
+	}
+	
+	out.Power = P;
+	out.Voltage  = V;
+	out.Current = I;
+	out.Efficiency = P/(Area*G_total);
+	out.Voc_oper = V_oc;
+	out.Isc_oper = I_sc;
+	out.CellTemp = T_cell - 273.15;
+}
+
+bool cec6par_module_t::operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &out )
+{
+	double G_total, Geff_total, T_cell, IL_oper, IO_oper, A_oper, Rsh_oper;
+	operating_parameters( input, TcellC, out, G_total, Geff_total, T_cell, IL_oper, IO_oper, A_oper, Rsh_oper );
+
+	if ( Geff_total >= 1.0 ) 
+		solve_operating_point( T_cell, G_total, IL_oper, IO_oper, A_oper, Rsh_oper, opvoltage, out );
+
+	return out.Power >= 0;
+}
+
+bool cec6par_module_t::evaluate( size_t n, pvinput_t *input, const double *TcellC, const double *opvoltage, pvoutput_t *output )
+{
+	/* Collects the operating parameters of the lit states into contiguous arrays, then solves them.
+	At the maximum power point with the Lambert W solver, the states are solved together by 
+	maxpower_5par_lambertw_batch; otherwise each state is solved as in operator(). */
+	m_lit.clear();
+	m_G.resize( n );
+	m_Tcell.resize( n );
+	m_IL.resize( n );
+	m_IO.resize( n );
+	m_A.resize( n );
+	m_Rsh.resize( n );
+
+	size_t nlit = 0;
+	for ( size_t i = 0; i < n; i++ )
+	{
+		double Geff_total;
+		operating_parameters( input[i], TcellC[i], output[i], m_G[nlit], Geff_total, m_Tcell[nlit],
+			m_IL[nlit], m_IO[nlit], m_A[nlit], m_Rsh[nlit] );
+		if ( Geff_total >= 1.0 )
+		{
+			m_lit.push_back( i );
+			nlit++;
 		}
-		else
-		{ // calculate power at specified operating voltage
-			V = opvoltage;
-			if (V >= V_oc) I = 0;
-			else I = current_5par( V, 0.9*IL_oper, A_oper, IL_oper, IO_oper, Rs, Rsh_oper );
+	}
 
-			P = V*I;
+	if ( UseLambertW && opvoltage == 0 )
+	{
+		m_Voc.resize( nlit );
+		m_P.resize( nlit );
+		m_V.resize( nlit );
+		m_I.resize( nlit );
+		for ( size_t k = 0; k < nlit; k++ )
+			m_Voc[k] = openvoltage_5par_lambertw( m_A[k], m_IL[k], m_IO[k], m_Rsh[k] );
+
+		maxpower_5par_lambertw_batch( nlit, m_Voc.data(), m_A.data(), m_IL.data(), m_IO.data(), Rs, m_Rsh.data(),
+			m_P.data(), m_V.data(), m_I.data() );
+
+		for ( size_t k = 0; k < nlit; k++ )
+		{
+			pvoutput_t &out = output[ m_lit[k] ];
+			out.Power = m_P[k];
+			out.Voltage = m_V[k];
+			out.Current = m_I[k];
+			out.Efficiency = m_P[k]/(Area*m_G[k]);
+			out.Voc_oper = m_Voc[k];
+			out.Isc_oper = m_IL[k]/(1+Rs/m_Rsh[k]);
+			out.CellTemp = m_Tcell[k] - 273.15;
+		}
+	}
+	else
+	{
+		for ( size_t k = 0; k < nlit; k++ )
+		{
+			size_t i = m_lit[k];
+			solve_operating_point( m_Tcell[k], m_G[k], m_IL[k], m_IO[k], m_A[k], m_Rsh[k], opvoltage ? opvoltage[i] : -1.0, output[i] );
 		}
-		
-		out.Power = P;
-		out.Voltage  = V;
-		out.Current = I;
-		out.Efficiency = P/(Area*G_total);
-		out.Voc_oper = V_oc;
-		out.Isc_oper = I_sc;
-		out.CellTemp = T_cell - 273.15;
 	}
 
-	return out.Power >= 0;
+	bool ok = true;
+	for ( size_t i = 0; i < n; i++ )
+		if ( !(output[i].Power >= 0) ) ok = false;
+	return ok;
 }
 
 
@@ -23,6 +23,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef cec6par_h
 #define cec6par_h
 
+#include <vector>
+
 #include "lib_pvmodel.h"
 
 
@@ -49,6 +51,7 @@ public:
 	double Rs;
 	double Rsh;
 	double Adj;
+	bool UseLambertW; // explicit Lambert W solution instead of iterative search for Voc, Imp, Vmp
 
 	cec6par_module_t();
 
@@ -59,8 +62,20 @@ public:
 	virtual double IscRef() { return Isc; }
 
 	virtual bool operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &output );
+	virtual bool evaluate( size_t n, pvinput_t *input, const double *TcellC, const double *opvoltage, pvoutput_t *output );
 
 	virtual ~cec6par_module_t() {};
+
+private:
+	// irradiance and single diode parameters at operating conditions, shared by operator() and evaluate()
+	void operating_parameters( pvinput_t &input, double TcellC, pvoutput_t &out, double &G_total, double &Geff_total, 
+		double &T_cell, double &IL_oper, double &IO_oper, double &A_oper, double &Rsh_oper );
+	void solve_operating_point( double T_cell, double G_total, double IL_oper, double IO_oper, double A_oper, double Rsh_oper,
+		double opvoltage, pvoutput_t &out );
+
+	// per-state working arrays for evaluate(), kept to avoid reallocating on every batch
+	std::vector<size_t> m_lit;
+	std::vector<double> m_G, m_Tcell, m_IL, m_IO, m_A, m_Rsh, m_Voc, m_P, m_V, m_I;
 };
 
 
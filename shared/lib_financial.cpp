@@ -21,7 +21,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <math.h>
+#include <stddef.h>
 #include <limits>
+#include <algorithm>
 #include "lib_financial.h"
 
 using namespace libfin;
@@ -100,6 +102,148 @@ double libfin::irr(double tolerance, int maxIterations, const std::vector<double
     return calculatedIRR;
 }
 
+/* npv of CashFlows[0..Count] and its derivative as polynomials in the discount factor x = 1/(1+rate), in Horner form */
+static double irr_horner_sum(double x, const double *CashFlows, int Count, double *dsum_dx)
+{
+	double sum = CashFlows[Count];
+	double dsum = 0;
+	for (int j = Count - 1; j >= 0; j--)
+	{
+		dsum = dsum * x + sum;
+		sum = sum * x + CashFlows[j];
+	}
+	if (dsum_dx) *dsum_dx = dsum;
+	return sum;
+}
+
+/* small scaled residual and the npv changing sign through the rate, from positive to negative for a conventional root
+   and in either direction otherwise, or for non-conventional roots also touching zero without changing sign; this
+   rejects rates where the npv only approaches zero, e.g. very large rates for a zero first cash flow */
+static bool is_valid_irr_root(double rate, const double *CashFlows, int Count, double tolerance, double scale_factor, bool conventional)
+{
+	if (!(rate > -1.0))
+		return false;
+	double x = 1.0 / (1.0 + rate);
+	double npv_of_irr = irr_horner_sum(x, CashFlows, Count, 0);
+	if (!(fabs(npv_of_irr / scale_factor) < tolerance))
+		return false;
+	double npv_below = irr_horner_sum(x * 1.001, CashFlows, Count, 0);
+	double npv_above = irr_horner_sum(x / 1.001, CashFlows, Count, 0);
+	if (conventional)
+		return (npv_below > 0) && (npv_above < 0);
+	if (npv_below * npv_above < 0)
+		return true;
+	return fabs(npv_of_irr) < 0.5 * std::min(fabs(npv_below), fabs(npv_above));
+}
+
+static bool irr_newton(double guess, const double *CashFlows, int Count, double tolerance, int maxIterations, double scale_factor, bool conventional, double &calculatedIRR)
+{
+	double rate = guess;
+	for (int it = 0; it < maxIterations; it++)
+	{
+		if (!(rate > -1.0)) return false;
+		double x = 1.0 / (1.0 + rate);
+		double dsum_dx = 0;
+		double sum = irr_horner_sum(x, CashFlows, Count, &dsum_dx);
+		if (fabs(sum / scale_factor) <= tolerance)
+		{
+			calculatedIRR = rate;
+			return is_valid_irr_root(rate, CashFlows, Count, tolerance, scale_factor, conventional);
+		}
+		// d(npv)/d(rate) = -x^2 d(npv)/dx
+		double deriv = -x * x * dsum_dx;
+		if (deriv == 0.0 || deriv != deriv) return false;
+		double next = rate - sum / deriv;
+		// keep the discount factor positive by stepping at most half way to -100%
+		if (!(next > -1.0)) next = 0.5 * (rate - 1.0);
+		rate = next;
+	}
+	return false;
+}
+
+/* scan the discount factor for an npv sign change, from negative to positive for a conventional root, and bisect it */
+static bool irr_bracket(const double *CashFlows, int Count, double tolerance, double scale_factor, bool conventional, double &calculatedIRR)
+{
+	// rates from 9900% down to -99.9%
+	double xa = 0.01;
+	double fa = irr_horner_sum(xa, CashFlows, Count, 0);
+	while (xa < 1000.0)
+	{
+		double xb = xa * 1.25;
+		double fb = irr_horner_sum(xb, CashFlows, Count, 0);
+		if ((fa < 0) != (fb < 0) && (!conventional || fa < 0))
+		{
+			for (int it = 0; it < 200 && fabs(fb / scale_factor) > tolerance; it++)
+			{
+				double xm = 0.5 * (xa + xb);
+				double fm = irr_horner_sum(xm, CashFlows, Count, 0);
+				if ((fm < 0) == (fa < 0)) xa = xm;
+				else { xb = xm; fb = fm; }
+			}
+			calculatedIRR = 1.0 / xb - 1.0;
+			return is_valid_irr_root(calculatedIRR, CashFlows, Count, tolerance, scale_factor, conventional);
+		}
+		xa = xb;
+		fa = fb;
+	}
+	return false;
+}
+
+double libfin::irr_from(const double *CashFlows, int Count, double Guess, double tolerance, int maxIterations)
+{
+	double calculatedIRR = std::numeric_limits<double>::quiet_NaN();
+
+	// only possible for first value negative
+	if ((Count < 1) || !(CashFlows[0] <= 0))
+		return calculatedIRR;
+
+	// scale to max value for better irr convergence
+	double scale_factor = 0;
+	for (int i = 0; i <= Count; i++)
+		if (fabs(CashFlows[i]) > scale_factor) scale_factor = fabs(CashFlows[i]);
+	if (!(scale_factor > 0)) scale_factor = 1;
+
+	// initial guess from http://zainco.blogspot.com/2008/08/internal-rate-of-return-using-newton.html
+	if (!(Guess > -1) && (CashFlows[0] != 0))
+	{
+		if (Count > 1) // second order
+		{
+			double b = 2.0 + CashFlows[1] / CashFlows[0];
+			double c = 1.0 + CashFlows[1] / CashFlows[0] + CashFlows[2] / CashFlows[0];
+			Guess = -0.5*b - 0.5*sqrt(b*b - 4.0*c);
+			if ((Guess <= 0) || (Guess >= 1)) Guess = -0.5*b + 0.5*sqrt(b*b - 4.0*c);
+		}
+		else // first order
+			Guess = -(1.0 + CashFlows[1] / CashFlows[0]);
+	}
+
+	// a conventional root, where the npv falls with the rate, is preferred when the cash flow has several
+	const double fallback_guesses[] = { 0.1, -0.1, 0 };
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool conventional = (pass == 0);
+		if (Guess == Guess && irr_newton(Guess, CashFlows, Count, tolerance, maxIterations, scale_factor, conventional, calculatedIRR))
+			return calculatedIRR;
+		for (size_t i = 0; i < sizeof(fallback_guesses) / sizeof(fallback_guesses[0]); i++)
+			if (irr_newton(fallback_guesses[i], CashFlows, Count, tolerance, maxIterations, scale_factor, conventional, calculatedIRR))
+				return calculatedIRR;
+		if (irr_bracket(CashFlows, Count, tolerance, scale_factor, conventional, calculatedIRR))
+			return calculatedIRR;
+	}
+
+	return std::numeric_limits<double>::quiet_NaN(); // did not converge
+}
+
+void libfin::irr_series(const double *CashFlows, int Count, double *Irrs, double tolerance, int maxIterations)
+{
+	// each year starts from the previous year's rate, which is usually within a few iterations of the new root
+	double guess = -2;
+	for (int i = 0; i <= Count; i++)
+	{
+		Irrs[i] = irr_from(CashFlows, i, guess, tolerance, maxIterations);
+		guess = (Irrs[i] == Irrs[i]) ? Irrs[i] : -2;
+	}
+}
   
 /*ported directly from Delphi simple geometric sum*/
 double libfin::npv(double Rate, const std::vector<double> &CashFlows, int Count) //, PaymentTime: TPaymentTime)
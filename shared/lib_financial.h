@@ -28,6 +28,12 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace libfin {
 
 double irr(double tolerance, int maxIterations, const std::vector<double> &CashFlows, int Count);
+
+/* irr of CashFlows[0..Count] starting Newton's method from Guess (Guess <= -1 for the default estimate), with
+   bracketing as a fallback; NaN when there is no rate where the npv falls through zero */
+double irr_from(const double *CashFlows, int Count, double Guess = -2, double tolerance = 1e-6, int maxIterations = 100);
+/* Irrs[i] = irr of CashFlows[0..i] for i = 0..Count, each year warm started from the previous year's rate */
+void irr_series(const double *CashFlows, int Count, double *Irrs, double tolerance = 1e-6, int maxIterations = 100);
 double npv(double Rate, const std::vector<double> &CashFlows, int Count);
 double payback(const std::vector<double> &CumulativePayback, const std::vector<double> &Payback, int Count);
 
@@ -49,6 +49,7 @@ iec61853_module_t::iec61853_module_t()
 
 	NcellSer = 0;
 	GlassAR = false;
+	UseLambertW = false;
 	for( int i=0;i<5;i++ )
 		AMA[i] = std::numeric_limits<double>::quiet_NaN();
 
@@ -906,20 +907,25 @@ bool iec61853_module_t::operator() ( pvinput_t &input, double TcellC, double opv
 		//if ( Rsop > 1000 ) Rsop = 10000;
 		//if ( Rshop > 25000 ) Rshop = 25000;
 
-		double V_oc = openvoltage_5par( Voc0, aop, Ilop, Ioop, Rshop );
+		double V_oc = UseLambertW ? openvoltage_5par_lambertw( aop, Ilop, Ioop, Rshop )
+			: openvoltage_5par( Voc0, aop, Ilop, Ioop, Rshop );
 		double I_sc = Ilop/(1+Rsop/Rshop);
 		
 		double P, V, I;
 		
 		if ( opvoltage < 0 )
 		{
-			P = maxpower_5par( V_oc, aop, Ilop, Ioop, Rsop, Rshop, &V, &I );
+			if ( UseLambertW )
+				P = maxpower_5par_lambertw( V_oc, aop, Ilop, Ioop, Rsop, Rshop, &V, &I );
+			else
+				P = maxpower_5par( V_oc, aop, Ilop, Ioop, Rsop, Rshop, &V, &I );
 			if ( P < 0 ) P = 0;
 		}
 		else
 		{ // calculate power at specified operating voltage
 			V = opvoltage;
 			if (V >= V_oc) I = 0;
+			else if ( UseLambertW ) I = current_5par_lambertw( V, aop, Ilop, Ioop, Rsop, Rshop );
 			else I = current_5par( V, 0.9*Ilop, aop, Ilop, Ioop, Rsop, Rshop );
 
 			if ( I < 0 ) { I=0; V=0; }
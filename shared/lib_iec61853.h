@@ -67,6 +67,8 @@ public:
 	bool GlassAR;
 	double AMA[5];
 
+	bool UseLambertW; // explicit Lambert W solution instead of iterative search for Voc, Imp, Vmp
+
 	Imessage_api *_imsg;
 
 
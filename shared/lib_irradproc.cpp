@@ -68,7 +68,8 @@ static int day_of_year( int month, int day_of_month ) /* returns 1-365 */
 	return iday + day_of_month;
 }
 
-void solarpos(int year,int month,int day,int hour,double minute,double lat,double lng,double tz,double sunn[9])
+/// solarpos() with the latitude terms precomputed, so they can be hoisted out of loops over time steps
+static inline void solarpos_eval(int year,int month,int day,int hour,double minute,double sinlat,double coslat,double tanlat,double lng,double tz,double sunn[9])
 {
 /* 
 	Revised 5/15/98. Replaced algorithm for solar azimuth with one by Iqbal
@@ -145,9 +146,7 @@ void solarpos(int year,int month,int day,int hour,double minute,double lat,doubl
 	else if( ha > M_PI )
 		ha = ha - 2*M_PI;             /* Hour angle in radians between -pi and pi */
 
-	lat = lat*DTOR;                /* Change latitude to radians */
-
-	arg = sin(dec)*sin(lat) + cos(dec)*cos(lat)*cos(ha);  /* For elevation in radians */
+	arg = sin(dec)*sinlat + cos(dec)*coslat*cos(ha);  /* For elevation in radians */
 	if( arg > 1.0 )
 		elv = M_PI/2.0;
 	else if( arg < -1.0 )
@@ -161,7 +160,7 @@ void solarpos(int year,int month,int day,int hour,double minute,double lat,doubl
 		}
 	else
 		{                 /* For solar azimuth in radians per Iqbal */
-		arg = ((sin(elv)*sin(lat)-sin(dec))/(cos(elv)*cos(lat))); /* for azimuth */
+		arg = ((sin(elv)*sinlat-sin(dec))/(cos(elv)*coslat)); /* for azimuth */
 		if( arg > 1.0 )
 			azm = 0.0;              /* Azimuth(radians)*/
 		else if( arg < -1.0 )
@@ -191,7 +190,7 @@ void solarpos(int year,int month,int day,int hour,double minute,double lat,doubl
 	else if( E > 0.33 )
 		E = E - 24.0;
 
-	arg = -tan(lat)*tan(dec);
+	arg = -tanlat*tan(dec);
 	if (arg >= 1.0)  // No sunrise, continuous nights
 	{
 		ws = 0.0;                        
@@ -251,6 +250,47 @@ void solarpos(int year,int month,int day,int hour,double minute,double lat,doubl
 	sunn[8] = hextra;
 }
 
+void solarpos(int year,int month,int day,int hour,double minute,double lat,double lng,double tz,double sunn[9])
+{
+	lat = lat*DTOR;                /* Change latitude to radians */
+	solarpos_eval( year, month, day, hour, minute, sin(lat), cos(lat), tan(lat), lng, tz, sunn );
+}
+
+void solarpos_series::resize( size_t n )
+{
+	azm.resize( n );
+	zen.resize( n );
+	elv.resize( n );
+	dec.resize( n );
+	sunrise.resize( n );
+	sunset.resize( n );
+	eccfac.resize( n );
+	tst.resize( n );
+	hextra.resize( n );
+}
+
+void solarpos_array(size_t n, const int year[], const int month[], const int day[], const int hour[], const double minute[],
+	double lat, double lng, double tz, solarpos_series &sun)
+{
+	sun.resize( n );
+	double lat_rad = lat*DTOR;
+	double sinlat = sin(lat_rad), coslat = cos(lat_rad), tanlat = tan(lat_rad);
+	double sunn[9];
+	for ( size_t i = 0; i < n; i++ )
+	{
+		solarpos_eval( year[i], month[i], day[i], hour[i], minute[i], sinlat, coslat, tanlat, lng, tz, sunn );
+		sun.azm[i] = sunn[0];
+		sun.zen[i] = sunn[1];
+		sun.elv[i] = sunn[2];
+		sun.dec[i] = sunn[3];
+		sun.sunrise[i] = sunn[4];
+		sun.sunset[i] = sunn[5];
+		sun.eccfac[i] = sunn[6];
+		sun.tst[i] = sunn[7];
+		sun.hextra[i] = sunn[8];
+	}
+}
+
 
 void incidence(int mode,double tilt,double sazm,double rlim,double zen,double azm, bool en_backtrack, double gcr, double angle[5])
 {
@@ -719,19 +759,19 @@ void perez( double , double dn, double df, double alb, double inc, double tilt,
 */
 
 													/* Local variables */
-	double F11R[8] = { -0.0083117, 0.1299457, 0.3296958, 0.5682053,
+	static const double F11R[8] = { -0.0083117, 0.1299457, 0.3296958, 0.5682053,
 							 0.8730280, 1.1326077, 1.0601591, 0.6777470 };
-	double F12R[8] = {  0.5877285, 0.6825954, 0.4868735, 0.1874525,
+	static const double F12R[8] = {  0.5877285, 0.6825954, 0.4868735, 0.1874525,
 							-0.3920403, -1.2367284, -1.5999137, -0.3272588 };
-	double F13R[8] = { -0.0620636, -0.1513752, -0.2210958, -0.2951290,
+	static const double F13R[8] = { -0.0620636, -0.1513752, -0.2210958, -0.2951290,
 							-0.3616149, -0.4118494, -0.3589221, -0.2504286 };
-	double F21R[8] = { -0.0596012, -0.0189325, 0.0554140, 0.1088631,
+	static const double F21R[8] = { -0.0596012, -0.0189325, 0.0554140, 0.1088631,
 							 0.2255647, 0.2877813, 0.2642124, 0.1561313 };
-	double F22R[8] = {  0.0721249, 0.0659650, -0.0639588, -0.1519229,
+	static const double F22R[8] = {  0.0721249, 0.0659650, -0.0639588, -0.1519229,
 							-0.4620442, -0.8230357, -1.1272340, -1.3765031 };
-	double F23R[8] = { -0.0220216, -0.0288748, -0.0260542, -0.0139754,
+	static const double F23R[8] = { -0.0220216, -0.0288748, -0.0260542, -0.0139754,
 							 0.0012448, 0.0558651, 0.1310694, 0.2506212 };
-	double EPSBINS[7] = { 1.065, 1.23, 1.5, 1.95, 2.8, 4.5, 6.2 };
+	static const double EPSBINS[7] = { 1.065, 1.23, 1.5, 1.95, 2.8, 4.5, 6.2 };
 	double B2=0.000005534,
 		EPS,T,D,DELTA,A,B,C,ZH,F1,F2,COSINC,x;
 	double CZ,ZC,ZENITH,AIRMASS;
@@ -889,11 +929,15 @@ irrad::irrad(weather_record wf, weather_header hdr,
 	}
 }
 
-int irrad::check()
+/// Input checks for irrad::check() and irrad_series::calc(), with radiation modes above max_radmode rejected
+static int check_inputs( int year, int month, int day, int hour, double minute, double delt,
+	double latitudeDegrees, double longitudeDegrees, double timezone, int radiationMode, int max_radmode, int skyModel, int trackingMode,
+	double directNormal, double diffuseHorizontal, double globalHorizontal, double albedo,
+	double tiltDegrees, double surfaceAzimuthDegrees, double rotationLimitDegrees )
 {
 	if (year < 0 || month < 0 || day < 0 || hour < 0 || minute < 0 || delt > 1) return -1;
 	if ( latitudeDegrees < -90 || latitudeDegrees > 90 || longitudeDegrees < -180 || longitudeDegrees > 180 || timezone < -15 || timezone > 15 ) return -2;
-	if ( radiationMode < irrad::DN_DF || radiationMode > irrad::POA_P || skyModel < 0 || skyModel > 2 ) return -3;
+	if ( radiationMode < irrad::DN_DF || radiationMode > max_radmode || skyModel < 0 || skyModel > 2 ) return -3;
 	if ( trackingMode < 0 || trackingMode > 4 ) return -4;
 	if ( radiationMode == irrad::DN_DF && (directNormal < 0 || directNormal > irrad::irradiationMax || diffuseHorizontal < 0 || diffuseHorizontal > 1500)) return -5;
 	if ( radiationMode == irrad::DN_GH && (globalHorizontal < 0 || globalHorizontal > 1500 || directNormal < 0 || directNormal > 1500)) return -6;
@@ -905,6 +949,12 @@ int irrad::check()
 	return 0;
 }
 
+int irrad::check()
+{
+	return check_inputs( year, month, day, hour, minute, delt, latitudeDegrees, longitudeDegrees, timezone, radiationMode, irrad::POA_P, skyModel, trackingMode,
+		directNormal, diffuseHorizontal, globalHorizontal, albedo, tiltDegrees, surfaceAzimuthDegrees, rotationLimitDegrees );
+}
+
 double irrad::getAlbedo()
 {
 	return albedo;
@@ -1046,29 +1096,15 @@ void irrad::set_sun_component(size_t index, double value)
 	}
 }
 
-int irrad::calc()
+/// Sunrise and sunset hours in local standard time for the given day, corrected when either falls on an adjacent day
+static void sunrise_sunset_hours( int year, int month, int day, double latitudeDegrees, double longitudeDegrees, double timezone,
+	double &t_sunrise, double &t_sunset )
 {
-	int code = check();
-	if ( code < 0 )
-		return -100+code;
-/*
-	calculates effective sun position at current timestep, with delt specified in hours
-
-	sunAnglesRadians: results from solarpos
-	timeStepSunPosition: [0]  effective hour of day used for sun position
-			[1]  effective minute of hour used for sun position
-			[2]  is sun up?  (0=no, 1=midday, 2=sunup, 3=sundown)
-	surfaceAnglesRadians: result from incidence
-	planeOfArrayIrradianceFront: result from sky model
-	diff: broken out diffuse components from sky model
-*/	
-	double t_cur = hour + minute/60.0;
-
-	// calculate sunrise and sunset hours in local standard time for the current day
+	double sunAnglesRadians[9];
 	solarpos( year, month, day, 12, 0.0, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
 
-	double t_sunrise = sunAnglesRadians[4];
-	double t_sunset = sunAnglesRadians[5];
+	t_sunrise = sunAnglesRadians[4];
+	t_sunset = sunAnglesRadians[5];
 
 	if (t_sunset > 24.0 && t_sunset != 100.0) //sunset is legitimately the next day but we're not in endless days, so recalculate sunset from the previous day
 	{
@@ -1103,54 +1139,127 @@ int irrad::calc()
 		else if (sunanglestemp[4] < 0.0)
 			t_sunrise = sunanglestemp[4] + 24.0;
 	}
+}
+
+/// Hour and minute used for the sun position of a time step, moved to the midpoint of the sun-up part of sunrise and sunset time steps.
+/// Returns whether the sun is up (0=no, 1=midday, 2=sunup, 3=sundown)
+static int sun_position_time( int hour, double minute, double delt, double t_sunrise, double t_sunset, int &hr_calc, double &min_calc )
+{
+	double t_cur = hour + minute/60.0;
 
 	// recall: if delt <= 0.0, do not interpolate sunrise and sunset hours, just use specified time stamp
 	// time step encompasses the sunrise
 	if ( delt > 0 && t_cur >= t_sunrise - delt/2.0 && t_cur < t_sunrise + delt/2.0 )
 	{
 		double t_calc = (t_sunrise + (t_cur+delt/2.0))/2.0; // midpoint of sunrise and end of timestep
-		int hr_calc = (int)t_calc;
-		double min_calc = (t_calc-hr_calc)*60.0;
-
-		timeStepSunPosition[0] = hr_calc;
-		timeStepSunPosition[1] = (int)min_calc;
-				
-		solarpos( year, month, day, hr_calc, min_calc, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
-
-		timeStepSunPosition[2] = 2;				
+		hr_calc = (int)t_calc;
+		min_calc = (t_calc-hr_calc)*60.0;
+		return 2;
 	}
 	// timestep encompasses the sunset
 	else if ( delt > 0 && t_cur > t_sunset - delt/2.0 && t_cur <= t_sunset + delt/2.0 )
 	{
 		double t_calc = ( (t_cur-delt/2.0) + t_sunset )/2.0; // midpoint of beginning of timestep and sunset
-		int hr_calc = (int)t_calc;
-		double min_calc = (t_calc-hr_calc)*60.0;
+		hr_calc = (int)t_calc;
+		min_calc = (t_calc-hr_calc)*60.0;
+		return 3;
+	}
 
-		timeStepSunPosition[0] = hr_calc;
-		timeStepSunPosition[1] = (int)min_calc;
-				
-		solarpos( year, month, day, hr_calc, min_calc, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
+	// otherwise the sun position is calculated at the provided time
+	hr_calc = hour;
+	min_calc = minute;
 
-		timeStepSunPosition[2] = 3;
-	}
-	// timestep is not sunrise nor sunset, but sun is up  (calculate position at provided t_cur)
-	else if ( (t_sunrise < t_sunset && t_cur >= t_sunrise && t_cur <= t_sunset) || //this captures normal daylight cases
+	// timestep is not sunrise nor sunset, but sun is up
+	if ( (t_sunrise < t_sunset && t_cur >= t_sunrise && t_cur <= t_sunset) || //this captures normal daylight cases
 		(t_sunrise > t_sunset && (t_cur <= t_sunset || t_cur >= t_sunrise)) ) //this captures cases where sunset (from previous day) is 1:30AM, sunrise 2:30AM, in arctic circle
-	{				
-		timeStepSunPosition[0] = hour;
-		timeStepSunPosition[1] = (int)minute;
-		solarpos( year, month, day, hour, minute, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
-		timeStepSunPosition[2] = 1;
+		return 1;
+
+	// sun is down
+	return 0;
+}
+
+/// Direct normal and diffuse horizontal inputs to the sky models for the beam/diffuse radiation modes.
+/// Returns -1 if the beam on a horizontal surface exceeds the extraterrestrial irradiance
+static int sky_model_inputs( int radiationMode, double directNormal, double diffuseHorizontal, double globalHorizontal, double zen, double hextra,
+	double &dn, double &df )
+{
+	double hbeam = directNormal*cos( zen ); // calculated beam on horizontal surface
+		
+	// check beam irradiance against extraterrestrial irradiance
+	if ( hbeam > hextra )
+	{
+		//beam irradiance on horizontal W/m2 exceeded calculated extraterrestrial irradiance
+		return -1;
+	}
+
+	// compute beam and diffuse inputs on horizontal based on irradiance inputs mode
+	if (radiationMode == irrad::DN_DF)  // Beam+Diffuse
+	{
+		df = diffuseHorizontal;
+		dn = directNormal;
+	}
+	else if (radiationMode == irrad::DN_GH) // Total+Beam
+	{
+		df = globalHorizontal - hbeam;
+		if (df < 0) df = 0;
+		dn = directNormal;
+	}
+	else if (radiationMode == irrad::GH_DF) //Total+Diffuse
+	{
+		df = diffuseHorizontal;
+		dn = (globalHorizontal - diffuseHorizontal) / cos(zen); //compute beam from total, diffuse, and zenith angle
+		if (dn > irrad::irradiationMax) dn = irrad::irradiationMax;
+		if (dn < 0) dn = 0;
 	}
 	else
-	{	
-		// sun is down, assign sundown values
-		solarpos(year, month, day, hour, minute, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians);
-		timeStepSunPosition[0] = hour;
-		timeStepSunPosition[1] = (int)minute;
-		timeStepSunPosition[2] = 0;
+		return -2; // just in case of a weird error
+
+	return 0;
+}
+
+/// Incident irradiance on a tilted surface from the selected sky model
+static void sky_model_poa( int skyModel, double hextra, double dn, double df, double alb, double inc, double tilt, double zen, double poa[3], double diffc[3] )
+{
+	switch( skyModel )
+	{
+	case 0:
+		isotropic( hextra, dn, df, alb, inc, tilt, zen, poa, diffc );
+		break;
+	case 1:
+		hdkr( hextra, dn, df, alb, inc, tilt, zen, poa, diffc );
+		break;
+	default:
+		perez( hextra, dn, df, alb, inc, tilt, zen, poa, diffc );
+		break;
 	}
+}
+
+int irrad::calc()
+{
+	int code = check();
+	if ( code < 0 )
+		return -100+code;
+/*
+	calculates effective sun position at current timestep, with delt specified in hours
+
+	sunAnglesRadians: results from solarpos
+	timeStepSunPosition: [0]  effective hour of day used for sun position
+			[1]  effective minute of hour used for sun position
+			[2]  is sun up?  (0=no, 1=midday, 2=sunup, 3=sundown)
+	surfaceAnglesRadians: result from incidence
+	planeOfArrayIrradianceFront: result from sky model
+	diff: broken out diffuse components from sky model
+*/	
 
+	double t_sunrise, t_sunset;
+	sunrise_sunset_hours( year, month, day, latitudeDegrees, longitudeDegrees, timezone, t_sunrise, t_sunset );
+
+	int hr_calc;
+	double min_calc;
+	timeStepSunPosition[2] = sun_position_time( hour, minute, delt, t_sunrise, t_sunset, hr_calc, min_calc );
+	timeStepSunPosition[0] = hr_calc;
+	timeStepSunPosition[1] = (int)min_calc;
+	solarpos( year, month, day, hr_calc, min_calc, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
 			
 	planeOfArrayIrradianceFront[0]=planeOfArrayIrradianceFront[1]=planeOfArrayIrradianceFront[2] = 0;
 	diffuseIrradianceFront[0]=diffuseIrradianceFront[1]=diffuseIrradianceFront[2] = 0;
@@ -1164,51 +1273,15 @@ int irrad::calc()
 
 		if(radiationMode < irrad::POA_R){
 			double hextra = sunAnglesRadians[8];
-			double hbeam = directNormal*cos( sunAnglesRadians[1] ); // calculated beam on horizontal surface: sunAnglesRadians[1]=zenith
-				
-			// check beam irradiance against extraterrestrial irradiance
-			if ( hbeam > hextra )
-			{
-				//beam irradiance on horizontal W/m2 exceeded calculated extraterrestrial irradiance
-				return -1;
-			}
-
-			// compute beam and diffuse inputs on horizontal based on irradiance inputs mode
-			if (radiationMode == irrad::DN_DF)  // Beam+Diffuse
-			{
-				calculatedDiffuseHorizontal = diffuseHorizontal;
-				calculatedDirectNormal = directNormal;
-			}
-			else if (radiationMode == irrad::DN_GH) // Total+Beam
-			{
-				calculatedDiffuseHorizontal = globalHorizontal - hbeam;
-				if (calculatedDiffuseHorizontal < 0) calculatedDiffuseHorizontal = 0;
-				calculatedDirectNormal = directNormal;
-			}
-			else if (radiationMode == irrad::GH_DF) //Total+Diffuse
-			{
-				calculatedDiffuseHorizontal = diffuseHorizontal;
-				calculatedDirectNormal = (globalHorizontal - diffuseHorizontal) / cos(sunAnglesRadians[1]); //compute beam from total, diffuse, and zenith angle
-				if (calculatedDirectNormal > irrad::irradiationMax) calculatedDirectNormal = irrad::irradiationMax;
-				if (calculatedDirectNormal < 0) calculatedDirectNormal = 0;
-			}
-			else
-				return -2; // just in case of a weird error
-
+			double dn, df;
+			int errorcode = sky_model_inputs( radiationMode, directNormal, diffuseHorizontal, globalHorizontal, sunAnglesRadians[1], hextra, dn, df );
+			if ( errorcode < 0 )
+				return errorcode;
+			calculatedDirectNormal = dn;
+			calculatedDiffuseHorizontal = df;
 
 			// compute incident irradiance on tilted surface
-			switch( skyModel )
-			{
-			case 0:
-				isotropic( hextra, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians[0], surfaceAnglesRadians[1], sunAnglesRadians[1], planeOfArrayIrradianceFront, diffuseIrradianceFront );
-				break;
-			case 1:
-				hdkr( hextra, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians[0], surfaceAnglesRadians[1], sunAnglesRadians[1], planeOfArrayIrradianceFront, diffuseIrradianceFront );
-				break;
-			default:
-				perez( hextra, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians[0], surfaceAnglesRadians[1], sunAnglesRadians[1], planeOfArrayIrradianceFront, diffuseIrradianceFront );
-				break;
-			} 
+			sky_model_poa( skyModel, hextra, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians[0], surfaceAnglesRadians[1], sunAnglesRadians[1], planeOfArrayIrradianceFront, diffuseIrradianceFront );
 		} 
 		else { // Sev 2015/09/11 - perform a POA decomp.
 			int errorcode = poaDecomp( weatherFilePOA, surfaceAnglesRadians, sunAnglesRadians, albedo, poaAll, directNormal, diffuseHorizontal, globalHorizontal, planeOfArrayIrradianceFront, diffuseIrradianceFront);
@@ -1223,6 +1296,137 @@ int irrad::calc()
 
 }
 
+irrad_series::irrad_series()
+	: latitudeDegrees(-999), longitudeDegrees(-999), timezone(-999), skyModel(irrad::PEREZ),
+	trackingMode(irrad::FIXED_TILT), enableBacktrack(false), tiltDegrees(0), surfaceAzimuthDegrees(180),
+	rotationLimitDegrees(45), groundCoverageRatio(0.4)
+{
+}
+
+void irrad_series::set_location( double lat, double lon, double tz )
+{
+	latitudeDegrees = lat;
+	longitudeDegrees = lon;
+	timezone = tz;
+}
+
+void irrad_series::set_sky_model( int sm )
+{
+	skyModel = sm;
+}
+
+void irrad_series::set_surface( int tracking, double tilt_deg, double azimuth_deg, double rotlim_deg, bool en_backtrack, double gcr )
+{
+	trackingMode = tracking;
+	if (tracking == 4)
+		trackingMode = 0; //treat timeseries tilt as fixed tilt
+	tiltDegrees = tilt_deg;
+	surfaceAzimuthDegrees = azimuth_deg;
+	rotationLimitDegrees = rotlim_deg;
+	enableBacktrack = en_backtrack;
+	groundCoverageRatio = gcr;
+}
+
+int irrad_series::calc( size_t n, const int year[], const int month[], const int day[], const int hour[], const double minute[], double delt,
+	int radmode, const double beam[], const double diffuse[], const double global[], const double albedo[] )
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	code.assign( n, 0 );
+	sunup.assign( n, -999 );
+	sunpos_hour.assign( n, nan );
+	solazi.assign( n, nan ); solzen.assign( n, nan ); solelv.assign( n, nan );
+	soldec.assign( n, nan ); sunrise.assign( n, nan ); sunset.assign( n, nan );
+	aoi.assign( n, nan ); surftilt.assign( n, nan ); surfazi.assign( n, nan ); axisrot.assign( n, nan ); btdiff.assign( n, nan );
+	poa_beam.assign( n, nan ); poa_skydiff.assign( n, nan ); poa_gnddiff.assign( n, nan );
+	poa_iso.assign( n, nan ); poa_cir.assign( n, nan ); poa_hor.assign( n, nan );
+
+	if ( n == 0 )
+		return 0;
+
+	m_hourCalc.resize( n );
+	m_minuteCalc.resize( n );
+
+	// effective sun position times, with sunrise and sunset computed once per day
+	int cur_year = -1, cur_month = -1, cur_day = -1;
+	double t_sunrise = 0, t_sunset = 0;
+	for ( size_t i = 0; i < n; i++ )
+	{
+		m_hourCalc[i] = hour[i];
+		m_minuteCalc[i] = minute[i];
+
+		// the component not used by radmode may be NULL, in which case it is passed as unassigned, as in irrad
+		double dn = beam ? beam[i] : -999, df = diffuse ? diffuse[i] : -999, gh = global ? global[i] : -999;
+		int c = check_inputs( year[i], month[i], day[i], hour[i], minute[i], delt, latitudeDegrees, longitudeDegrees, timezone, radmode, irrad::GH_DF, skyModel, trackingMode,
+			dn, df, gh, albedo[i], tiltDegrees, surfaceAzimuthDegrees, rotationLimitDegrees );
+		if ( c < 0 )
+		{
+			code[i] = -100 + c;
+			continue;
+		}
+
+		if ( year[i] != cur_year || month[i] != cur_month || day[i] != cur_day )
+		{
+			cur_year = year[i]; cur_month = month[i]; cur_day = day[i];
+			sunrise_sunset_hours( cur_year, cur_month, cur_day, latitudeDegrees, longitudeDegrees, timezone, t_sunrise, t_sunset );
+		}
+
+		sunup[i] = sun_position_time( hour[i], minute[i], delt, t_sunrise, t_sunset, m_hourCalc[i], m_minuteCalc[i] );
+		sunpos_hour[i] = ((double)m_hourCalc[i]) + ((double)(int)m_minuteCalc[i])/60.0;
+	}
+
+	solarpos_array( n, year, month, day, &m_hourCalc[0], &m_minuteCalc[0], latitudeDegrees, longitudeDegrees, timezone, m_sun );
+
+	// surface angles and plane-of-array irradiance for time steps with the sun up
+	for ( size_t i = 0; i < n; i++ )
+	{
+		if ( code[i] < 0 ) continue;
+
+		solazi[i] = m_sun.azm[i] * (180/M_PI);
+		solzen[i] = m_sun.zen[i] * (180/M_PI);
+		solelv[i] = m_sun.elv[i] * (180/M_PI);
+		soldec[i] = m_sun.dec[i] * (180/M_PI);
+		sunrise[i] = m_sun.sunrise[i];
+		sunset[i] = m_sun.sunset[i];
+
+		aoi[i] = surftilt[i] = surfazi[i] = axisrot[i] = btdiff[i] = 0;
+		poa_beam[i] = poa_skydiff[i] = poa_gnddiff[i] = 0;
+		poa_iso[i] = poa_cir[i] = poa_hor[i] = 0;
+
+		if ( sunup[i] <= 0 ) continue;
+
+		double angle[5];
+		incidence( trackingMode, tiltDegrees, surfaceAzimuthDegrees, rotationLimitDegrees, m_sun.zen[i], m_sun.azm[i], enableBacktrack, groundCoverageRatio, angle );
+		aoi[i] = angle[0] * (180/M_PI);
+		surftilt[i] = angle[1] * (180/M_PI);
+		surfazi[i] = angle[2] * (180/M_PI);
+		axisrot[i] = angle[3] * (180/M_PI);
+		btdiff[i] = angle[4] * (180/M_PI);
+
+		// in GH_DF mode irrad::calc() tests the beam against the extraterrestrial irradiance with direct normal still at its unassigned value
+		double hextra = m_sun.hextra[i];
+		double dn, df;
+		int c = sky_model_inputs( radmode, radmode == irrad::GH_DF ? -999 : beam[i], diffuse ? diffuse[i] : -999, global ? global[i] : -999,
+			m_sun.zen[i], hextra, dn, df );
+		if ( c < 0 )
+		{
+			code[i] = c;
+			continue;
+		}
+
+		double poa[3], diffc[3];
+		sky_model_poa( skyModel, hextra, dn, df, albedo[i], angle[0], angle[1], m_sun.zen[i], poa, diffc );
+		poa_beam[i] = poa[0]; poa_skydiff[i] = poa[1]; poa_gnddiff[i] = poa[2];
+		poa_iso[i] = diffc[0]; poa_cir[i] = diffc[1]; poa_hor[i] = diffc[2];
+	}
+
+	for ( size_t i = 0; i < n; i++ )
+		if ( code[i] != 0 )
+			return code[i];
+
+	return 0;
+}
+
 int irrad::calc_rear_side(double transmissionFactor, double groundClearanceHeight, double slopeLength)
 {
 	// do irradiance calculations if sun is up
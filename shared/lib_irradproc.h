@@ -51,6 +51,7 @@
 #define __irradproc_h
 
 #include <memory>
+#include <vector>
 
 #include "lib_weatherfile.h"
 
@@ -97,6 +98,39 @@ struct poaDecompReq;
 */
 void solarpos(int year,int month,int day,int hour,double minute,double lat,double lng,double tz,double sunn[9]);
 
+/**
+* solarpos_series holds the sun position for a series of time steps in structure-of-arrays form.
+* Element i of each array is the corresponding element of sunn[] from solarpos() for time step i.
+*/
+struct solarpos_series
+{
+	std::vector<double> azm;		///< sun azimuth in radians, measured east from north, 0 to 2*pi
+	std::vector<double> zen;		///< sun zenith in radians, 0 to pi
+	std::vector<double> elv;		///< sun elevation in radians, -pi/2 to pi/2
+	std::vector<double> dec;		///< sun declination in radians
+	std::vector<double> sunrise;	///< sunrise in local standard time (hrs), not corrected for refraction
+	std::vector<double> sunset;		///< sunset in local standard time (hrs), not corrected for refraction
+	std::vector<double> eccfac;		///< eccentricity correction factor
+	std::vector<double> tst;		///< true solar time (hrs)
+	std::vector<double> hextra;		///< extraterrestrial solar irradiance on horizontal (W/m2)
+
+	void resize( size_t n );
+};
+
+/**
+* solarpos_array computes solarpos() for n time steps at one location.
+* The latitude terms are computed once for the whole series instead of once per time step.
+*
+* \param[in] n number of time steps
+* \param[in] year, month, day, hour, minute arrays of length n, as in solarpos()
+* \param[in] lat latitude in degrees, north positive
+* \param[in] lng longitude in degrees, east positive
+* \param[in] tz time zone, west longitudes negative
+* \param[out] sun sun position for each time step, resized to n
+*/
+void solarpos_array(size_t n, const int year[], const int month[], const int day[], const int hour[], const double minute[],
+	double lat, double lng, double tz, solarpos_series &sun);
+
 /**
 * incidence function calculates the incident angle of direct beam radiation to a surface.
 * The calculation is done for a given sun position, latitude, and surface orientation. 
@@ -449,6 +483,64 @@ public:
 
 };
 
+/**
+* \class irrad_series
+*
+*  The irrad_series class calculates the same sun position, surface angles, and front-side plane-of-array irradiance as
+*  irrad::calc() for an entire time series at one location and surface orientation. Sunrise and sunset are computed once
+*  per day rather than once per time step, and results are stored in structure-of-arrays form.
+*  Only the DN_DF, DN_GH, and GH_DF radiation modes are supported, since POA decomposition and rear-side irradiance
+*  depend on state that changes from one time step to the next; use irrad for those.
+*/
+class irrad_series
+{
+	double latitudeDegrees, longitudeDegrees, timezone;
+	int skyModel;
+	int trackingMode;
+	bool enableBacktrack;
+	double tiltDegrees, surfaceAzimuthDegrees, rotationLimitDegrees, groundCoverageRatio;
+
+	// working arrays
+	std::vector<int> m_hourCalc;
+	std::vector<double> m_minuteCalc;
+	solarpos_series m_sun;
+
+public:
+
+	irrad_series();
+
+	/// Set the location, as irrad::set_location()
+	void set_location( double lat, double lon, double tz );
+
+	/// Set the sky model, using \link irrad::SKYMODEL
+	void set_sky_model( int skymodel );
+
+	/// Set the surface orientation, as irrad::set_surface()
+	void set_surface( int tracking, double tilt_deg, double azimuth_deg, double rotlim_deg, bool en_backtrack, double gcr );
+
+	/**
+	* Run the irradiance processor for n time steps.
+	*
+	* \param[in] n number of time steps
+	* \param[in] year, month, day, hour, minute time stamps of length n, as irrad::set_time()
+	* \param[in] delt_hr time step in hours, or IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET
+	* \param[in] radmode irrad::DN_DF, irrad::DN_GH, or irrad::GH_DF
+	* \param[in] beam, diffuse, global irradiance components of length n (W/m2), the one not used by radmode can be NULL
+	* \param[in] albedo ground albedo of length n (0-1)
+	* \return 0 if every time step succeeded, otherwise the first nonzero code in \link code
+	*/
+	int calc( size_t n, const int year[], const int month[], const int day[], const int hour[], const double minute[], double delt_hr,
+		int radmode, const double beam[], const double diffuse[], const double global[], const double albedo[] );
+
+	// Results for each time step, in the same units as the irrad get_* methods (angles in degrees)
+	std::vector<int> code;				///< return code of irrad::calc() for each time step
+	std::vector<int> sunup;				///< 0=no, 1=midday, 2=sunup, 3=sundown
+	std::vector<double> sunpos_hour;	///< effective hour and fraction used for the sun position
+	std::vector<double> solazi, solzen, solelv, soldec, sunrise, sunset;
+	std::vector<double> aoi, surftilt, surfazi, axisrot, btdiff;
+	std::vector<double> poa_beam, poa_skydiff, poa_gnddiff, poa_iso, poa_cir, poa_hor;
+};
+
 // allow for the poa decomp model to take all daily POA measurements into consideration
 struct poaDecompReq {
 	poaDecompReq() : i(0), dayStart(0), stepSize(1), stepScale('h'), doy(-1) {}
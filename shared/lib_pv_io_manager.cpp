@@ -829,6 +829,7 @@ void PVSystem_IO::AssignOutputs(compute_module* cm)
 Module_IO::Module_IO(compute_module* cm, std::string cmName, double dcLoss)
 {
 	modulePowerModel = cm->as_integer("module_model");
+	bool useLambertW = cm->is_assigned("module_mpp_solver") && cm->as_integer("module_mpp_solver") == 1;
 
 	simpleEfficiencyForceNoPOA = false;
 	mountingSpecificCellTemperatureForceNoPOA = false;
@@ -924,6 +925,7 @@ Module_IO::Module_IO(compute_module* cm, std::string cmName, double dcLoss)
 		cecModel.Rs = cm->as_double("cec_r_s");
 		cecModel.Rsh = cm->as_double("cec_r_sh_ref");
 		cecModel.Adj = cm->as_double("cec_adjust");
+		cecModel.UseLambertW = useLambertW;
 
 		selfShadingFillFactor = cecModel.Vmp * cecModel.Imp / cecModel.Voc / cecModel.Isc;
 		voltageMaxPower = cecModel.Vmp;
@@ -1027,6 +1029,7 @@ Module_IO::Module_IO(compute_module* cm, std::string cmName, double dcLoss)
 		cecModel.Rs = m.Rs;
 		cecModel.Rsh = m.Rsh;
 		cecModel.Adj = m.Adj;
+		cecModel.UseLambertW = useLambertW;
 
 		selfShadingFillFactor = cecModel.Vmp * cecModel.Imp / cecModel.Voc / cecModel.Isc;
 		voltageMaxPower = cecModel.Vmp;
@@ -1144,6 +1147,7 @@ Module_IO::Module_IO(compute_module* cm, std::string cmName, double dcLoss)
 		elevenParamSingleDiodeModel.AMA[3] = cm->as_double("sd11par_AMa3");
 		elevenParamSingleDiodeModel.AMA[4] = cm->as_double("sd11par_AMa4");
 		elevenParamSingleDiodeModel.GlassAR = cm->as_boolean("sd11par_glass");
+		elevenParamSingleDiodeModel.UseLambertW = useLambertW;
 
 		setupNOCTModel(cm, "sd11par");
 
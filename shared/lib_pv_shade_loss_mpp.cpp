@@ -25,6 +25,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <algorithm>    // std::sort
 #include <math.h> // logarithm function
 #include <cstring> // memcpy
+#include <mutex>
 
 #include "lib_miniz.h" // decompression
 #include "DB8_vmpp_impp_uint8_bin.h" // char* of binary compressed file
@@ -143,6 +144,7 @@ std::vector<double> ShadeDB8_mpp::get_vector(const size_t &N, const size_t &d, c
 		break;
 	}
 	if (length == 0) return ret_vec;
+	if (!load()) return ret_vec;
 	size_t ndx;
 	if (get_index(N, d, t, S, DB_TYPE, &ndx))
 	{
@@ -161,46 +163,67 @@ void ShadeDB8_mpp::init()
 {
 	p_error_msg = "";
 	p_warning_msg = "";
-	p_vmpp_uint8_size = 12091680; // uint8 size from matlab
-	p_impp_uint8_size = 12091680; // uint8 size from matlab
-	p_vmpp = (unsigned char *)malloc(p_vmpp_uint8_size);//malloc(12091680); uint8 size
-	p_impp = (unsigned char *)malloc(p_impp_uint8_size);//malloc(12091680); uint8 size
-	p_compressed_size = 3133517; // from modified example5.c in miniz project
-	decompress_file_to_uint8();
 }
 
 ShadeDB8_mpp::~ShadeDB8_mpp()
 {
-	if (p_vmpp)
-		free(p_vmpp);
-	if (p_impp)
-		free(p_impp);
+	// tables are owned by the shared ShadeDB8_mpp_data
 }
 
-
-
-bool ShadeDB8_mpp::decompress_file_to_uint8()
+std::shared_ptr<const ShadeDB8_mpp_data> ShadeDB8_mpp::shared_data()
 {
-	size_t status;
-	uint8 *pTmp_data;
+	// the tables never change, so one copy is kept for the life of the process
+	// and handed out to all modules and threads
+	static std::mutex db_mutex;
+	static std::shared_ptr<const ShadeDB8_mpp_data> db;
 
-	size_t mem_size = p_vmpp_uint8_size + p_impp_uint8_size;
+	std::lock_guard<std::mutex> lock(db_mutex);
+	if (!db)
+	{
+		std::shared_ptr<ShadeDB8_mpp_data> data(new ShadeDB8_mpp_data());
+		data->vmpp_uint8_size = 12091680; // uint8 size from matlab
+		data->impp_uint8_size = 12091680; // uint8 size from matlab
+		decompress_file_to_uint8(*data);
+		db = data;
+	}
+	return db;
+}
 
-	pTmp_data = (uint8 *)malloc(mem_size);
+bool ShadeDB8_mpp::load()
+{
+	if (!p_data)
+	{
+		p_data = shared_data();
+		if (!p_data->error_msg.empty())
+		{
+			p_error_msg = p_data->error_msg;
+			p_vmpp = NULL;
+			p_impp = NULL;
+		}
+		else
+		{
+			p_vmpp = &p_data->bytes[0];
+			p_impp = &p_data->bytes[p_data->vmpp_uint8_size];
+		}
+	}
+	return (p_vmpp != NULL);
+}
 
-	status = tinfl_decompress_mem_to_mem((void *)pTmp_data, mem_size, pCmp_data, p_compressed_size, TINFL_FLAG_PARSE_ZLIB_HEADER);
+bool ShadeDB8_mpp::decompress_file_to_uint8(ShadeDB8_mpp_data &data)
+{
+	size_t status;
+	size_t compressed_size = 3133517; // from modified example5.c in miniz project
 
-	memcpy(p_vmpp, pTmp_data, p_vmpp_uint8_size);
-	memcpy(p_impp, pTmp_data + p_vmpp_uint8_size, p_impp_uint8_size);
+	data.bytes.resize(data.vmpp_uint8_size + data.impp_uint8_size);
 
-	free(pTmp_data);
+	status = tinfl_decompress_mem_to_mem((void *)&data.bytes[0], data.bytes.size(), pCmp_data, compressed_size, TINFL_FLAG_PARSE_ZLIB_HEADER);
 
 	if (status == TINFL_DECOMPRESS_MEM_TO_MEM_FAILED)
 	{
 		std::stringstream outm;
 		outm << "tinfl_decompress_mem_to_mem() failed with status " << (int)status;
-		p_error_msg = outm.str();
-		return EXIT_FAILURE;
+		data.error_msg = outm.str();
+		return false;
 	}
 
 	return true;
@@ -29,8 +29,19 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 #include <stdlib.h>
 #include <string>
+#include <memory>
 
 extern const unsigned char pCmp_data[3133517];
+
+// decompressed vmpp and impp tables, immutable once built and shared by every ShadeDB8_mpp in the process
+struct ShadeDB8_mpp_data
+{
+	std::vector<unsigned char> bytes; // vmpp table followed by impp table
+	size_t vmpp_uint8_size;
+	size_t impp_uint8_size;
+	std::string error_msg;
+};
+
 // shading database with up to 8 strings
 class ShadeDB8_mpp
 {
@@ -41,7 +52,10 @@ public:
 		p_impp=NULL ;
 	};
 	~ShadeDB8_mpp();
+	/// Prepare for lookups; the shared tables are decompressed on first use by any instance in the process
 	void init();
+	/// Reference to the process-wide tables, decompressing them if no instance has done so yet
+	static std::shared_ptr<const ShadeDB8_mpp_data> shared_data();
 	short vmpp(size_t ndx){
 		return get_vmpp(ndx);
 	};
@@ -58,14 +72,13 @@ public:
 
 
 private:
-	unsigned char *p_vmpp;
-	unsigned char *p_impp;
+	std::shared_ptr<const ShadeDB8_mpp_data> p_data;
+	const unsigned char *p_vmpp;
+	const unsigned char *p_impp;
 	short get_vmpp(size_t i);
 	short get_impp(size_t i);
-	bool decompress_file_to_uint8();
-	size_t p_vmpp_uint8_size;
-	size_t p_impp_uint8_size;
-	size_t p_compressed_size;
+	bool load();
+	static bool decompress_file_to_uint8(ShadeDB8_mpp_data &data);
 	std::string p_warning_msg;
 	std::string p_error_msg;
 };
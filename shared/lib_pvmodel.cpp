@@ -24,6 +24,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <math.h>
 #include <limits>
 #include <iostream>
+#include <vector>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846264338327
@@ -36,6 +37,7 @@ pvinput_t::pvinput_t()
 		= Zenith = IncAng = Elev 
 		= Tilt = Azimuth = HourOfDay = std::numeric_limits<double>::quiet_NaN();
 
+	Irear = 0;
 	radmode = 0;
 	usePOAFromWF = false;
 }
@@ -99,6 +101,15 @@ std::string pvmodule_t::error()
 	return m_err;
 }
 
+bool pvmodule_t::evaluate( size_t n, pvinput_t *input, const double *TcellC, const double *opvoltage, pvoutput_t *output )
+{
+	bool ok = true;
+	for ( size_t i = 0; i < n; i++ )
+		if ( !(*this)( input[i], TcellC[i], opvoltage ? opvoltage[i] : -1.0, output[i] ) )
+			ok = false;
+	return ok;
+}
+
 spe_module_t::spe_module_t( )
 {
 	VmpNominal = 0;
@@ -439,6 +450,198 @@ double maxpower_5par( double Voc_ubound, double a, double Il, double Io, double
 	return P;
 }
 
+double lambertw_exp( double lnx )
+{
+/*
+	Principal branch of the Lambert W function evaluated at x = exp(lnx), i.e. the w >= 0 that
+	solves w*exp(w) = x.  Taking the argument as a logarithm lets the single diode equations pass
+	arguments far beyond the range of a double.  Winitzki's approximation gives the starting point
+	and Halley's method converges to full precision in two or three steps.
+*/
+	if ( lnx > 2.0 )
+	{
+		// solve w + ln(w) = lnx in the log domain
+		double L = ( lnx > 700 ) ? lnx : log1p( exp( lnx ) );
+		double w = L * ( 1 - log1p( L ) / ( 2 + L ) );
+		for ( int i = 0; i < 10; i++ )
+		{
+			double f = w + log( w ) - lnx;
+			double fp = 1 + 1/w;
+			double dw = f / ( fp + 0.5*f/(w*w*fp) );
+			w -= dw;
+			if ( fabs(dw) <= 1e-15*w ) break;
+		}
+		return w;
+	}
+
+	double x = exp( lnx );
+	double L = log1p( x );
+	double w = L * ( 1 - log1p( L ) / ( 2 + L ) );
+	for ( int i = 0; i < 10; i++ )
+	{
+		double ew = exp( w );
+		double f = w*ew - x;
+		double dw = f / ( ew*(w + 1) - (w + 2)*f/(2*w + 2) );
+		w -= dw;
+		if ( fabs(dw) <= 1e-15*( w > 1e-300 ? w : 1e-300 ) ) break;
+	}
+	return w;
+}
+
+// explicit single diode current and its first two voltage derivatives (Jain & Kapoor 2004)
+struct sd_lambertw_t
+{
+	double a, Il, Io, Rs, Rsh;
+	double I, dIdV, d2IdV2;
+
+	void eval( double V )
+	{
+		if ( Rs < 1e-9 )
+		{
+			double e = Io*exp( V/a );
+			I = Il - ( e - Io ) - V/Rsh;
+			dIdV = -e/a - 1/Rsh;
+			d2IdV2 = -e/(a*a);
+			return;
+		}
+
+		double R = Rs + Rsh;
+		double k = Rsh / (a*R);
+		double lntheta = log( Rs*Io*Rsh/(a*R) ) + k*( Rs*(Il + Io) + V );
+		double W = lambertw_exp( lntheta );
+		double c = Rsh / (Rs*R);
+		I = ( Rsh*(Il + Io) - V )/R - (a/Rs)*W;
+		dIdV = -1/R - c*W/(1 + W);
+		d2IdV2 = -c*k*W/( (1 + W)*(1 + W)*(1 + W) );
+	}
+};
+
+double current_5par_lambertw( double V, double a, double Il, double Io, double Rs, double Rsh )
+{
+	sd_lambertw_t sd = { a, Il, Io, Rs, Rsh, 0, 0, 0 };
+	sd.eval( V );
+	return sd.I > 0 ? sd.I : 0.0;
+}
+
+double openvoltage_5par_lambertw( double a, double Il, double Io, double Rsh )
+{
+	double lntheta = log( Io*Rsh/a ) + Rsh*(Il + Io)/a;
+	return (Il + Io)*Rsh - a*lambertw_exp( lntheta );
+}
+
+double maxpower_5par_lambertw( double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double *__Vmp, double *__Imp )
+{
+/*
+	At the maximum power point d(V*I)/dV = I + V*dI/dV = 0.  With the current explicit in V this
+	is a smooth one dimensional root, found by Newton's method kept inside a shrinking bracket.
+	g(0) = Isc > 0 and g(Voc) = Voc*dI/dV < 0, so the bracket always holds a root.
+*/
+	double P = 0, V = 0, I = 0;
+	sd_lambertw_t sd = { a, Il, Io, Rs, Rsh, 0, 0, 0 };
+
+	double lo = 0, hi = Voc_ubound;
+	sd.eval( lo );
+	if ( Il > 0 && hi > 0 && sd.I > 0 )
+	{
+		// ideal diode estimate of the maximum power voltage as the starting point
+		V = hi - a*log( 1 + hi/a );
+		if ( V <= lo || V >= hi ) V = 0.8*hi;
+		for ( int it = 0; it < 100; it++ )
+		{
+			sd.eval( V );
+			double g = sd.I + V*sd.dIdV;
+			if ( g > 0 ) lo = V;
+			else hi = V;
+
+			double gp = 2*sd.dIdV + V*sd.d2IdV2;
+			double Vnew = ( gp < 0 ) ? V - g/gp : 0.5*(lo + hi);
+			if ( Vnew <= lo || Vnew >= hi )
+				Vnew = 0.5*(lo + hi);
+
+			bool done = fabs( Vnew - V ) <= 1e-9*Voc_ubound;
+			V = Vnew;
+			if ( done || hi - lo <= 1e-12*Voc_ubound ) break;
+		}
+
+		sd.eval( V );
+		I = sd.I > 0 ? sd.I : 0.0;
+		P = V*I;
+	}
+
+	if ( __Vmp ) *__Vmp = V;
+	if ( __Imp ) *__Imp = I;
+	return P;
+}
+
+void maxpower_5par_lambertw_batch( size_t n, const double *Voc_ubound, const double *a, const double *Il, const double *Io, double Rs, const double *Rsh,
+	double *P, double *Vmp, double *Imp )
+{
+/*
+	The same Newton iteration as maxpower_5par_lambertw, with every state taking exactly the same steps,
+	run in lockstep: each pass evaluates the current of all unconverged states before any of them is
+	updated.  The Lambert W evaluations of different states are independent, so the processor overlaps
+	them instead of waiting on one state's chain of exp/log calls at a time.
+*/
+	std::vector<sd_lambertw_t> sd( n );
+	std::vector<double> lo( n ), hi( n ), V( n );
+	std::vector<size_t> active, next;
+	active.reserve( n );
+	next.reserve( n );
+
+	for ( size_t i = 0; i < n; i++ )
+	{
+		sd_lambertw_t s = { a[i], Il[i], Io[i], Rs, Rsh[i], 0, 0, 0 };
+		sd[i] = s;
+		lo[i] = 0;
+		hi[i] = Voc_ubound[i];
+		V[i] = 0;
+		P[i] = Vmp[i] = Imp[i] = 0;
+		sd[i].eval( lo[i] );
+		if ( Il[i] > 0 && hi[i] > 0 && sd[i].I > 0 )
+		{
+			V[i] = hi[i] - a[i]*log( 1 + hi[i]/a[i] );
+			if ( V[i] <= lo[i] || V[i] >= hi[i] ) V[i] = 0.8*hi[i];
+			active.push_back( i );
+		}
+	}
+	std::vector<size_t> solved( active );
+
+	for ( int it = 0; it < 100 && !active.empty(); it++ )
+	{
+		for ( size_t k = 0; k < active.size(); k++ )
+			sd[ active[k] ].eval( V[ active[k] ] );
+
+		next.clear();
+		for ( size_t k = 0; k < active.size(); k++ )
+		{
+			size_t i = active[k];
+			double g = sd[i].I + V[i]*sd[i].dIdV;
+			if ( g > 0 ) lo[i] = V[i];
+			else hi[i] = V[i];
+
+			double gp = 2*sd[i].dIdV + V[i]*sd[i].d2IdV2;
+			double Vnew = ( gp < 0 ) ? V[i] - g/gp : 0.5*(lo[i] + hi[i]);
+			if ( Vnew <= lo[i] || Vnew >= hi[i] )
+				Vnew = 0.5*(lo[i] + hi[i]);
+
+			bool done = fabs( Vnew - V[i] ) <= 1e-9*Voc_ubound[i];
+			V[i] = Vnew;
+			if ( !( done || hi[i] - lo[i] <= 1e-12*Voc_ubound[i] ) )
+				next.push_back( i );
+		}
+		active.swap( next );
+	}
+
+	for ( size_t k = 0; k < solved.size(); k++ )
+	{
+		size_t i = solved[k];
+		sd[i].eval( V[i] );
+		Vmp[i] = V[i];
+		Imp[i] = sd[i].I > 0 ? sd[i].I : 0.0;
+		P[i] = Vmp[i]*Imp[i];
+	}
+}
+
 double maxpower_5par_rec( double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double D2MuTau, double Vbi, double *__Vmp, double *__Imp )
 {
 	double P, V, I;
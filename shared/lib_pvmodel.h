@@ -24,6 +24,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __pvmodulemodel_h
 
 #include <string>
+#include <cstddef>
 
 class pvcelltemp_t;
 class pvpower_t;
@@ -104,6 +105,12 @@ public:
 
 
 	virtual bool operator() ( pvinput_t &input, double TcellC, double opvoltage, pvoutput_t &output ) = 0;
+
+	/* Evaluates n independent module states whose cell temperatures are already known, with the
+	same results as calling operator() for each one.  opvoltage may be 0, in which case every state
+	operates at its maximum power point.  The default evaluates each state through operator().
+	Returns false if any state failed. */
+	virtual bool evaluate( size_t n, pvinput_t *input, const double *TcellC, const double *opvoltage, pvoutput_t *output );
 	std::string error();
 
 	virtual ~pvmodule_t() {};
@@ -147,6 +154,14 @@ double openvoltage_5par( double Voc0, double a, double IL, double IO, double Rsh
 double openvoltage_5par_rec(double Voc0, double a, double IL, double IO, double Rsh, double D2MuTau, double Vbi);
 double maxpower_5par( double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double *Vmp=0, double *Imp=0);
 double maxpower_5par_rec(double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double D2MuTau, double Vbi, double *__Vmp=0, double *__Imp=0);
+
+// explicit single diode solutions using the Lambert W function, alternatives to the iterative versions above
+double lambertw_exp( double lnx ); // W0( exp(lnx) )
+double current_5par_lambertw( double V, double a, double Il, double Io, double Rs, double Rsh );
+double openvoltage_5par_lambertw( double a, double Il, double Io, double Rsh );
+double maxpower_5par_lambertw( double Voc_ubound, double a, double Il, double Io, double Rs, double Rsh, double *Vmp=0, double *Imp=0 );
+void maxpower_5par_lambertw_batch( size_t n, const double *Voc_ubound, const double *a, const double *Il, const double *Io, double Rs, const double *Rsh,
+	double *P, double *Vmp, double *Imp ); // maxpower_5par_lambertw for n states
 double air_mass_modifier( double Zenith_deg, double Elev_m, double a[5] );
 
 
@@ -70,7 +70,7 @@ double mask_angle_func(double x, double R, double B, double tilt_eff)
 double trapzd(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt, int n)
 {
 	double x,tnm,sum,del;
-	static double s;
+	static thread_local double s; // per thread so that self-shading can run in concurrent simulations
 	int it,j;
 	if (n == 1) 
 	{
@@ -263,18 +263,21 @@ namespace util
 	protected:
 		T *t_array;
 		size_t n_rows, n_cols;
+		bool t_borrowed; // t_array is owned by the caller of borrow() and is never freed here
 	public:
 
 		matrix_t()
 		{
 			t_array = new T[1];
 			n_rows = n_cols = 1;
+			t_borrowed = false;
 		}
 
 		matrix_t( const matrix_t &cc )
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			copy( cc );
 		}
 		
@@ -282,6 +285,7 @@ namespace util
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			if (len < 1) len = 1;
 			resize( 1, len );
 		}
@@ -290,6 +294,7 @@ namespace util
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			if (nr < 1) nr = 1;
 			if (nc < 1) nc = 1;
 			resize(nr,nc);
@@ -299,6 +304,7 @@ namespace util
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			if (nr < 1) nr = 1;
 			if (nc < 1) nc = 1;
 			resize(nr,nc);
@@ -308,6 +314,7 @@ namespace util
 		{
 			n_rows = n_cols = 0;
 			t_array = NULL;
+			t_borrowed = false;
 			if (nr < 1) nr = 1;
 			if (nc < 1) nc = 1;
 			resize(nr, nc);
@@ -319,20 +326,58 @@ namespace util
 
 		virtual ~matrix_t()
 		{
-			if (t_array) delete [] t_array;
+			if (t_array && !t_borrowed) delete [] t_array;
 		}
 		
 		void clear()
 		{
-			if (t_array) delete [] t_array;
+			if (t_array && !t_borrowed) delete [] t_array;
 			n_rows = n_cols = 1;
 			t_array = new T[1];
+			t_borrowed = false;
 		}
+
+		/// Use caller-owned memory in place instead of copying it.  The caller keeps the memory
+		/// valid until the matrix is destroyed, resized to another shape, or assigned a new value.
+		void borrow( T *pvalues, size_t nr, size_t nc )
+		{
+			if (!pvalues || nr < 1 || nc < 1) return;
+			if (t_array && !t_borrowed) delete [] t_array;
+			t_array = pvalues;
+			n_rows = nr;
+			n_cols = nc;
+			t_borrowed = true;
+		}
+
+		/// Take ownership of memory allocated with new[] instead of copying it.  The memory is
+		/// freed by this matrix from then on, so the caller must not use or delete it afterwards.
+		void adopt( T *pvalues, size_t nr, size_t nc )
+		{
+			if (!pvalues || nr < 1 || nc < 1) return;
+			if (t_array && !t_borrowed) delete [] t_array;
+			t_array = pvalues;
+			n_rows = nr;
+			n_cols = nc;
+			t_borrowed = false;
+		}
+
+		inline bool is_borrowed() const
+		{
+			return t_borrowed;
+		}
+
 		
 		void copy( const matrix_t &rhs )
 		{
 			if (this != &rhs)
 			{
+				if (t_borrowed)
+				{
+					// assigning a new value never writes through to borrowed memory
+					t_array = NULL;
+					n_rows = n_cols = 0;
+					t_borrowed = false;
+				}
 				resize( rhs.nrows(), rhs.ncols() );
 				size_t nn = n_rows*n_cols;
 				for (size_t i=0;i<nn;i++)
@@ -369,6 +414,7 @@ namespace util
 		
 		matrix_t &operator=(const T &val)
 		{
+			if (t_borrowed) clear();
 			resize(1,1);
 			t_array[0] = val;
 			return *this;
@@ -413,10 +459,11 @@ namespace util
 			if (nr < 1 || nc < 1) return;
 			if (nr == n_rows && nc == n_cols) return;
 			
-			if (t_array) delete [] t_array;
+			if (t_array && !t_borrowed) delete [] t_array;
 			t_array = new T[ nr * nc ];
 			n_rows = nr;
 			n_cols = nc;
+			t_borrowed = false;
 		}
 
 		void resize_fill(size_t nr, size_t nc, const T &val)
@@ -31,13 +31,25 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstdint>
 
 #if defined(__WINDOWS__)||defined(WIN32)||defined(_WIN32)
 #define CASECMP(a,b) _stricmp(a,b)
 #define CASENCMP(a,b,n) _strnicmp(a,b,n)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
 #else
 #define CASECMP(a,b) strcasecmp(a,b) 
 #define CASENCMP(a,b,n) strncasecmp(a,b,n)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include "lib_util.h"
@@ -108,6 +120,176 @@ static float col_or_nan(const std::string &s)
 		return std::numeric_limits<float>::quiet_NaN();;
 }
 
+static const double pow10_table[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+	1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static inline bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+static inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+/* Locale-independent decimal parser over [p,end): optional sign, digits, fraction and exponent.
+Leading whitespace is skipped.  Returns false if no digits were found. */
+static bool parse_decimal(const char *p, const char *end, double &val)
+{
+	while (p < end && is_space(*p)) p++;
+
+	bool neg = false;
+	if (p < end && (*p == '-' || *p == '+'))
+		neg = (*p++ == '-');
+
+	uint64_t mant = 0;
+	int ndigits = 0, exp10 = 0;
+	bool any = false;
+	for (; p < end && is_digit(*p); p++, any = true)
+	{
+		if (ndigits < 19) { mant = mant * 10 + (uint64_t)(*p - '0'); if (mant) ndigits++; }
+		else exp10++;
+	}
+	if (p < end && *p == '.')
+	{
+		for (p++; p < end && is_digit(*p); p++, any = true)
+		{
+			if (ndigits < 19) { mant = mant * 10 + (uint64_t)(*p - '0'); if (mant) ndigits++; exp10--; }
+		}
+	}
+	if (!any) return false;
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char *q = p + 1;
+		bool eneg = false;
+		if (q < end && (*q == '-' || *q == '+'))
+			eneg = (*q++ == '-');
+		if (q < end && is_digit(*q))
+		{
+			int e = 0;
+			for (; q < end && is_digit(*q); q++)
+				if (e < 10000) e = e * 10 + (*q - '0');
+			exp10 += eneg ? -e : e;
+		}
+	}
+
+	double v = (double)mant;
+	if (mant != 0 && exp10 != 0)
+	{
+		if (exp10 > 0 && exp10 <= 22) v *= pow10_table[exp10];
+		else if (exp10 < 0 && exp10 >= -22) v /= pow10_table[-exp10];
+		else v *= std::pow(10.0, (double)exp10);
+	}
+	val = neg ? -v : v;
+	return true;
+}
+
+/* Splits delimited data lines into fields without copying them.  The field offsets are kept
+between lines, so once the widest line has been seen no further allocation happens. */
+class field_tokenizer
+{
+	const char *m_line;
+	std::vector<size_t> m_start, m_end;
+	size_t m_count;
+	bool m_bad;
+
+public:
+	field_tokenizer() : m_line(0), m_count(0), m_bad(false) { }
+
+	size_t split(const std::string &line, char delim = ',')
+	{
+		m_line = line.c_str();
+		m_count = 0;
+		m_bad = false;
+		size_t n = line.length(), start = 0;
+		for (size_t i = 0; i <= n; i++)
+		{
+			if (i == n || m_line[i] == delim)
+			{
+				if (i == n && start == n && m_count > 0) break; // trailing delimiter, as getline-based split
+				if (m_count == m_start.size())
+				{
+					m_start.push_back(0);
+					m_end.push_back(0);
+				}
+				m_start[m_count] = start;
+				m_end[m_count] = i;
+				m_count++;
+				start = i + 1;
+			}
+		}
+		if (n == 0) m_count = 0;
+		return m_count;
+	}
+
+	size_t size() const { return m_count; }
+
+	// false if integer() was asked for a field with no number in it since the last split()
+	bool ok() const { return !m_bad; }
+
+	/// same semantics as col_or_nan() on the field text, 'unparsable' is returned where stof() would throw
+	float number(size_t i, float unparsable = std::numeric_limits<float>::quiet_NaN()) const
+	{
+		if (i >= m_count) return std::numeric_limits<float>::quiet_NaN();
+		const char *p = m_line + m_start[i], *end = m_line + m_end[i];
+		while (p < end && is_space(*p)) p++;
+		while (end > p && is_space(end[-1])) end--;
+		if (p == end || std::find_if(p, end, is_digit) == end)
+			return std::numeric_limits<float>::quiet_NaN();
+
+		double v;
+		if (is_digit(*p))
+			return parse_decimal(p, end, v) ? (float)v : unparsable;
+
+		bool neg = (*p == '-');
+		if (!parse_decimal(p + 1, end, v)) return unparsable;
+		return (float)(neg ? 0.0 - v : v);
+	}
+
+	/// same semantics as stoi() on the field text
+	int integer(size_t i)
+	{
+		double v = 0;
+		if (i >= m_count || !parse_decimal(m_line + m_start[i], m_line + m_end[i], v))
+		{
+			m_bad = true;
+			return 0;
+		}
+		return (int)v;
+	}
+
+	const char *begin(size_t i) const { return m_line + m_start[i]; }
+	const char *end(size_t i) const { return m_line + m_end[i]; }
+};
+
+/* Reads one TMY2 data line: fixed-width integer fields ('1'-'9' give the width, as scanf %Nd) and
+single-character flags ('s', as scanf %1s), skipping whitespace before each field the same way
+scanf does.  Returns the number of fields converted. */
+static int scan_fixed_width(const char *p, const char *layout, int *out)
+{
+	int n = 0;
+	for (; *layout; layout++, n++)
+	{
+		while (*p && is_space(*p)) p++;
+		if (!*p) break;
+
+		if (*layout == 's')
+		{
+			out[n] = *p++;
+			continue;
+		}
+
+		int width = *layout - '0';
+		bool neg = false;
+		if (*p == '-' || *p == '+')
+		{
+			neg = (*p++ == '-');
+			width--;
+		}
+		if (width <= 0 || !is_digit(*p)) break;
+		int v = 0;
+		for (; width > 0 && is_digit(*p); width--)
+			v = v * 10 + (*p++ - '0');
+		out[n] = neg ? -v : v;
+	}
+	return n;
+}
+
 static double conv_deg_min_sec(double degrees,
 	double minutes,
 	double seconds,
@@ -413,13 +595,110 @@ void weather_record::reset()
 
 #define NBUF 2048
 
+/* Binary columnar weather cache (.wfb)
+
+	wfb_header
+	7 strings, each a uint32_t byte count followed by the bytes (location, city, state, country,
+		source, description, url)
+	zero padding up to data_offset (a multiple of WFB_ALIGN)
+	_MAXCOL_ columns of float, each 'stride' values long, in weather_data_provider column order
+
+The columns are written after missing-value handling and leap day removal, so reading them
+back gives exactly the records the text reader would have produced. */
+
+static const char WFB_MAGIC[8] = { 'S', 'S', 'C', 'W', 'F', 'B', 'I', 'N' };
+static const uint32_t WFB_VERSION = 1;
+static const uint32_t WFB_BYTE_ORDER = 0x01020304;
+static const size_t WFB_ALIGN = 64;
+
+struct wfb_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t type; // source format, reported by weatherfile::type()
+	int32_t start_year;
+	uint64_t nrecords;
+	uint64_t start_sec;
+	uint64_t step_sec;
+	uint64_t stride; // values per column, padded so that every column starts on a WFB_ALIGN boundary
+	uint64_t data_offset;
+	int32_t has_leap_year;
+	int32_t hasunits;
+	int32_t ncols;
+	int32_t index[weather_data_provider::_MAXCOL_];
+	double time;
+	double tz;
+	double lat;
+	double lon;
+	double elev;
+};
+
+class weatherfile_mapping
+{
+	const unsigned char *m_base;
+	size_t m_size;
+#if defined(__WINDOWS__)||defined(WIN32)||defined(_WIN32)
+	HANDLE m_file;
+	HANDLE m_map;
+#endif
+
+public:
+	weatherfile_mapping(const std::string &file)
+		: m_base(0), m_size(0)
+	{
+#if defined(__WINDOWS__)||defined(WIN32)||defined(_WIN32)
+		m_map = 0;
+		m_file = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		if (m_file == INVALID_HANDLE_VALUE) return;
+		LARGE_INTEGER sz;
+		if (!GetFileSizeEx(m_file, &sz) || sz.QuadPart == 0) return;
+		m_map = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+		if (!m_map) return;
+		m_base = (const unsigned char*)MapViewOfFile(m_map, FILE_MAP_READ, 0, 0, 0);
+		if (m_base) m_size = (size_t)sz.QuadPart;
+#else
+		int fd = ::open(file.c_str(), O_RDONLY);
+		if (fd < 0) return;
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0)
+		{
+			void *p = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (p != MAP_FAILED)
+			{
+				m_base = (const unsigned char*)p;
+				m_size = (size_t)st.st_size;
+			}
+		}
+		::close(fd); // the mapping keeps its own reference to the file
+#endif
+	}
+
+	~weatherfile_mapping()
+	{
+#if defined(__WINDOWS__)||defined(WIN32)||defined(_WIN32)
+		if (m_base) UnmapViewOfFile(m_base);
+		if (m_map) CloseHandle(m_map);
+		if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#else
+		if (m_base) munmap((void*)m_base, m_size);
+#endif
+	}
+
+	bool ok() const { return m_base != 0; }
+	const unsigned char *data() const { return m_base; }
+	size_t size() const { return m_size; }
+};
+
 
 weatherfile::weatherfile()
+	: m_mappedData(0), m_mappedStride(0)
 {
 	reset();
 }
 
 weatherfile::weatherfile(const std::string &file, bool header_only)
+	: m_mappedData(0), m_mappedStride(0)
 {
 	reset();
 	m_ok = open(file, header_only);
@@ -445,6 +724,10 @@ void weatherfile::reset()
 	m_file.clear();
 	m_startYear = 1900;
 
+	m_mapping.reset();
+	m_mappedData = 0;
+	m_mappedStride = 0;
+
 	m_hdr.reset();
 	//m_rec.reset();
 }
@@ -557,6 +840,13 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		return false;
 	}
 
+	m_mapping.reset();
+	m_mappedData = 0;
+	m_mappedStride = 0;
+
+	if (cmp_ext(file, "wfb"))
+		return open_binary(file, header_only);
+
 	if (cmp_ext(file, "tm2") || cmp_ext(file, "tmy2"))
 		m_type = TMY2;
 	else if (cmp_ext(file, "tm3") || cmp_ext(file, "tmy3"))
@@ -569,7 +859,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		m_type = SMW;
 	else
 	{
-		m_message = "could not detect weather data file format from file extension (.csv,.tm2,.tm2,.epw)";
+		m_message = "could not detect weather data file format from file extension (.csv,.tm2,.tm2,.epw,.wfb)";
 		return false;
 	}
 
@@ -1047,54 +1337,39 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	int tmy3_hour_shift = 1;
 	int n_leap_data_removed = 0;
 
+	/* TMY2 data line layout, see scan_fixed_width():
+		yr mn dy hr, extraterrestrial horizontal and direct normal,
+		7x (value, source, uncertainty) for GH, DN, DF, GH/DN/DF/zenith illuminance,
+		total and opaque sky cover, dry bulb and dew point temperature, relative humidity,
+		pressure, wind direction, wind speed, visibility, ceiling height, 10 present weather
+		codes, precipitable water, aerosol optical depth, snow depth, days since snowfall */
+	static const char tmy2_layout[] = "2222" "44" "4s14s14s14s14s14s14s1" "2s12s1" "4s14s1"
+		"3s1" "4s1" "3s1" "3s1" "4s1" "5s1" "1111111111" "3s13s13s1" "2s1";
+	int f[79] = { 0 };
+
+	// resolved once from the header: (field index, column) pairs of a WFCSV data line
+	std::vector<std::pair<int, int> > csv_fields;
+	if (m_type == WFCSV)
+		for (int k = 0; k < _MAXCOL_; k++)
+			if (m_columns[k].index >= 0)
+				csv_fields.push_back(std::make_pair(m_columns[k].index, k));
+
+	field_tokenizer cols;
+	bool col_missing[_MAXCOL_] = { false };
+
 	for (int i = 0; i < (int)m_nRecords; i++)
 	{
 		if (m_type == TMY2)
 		{
 
-			int yr, mn, dy, hr, ethor, etdn;
-			int d1, d2, d3, d4, d5, d6, d7, d8, d9, d10, d11, d12, d13, d14, d15, d16, d17, d18, d19, d20, d21;      /* which of these are used? d3, d10, d15 & d20 */
-			int u1, u2, u3, u4, u5, u6, u7, u8, u9, u10, u11, u12, u13, u14, u15, u16, u17, u18, u19, u20, u21;  /* are any of these ever used?? */
-			int w1, w2, w3, w4, w5, w6, w7, w8, w9, w10;
-			char f1[2], f2[2], f3[2], f4[2], f5[2], f6[2], f7[2], f8[2], f9[2], f10[2], f11[2], f12[2], f13[2], f14[2], f15[2], f16[2], f17[2], f18[2], f19[2], f20[2], f21[2];
-
 			int nread = 0;
 
 			for (;;)
 			{
 				getline(ifs, buf);
-				nread = sscanf(buf.c_str(),
-					"%2d%2d%2d%2d"
-					"%4d%4d"
-					"%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d"
-					"%2d%1s%1d%2d%1s%1d%4d%1s%1d%4d%1s%1d%3d%1s%1d%4d%1s%1d%3d%1s%1d"
-					"%3d%1s%1d%4d%1s%1d%5d%1s%1d%1d%1d%1d%1d%1d%1d%1d%1d%1d%1d%3d%1s%1d%3d%1s%1d%3d%1s%1d%2d%1s%1d\n",
-					&yr, &mn, &dy, &hr,
-					&ethor, /* extraterrestrial horizontal radiation */
-					&etdn, /* extraterrestrial direct normal radiation */
-					&d1, f1, &u1, /* GH data value 0-1415 Wh/m2, Source, Uncertainty */
-					&d2, f2, &u2, /* DN data value 0-1200 Wh/m2, Source, Uncertainty */
-					&d3, f3, &u3, /* DF data value 0-700 Wh/m2, Source, Uncertainty */
-					&d4, f4, &u4, /* GH illum data value, Source, Uncertainty */
-					&d5, f5, &u5, /* DN illum data value, Source, Uncertainty */
-					&d6, f6, &u6, /* DF illum data value, Source, Uncertainty */
-					&d7, f7, &u7, /* Zenith illum data value, Source, Uncertainty */
-					&d8, f8, &u8, /* Total sky cover */
-					&d9, f9, &u9, /* opaque sky cover */
-					&d10, f10, &u10, /* dry bulb temp -500 to 500 = -50.0 to 50.0 'C */
-					&d11, f11, &u11, /* dew point temp -600 to 300 = -60.0 to 30.0 'C */
-					&d12, f12, &u12, /* relative humidity 0-100 */
-					&d13, f13, &u13, /* pressure millibars */
-					&d14, f14, &u14, /* wind direction */
-					&d15, f15, &u15, // wind speed 0 to 400 = 0.0 to 40.0 m/s
-					&d16, f16, &u16, // visibility
-					&d17, f17, &u17, // ceiling height
-					&w1, &w2, &w3, &w4, &w5, &w6, &w7, &w8, &w9, &w10, // present weather
-					&d18, f18, &u18, // precipitable water
-					&d19, f19, &u19, // aerosol optical depth
-					&d20, f20, &u20, // snow depth 0-150 cm
-					&d21, f21, &u21); // days since last snowfall 0-88
+				nread = scan_fixed_width(buf.c_str(), tmy2_layout, f);
 
+				int yr = f[0], mn = f[1], dy = f[2], hr = f[3];
 				if (mn == 2 && dy == 29)
 				{
 					// skip data lines for february 29th if they exist in the file
@@ -1102,6 +1377,9 @@ bool weatherfile::open(const std::string &file, bool header_only)
 					continue;
 				}
 
+				int d1 = f[6], d2 = f[9], d3 = f[12], d10 = f[33], d11 = f[36], d12 = f[39],
+					d13 = f[42], d14 = f[45], d15 = f[48], d20 = f[73];
+
 				m_columns[YEAR].data[i] = (float)yr + 1900;
 				m_columns[MONTH].data[i] = (float)mn;
 				m_columns[DAY].data[i] = (float)dy;
@@ -1142,34 +1420,30 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			for (;;)
 			{
 				getline(ifs, buf);
-				auto cols = split(buf);
+				cols.split(buf);
 				//				if (cols.size() < 68)
 				//				{
 				//					m_message = "TMY3: data line does not have at least 68 fields at record " + util::to_string(i);
 				//					return false;
 				//				}
 
-				const char *p = cols[0].c_str();
-
-				int month = stoi(p);
-				p = strchr(p, '/');
-				if (!p)
+				// date is mm/dd/yyyy
+				int month = 0, day = 0, year = 0;
+				const char *p = cols.size() > 0 ? cols.begin(0) : "";
+				const char *pend = cols.size() > 0 ? cols.end(0) : p;
+				double v;
+				const char *s1 = std::find(p, pend, '/');
+				const char *s2 = (s1 < pend) ? std::find(s1 + 1, pend, '/') : pend;
+				if (s1 == pend || s2 == pend || !parse_decimal(p, s1, v))
 				{
 					m_message = "TMY3: invalid date format at record " + util::to_string(i);
 					return false;
 				}
-				p++;
-				int day = stoi(p);
-				p = strchr(p, '/');
-				if (!p)
-				{
-					m_message = "TMY3: invalid date format at record " + util::to_string(i);
-					return false;
-				}
-				p++;
-				int year = stoi(p);
+				month = (int)v;
+				if (parse_decimal(s1 + 1, s2, v)) day = (int)v;
+				if (parse_decimal(s2 + 1, pend, v)) year = (int)v;
 
-				int hour = stoi(cols[1]) - tmy3_hour_shift;  // hour goes 0-23, not 1-24
+				int hour = cols.integer(1) - tmy3_hour_shift;  // hour goes 0-23, not 1-24
 				if (i == 0 && hour < 0)
 				{
 					// this was a TMY3 file but with hours going 0-23 (against the tmy3 spec)
@@ -1189,21 +1463,21 @@ bool weatherfile::open(const std::string &file, bool header_only)
 				m_columns[DAY].data[i] = (float)day;
 				m_columns[HOUR].data[i] = (float)hour;
 				m_columns[MINUTE].data[i] = 30;
-				m_columns[GHI].data[i] = col_or_nan(cols[4]);
-				m_columns[DNI].data[i] = col_or_nan(cols[7]);
-				m_columns[DHI].data[i] = col_or_nan(cols[10]);
+				m_columns[GHI].data[i] = cols.number(4);
+				m_columns[DNI].data[i] = cols.number(7);
+				m_columns[DHI].data[i] = cols.number(10);
 				m_columns[POA].data[i] = (float)(-999);       /* No POA in TMY3 */
 
-				m_columns[TDRY].data[i] = col_or_nan(cols[31]);
-				m_columns[TDEW].data[i] = col_or_nan(cols[34]);
+				m_columns[TDRY].data[i] = cols.number(31);
+				m_columns[TDEW].data[i] = cols.number(34);
 
-				m_columns[WSPD].data[i] = col_or_nan(cols[46]);
-				m_columns[WDIR].data[i] = col_or_nan(cols[43]);
+				m_columns[WSPD].data[i] = cols.number(46);
+				m_columns[WDIR].data[i] = cols.number(43);
 
-				m_columns[RH].data[i] = col_or_nan(cols[37]);
-				m_columns[PRES].data[i] = col_or_nan(cols[40]);
+				m_columns[RH].data[i] = cols.number(37);
+				m_columns[PRES].data[i] = cols.number(40);
 				m_columns[SNOW].data[i] = -999.0; // no snowfall in TMY3
-				m_columns[ALB].data[i] = col_or_nan(cols[61]);
+				m_columns[ALB].data[i] = cols.number(61);
 				m_columns[AOD].data[i] = -999; /* no AOD in TMY3 */
 
 				m_columns[TWET].data[i]
@@ -1226,7 +1500,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			for (;;)
 			{
 				getline(ifs, buf);
-				auto cols = split(buf);
+				cols.split(buf);
 
 				if (cols.size() < 32)
 				{
@@ -1234,8 +1508,8 @@ bool weatherfile::open(const std::string &file, bool header_only)
 					return false;
 				}
 
-				int month = stoi(cols[1]);
-				int day = stoi(cols[2]);
+				int month = cols.integer(1);
+				int day = cols.integer(2);
 
 				if (month == 2 && day == 29)
 				{
@@ -1243,32 +1517,42 @@ bool weatherfile::open(const std::string &file, bool header_only)
 					continue;
 				}
 
-				m_columns[YEAR].data[i] = (float)stoi(cols[0]);
-				m_columns[MONTH].data[i] = (float)stoi(cols[1]);
-				m_columns[DAY].data[i] = (float)stoi(cols[2]);
-				m_columns[HOUR].data[i] = (float)stoi(cols[3]) - 1;  // hour goes 0-23, not 1-24;
-				m_columns[MINUTE].data[i] = (float)stoi(cols[4]);
+				m_columns[YEAR].data[i] = (float)cols.integer(0);
+				m_columns[MONTH].data[i] = (float)cols.integer(1);
+				m_columns[DAY].data[i] = (float)cols.integer(2);
+				m_columns[HOUR].data[i] = (float)cols.integer(3) - 1;  // hour goes 0-23, not 1-24;
+				m_columns[MINUTE].data[i] = (float)cols.integer(4);
 
-				m_columns[GHI].data[i] = check_missing(col_or_nan(cols[13]), 9999.);
-				m_columns[DNI].data[i] = check_missing(col_or_nan(cols[14]), 9999.);
-				m_columns[DHI].data[i] = check_missing(col_or_nan(cols[15]), 9999.);
+				m_columns[GHI].data[i] = check_missing(cols.number(13), 9999.);
+				m_columns[DNI].data[i] = check_missing(cols.number(14), 9999.);
+				m_columns[DHI].data[i] = check_missing(cols.number(15), 9999.);
 				m_columns[POA].data[i] = (float)(-999);       /* No POA in EPW */
 
-				m_columns[WSPD].data[i] = check_missing(col_or_nan(cols[21]), 999.);
-				m_columns[WDIR].data[i] = check_missing(col_or_nan(cols[20]), 999.);
+				m_columns[WSPD].data[i] = check_missing(cols.number(21), 999.);
+				m_columns[WDIR].data[i] = check_missing(cols.number(20), 999.);
 
-				m_columns[TDRY].data[i] = check_missing(col_or_nan(cols[6]), 99.9);
+				m_columns[TDRY].data[i] = check_missing(cols.number(6), 99.9);
 
-				m_columns[TDEW].data[i] = check_missing(col_or_nan(cols[7]), 99.9);
+				m_columns[TDEW].data[i] = check_missing(cols.number(7), 99.9);
 
-				m_columns[RH].data[i] = check_missing(col_or_nan(cols[8]), 999.);
-				m_columns[PRES].data[i] = check_missing(col_or_nan(cols[6]) * 0.01, 999999.*0.01);
-				m_columns[SNOW].data[i] = check_missing(col_or_nan(cols[30]), 999.); // snowfall
+				m_columns[RH].data[i] = check_missing(cols.number(8), 999.);
+				m_columns[PRES].data[i] = check_missing(cols.number(6) * 0.01, 999999.*0.01);
+				m_columns[SNOW].data[i] = check_missing(cols.number(30), 999.); // snowfall
 				m_columns[ALB].data[i] = -999; /* no albedo in EPW file */
 				m_columns[AOD].data[i] = -999; /* no AOD in EPW */
 
 				m_columns[TWET].data[i] = -999; /* calculated later during handling of missing data */
 
+				if (!cols.ok())
+				{
+					m_message = "EPW: data line formatting error at record " + util::to_string(i);
+					return false;
+				}
+
+				// note which columns need the missing value pass below
+				for (int j = GHI; j < _MAXCOL_; j++)
+					if (my_isnan(m_columns[j].data[i])) col_missing[j] = true;
+
 				break;
 			}
 
@@ -1281,7 +1565,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		else if (m_type == SMW)
 		{
 			getline(ifs, buf);
-			auto cols = split(buf);
+			cols.split(buf);
 
 			if (cols.size() < 12)
 			{
@@ -1299,22 +1583,22 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 			m_time += m_stepSec; // increment by step
 
-			m_columns[GHI].data[i] = col_or_nan(cols[7]);
-			m_columns[DNI].data[i] = col_or_nan(cols[8]);
-			m_columns[DHI].data[i] = col_or_nan(cols[9]);
+			m_columns[GHI].data[i] = cols.number(7);
+			m_columns[DNI].data[i] = cols.number(8);
+			m_columns[DHI].data[i] = cols.number(9);
 			m_columns[POA].data[i] = (double)(-999);       /* No POA in SMW */
 
-			m_columns[WSPD].data[i] = col_or_nan(cols[4]);
-			m_columns[WDIR].data[i] = col_or_nan(cols[5]);
+			m_columns[WSPD].data[i] = cols.number(4);
+			m_columns[WDIR].data[i] = cols.number(5);
 
-			m_columns[TDRY].data[i] = col_or_nan(cols[0]);
-			m_columns[TDEW].data[i] = col_or_nan(cols[1]);
-			m_columns[TWET].data[i] = col_or_nan(cols[2]);
+			m_columns[TDRY].data[i] = cols.number(0);
+			m_columns[TDEW].data[i] = cols.number(1);
+			m_columns[TWET].data[i] = cols.number(2);
 
-			m_columns[RH].data[i] = col_or_nan(cols[3]);
-			m_columns[PRES].data[i] = col_or_nan(cols[6]);
-			m_columns[SNOW].data[i] = col_or_nan(cols[11]);
-			m_columns[ALB].data[i] = col_or_nan(cols[10]);
+			m_columns[RH].data[i] = cols.number(3);
+			m_columns[PRES].data[i] = cols.number(6);
+			m_columns[SNOW].data[i] = cols.number(11);
+			m_columns[ALB].data[i] = cols.number(10);
 			m_columns[AOD].data[i] = -999; /* no AOD in SMW */
 
 			if (ifs.eof())
@@ -1329,30 +1613,20 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			for (;;)
 			{
 				getline(ifs, buf);
-				buf = trimboth(buf);
-				if (buf.length() == 0)
+				if (buf.find_first_not_of(" \t\r\n") == std::string::npos)
 				{
 					m_message = "CSV: data line formatting error at record " + util::to_string(i);
 					return false;
 				}
 
-				auto cols = split(buf);
-				int ncols = (int)cols.size();
-				for (size_t k = 0; k < _MAXCOL_; k++)
+				size_t ncols = cols.split(buf);
+				for (size_t k = 0; k < csv_fields.size(); k++)
 				{
-					if (m_columns[k].index >= 0
-						&& m_columns[k].index < ncols)
+					int col = csv_fields[k].second;
+					if ((size_t)csv_fields[k].first < ncols)
 					{
-						if (k == YEAR) {
-							try {
-								m_columns[k].data[i] = col_or_nan(trimboth(cols[m_columns[k].index]));
-							}
-							catch (const std::exception& ) {
-								m_columns[k].data[i] = 1990;
-							}
-						}
-						else
-							m_columns[k].data[i] = col_or_nan(trimboth(cols[m_columns[k].index]));
+						m_columns[col].data[i] = cols.number(csv_fields[k].first,
+							col == YEAR ? 1990.0f : std::numeric_limits<float>::quiet_NaN());
 					}
 				}
 
@@ -1451,7 +1725,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		for (size_t i = 0; i < m_nRecords; i++) {
 			for (int j = 5; j < 19; j++) {
 				if (j == 8 || j == 17 || j == 18 || j == 10) continue;	// EPW format does not contain 
-				if (my_isnan(m_columns[j].data[i])) handle_missing_field(i, j);
+				if (col_missing[j] && my_isnan(m_columns[j].data[i])) handle_missing_field(i, j);
 			}
 			if (m_columns[TWET].data[i] == -999.) m_columns[TWET].data[i] = (float)calc_twet((double)m_columns[TDRY].data[i], (double)m_columns[RH].data[i], (double)m_columns[PRES].data[i]);
 		}
@@ -1482,29 +1756,116 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	return true;
 }
 
+bool weatherfile::open_binary(const std::string &file, bool /*header_only*/)
+{
+	// mapping the file is cheap enough that a header-only open does not need a separate path
+	std::shared_ptr<weatherfile_mapping> map(new weatherfile_mapping(file));
+	if (!map->ok())
+	{
+		m_message = "could not open file for reading: " + file;
+		return false;
+	}
+
+	const unsigned char *base = map->data();
+	size_t size = map->size();
+
+	wfb_header hdr;
+	if (size < sizeof(wfb_header))
+	{
+		m_message = "binary weather file is truncated: " + file;
+		return false;
+	}
+	memcpy(&hdr, base, sizeof(wfb_header));
+
+	if (memcmp(hdr.magic, WFB_MAGIC, sizeof(WFB_MAGIC)) != 0)
+	{
+		m_message = "not a binary weather file: " + file;
+		return false;
+	}
+	if (hdr.version != WFB_VERSION || hdr.byte_order != WFB_BYTE_ORDER || hdr.ncols != _MAXCOL_)
+	{
+		m_message = util::format("binary weather file version %d is not supported, regenerate it from the source weather file", (int)hdr.version);
+		return false;
+	}
+	if (hdr.stride < hdr.nrecords
+		|| hdr.data_offset % WFB_ALIGN != 0
+		|| hdr.data_offset > size
+		|| (size - hdr.data_offset) / (sizeof(float) * _MAXCOL_) < hdr.stride)
+	{
+		m_message = "binary weather file is truncated: " + file;
+		return false;
+	}
+
+	std::string *fields[7] = { &m_hdr.location, &m_hdr.city, &m_hdr.state, &m_hdr.country,
+		&m_hdr.source, &m_hdr.description, &m_hdr.url };
+	size_t pos = sizeof(wfb_header);
+	for (size_t i = 0; i < 7; i++)
+	{
+		uint32_t len = 0;
+		if (pos + sizeof(len) > hdr.data_offset)
+		{
+			m_message = "binary weather file header is corrupt: " + file;
+			return false;
+		}
+		memcpy(&len, base + pos, sizeof(len));
+		pos += sizeof(len);
+		if (len > hdr.data_offset - pos)
+		{
+			m_message = "binary weather file header is corrupt: " + file;
+			return false;
+		}
+		fields[i]->assign((const char*)base + pos, len);
+		pos += len;
+	}
+
+	m_type = (int)hdr.type;
+	m_startYear = hdr.start_year;
+	m_time = hdr.time;
+	m_nRecords = (size_t)hdr.nrecords;
+	m_startSec = (size_t)hdr.start_sec;
+	m_stepSec = (size_t)hdr.step_sec;
+	m_hasLeapYear = hdr.has_leap_year != 0;
+	m_hdr.hasunits = hdr.hasunits != 0;
+	m_hdr.tz = hdr.tz;
+	m_hdr.lat = hdr.lat;
+	m_hdr.lon = hdr.lon;
+	m_hdr.elev = hdr.elev;
+
+	for (size_t i = 0; i < _MAXCOL_; i++)
+	{
+		m_columns[i].index = hdr.index[i];
+		m_columns[i].data.clear();
+	}
+
+	m_mapping = map;
+	m_mappedData = (const float*)(base + hdr.data_offset);
+	m_mappedStride = (size_t)hdr.stride;
+	return true;
+}
+
 bool weatherfile::read_average(weather_record *r, std::vector<int> &cols, size_t &num_timesteps)
 {
 	if (r && m_index < m_nRecords && num_timesteps > 0 && num_timesteps < m_nRecords)
 	{
-		r->year = (int)m_columns[YEAR].data[m_index];
-		r->month = (int)m_columns[MONTH].data[m_index];
-		r->day = (int)m_columns[DAY].data[m_index];
-		r->hour = (int)m_columns[HOUR].data[m_index];
-		r->minute = m_columns[MINUTE].data[m_index];
-		r->gh = m_columns[GHI].data[m_index];
-		r->dn = m_columns[DNI].data[m_index];
-		r->df = m_columns[DHI].data[m_index];
-		r->poa = m_columns[POA].data[m_index];
-		r->wspd = m_columns[WSPD].data[m_index];
-		r->wdir = m_columns[WDIR].data[m_index];
-		r->tdry = m_columns[TDRY].data[m_index];
-		r->twet = m_columns[TWET].data[m_index];
-		r->tdew = m_columns[TDEW].data[m_index];
-		r->rhum = m_columns[RH].data[m_index];
-		r->pres = m_columns[PRES].data[m_index];
-		r->snow = m_columns[SNOW].data[m_index];
-		r->alb = m_columns[ALB].data[m_index];
-		r->aod = m_columns[AOD].data[m_index];
+		r->year = (int)column_data(YEAR)[m_index];
+		r->month = (int)column_data(MONTH)[m_index];
+		r->day = (int)column_data(DAY)[m_index];
+		r->hour = (int)column_data(HOUR)[m_index];
+		r->minute = column_data(MINUTE)[m_index];
+		r->gh = column_data(GHI)[m_index];
+		r->dn = column_data(DNI)[m_index];
+		r->df = column_data(DHI)[m_index];
+		r->poa = column_data(POA)[m_index];
+		r->wspd = column_data(WSPD)[m_index];
+		r->wdir = column_data(WDIR)[m_index];
+		r->tdry = column_data(TDRY)[m_index];
+		r->twet = column_data(TWET)[m_index];
+		r->tdew = column_data(TDEW)[m_index];
+		r->rhum = column_data(RH)[m_index];
+		r->pres = column_data(PRES)[m_index];
+		r->snow = column_data(SNOW)[m_index];
+		r->alb = column_data(ALB)[m_index];
+		r->aod = column_data(AOD)[m_index];
 
 		// average columns requested
 		int start = (int)m_index - (int)num_timesteps / 2;
@@ -1524,7 +1885,7 @@ bool weatherfile::read_average(weather_record *r, std::vector<int> &cols, size_t
 			{
 				for (size_t j = (size_t)start; j < num_timesteps && j < m_nRecords; j++)
 				{
-					col_val += m_columns[cols[i]].data[start];
+					col_val += column_data(cols[i])[start];
 					n_vals++;
 				}
 				if (n_vals > 0)
@@ -1610,25 +1971,25 @@ bool weatherfile::read( weather_record *r )
 {
 	if ( r && m_index < m_nRecords)
 	{
-		r->year = (int)m_columns[YEAR].data[m_index];
-		r->month = (int)m_columns[MONTH].data[m_index];
-		r->day = (int)m_columns[DAY].data[m_index];
-		r->hour = (int)m_columns[HOUR].data[m_index];
-		r->minute = m_columns[MINUTE].data[m_index];
-		r->gh = m_columns[GHI].data[m_index];
-		r->dn = m_columns[DNI].data[m_index];
-		r->df = m_columns[DHI].data[m_index];
-		r->poa = m_columns[POA].data[m_index];
-		r->wspd = m_columns[WSPD].data[m_index];
-		r->wdir = m_columns[WDIR].data[m_index];
-		r->tdry = m_columns[TDRY].data[m_index];
-		r->twet = m_columns[TWET].data[m_index];
-		r->tdew = m_columns[TDEW].data[m_index];
-		r->rhum = m_columns[RH].data[m_index];
-		r->pres = m_columns[PRES].data[m_index];
-		r->snow = m_columns[SNOW].data[m_index];
-		r->alb = m_columns[ALB].data[m_index];
-		r->aod = m_columns[AOD].data[m_index];
+		r->year = (int)column_data(YEAR)[m_index];
+		r->month = (int)column_data(MONTH)[m_index];
+		r->day = (int)column_data(DAY)[m_index];
+		r->hour = (int)column_data(HOUR)[m_index];
+		r->minute = column_data(MINUTE)[m_index];
+		r->gh = column_data(GHI)[m_index];
+		r->dn = column_data(DNI)[m_index];
+		r->df = column_data(DHI)[m_index];
+		r->poa = column_data(POA)[m_index];
+		r->wspd = column_data(WSPD)[m_index];
+		r->wdir = column_data(WDIR)[m_index];
+		r->tdry = column_data(TDRY)[m_index];
+		r->twet = column_data(TWET)[m_index];
+		r->tdew = column_data(TDEW)[m_index];
+		r->rhum = column_data(RH)[m_index];
+		r->pres = column_data(PRES)[m_index];
+		r->snow = column_data(SNOW)[m_index];
+		r->alb = column_data(ALB)[m_index];
+		r->aod = column_data(AOD)[m_index];
 
 		m_index++;
 		return true;
@@ -1718,3 +2079,66 @@ bool weatherfile::convert_to_wfcsv( const std::string &input, const std::string
 
 }
 
+bool weatherfile::convert_to_binary( const std::string &input, const std::string &output )
+{
+	weatherfile wf( input );
+	if ( !wf.ok() ) return false;
+
+	size_t nrec = wf.nrecords();
+	size_t per_block = WFB_ALIGN / sizeof(float);
+	size_t stride = ((nrec + per_block - 1) / per_block) * per_block;
+
+	const std::string *fields[7] = { &wf.m_hdr.location, &wf.m_hdr.city, &wf.m_hdr.state, &wf.m_hdr.country,
+		&wf.m_hdr.source, &wf.m_hdr.description, &wf.m_hdr.url };
+	size_t strings_size = 0;
+	for (size_t i = 0; i < 7; i++)
+		strings_size += sizeof(uint32_t) + fields[i]->size();
+
+	wfb_header hdr;
+	memset(&hdr, 0, sizeof(wfb_header));
+	memcpy(hdr.magic, WFB_MAGIC, sizeof(WFB_MAGIC));
+	hdr.version = WFB_VERSION;
+	hdr.byte_order = WFB_BYTE_ORDER;
+	hdr.type = (uint32_t)wf.m_type;
+	hdr.start_year = wf.m_startYear;
+	hdr.nrecords = nrec;
+	hdr.start_sec = wf.m_startSec;
+	hdr.step_sec = wf.m_stepSec;
+	hdr.stride = stride;
+	hdr.data_offset = ((sizeof(wfb_header) + strings_size + WFB_ALIGN - 1) / WFB_ALIGN) * WFB_ALIGN;
+	hdr.has_leap_year = wf.m_hasLeapYear ? 1 : 0;
+	hdr.hasunits = wf.m_hdr.hasunits ? 1 : 0;
+	hdr.ncols = _MAXCOL_;
+	for (size_t i = 0; i < _MAXCOL_; i++)
+		hdr.index[i] = wf.m_columns[i].index;
+	hdr.time = wf.m_time;
+	hdr.tz = wf.m_hdr.tz;
+	hdr.lat = wf.m_hdr.lat;
+	hdr.lon = wf.m_hdr.lon;
+	hdr.elev = wf.m_hdr.elev;
+
+	util::stdfile fp( output, "wb" );
+	if ( !fp.ok() ) return false;
+
+	if (fwrite(&hdr, sizeof(wfb_header), 1, fp) != 1) return false;
+	for (size_t i = 0; i < 7; i++)
+	{
+		uint32_t len = (uint32_t)fields[i]->size();
+		if (fwrite(&len, sizeof(len), 1, fp) != 1) return false;
+		if (len > 0 && fwrite(fields[i]->c_str(), 1, len, fp) != len) return false;
+	}
+
+	std::vector<float> buf(std::max(stride, WFB_ALIGN), 0.0f);
+	size_t pad = (size_t)hdr.data_offset - sizeof(wfb_header) - strings_size;
+	if (pad > 0 && fwrite(&buf[0], 1, pad, fp) != pad) return false;
+
+	for (int i = 0; i < _MAXCOL_; i++)
+	{
+		const float *col = wf.column_data(i);
+		std::fill(buf.begin(), buf.end(), std::numeric_limits<float>::quiet_NaN());
+		if (col) std::copy(col, col + nrec, buf.begin());
+		if (fwrite(&buf[0], sizeof(float), stride, fp) != stride) return false;
+	}
+
+	return true;
+}
@@ -25,6 +25,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <string>
 #include <vector>  // needed to compile in typelib_vc2012
+#include <memory>
 #include <cmath>
 
 /***************************************************************************\
@@ -199,6 +200,8 @@ public:
 	}
 };
 
+class weatherfile_mapping;
+
 class weatherfile : public weather_data_provider
 {
 private:
@@ -212,6 +215,17 @@ private:
 	};
 	column m_columns[_MAXCOL_];
 
+	// read-only view of the columns when opened from a binary weather cache (.wfb)
+	std::shared_ptr<weatherfile_mapping> m_mapping;
+	const float *m_mappedData;
+	size_t m_mappedStride;
+
+	const float *column_data(int col) const {
+		return m_mappedData ? m_mappedData + col * m_mappedStride : m_columns[col].data.data();
+	}
+
+	bool open_binary(const std::string &file, bool header_only);
+
 public:
 	weatherfile();
 	/* Detects file format, read header information, detects which data columns are available and at what index
@@ -239,6 +253,12 @@ public:
 	
 	static std::string normalize_city( const std::string &in );
 	static bool convert_to_wfcsv( const std::string &input, const std::string &output );
+
+	/* Writes the fully processed columns of any readable weather file to the versioned binary
+	columnar format (.wfb).  Opening the result maps it read-only instead of parsing text, so the
+	pages are shared between processes reading the same file.  The layout is native byte order;
+	caches are meant to be regenerated on the machine architecture that reads them. */
+	static bool convert_to_binary( const std::string &input, const std::string &output );
 	
 };
 
@@ -140,7 +140,7 @@ var_info vtab_battery_inputs[] = {
 	{ SSC_INPUT,        SSC_ARRAY,      "batt_target_power_monthly",                   "Grid target power on monthly basis",                     "kW",       "",                     "Battery",       "en_batt=1&batt_meter_position=0&batt_dispatch_choice=2",                        "",                             "" },
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_target_choice",                          "Target power input option",                              "0/1",      "0=InputMonthlyTarget,1=InputFullTimeSeries", "Battery", "en_batt=1&batt_meter_position=0&batt_dispatch_choice=2",                        "",                             "" },
 	{ SSC_INPUT,        SSC_ARRAY,      "batt_custom_dispatch",                        "Custom battery power for every time step",               "kW",       "",                     "Battery",       "en_batt=1&batt_dispatch_choice=3","",                         "" },
-	{ SSC_INPUT,        SSC_NUMBER,     "batt_dispatch_choice",                        "Battery dispatch algorithm",                             "0/1/2/3/4", "If behind the meter: 0=PeakShavingLookAhead,1=PeakShavingLookBehind,2=InputGridTarget,3=InputBatteryPower,4=ManualDispatch, if front of meter: 0=AutomatedLookAhead,1=AutomatedLookBehind,2=AutomatedInputForecast,3=InputBatteryPower,4=ManualDispatch",                    "Battery",       "en_batt=1",                        "",                             "" },
+	{ SSC_INPUT,        SSC_NUMBER,     "batt_dispatch_choice",                        "Battery dispatch algorithm",                             "0/1/2/3/4/5", "If behind the meter: 0=PeakShavingLookAhead,1=PeakShavingLookBehind,2=InputGridTarget,3=InputBatteryPower,4=ManualDispatch,5=OptimizedLookAhead, if front of meter: 0=AutomatedLookAhead,1=AutomatedLookBehind,2=AutomatedInputForecast,3=InputBatteryPower,4=ManualDispatch,5=OptimizedLookAhead",                    "Battery",       "en_batt=1",                        "",                             "" },
 	{ SSC_INPUT,        SSC_ARRAY,      "batt_pv_clipping_forecast",                   "PV clipping forecast",                                   "kW",       "",                     "Battery",       "en_batt=1&batt_meter_position=1&batt_dispatch_choice=2",  "",          "" },
 	{ SSC_INPUT,        SSC_ARRAY,      "batt_pv_dc_forecast",                         "PV dc power forecast",                                   "kW",       "",                     "Battery",       "en_batt=1&batt_meter_position=1&batt_dispatch_choice=2",  "",          "" },
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_dispatch_auto_can_fuelcellcharge",       "Charging from fuel cell allowed for automated dispatch?",          "kW",       "",                     "Battery",       "",                           "",                             "" },
@@ -150,6 +150,7 @@ var_info vtab_battery_inputs[] = {
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_auto_gridcharge_max_daily",              "Allowed grid charging percent per day for automated dispatch","kW",  "",                     "Battery",       "",                           "",                             "" },
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_look_ahead_hours",                       "Hours to look ahead in automated dispatch",              "hours",    "",                     "Battery",       "",                           "",                             "" },
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_dispatch_update_frequency_hours",        "Frequency to update the look-ahead dispatch",            "hours",    "",                     "Battery",       "",                           "",                             "" },
+	{ SSC_INPUT,        SSC_NUMBER,     "batt_dispatch_opt_timeout",                   "Time limit for each optimized look-ahead dispatch solve", "s",       "Rounded up to whole seconds", "Battery", "?=5",                        "POSITIVE",                     "" },
 
 	//  cycle cost inputs
 	{ SSC_INPUT,        SSC_NUMBER,     "batt_cycle_cost_choice",                      "Use SAM model for cycle costs or input custom",           "0/1",     "0=UseCostModel,1=InputCost", "Battery", "",                           "",                             "" },
@@ -357,6 +358,7 @@ battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_
 			// Storage dispatch controllers
 			batt_vars->batt_dispatch = cm.as_integer("batt_dispatch_choice");
 			batt_vars->batt_meter_position = cm.as_integer("batt_meter_position");
+			batt_vars->batt_dispatch_opt_timeout = cm.as_double("batt_dispatch_opt_timeout");
 
 			// Front of meter
 			if (batt_vars->batt_meter_position == dispatch_t::FRONT)
@@ -402,7 +404,8 @@ battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_
 
 				if (batt_vars->batt_dispatch == dispatch_t::FOM_LOOK_AHEAD ||
 					batt_vars->batt_dispatch == dispatch_t::FOM_FORECAST ||
-					batt_vars->batt_dispatch == dispatch_t::FOM_LOOK_BEHIND)
+					batt_vars->batt_dispatch == dispatch_t::FOM_LOOK_BEHIND ||
+					batt_vars->batt_dispatch == dispatch_t::FOM_OPTIMIZED_LOOK_AHEAD)
 				{
 					batt_vars->batt_look_ahead_hours = cm.as_unsigned_long("batt_look_ahead_hours");
 					batt_vars->batt_dispatch_update_frequency_hours = cm.as_double("batt_dispatch_update_frequency_hours");
@@ -888,6 +891,11 @@ battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_
 				dispatch_fom->set_custom_dispatch(batt_vars->batt_custom_dispatch);
 			}
 		}
+		else if (batt_vars->batt_dispatch == dispatch_t::FOM_OPTIMIZED_LOOK_AHEAD)
+		{
+			if (dispatch_automatic_front_of_meter_t * dispatch_fom = dynamic_cast<dispatch_automatic_front_of_meter_t*>(dispatch_model))
+				dispatch_fom->set_optimizer_timeout(batt_vars->batt_dispatch_opt_timeout);
+		}
 		
 	}
 	/*! Behind-the-meter automated dispatch for peak shaving */
@@ -910,6 +918,11 @@ battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_
 				dispatch_btm->set_custom_dispatch(batt_vars->batt_custom_dispatch);
 			}
 		}
+		else if (batt_vars->batt_dispatch == dispatch_t::OPTIMIZED_LOOK_AHEAD)
+		{
+			if (dispatch_automatic_behind_the_meter_t * dispatch_btm = dynamic_cast<dispatch_automatic_behind_the_meter_t*>(dispatch_model))
+				dispatch_btm->set_optimizer_timeout(batt_vars->batt_dispatch_opt_timeout);
+		}
 	}
 
 	if (batt_vars->batt_topology == ChargeController::AC_CONNECTED) {
@@ -933,7 +946,8 @@ void battstor::parse_configuration()
 		prediction_index = 0;
 		if (batt_meter_position == dispatch_t::BEHIND)
 		{
-			if (batt_dispatch == dispatch_t::LOOK_AHEAD || batt_dispatch == dispatch_t::MAINTAIN_TARGET)
+			if (batt_dispatch == dispatch_t::LOOK_AHEAD || batt_dispatch == dispatch_t::MAINTAIN_TARGET ||
+				batt_dispatch == dispatch_t::OPTIMIZED_LOOK_AHEAD)
 			{
 				look_ahead = true;
 				if (batt_dispatch == dispatch_t::MAINTAIN_TARGET)
@@ -948,7 +962,7 @@ void battstor::parse_configuration()
 		}
 		else if (batt_meter_position == dispatch_t::FRONT)
 		{
-			if (batt_dispatch == dispatch_t::FOM_LOOK_AHEAD) {
+			if (batt_dispatch == dispatch_t::FOM_LOOK_AHEAD || batt_dispatch == dispatch_t::FOM_OPTIMIZED_LOOK_AHEAD) {
 				look_ahead = true;
 			}
 			else if (batt_dispatch == dispatch_t::FOM_LOOK_BEHIND) {
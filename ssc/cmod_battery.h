@@ -140,6 +140,9 @@ struct batt_variables
 	/*! The frequency to update the look-ahead automated dispatch */
 	double batt_dispatch_update_frequency_hours;
 
+	/*! The time limit for each solve of the optimized look-ahead dispatch [s] */
+	double batt_dispatch_opt_timeout;
+
 	util::matrix_t<double>  batt_lifetime_matrix;
 	util::matrix_t<double> batt_calendar_lifetime_matrix;
 	util::matrix_t<double> batt_voltage_matrix;
@@ -287,7 +287,7 @@ enum {
 class cm_cashloan : public compute_module
 {
 private:
-	util::matrix_t<double> cf;
+	cashflow_table cf;
 	double ibi_fed_amount;
 	double ibi_sta_amount;
 	double ibi_uti_amount;
@@ -1210,15 +1210,15 @@ public:
 		double pvPropertyTax = npv(CF_property_tax_expense, nyears, nom_discount_rate);
 
 		assign( "present_value_insandproptax", var_data((ssc_number_t)(pvInsurance + pvPropertyTax)));
+
+		cf.export_outputs(this);
 	}
 
 /* These functions can be placed in common financial library with matrix and constants passed? */
 
 	void save_cf(int cf_line, int nyears, const std::string &name)
 	{
-		ssc_number_t *arrp = allocate( name, nyears+1 );
-		for (int i=0;i<=nyears;i++)
-			arrp[i] = (ssc_number_t)cf.at(cf_line, i);
+		cf.save(cf_line, nyears, name);
 	}
 
 	double compute_payback( int cf_cpb, int cf_pb, int nyears )
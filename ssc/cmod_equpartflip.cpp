@@ -1028,7 +1028,7 @@ enum {
 class cm_equpartflip : public compute_module
 {
 private:
-	util::matrix_t<double> cf;
+	cashflow_table cf;
 	dispatch_calculations m_disp_calcs;
 	hourly_energy_calculation hourly_energy_calcs;
 
@@ -1840,6 +1840,8 @@ public:
 		bool ppa_interval_reset=true;
 		// 12/14/12 - address issue from Eric Lantz - ppa solution when target mode and ppa < 0
 		double ppa_old=ppa;
+		// price from the linear part of the cash flow, tried once during the interval search
+		ppa_linear_solution ppa_linear;
 
 /***************** begin iterative solution *********************************************************************/
 
@@ -1847,7 +1849,7 @@ public:
 	{
 
 		flip_year=-1;
-		if (ppa_interval_found)	ppa = (w0*x1+w1*x0)/(w0 + w1);
+		if (ppa_interval_found && !ppa_linear.is_trial())	ppa = (w0*x1+w1*x0)/(w0 + w1);
 		// debt pre calculation
 		for (i=1; i<=nyears; i++)
 		{			
@@ -2197,7 +2199,7 @@ public:
 			cf.at(CF_project_return_pretax,i) = cf.at(CF_pretax_cashflow,i);
 			if (i==0) cf.at(CF_project_return_pretax,i) -= (issuance_of_equity); 
 
-			cf.at(CF_project_return_pretax_irr,i) = irr(CF_project_return_pretax,i)*100.0;
+			cf.at(CF_project_return_pretax_irr,i) = irr(CF_project_return_pretax,i,(i>0) ? cf.at(CF_project_return_pretax_irr,i-1)/100.0 : -2)*100.0;
 			cf.at(CF_project_return_pretax_npv,i) = npv(CF_project_return_pretax,i,nom_discount_rate) +  cf.at(CF_project_return_pretax,0) ;
 
 			cf.at(CF_project_return_aftertax_cash,i) = cf.at(CF_project_return_pretax,i);
@@ -2283,7 +2285,7 @@ public:
 				cf.at(CF_statax,i) + cf.at(CF_fedtax,i);
 			if (i==1) cf.at(CF_project_return_aftertax,i) += itc_total;
 
-			cf.at(CF_project_return_aftertax_irr,i) = irr(CF_project_return_aftertax,i)*100.0;
+			cf.at(CF_project_return_aftertax_irr,i) = irr(CF_project_return_aftertax,i,cf.at(CF_project_return_aftertax_irr,i-1)/100.0)*100.0;
 			cf.at(CF_project_return_aftertax_npv,i) = npv(CF_project_return_aftertax,i,nom_discount_rate) +  cf.at(CF_project_return_aftertax,0) ;
 
 		}
@@ -2346,12 +2348,12 @@ public:
 				cf.at(CF_tax_investor_aftertax_itc,i) +
 				cf.at(CF_tax_investor_aftertax_ptc,i) +
 				cf.at(CF_tax_investor_aftertax_tax,i);
-			cf.at(CF_tax_investor_aftertax_irr,i) = irr(CF_tax_investor_aftertax,i)*100.0;
+			cf.at(CF_tax_investor_aftertax_irr,i) = irr(CF_tax_investor_aftertax,i,cf.at(CF_tax_investor_aftertax_irr,i-1)/100.0)*100.0;
 			cf.at(CF_tax_investor_aftertax_max_irr,i) = max(cf.at(CF_tax_investor_aftertax_max_irr,i-1),cf.at(CF_tax_investor_aftertax_irr,i));
 			cf.at(CF_tax_investor_aftertax_npv,i) = npv(CF_tax_investor_aftertax,i,nom_discount_rate) +  cf.at(CF_tax_investor_aftertax,0) ;
 
 			cf.at(CF_tax_investor_pretax,i) = cf.at(CF_tax_investor_aftertax_cash,i);
-			cf.at(CF_tax_investor_pretax_irr,i) = irr(CF_tax_investor_pretax,i)*100.0;
+			cf.at(CF_tax_investor_pretax_irr,i) = irr(CF_tax_investor_pretax,i,cf.at(CF_tax_investor_pretax_irr,i-1)/100.0)*100.0;
 			cf.at(CF_tax_investor_pretax_npv,i) = npv(CF_tax_investor_pretax,i,nom_discount_rate) +  cf.at(CF_tax_investor_pretax,0) ;
 
 			if (flip_year <=0) 
@@ -2381,9 +2383,9 @@ public:
 				cf.at(CF_sponsor_aftertax_tax,i);
 			// year 1 development fee tax
 			if (i == 1) cf.at(CF_sponsor_aftertax, i) -= sponsor_pretax_development_fee * cf.at(CF_effective_tax_frac, i);
-			cf.at(CF_sponsor_pretax_irr,i) = irr(CF_sponsor_pretax,i)*100.0;
+			cf.at(CF_sponsor_pretax_irr,i) = irr(CF_sponsor_pretax,i,cf.at(CF_sponsor_pretax_irr,i-1)/100.0)*100.0;
 			cf.at(CF_sponsor_pretax_npv,i) = npv(CF_sponsor_pretax,i,nom_discount_rate) +  cf.at(CF_sponsor_pretax,0) ;
-			cf.at(CF_sponsor_aftertax_irr,i) = irr(CF_sponsor_aftertax,i)*100.0;
+			cf.at(CF_sponsor_aftertax_irr,i) = irr(CF_sponsor_aftertax,i,cf.at(CF_sponsor_aftertax_irr,i-1)/100.0)*100.0;
 			cf.at(CF_sponsor_aftertax_npv,i) = npv(CF_sponsor_aftertax,i,nom_discount_rate) +  cf.at(CF_sponsor_aftertax,0) ;
 
 		}
@@ -2402,7 +2404,12 @@ public:
 			solved = (( fabs( residual )/resid_denom < ppa_soln_tolerance ) || ( fabs(x0-x1)/ppa_denom < ppa_soln_tolerance) );
 //			solved = (( fabs( residual ) < ppa_soln_tolerance ) || ( fabs(x0-x1) < ppa_soln_tolerance) );
 //			solved = (( fabs( residual ) < ppa_soln_tolerance ) );
-			if (!solved)
+			if (ppa_linear.is_trial())
+			{
+				// a miss means the cash flow is not linear in the price, the interval search goes on from where it was
+				if (!solved) ppa = ppa_linear.resume();
+			}
+			else if (!solved)
 			{
 				double flip_frac = flip_target_percent/100.0;
 				double itnpv_target = npv(CF_tax_investor_aftertax,flip_target_year,flip_frac) +  cf.at(CF_tax_investor_aftertax,0) ;
@@ -2470,6 +2477,7 @@ public:
 					// for initial guess of zero
 					if (fabs(x0-x1)<ppa_soln_tolerance) x0 = x1-2*ppa_soln_tolerance;
 				}
+				ppa_linear.next(ppa_old, itnpv_target, ppa);
 					//std::stringstream outm;
 					//outm << "iteration=" << its  << ", irr=" << cf.at(CF_tax_investor_aftertax_irr, flip_target_year)  << ", npvtarget=" << itnpv_target  << ", npvtarget_delta=" << itnpv_target_delta  
 					//	  << ", npvactual=" << itnpv_actual  << ", npvactual_delta=" << itnpv_target_delta  
@@ -3275,6 +3283,8 @@ public:
 		double pvPropertyTax = npv(CF_property_tax_expense, nyears, nom_discount_rate);
 
 		assign( "present_value_insandproptax", var_data((ssc_number_t)(pvInsurance + pvPropertyTax)));
+
+		cf.export_outputs(this);
 	}
 
 
@@ -3515,9 +3525,7 @@ public:
 	// std lib
 	void save_cf(int cf_line, int nyears, const std::string &name)
 	{
-		ssc_number_t *arrp = allocate( name, nyears+1 );
-		for (int i=0;i<=nyears;i++)
-			arrp[i] = (ssc_number_t)cf.at(cf_line, i);
+		cf.save(cf_line, nyears, name);
 	}
 
 	void escal_or_annual( int cf_line, int nyears, const std::string &variable, 
@@ -3623,162 +3631,9 @@ public:
 		return result*rr;
 	}
 
-/* ported from http://code.google.com/p/irr-newtonraphson-calculator/ */
-	bool is_valid_iter_bound(double estimated_return_rate)
-	{
-		return estimated_return_rate != -1 && (estimated_return_rate < std::numeric_limits<int>::max()) && (estimated_return_rate > std::numeric_limits<int>::min());
-	}
-
-	double irr_poly_sum(double estimated_return_rate, int cf_line, int count)
-	{
-		double sum_of_polynomial = 0;
-		if (is_valid_iter_bound(estimated_return_rate))
-		{
-			for (int j = 0; j <= count ; j++)
-			{
-				double val = (pow((1 + estimated_return_rate), j));
-				if (val != 0.0)
-					sum_of_polynomial += cf.at(cf_line,j)/val;
-				else
-					break;
-			}
-		}
-		return sum_of_polynomial;
-	}
-
-	double irr_derivative_sum(double estimated_return_rate,int cf_line, int count)
-	{
-		double sum_of_derivative = 0;
-		if (is_valid_iter_bound(estimated_return_rate))
-			for (int i = 1; i <= count ; i++)
-			{
-				sum_of_derivative += cf.at(cf_line,i)*(i)/pow((1 + estimated_return_rate), i+1);
-			}
-		return sum_of_derivative*-1;
-	}
-
-	double irr_scale_factor( int cf_unscaled, int count)
-	{
-		// scale to max value for better irr convergence
-		if (count<1) return 1.0;
-		int i=0;
-		double max=fabs(cf.at(cf_unscaled,0));
-		for (i=0;i<=count;i++) 
-			if (fabs(cf.at(cf_unscaled,i))> max) max =fabs(cf.at(cf_unscaled,i));
-		return (max>0 ? max:1);
-	}
-
-	bool is_valid_irr( int cf_line, int count, double residual, double tolerance, int number_of_iterations, int max_iterations, double calculated_irr, double scale_factor )
-	{
-		double npv_of_irr = npv(cf_line,count,calculated_irr)+cf.at(cf_line,0);
-		double npv_of_irr_plus_delta = npv(cf_line,count,calculated_irr+0.001)+cf.at(cf_line,0);
-		bool is_valid = ( (number_of_iterations<max_iterations) && (fabs(residual)<tolerance) && (npv_of_irr>npv_of_irr_plus_delta) && (fabs(npv_of_irr/scale_factor)<tolerance) );
-				//if (!is_valid)
-				//{
-				//std::stringstream outm;
-				//outm <<  "cf_line=" << cf_line << "count=" << count << "residual=" << residual << "number_of_iterations=" << number_of_iterations << "calculated_irr=" << calculated_irr
-				//	<< "npv of irr=" << npv_of_irr << "npv of irr plus delta=" << npv_of_irr_plus_delta;
-				//log( outm.str() );
-				//}
-		return is_valid;
-	}
-
 	double irr( int cf_line, int count, double initial_guess=-2, double tolerance=1e-6, int max_iterations=100 )
 	{
-		int number_of_iterations=0;
-		//double calculated_irr=0;
-		double calculated_irr = std::numeric_limits<double>::quiet_NaN();
-
-
-		if (count < 1)
-			return calculated_irr;
-
-		// only possible for first value negative
-		if ( (cf.at(cf_line,0) <= 0))
-		{
-			// initial guess from http://zainco.blogspot.com/2008/08/internal-rate-of-return-using-newton.html
-			if ((initial_guess < -1) && (count > 1))// second order
-			{
-				if (cf.at(cf_line,0) !=0) 
-				{
-					double b = 2.0+ cf.at(cf_line,1)/cf.at(cf_line,0);
-					double c = 1.0+cf.at(cf_line,1)/cf.at(cf_line,0)+cf.at(cf_line,2)/cf.at(cf_line,0);
-					initial_guess = -0.5*b - 0.5*sqrt(b*b-4.0*c);
-					if ((initial_guess <= 0) || (initial_guess >= 1)) initial_guess = -0.5*b + 0.5*sqrt(b*b-4.0*c);
-				}
-			}
-			else if (initial_guess < 0) // first order
-			{
-				if (cf.at(cf_line,0) !=0) initial_guess = -(1.0 + cf.at(cf_line,1)/cf.at(cf_line,0));
-			}
-
-			double scale_factor = irr_scale_factor(cf_line,count);
-			double residual=DBL_MAX;
-
-			calculated_irr = irr_calc(cf_line,count,initial_guess,tolerance,max_iterations,scale_factor,number_of_iterations,residual);
-
-			if (!is_valid_irr(cf_line,count,residual,tolerance,number_of_iterations,max_iterations,calculated_irr,scale_factor)) // try 0.1 as initial guess
-			{
-				initial_guess=0.1;
-				number_of_iterations=0;
-				residual=0;
-				calculated_irr = irr_calc(cf_line,count,initial_guess,tolerance,max_iterations,scale_factor,number_of_iterations,residual);
-			}
-
-			if (!is_valid_irr(cf_line,count,residual,tolerance,number_of_iterations,max_iterations,calculated_irr,scale_factor)) // try -0.1 as initial guess
-			{
-				initial_guess=-0.1;
-				number_of_iterations=0;
-				residual=0;
-				calculated_irr = irr_calc(cf_line,count,initial_guess,tolerance,max_iterations,scale_factor,number_of_iterations,residual);
-			}
-			if (!is_valid_irr(cf_line,count,residual,tolerance,number_of_iterations,max_iterations,calculated_irr,scale_factor)) // try 0 as initial guess
-			{
-				initial_guess=0;
-				number_of_iterations=0;
-				residual=0;
-				calculated_irr = irr_calc(cf_line,count,initial_guess,tolerance,max_iterations,scale_factor,number_of_iterations,residual);
-			}
-
-			if (!is_valid_irr(cf_line,count,residual,tolerance,number_of_iterations,max_iterations,calculated_irr,scale_factor)) // try 0.1 as initial guess
-			{
-				//				calculated_irr = 0.0; // did not converge
-				calculated_irr = std::numeric_limits<double>::quiet_NaN(); // did not converge
-			}
-
-		}
-		return calculated_irr;
-	}
-
-
-	double irr_calc( int cf_line, int count, double initial_guess, double tolerance, int max_iterations, double scale_factor, int &number_of_iterations, double &residual )
-	{
-//		double calculated_irr=0;
-		double calculated_irr = std::numeric_limits<double>::quiet_NaN();
-
-		double deriv_sum = irr_derivative_sum(initial_guess,cf_line,count);
-		if (deriv_sum != 0.0)
-			calculated_irr = initial_guess - irr_poly_sum(initial_guess,cf_line,count)/deriv_sum;
-		else
-			return initial_guess;
-
-		number_of_iterations++;
-
-
-		residual = irr_poly_sum(calculated_irr,cf_line,count) / scale_factor;
-
-		while (!(fabs(residual) <= tolerance) && (number_of_iterations < max_iterations))
-		{
-			deriv_sum = irr_derivative_sum(initial_guess,cf_line,count);
-			if (deriv_sum != 0.0)
-				calculated_irr = calculated_irr - irr_poly_sum(calculated_irr,cf_line,count)/deriv_sum;
-			else
-				break;
-
-			number_of_iterations++;
-			residual = irr_poly_sum(calculated_irr,cf_line,count) / scale_factor;
-		}
-		return calculated_irr;
+		return libfin::irr_from(&cf.at(cf_line,0), count, initial_guess, tolerance, max_iterations);
 	}
 
 
@@ -3807,6 +3662,6 @@ public:
 
 
 
-DEFINE_MODULE_ENTRY( equpartflip, "All Equity Partnership Flip Financial Model_", 1 );
+DEFINE_THREAD_SAFE_MODULE_ENTRY( equpartflip, "All Equity Partnership Flip Financial Model_", 1 );
 
 
@@ -0,0 +1,243 @@
+/**
+BSD-3-Clause
+Copyright 2019 Alliance for Sustainable Energy, LLC
+Redistribution and use in source and binary forms, with or without modification, are permitted provided
+that the following conditions are met :
+1.	Redistributions of source code must retain the above copyright notice, this list of conditions
+and the following disclaimer.
+2.	Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+and the following disclaimer in the documentation and/or other materials provided with the distribution.
+3.	Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED.IN NO EVENT SHALL THE COPYRIGHT HOLDER, CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES
+DEPARTMENT OF ENERGY, NOR ANY OF THEIR EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+OR CONSEQUENTIAL DAMAGES(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "core.h"
+#include "sscapi.h"
+#include <algorithm>
+#include <limits>
+
+static var_info vtab_financial_sweep[] = {
+/*   VARTYPE           DATATYPE         NAME                         LABEL                                                   UNITS      META                      GROUP              REQUIRED_IF    CONSTRAINTS   UI_HINTS*/
+	{ SSC_INPUT,       SSC_STRING,      "sweep_module",              "Financial model run for each sample",                  "",        "singleowner,host_developer,levpartflip,equpartflip,saleleaseback", "Financial Sweep", "*", "", "" },
+	{ SSC_INPUT,       SSC_STRING,      "sweep_parameters",          "Swept financial inputs",                               "",        "Comma separated input names, one per column of sweep_samples", "Financial Sweep", "*", "", "" },
+	{ SSC_INPUT,       SSC_MATRIX,      "sweep_samples",             "Sampled values of the swept inputs",                   "",        "One row per sample",     "Financial Sweep", "*",           "",           "" },
+	{ SSC_INPUT,       SSC_STRING,      "sweep_outputs",             "Additional outputs collected for each sample",         "",        "Comma separated names of number outputs of the financial model", "Financial Sweep", "?", "", "" },
+	{ SSC_INPUT,       SSC_NUMBER,      "sweep_nthreads",            "Number of threads",                                    "",        "0=one per processor",    "Financial Sweep", "?=0",         "INTEGER,MIN=0", "" },
+
+	{ SSC_OUTPUT,      SSC_ARRAY,       "sweep_success",             "Sample ran successfully",                              "0/1",     "",                       "Financial Sweep", "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "sweep_ppa",                 "PPA price in first year",                              "cents/kWh", "",                     "Financial Sweep", "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "sweep_lcoe_nom",            "Levelized cost (nominal)",                             "cents/kWh", "",                     "Financial Sweep", "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "sweep_lcoe_real",           "Levelized cost (real)",                                "cents/kWh", "",                     "Financial Sweep", "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "sweep_npv",                 "After-tax NPV",                                        "$",       "Project for single owner and host developer, tax investor for partnership flip and sale leaseback", "Financial Sweep", "*", "", "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "sweep_irr",                 "After-tax IRR",                                        "%",       "Project for single owner and host developer, tax investor for partnership flip and sale leaseback", "Financial Sweep", "*", "", "" },
+	{ SSC_OUTPUT,      SSC_MATRIX,      "sweep_results",             "Additional outputs",                                   "",        "One row per sample, one column per sweep_outputs name", "Financial Sweep", "",            "",           "" },
+
+var_info_invalid };
+
+// samples are run in blocks of this many so that only one block of cases is held in memory at a time
+static const size_t sweep_block_size = 256;
+
+struct sweep_block_status
+{
+	std::vector<int> success;
+	std::string first_error;
+};
+
+static void sweep_sample_done( int index, ssc_bool_t result, ssc_module_t p_mod, void *user_data )
+{
+	sweep_block_status *status = static_cast<sweep_block_status*>(user_data);
+	status->success[index] = result ? 1 : 0;
+	if ( !result && status->first_error.empty() )
+	{
+		status->first_error = "unknown error";
+		const char *text;
+		int type, i = 0;
+		while ( p_mod && (text = ssc_module_log( p_mod, i++, &type, 0 )) )
+		{
+			if ( type == SSC_ERROR )
+			{
+				status->first_error = text;
+				break;
+			}
+		}
+	}
+}
+
+static std::vector<std::string> sweep_names( const std::string &list )
+{
+	std::vector<std::string> names;
+	std::vector<std::string> items = util::split( list, "," );
+	for ( size_t i = 0; i < items.size(); i++ )
+	{
+		std::string name = items[i];
+		name.erase( 0, name.find_first_not_of( " \t" ) );
+		name.erase( name.find_last_not_of( " \t" ) + 1 );
+		if ( !name.empty() ) names.push_back( name );
+	}
+	return names;
+}
+
+class cm_financial_sweep : public compute_module
+{
+public:
+	cm_financial_sweep()
+	{
+		add_var_info( vtab_financial_sweep );
+	}
+
+	void exec( )
+	{
+		std::string fin_module = as_string( "sweep_module" );
+		std::string npv_name, irr_name;
+		if ( fin_module == "singleowner" || fin_module == "host_developer" )
+		{
+			npv_name = "project_return_aftertax_npv";
+			irr_name = "project_return_aftertax_irr";
+		}
+		else if ( fin_module == "levpartflip" || fin_module == "equpartflip" || fin_module == "saleleaseback" )
+		{
+			npv_name = "tax_investor_aftertax_npv";
+			irr_name = "tax_investor_aftertax_irr";
+		}
+		else
+			throw exec_error( "financial_sweep", "unsupported financial model: " + fin_module );
+
+		std::vector<std::string> params = sweep_names( as_string( "sweep_parameters" ) );
+		util::matrix_t<double> samples = as_matrix( "sweep_samples" );
+		size_t nsamples = samples.nrows();
+		if ( params.empty() || samples.ncols() != params.size() )
+			throw exec_error( "financial_sweep", util::format( "sweep_samples has %d columns for %d swept inputs",
+				(int)samples.ncols(), (int)params.size() ) );
+
+		std::vector<std::string> extra_outputs;
+		if ( is_assigned( "sweep_outputs" ) )
+			extra_outputs = sweep_names( as_string( "sweep_outputs" ) );
+		int nthreads = as_integer( "sweep_nthreads" );
+
+		// the financial model's inputs are shared by all samples. arrays and matrices are referenced
+		// in place rather than copied, except gen, which hourly_energy_calculation adds the grid to
+		// battery energy to in place for front of meter batteries, and inout variables
+		std::vector<std::string> shared_names;
+		std::vector<bool> shared_by_ref;
+		ssc_module_t p_fin = ssc_module_create( fin_module.c_str() );
+		if ( !p_fin )
+			throw exec_error( "financial_sweep", "could not create financial model: " + fin_module );
+		compute_module *fin = static_cast<compute_module*>( p_fin );
+		std::vector<bool> param_found( params.size(), false );
+		var_info *vi;
+		for ( int i = 0; (vi = fin->info( i )) != NULL; i++ )
+		{
+			if ( vi->var_type != SSC_INPUT && vi->var_type != SSC_INOUT ) continue;
+			std::string name( vi->name );
+			std::vector<std::string>::iterator it = std::find( params.begin(), params.end(), name );
+			if ( it != params.end() )
+			{
+				if ( vi->data_type != SSC_NUMBER )
+				{
+					ssc_module_free( p_fin );
+					throw exec_error( "financial_sweep", "swept input " + name + " is not a number" );
+				}
+				param_found[it - params.begin()] = true;
+				continue;
+			}
+			if ( std::find( shared_names.begin(), shared_names.end(), name ) != shared_names.end() ) continue;
+			shared_names.push_back( name );
+			shared_by_ref.push_back( vi->var_type == SSC_INPUT && name != "gen"
+				&& (vi->data_type == SSC_ARRAY || vi->data_type == SSC_MATRIX) );
+		}
+		ssc_module_free( p_fin );
+		for ( size_t j = 0; j < params.size(); j++ )
+			if ( !param_found[j] )
+				throw exec_error( "financial_sweep", "swept input " + params[j] + " is not an input of " + fin_module );
+
+		ssc_number_t *success = allocate( "sweep_success", nsamples );
+		ssc_number_t *ppa = allocate( "sweep_ppa", nsamples );
+		ssc_number_t *lcoe_nom = allocate( "sweep_lcoe_nom", nsamples );
+		ssc_number_t *lcoe_real = allocate( "sweep_lcoe_real", nsamples );
+		ssc_number_t *npv = allocate( "sweep_npv", nsamples );
+		ssc_number_t *irr = allocate( "sweep_irr", nsamples );
+		ssc_number_t *results = 0;
+		if ( !extra_outputs.empty() )
+			results = allocate( "sweep_results", nsamples, extra_outputs.size() );
+
+		size_t nfailed = 0;
+		std::string first_error;
+		for ( size_t start = 0; start < nsamples; start += sweep_block_size )
+		{
+			size_t n = std::min( sweep_block_size, nsamples - start );
+
+			std::vector<var_table*> tables( n );
+			std::vector<ssc_data_t> p_data( n );
+			for ( size_t i = 0; i < n; i++ )
+			{
+				var_table *vt = new var_table;
+				for ( size_t k = 0; k < shared_names.size(); k++ )
+				{
+					var_data *src = lookup( shared_names[k] );
+					if ( !src ) continue;
+					if ( shared_by_ref[k] && (src->type == SSC_ARRAY || src->type == SSC_MATRIX) )
+					{
+						var_data *v = vt->assign( shared_names[k], var_data() );
+						v->type = src->type;
+						v->num.borrow( src->num.data(), src->num.nrows(), src->num.ncols() );
+					}
+					else
+						vt->assign( shared_names[k], *src );
+				}
+				for ( size_t j = 0; j < params.size(); j++ )
+					vt->assign( params[j], var_data( (ssc_number_t)samples.at( start + i, j ) ) );
+				tables[i] = vt;
+				p_data[i] = static_cast<ssc_data_t>( vt );
+			}
+
+			sweep_block_status status;
+			status.success.assign( n, 0 );
+			if ( ssc_module_exec_batch( fin_module.c_str(), &p_data[0], (int)n, nthreads, sweep_sample_done, &status ) < 0 )
+			{
+				for ( size_t i = 0; i < n; i++ ) delete tables[i];
+				throw exec_error( "financial_sweep", "could not run financial model: " + fin_module );
+			}
+
+			for ( size_t i = 0; i < n; i++ )
+			{
+				size_t s = start + i;
+				var_table *vt = tables[i];
+				success[s] = (ssc_number_t)status.success[i];
+				ppa[s] = sweep_output( vt, "ppa", status.success[i] );
+				lcoe_nom[s] = sweep_output( vt, "lcoe_nom", status.success[i] );
+				lcoe_real[s] = sweep_output( vt, "lcoe_real", status.success[i] );
+				npv[s] = sweep_output( vt, npv_name, status.success[i] );
+				irr[s] = sweep_output( vt, irr_name, status.success[i] );
+				for ( size_t j = 0; j < extra_outputs.size(); j++ )
+					results[s * extra_outputs.size() + j] = sweep_output( vt, extra_outputs[j], status.success[i] );
+				if ( !status.success[i] ) nfailed++;
+				delete vt;
+			}
+			if ( first_error.empty() ) first_error = status.first_error;
+
+			update( util::format( "%d of %d samples", (int)(start + n), (int)nsamples ), 100.0f * (float)(start + n) / (float)nsamples );
+		}
+
+		if ( nfailed > 0 )
+			log( util::format( "%d of %d samples failed, first error: %s", (int)nfailed, (int)nsamples, first_error.c_str() ), SSC_WARNING );
+	}
+
+	ssc_number_t sweep_output( var_table *vt, const std::string &name, int success )
+	{
+		var_data *v = vt->lookup( name );
+		if ( !success || !v || v->type != SSC_NUMBER )
+			return std::numeric_limits<ssc_number_t>::quiet_NaN();
+		return v->num.at(0);
+	}
+};
+
+DEFINE_MODULE_ENTRY( financial_sweep, "Run a financial model for many samples of its inputs against one set of performance results", 1 );
@@ -1031,7 +1031,7 @@ enum {
 class cm_host_developer : public compute_module
 {
 private:
-	util::matrix_t<double> cf;
+	cashflow_table cf;
 	dispatch_calculations m_disp_calcs;
 	hourly_energy_calculation hourly_energy_calcs;
 
@@ -1868,6 +1868,8 @@ public:
 		bool ppa_interval_reset=true;
 		// 12/14/12 - address issue from Eric Lantz - ppa solution when target mode and ppa < 0
 		double ppa_old=ppa;
+		// price from the linear part of the cash flow, tried once during the interval search
+		ppa_linear_solution ppa_linear;
 
 
 		// debt fraction input
@@ -2058,7 +2060,7 @@ public:
 		cash_for_debt_service=0;
 		pv_cafds=0;
 		if (constant_dscr_mode)	size_of_debt=0;
-		if (ppa_interval_found)	ppa = (w0*x1+w1*x0)/(w0 + w1);
+		if (ppa_interval_found && !ppa_linear.is_trial())	ppa = (w0*x1+w1*x0)/(w0 + w1);
 
 		// debt pre calculation
 		for (i=1; i<=nyears; i++)
@@ -2477,17 +2479,11 @@ public:
 			cf.at(CF_project_return_pretax,i) = cf.at(CF_pretax_cashflow,i);
 			if (i==0) cf.at(CF_project_return_pretax,i) -= (issuance_of_equity); 
 
-			cf.at(CF_project_return_pretax_irr,i) = irr(CF_project_return_pretax,i)*100.0;
-			cf.at(CF_project_return_pretax_npv,i) = npv(CF_project_return_pretax,i,nom_discount_rate) +  cf.at(CF_project_return_pretax,0) ;
-
 			cf.at(CF_project_return_aftertax_cash,i) = cf.at(CF_project_return_pretax,i);
 		}
 
 
 		cf.at(CF_project_return_aftertax,0) = cf.at(CF_project_return_aftertax_cash,0);
-		cf.at(CF_project_return_aftertax_irr,0) = irr(CF_project_return_aftertax_tax,0)*100.0;
-		cf.at(CF_project_return_aftertax_max_irr,0) = cf.at(CF_project_return_aftertax_irr,0);
-		cf.at(CF_project_return_aftertax_npv,0) = cf.at(CF_project_return_aftertax,0) ;
 
 
 		for (i=1;i<=nyears;i++)
@@ -2567,25 +2563,7 @@ public:
 				cf.at(CF_ptc_fed,i) + cf.at(CF_ptc_sta,i) +
 				cf.at(CF_statax,i) + cf.at(CF_fedtax,i);
 			if (i==1) cf.at(CF_project_return_aftertax,i) += itc_total;
-
-			cf.at(CF_project_return_aftertax_irr,i) = irr(CF_project_return_aftertax,i)*100.0;
-			cf.at(CF_project_return_aftertax_max_irr,i) = max(cf.at(CF_project_return_aftertax_max_irr,i-1),cf.at(CF_project_return_aftertax_irr,i));
-			cf.at(CF_project_return_aftertax_npv,i) = npv(CF_project_return_aftertax,i,nom_discount_rate) +  cf.at(CF_project_return_aftertax,0) ;
-
-			if (flip_year <=0) 
-			{
-				double residual = fabs(cf.at(CF_project_return_aftertax_irr, i) - flip_target_percent) / 100.0; // solver checks fractions and not percentages
-				if ( ( cf.at(CF_project_return_aftertax_max_irr,i-1) < flip_target_percent ) &&  (   residual  < ppa_soln_tolerance ) 	) 
-				{
-					flip_year = i;
-					cf.at(CF_project_return_aftertax_max_irr,i)=flip_target_percent; //within tolerance so pre-flip and post-flip percentages applied correctly
-				}
-				else if ((cf.at(CF_project_return_aftertax_max_irr, i - 1) < flip_target_percent) && (cf.at(CF_project_return_aftertax_max_irr, i) >= flip_target_percent)) flip_year = i;
-			}
-
-
 		}
-		cf.at(CF_project_return_aftertax_npv,0) = cf.at(CF_project_return_aftertax,0) ;
 
 		// 12/14/12 - address issue from Eric Lantz - ppa solution when target mode and ppa < 0
 		ppa_old = ppa;
@@ -2597,7 +2575,8 @@ public:
 		// 12/14/12 - address issue from Eric Lantz - ppa solution when target mode and ppa < 0
 			double ppa_denom = max(x0, x1);
 			if (ppa_denom <= ppa_soln_tolerance) ppa_denom = 1;
-			double residual = cf.at(CF_project_return_aftertax_irr, flip_target_year) - flip_target_percent;
+			// only the target year return is needed to update the price, the yearly returns are calculated after the solution
+			double residual = irr(CF_project_return_aftertax, flip_target_year)*100.0 - flip_target_percent;
 			solved = (( fabs( residual )/resid_denom < ppa_soln_tolerance ) || ( fabs(x0-x1)/ppa_denom < ppa_soln_tolerance) );
 //			solved = (( fabs( residual ) < ppa_soln_tolerance ) );
 				double flip_frac = flip_target_percent/100.0;
@@ -2605,7 +2584,12 @@ public:
 //				double itnpv_target_delta = npv(CF_project_return_aftertax,flip_target_year,flip_frac+0.001) +  cf.at(CF_project_return_aftertax,0) ;
 			//	double itnpv_actual = npv(CF_project_return_aftertax,flip_target_year,cf.at(CF_project_return_aftertax_irr, flip_target_year)) +  cf.at(CF_project_return_aftertax,0) ;
 			//	double itnpv_actual_delta = npv(CF_project_return_aftertax,flip_target_year,cf.at(CF_project_return_aftertax_irr, flip_target_year)+0.001) +  cf.at(CF_project_return_aftertax,0) ;
-			if (!solved)
+			if (ppa_linear.is_trial())
+			{
+				// a miss means the cash flow is not linear in the price, the interval search goes on from where it was
+				if (!solved) ppa = ppa_linear.resume();
+			}
+			else if (!solved)
 			{
 //				double flip_frac = flip_target_percent/100.0;
 //				double itnpv_target = npv(CF_project_return_aftertax,flip_target_year,flip_frac) +  cf.at(CF_project_return_aftertax,0) ;
@@ -2673,6 +2657,7 @@ public:
 					// for initial guess of zero
 					if (fabs(x0-x1)<ppa_soln_tolerance) x0 = x1-2*ppa_soln_tolerance;
 				}
+				ppa_linear.next(ppa_old, itnpv_target, ppa);
 					//std::stringstream outm;
 					//outm << "iteration=" << its  << ", irr=" << cf.at(CF_project_return_aftertax_irr, flip_target_year)  << ", npvtarget=" << itnpv_target  << ", npvtarget_delta=" << itnpv_target_delta  
 					//	//  << ", npvactual=" << itnpv_actual  << ", npvactual_delta=" << itnpv_target_delta  
@@ -2691,6 +2676,37 @@ public:
 
 /***************** end iterative solution *********************************************************************/
 
+	// project returns by year for the solved ppa price
+	flip_year=-1;
+	libfin::irr_series(&cf.at(CF_project_return_pretax,0), nyears, &cf.at(CF_project_return_pretax_irr,0));
+	libfin::irr_series(&cf.at(CF_project_return_aftertax,0), nyears, &cf.at(CF_project_return_aftertax_irr,0));
+	for (i=0; i<=nyears; i++)
+	{
+		cf.at(CF_project_return_pretax_irr,i) *= 100.0;
+		cf.at(CF_project_return_pretax_npv,i) = npv(CF_project_return_pretax,i,nom_discount_rate) +  cf.at(CF_project_return_pretax,0) ;
+	}
+
+	cf.at(CF_project_return_aftertax_irr,0) *= 100.0;
+	cf.at(CF_project_return_aftertax_max_irr,0) = cf.at(CF_project_return_aftertax_irr,0);
+	cf.at(CF_project_return_aftertax_npv,0) = cf.at(CF_project_return_aftertax,0) ;
+	for (i=1;i<=nyears;i++)
+	{
+		cf.at(CF_project_return_aftertax_irr,i) *= 100.0;
+		cf.at(CF_project_return_aftertax_max_irr,i) = max(cf.at(CF_project_return_aftertax_max_irr,i-1),cf.at(CF_project_return_aftertax_irr,i));
+		cf.at(CF_project_return_aftertax_npv,i) = npv(CF_project_return_aftertax,i,nom_discount_rate) +  cf.at(CF_project_return_aftertax,0) ;
+
+		if (flip_year <=0) 
+		{
+			double residual = fabs(cf.at(CF_project_return_aftertax_irr, i) - flip_target_percent) / 100.0; // solver checks fractions and not percentages
+			if ( ( cf.at(CF_project_return_aftertax_max_irr,i-1) < flip_target_percent ) &&  (   residual  < ppa_soln_tolerance ) 	) 
+			{
+				flip_year = i;
+				cf.at(CF_project_return_aftertax_max_irr,i)=flip_target_percent; //within tolerance so pre-flip and post-flip percentages applied correctly
+			}
+			else if ((cf.at(CF_project_return_aftertax_max_irr, i - 1) < flip_target_percent) && (cf.at(CF_project_return_aftertax_max_irr, i) >= flip_target_percent)) flip_year = i;
+		}
+	}
+
 //	log(util::format("after loop  - size of debt =%lg .", size_of_debt), SSC_WARNING);
 
 
@@ -3622,6 +3638,8 @@ public:
 		double pvPropertyTax = npv(CF_property_tax_expense, nyears, nom_discount_rate);
 
 		assign( "present_value_insandproptax", var_data((ssc_number_t)(pvInsurance + pvPropertyTax)));
+
+		cf.export_outputs(this);
 	}
 
 
@@ -3864,9 +3882,7 @@ public:
 	// std lib
 	void save_cf(int cf_line, int nyears, const std::string &name)
 	{
-		ssc_number_t *arrp = allocate( name, nyears+1 );
-		for (int i=0;i<=nyears;i++)
-			arrp[i] = (ssc_number_t)cf.at(cf_line, i);
+		cf.save(cf_line, nyears, name);
 	}
 
 	void escal_or_annual( int cf_line, int nyears, const std::string &variable, 
@@ -3972,164 +3988,9 @@ public:
 		return result*rr;
 	}
 
-/* ported from http://code.google.com/p/irr-newtonraphson-calculator/ */
-	bool is_valid_iter_bound(double estimated_return_rate)
-	{
-		return estimated_return_rate != -1 && (estimated_return_rate < std::numeric_limits<int>::max()) && (estimated_return_rate > std::numeric_limits<int>::min());
-	}
-
-	double irr_poly_sum(double estimated_return_rate, int cf_line, int count)
-	{
-		double sum_of_polynomial = 0;
-		if (is_valid_iter_bound(estimated_return_rate))
-		{
-			for (int j = 0; j <= count ; j++)
-			{
-				double val = (pow((1 + estimated_return_rate), j));
-				if (val != 0.0)
-					sum_of_polynomial += cf.at(cf_line,j)/val;
-				else
-					break;
-			}
-		}
-		return sum_of_polynomial;
-	}
-
-	double irr_derivative_sum(double estimated_return_rate,int cf_line, int count)
-	{
-		double sum_of_derivative = 0;
-		if (is_valid_iter_bound(estimated_return_rate))
-			for (int i = 1; i <= count ; i++)
-			{
-				sum_of_derivative += cf.at(cf_line,i)*(i)/pow((1 + estimated_return_rate), i+1);
-			}
-		return sum_of_derivative*-1;
-	}
-
-	double irr_scale_factor( int cf_unscaled, int count)
-	{
-		// scale to max value for better irr convergence
-		if (count<1) return 1.0;
-		int i=0;
-		double max=fabs(cf.at(cf_unscaled,0));
-		for (i=0;i<=count;i++) 
-			if (fabs(cf.at(cf_unscaled,i))> max) max =fabs(cf.at(cf_unscaled,i));
-		return (max>0 ? max:1);
-	}
-
-	bool is_valid_irr( int cf_line, int count, double residual, double tolerance, int number_of_iterations, int max_iterations, double calculated_irr, double scale_factor )
-	{
-		double npv_of_irr = npv(cf_line,count,calculated_irr)+cf.at(cf_line,0);
-		double npv_of_irr_plus_delta = npv(cf_line,count,calculated_irr+0.001)+cf.at(cf_line,0);
-		bool is_valid = ( (number_of_iterations<max_iterations) && (fabs(residual)<tolerance) && (npv_of_irr>npv_of_irr_plus_delta) && (fabs(npv_of_irr/scale_factor)<tolerance) );
-				//if (!is_valid)
-				//{
-				//std::stringstream outm;
-				//outm <<  "cf_line=" << cf_line << "count=" << count << "residual=" << residual << "number_of_iterations=" << number_of_iterations << "calculated_irr=" << calculated_irr
-				//	<< "npv of irr=" << npv_of_irr << "npv of irr plus delta=" << npv_of_irr_plus_delta;
-				//log( outm.str() );
-				//}
-		return is_valid;
-	}
-
 	double irr( int cf_line, int count, double initial_guess=-2, double tolerance=1e-6, int max_iterations=100 )
 	{
-		int number_of_iterations=0;
-//		double calculated_irr = 0;
-		double calculated_irr = std::numeric_limits<double>::quiet_NaN();
-//		double calculated_irr = -999;
-
-
-		if (count < 1) 
-			return calculated_irr;
-
-		// only possible for first value negative
-		if ( (cf.at(cf_line,0) <= 0))
-		{
-			// initial guess from http://zainco.blogspot.com/2008/08/internal-rate-of-return-using-newton.html
-			if ((initial_guess < -1) && (count > 1))// second order
-			{
-				if (cf.at(cf_line,0) !=0) 
-				{
-					double b = 2.0+ cf.at(cf_line,1)/cf.at(cf_line,0);
-					double c = 1.0+cf.at(cf_line,1)/cf.at(cf_line,0)+cf.at(cf_line,2)/cf.at(cf_line,0);
-					initial_guess = -0.5*b - 0.5*sqrt(b*b-4.0*c);
-					if ((initial_guess <= 0) || (initial_guess >= 1)) initial_guess = -0.5*b + 0.5*sqrt(b*b-4.0*c);
-				}
-			}
-			else if (initial_guess < 0) // first order
-			{
-				if (cf.at(cf_line,0) !=0) initial_guess = -(1.0 + cf.at(cf_line,1)/cf.at(cf_line,0));
-			}
-
-			double scale_factor = irr_scale_factor(cf_line,count);
-			double residual=DBL_MAX;
-
-			calculated_irr = irr_calc(cf_line,count,initial_guess,tolerance,max_iterations,scale_factor,number_of_iterations,residual);
-
-			if (!is_valid_irr(cf_line,count,residual,tolerance,number_of_iterations,max_iterations,calculated_irr,scale_factor)) // try 0.1 as initial guess
-			{
-				initial_guess=0.1;
-				number_of_iterations=0;
-				residual=0;
-				calculated_irr = irr_calc(cf_line,count,initial_guess,tolerance,max_iterations,scale_factor,number_of_iterations,residual);
-			}
-
-			if (!is_valid_irr(cf_line,count,residual,tolerance,number_of_iterations,max_iterations,calculated_irr,scale_factor)) // try -0.1 as initial guess
-			{
-				initial_guess=-0.1;
-				number_of_iterations=0;
-				residual=0;
-				calculated_irr = irr_calc(cf_line,count,initial_guess,tolerance,max_iterations,scale_factor,number_of_iterations,residual);
-			}
-			if (!is_valid_irr(cf_line,count,residual,tolerance,number_of_iterations,max_iterations,calculated_irr,scale_factor)) // try 0 as initial guess
-			{
-				initial_guess=0;
-				number_of_iterations=0;
-				residual=0;
-				calculated_irr = irr_calc(cf_line,count,initial_guess,tolerance,max_iterations,scale_factor,number_of_iterations,residual);
-			}
-
-			if (!is_valid_irr(cf_line,count,residual,tolerance,number_of_iterations,max_iterations,calculated_irr,scale_factor)) // try 0.1 as initial guess
-			{
-//				calculated_irr = 0.0; // did not converge
-				calculated_irr = std::numeric_limits<double>::quiet_NaN(); // did not converge
-//				double calculated_irr = -999;
-			}
-
-		}
-		return calculated_irr;
-	}
-
-
-	double irr_calc( int cf_line, int count, double initial_guess, double tolerance, int max_iterations, double scale_factor, int &number_of_iterations, double &residual )
-	{
-//		double calculated_irr = 0;
-		double calculated_irr = std::numeric_limits<double>::quiet_NaN();
-//		double calculated_irr = -999;
-		double deriv_sum = irr_derivative_sum(initial_guess, cf_line, count);
-		if (deriv_sum != 0.0)
-			calculated_irr = initial_guess - irr_poly_sum(initial_guess,cf_line,count)/deriv_sum;
-		else
-			return initial_guess;
-
-		number_of_iterations++;
-
-
-		residual = irr_poly_sum(calculated_irr,cf_line,count) / scale_factor;
-
-		while (!(fabs(residual) <= tolerance) && (number_of_iterations < max_iterations))
-		{
-			deriv_sum = irr_derivative_sum(initial_guess,cf_line,count);
-			if (deriv_sum != 0.0)
-				calculated_irr = calculated_irr - irr_poly_sum(calculated_irr,cf_line,count)/deriv_sum;
-			else
-				break;
-
-			number_of_iterations++;
-			residual = irr_poly_sum(calculated_irr,cf_line,count) / scale_factor;
-		}
-		return calculated_irr;
+		return libfin::irr_from(&cf.at(cf_line,0), count, initial_guess, tolerance, max_iterations);
 	}
 
 
@@ -4169,6 +4030,6 @@ public:
 
 
 
-DEFINE_MODULE_ENTRY( host_developer, "Host Developer Financial Model_", 1 );
+DEFINE_THREAD_SAFE_MODULE_ENTRY( host_developer, "Host Developer Financial Model_", 1 );
 
 
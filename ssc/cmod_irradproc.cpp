@@ -168,89 +168,64 @@ public:
 		ssc_number_t *p_sunrise = allocate("sunrise", count);
 		ssc_number_t *p_sunset = allocate("sunset", count);
 		
+		std::vector<int> yr( count ), mn( count ), dy( count ), hr( count );
+		std::vector<double> mi( count ), dn( count, 0.0 ), df( count, 0.0 ), gh( count, 0.0 ), alb( count );
 		for (size_t i = 0; i < count ;i ++ )
 		{
-			double t_cur = hour[i] + minute[i]/60.0;
-			double delt = 1.0;
-			if ( i == 0 )
-			{
-				double t_next = hour[i+1] + minute[i+1]/60.0;
-				if (t_cur > t_next) t_next += 24;
-				delt = t_next - t_cur;
-			}
-			else
-			{
-				double t_prev = hour[i-1] + minute[i-1]/60.0;
-				if (t_cur < t_prev) t_cur += 24;
-				delt = t_cur - t_prev;
-			}
-
-			// double precsion issue (15 digits IEEE 754) encountered by Anthony Lopez 4/29/13 for 
-			// minutes other than 15,30,45 and 60
-			if (fabs(delt-1.0)<1e-14) delt=1.0;
-
-			double alb = alb_const;
+			yr[i] = (int)year[i];
+			mn[i] = (int)month[i];
+			dy[i] = (int)day[i];
+			hr[i] = (int)hour[i];
+			mi[i] = minute[i];
+			if ( beam != 0 ) dn[i] = beam[i];
+			if ( diff != 0 ) df[i] = diff[i];
+			if ( glob != 0 ) gh[i] = glob[i];
+
+			alb[i] = alb_const;
 			// if we have array of albedo values, use it
 			if ( albvec != 0  && albvec[i] >= 0 && albvec[i] <= (ssc_number_t)1.0)
-				alb = albvec[i];
-
-			irrad x;
-
-			x.set_time( (int)year[i], (int)month[i], (int)day[i], (int)hour[i], minute[i], IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET );
-			x.set_location( lat, lon, tz );
-			x.set_sky_model( sky_model, alb );
-			if ( irrad_mode == 1 ) x.set_global_beam( glob[i], beam[i] );
-			else if (irrad_mode == 2) x.set_global_diffuse(glob[i], diff[i]);
-			else x.set_beam_diffuse( beam[i], diff[i] );
-			x.set_surface( track_mode, tilt, azimuth, rotlim, en_backtrack, gcr );
-			
-			int code = x.calc();
-			if (code < 0)
-				throw general_error( util::format("irradiance processor issued error code %d", code ));
-
-			double solazi, solzen, solelv, soldec, sunrise, sunset;
-			int sunup;
-
-			x.get_sun( &solazi,
-				&solzen,
-				&solelv,
-				&soldec,
-				&sunrise,
-				&sunset,
-				&sunup,
-				0,
-				0,
-				0 );
-			
-			p_azm[i] = (ssc_number_t) solazi;
-			p_zen[i] = (ssc_number_t) solzen;
-			p_elv[i] = (ssc_number_t) solelv;
-			p_dec[i] = (ssc_number_t) soldec;	
-			p_sunrise[i] = (ssc_number_t) sunrise;
-			p_sunset[i] = (ssc_number_t) sunset;
-			p_sunup[i] = (ssc_number_t) sunup;
-			
-			
-			double aoi, stilt, sazi, rot, btd;
-			x.get_angles( &aoi, &stilt, &sazi, &rot, &btd );
+				alb[i] = albvec[i];
+		}
+
+		// the whole series is processed at once, since no state carries over between time steps
+		irrad_series x;
+		x.set_location( lat, lon, tz );
+		x.set_sky_model( sky_model );
+		x.set_surface( track_mode, tilt, azimuth, rotlim, en_backtrack, gcr );
+
+		int radmode = irrad::DN_DF;
+		if ( irrad_mode == 1 ) radmode = irrad::DN_GH;
+		else if ( irrad_mode == 2 ) radmode = irrad::GH_DF;
+
+		x.calc( count, &yr[0], &mn[0], &dy[0], &hr[0], &mi[0], IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET,
+			radmode, &dn[0], &df[0], &gh[0], &alb[0] );
+
+		for (size_t i = 0; i < count ;i ++ )
+		{
+			if (x.code[i] < 0)
+				throw general_error( util::format("irradiance processor issued error code %d", x.code[i] ));
+
+			p_azm[i] = (ssc_number_t) x.solazi[i];
+			p_zen[i] = (ssc_number_t) x.solzen[i];
+			p_elv[i] = (ssc_number_t) x.solelv[i];
+			p_dec[i] = (ssc_number_t) x.soldec[i];	
+			p_sunrise[i] = (ssc_number_t) x.sunrise[i];
+			p_sunset[i] = (ssc_number_t) x.sunset[i];
+			p_sunup[i] = (ssc_number_t) x.sunup[i];
 
 			// assign outputs
-			p_inc[i] = (ssc_number_t) aoi;
-			p_surftilt[i] = (ssc_number_t) stilt;
-			p_surfazm[i] = (ssc_number_t) sazi;
-			p_rot[i] = (ssc_number_t) rot;
-			p_btdiff[i] = (ssc_number_t) btd;
-			
-			double beam, skydiff, gnddiff, iso, cir, hor;
-			x.get_poa( &beam, &skydiff, &gnddiff, &iso, &cir, &hor );
-
-			p_poa_beam[i] = (ssc_number_t) beam;
-			p_poa_skydiff[i] = (ssc_number_t) skydiff;
-			p_poa_gnddiff[i] = (ssc_number_t) gnddiff;
-			p_poa_skydiff_iso[i] = (ssc_number_t) iso;
-			p_poa_skydiff_cir[i] = (ssc_number_t) cir;
-			p_poa_skydiff_hor[i] = (ssc_number_t) hor;
-			
+			p_inc[i] = (ssc_number_t) x.aoi[i];
+			p_surftilt[i] = (ssc_number_t) x.surftilt[i];
+			p_surfazm[i] = (ssc_number_t) x.surfazi[i];
+			p_rot[i] = (ssc_number_t) x.axisrot[i];
+			p_btdiff[i] = (ssc_number_t) x.btdiff[i];
+
+			p_poa_beam[i] = (ssc_number_t) x.poa_beam[i];
+			p_poa_skydiff[i] = (ssc_number_t) x.poa_skydiff[i];
+			p_poa_gnddiff[i] = (ssc_number_t) x.poa_gnddiff[i];
+			p_poa_skydiff_iso[i] = (ssc_number_t) x.poa_iso[i];
+			p_poa_skydiff_cir[i] = (ssc_number_t) x.poa_cir[i];
+			p_poa_skydiff_hor[i] = (ssc_number_t) x.poa_hor[i];
 		}
 	}
 };
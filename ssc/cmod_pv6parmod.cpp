@@ -21,6 +21,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include <math.h>
+#include <vector>
 
 #ifndef M_PI
 #define M_PI 3.141592653589793238462643
@@ -65,6 +66,7 @@ static var_info _cm_vtab_pv6parmod[] = {
 	{ SSC_INPUT,        SSC_NUMBER,      "Adj",                     "OC SC temp coeff adjustment",    "%",      "",                      "CEC 6 Parameter PV Module Model",      "*",                        "",                      "" },
 	{ SSC_INPUT,        SSC_NUMBER,      "standoff",                "Mounting standoff option",       "0..6",   "0=bipv, 1= >3.5in, 2=2.5-3.5in, 3=1.5-2.5in, 4=0.5-1.5in, 5= <0.5in, 6=ground/rack",   "CEC 6 Parameter PV Module Model",      "?=6",     "INTEGER,MIN=0,MAX=6",     "" },
 	{ SSC_INPUT,        SSC_NUMBER,      "height",                  "System installation height",     "0/1",    "0=less than 22ft, 1=more than 22ft",                                                   "CEC 6 Parameter PV Module Model",      "?=0",     "INTEGER,MIN=0,MAX=1",     "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "module_mpp_solver",       "Module maximum power point solver", "",    "0=golden section search,1=explicit Lambert W",                                         "CEC 6 Parameter PV Module Model",      "?=0",     "INTEGER,MIN=0,MAX=1",     "" },
 
 	
 	{ SSC_OUTPUT,       SSC_ARRAY,       "tcell",                      "Cell temperature",               "'C",     "",                   "CEC 6 Parameter PV Module Model",      "*",                       "LENGTH_EQUAL=poa_beam",                          "" },
@@ -112,6 +114,7 @@ public:
 		mod.Rs = as_double("Rs");
 		mod.Rsh = as_double("Rsh");
 		mod.Adj = as_double("Adj");
+		mod.UseLambertW = as_integer("module_mpp_solver") == 1;
 
 		noct_celltemp_t tc;
 		tc.Tnoct = as_double("tnoct");
@@ -147,35 +150,48 @@ public:
 		ssc_number_t *p_eff = allocate("eff", arr_len);
 		ssc_number_t *p_dc = allocate("dc", arr_len);
 
+		// cell temperatures first, then the electrical model for all records in one batch
+		std::vector<pvinput_t> in( arr_len );
+		std::vector<pvoutput_t> out( arr_len );
+		std::vector<double> tcell( arr_len ), opv;
+		if ( opvoltage != 0 )
+			opv.assign( opvoltage, opvoltage + arr_len );
+
 		for (size_t i = 0; i < arr_len; i++ )
 		{
-			pvinput_t in;
-			in.Ibeam = (double) p_poabeam[i];
-			in.Idiff = (double) p_poaskydiff[i];
-			in.Ignd = (double) p_poagnddiff[i];
-			in.Tdry = (double) p_tdry[i];
-			in.Wspd = (double) p_wspd[i];
-			in.Wdir = (double) p_wdir[i];
-			in.Zenith = (double) p_zen[i];
-			in.IncAng = (double) p_inc[i];
-			in.Elev = site_elevation;
-			in.Tilt = (double) p_stilt[i];
-
-			pvoutput_t out;
-
-			double opv = -1; // by default, calculate MPPT
+			in[i].Ibeam = (double) p_poabeam[i];
+			in[i].Idiff = (double) p_poaskydiff[i];
+			in[i].Ignd = (double) p_poagnddiff[i];
+			in[i].Tdry = (double) p_tdry[i];
+			in[i].Wspd = (double) p_wspd[i];
+			in[i].Wdir = (double) p_wdir[i];
+			in[i].Zenith = (double) p_zen[i];
+			in[i].IncAng = (double) p_inc[i];
+			in[i].Elev = site_elevation;
+			in[i].Tilt = (double) p_stilt[i];
+
+			double v = -1; // by default, calculate MPPT
 			if ( opvoltage != 0 )
-				opv = opvoltage[i];
+				v = opvoltage[i];
 
-			double tcell = in.Tdry;
-			if (! tc( in, mod, opv, tcell ) ) throw general_error("error calculating cell temperature", (float)i);
-			if (! mod( in, tcell, opv, out ) ) throw general_error( "error calculating module power and temperature with given parameters", (float) i);
+			tcell[i] = in[i].Tdry;
+			if (! tc( in[i], mod, v, tcell[i] ) ) throw general_error("error calculating cell temperature", (float)i);
+		}
 
-			p_tcell[i] = (ssc_number_t)out.CellTemp;
-			p_volt[i] = (ssc_number_t)out.Voltage;
-			p_amp[i] = (ssc_number_t)out.Current;
-			p_eff[i] = (ssc_number_t)out.Efficiency;
-			p_dc[i] = (ssc_number_t)out.Power;
+		if (! mod.evaluate( arr_len, in.data(), tcell.data(), opv.empty() ? 0 : opv.data(), out.data() ) )
+		{
+			for (size_t i = 0; i < arr_len; i++ )
+				if ( !(out[i].Power >= 0) )
+					throw general_error( "error calculating module power and temperature with given parameters", (float) i);
+		}
+
+		for (size_t i = 0; i < arr_len; i++ )
+		{
+			p_tcell[i] = (ssc_number_t)out[i].CellTemp;
+			p_volt[i] = (ssc_number_t)out[i].Voltage;
+			p_amp[i] = (ssc_number_t)out[i].Current;
+			p_eff[i] = (ssc_number_t)out[i].Efficiency;
+			p_dc[i] = (ssc_number_t)out[i].Power;
 		}
 	}
 };
@@ -188,6 +188,7 @@ static var_info _cm_vtab_pvsamv1[] = {
     
 		// module
     { SSC_INPUT, SSC_NUMBER,   "module_model",                         "Photovoltaic module model specifier",                 "",       "0=spe,1=cec,2=6par_user,3=snl,4=sd11-iec61853,5=PVYield",                                                                                                                               "Module",                                                "*",                                  "INTEGER,MIN=0,MAX=5", "" },
+    { SSC_INPUT, SSC_NUMBER,   "module_mpp_solver",                    "Module maximum power point solver",                   "",       "0=golden section search,1=explicit Lambert W",                                                                                                                                          "Module",                                                "?=0",                                "INTEGER,MIN=0,MAX=1", "" },
     { SSC_INPUT, SSC_NUMBER,   "module_aspect_ratio",                  "Module aspect ratio",                                 "",       "",                                                                                                                                                                                      "Layout",                                                "?=1.7",                              "POSITIVE",            "" },
     
 		// spe model
@@ -969,8 +970,8 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 		nameplate_kw += Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings * module_watts_stc * util::watt_to_kilowatt;
 	}
 
-	// Warning workaround
-	static bool is32BitLifetime = (__ARCHBITS__ == 32 && system_use_lifetime_output);
+	// Warning workaround; not static, since it depends on this run's inputs
+	bool is32BitLifetime = (__ARCHBITS__ == 32 && system_use_lifetime_output);
 	if (is32BitLifetime)
 		throw exec_error( "pvsamv1", "Lifetime simulation of PV systems is only available in the 64 bit version of SAM.");
 
@@ -1061,6 +1062,15 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 		std::vector<double> tmp;
 		dcStringVoltage.push_back(tmp);
 	}
+
+	// sun position, incidence angles, transposition and rear-side irradiance depend only on the weather file
+	// and the array geometry, so lifetime simulations calculate them in the first year and reuse them after.
+	// POA input decomposition carries state from step to step and is always recalculated.
+	bool use_irradiance_cache = (nyears > 1 && radmode != irrad::POA_R && radmode != irrad::POA_P);
+	pv_irradiance_cache_t irradianceCache;
+	if (use_irradiance_cache)
+		irradianceCache.init(nrec, num_subarrays);
+
 	for (size_t iyear = 0; iyear < nyears; iyear++)
 	{
 		for (hour = 0; hour < 8760; hour++)
@@ -1148,45 +1158,6 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 						|| Subarrays[nn]->nStrings < 1)
 						continue; // skip disabled subarrays
 
-					irrad irr(Irradiance->weatherRecord, Irradiance->weatherHeader,
-						Irradiance->skyModel, Irradiance->radiationMode, Subarrays[nn]->trackMode,
-						Irradiance->useWeatherFileAlbedo, Irradiance->instantaneous, Subarrays[nn]->backtrackingEnabled,
-						Irradiance->dtHour, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->trackerRotationLimitDegrees, Subarrays[nn]->groundCoverageRatio,
-						Subarrays[nn]->monthlyTiltDegrees, Irradiance->userSpecifiedMonthlyAlbedo,
-						Subarrays[nn]->poa.poaAll.get());
-											
-					int code = irr.calc();
-
-					if (code < 0) //jmf updated 11/30/18 so that negative numbers are errors, positive numbers are warnings, 0 is everything correct. implemented in patch for POA model only, will be added to develop for other irrad models as well
-						throw exec_error("pvsamv1",
-						util::format("failed to calculate irradiance incident on surface (POA) %d (code: %d) [y:%d m:%d d:%d h:%d]",
-						nn + 1, code, wf.year, wf.month, wf.day, wf.hour));
-
-					if (code == 40)
-						log(util::format("SAM calculated negative direct normal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
-							wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-					else if (code == 41)
-						log(util::format("SAM calculated negative diffuse horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
-							wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-					else if (code == 42)
-						log(util::format("SAM calculated negative global horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
-							wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-									   					 
-					// p_irrad_calc is only weather file records long...
-					if (iyear == 0)
-					{
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P) {
-							double gh_temp, df_temp, dn_temp;
-							gh_temp = df_temp = dn_temp = 0;
-							irr.get_irrad(&gh_temp, &dn_temp, &df_temp);
-							Irradiance->p_IrradianceCalculated[1][idx] = (ssc_number_t)df_temp;
-							Irradiance->p_IrradianceCalculated[2][idx] = (ssc_number_t)dn_temp;
-						}
-					}
-					// beam, skydiff, and grounddiff IN THE PLANE OF ARRAY (W/m2)
-					double ibeam, iskydiff, ignddiff;
-					double aoi, stilt, sazi, rot, btd;
-
 					// Ensure that the usePOAFromWF flag is false unless a reference cell has been used. 
 					//  This will later get forced to false if any shading has been applied (in any scenario)
 					//  also this will also be forced to false if using the cec mcsp thermal model OR if using the spe module model with a diffuse util. factor < 1.0
@@ -1211,15 +1182,75 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 							log("The combination of POA irradiance as input and heat transfer method for cell temperature means that SAM must use a POA decomposition model to calculate the beam irradiance required by the cell temperature model", SSC_WARNING);
 					}
 
+					// beam, skydiff, and grounddiff IN THE PLANE OF ARRAY (W/m2)
+					double ibeam, iskydiff, ignddiff;
+					double aoi, stilt, sazi, rot, btd;
 
-					// Get Incident angles and irradiances
-					irr.get_sun(&solazi, &solzen, &solalt, 0, 0, 0, &sunup, 0, 0, 0);
-					irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
-					irr.get_poa(&ibeam, &iskydiff, &ignddiff, 0, 0, 0);
-					alb = irr.getAlbedo();
+					if (use_irradiance_cache && iyear > 0)
+					{
+						irradianceCache.get(idx % nrec, nn, solazi, solzen, solalt, sunup, aoi, stilt, sazi, rot, btd, ibeam, iskydiff, ignddiff, alb, ipoa_rear[nn]);
+					}
+					else
+					{
+						irrad irr(Irradiance->weatherRecord, Irradiance->weatherHeader,
+							Irradiance->skyModel, Irradiance->radiationMode, Subarrays[nn]->trackMode,
+							Irradiance->useWeatherFileAlbedo, Irradiance->instantaneous, Subarrays[nn]->backtrackingEnabled,
+							Irradiance->dtHour, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->trackerRotationLimitDegrees, Subarrays[nn]->groundCoverageRatio,
+							Subarrays[nn]->monthlyTiltDegrees, Irradiance->userSpecifiedMonthlyAlbedo,
+							Subarrays[nn]->poa.poaAll.get());
+
+						int code = irr.calc();
+
+						if (code < 0) //jmf updated 11/30/18 so that negative numbers are errors, positive numbers are warnings, 0 is everything correct. implemented in patch for POA model only, will be added to develop for other irrad models as well
+							throw exec_error("pvsamv1",
+							util::format("failed to calculate irradiance incident on surface (POA) %d (code: %d) [y:%d m:%d d:%d h:%d]",
+							nn + 1, code, wf.year, wf.month, wf.day, wf.hour));
+
+						if (code == 40)
+							log(util::format("SAM calculated negative direct normal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+								wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+						else if (code == 41)
+							log(util::format("SAM calculated negative diffuse horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+								wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+						else if (code == 42)
+							log(util::format("SAM calculated negative global horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
+								wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+
+						// p_irrad_calc is only weather file records long...
+						if (iyear == 0)
+						{
+							if (radmode == irrad::POA_R || radmode == irrad::POA_P) {
+								double gh_temp, df_temp, dn_temp;
+								gh_temp = df_temp = dn_temp = 0;
+								irr.get_irrad(&gh_temp, &dn_temp, &df_temp);
+								Irradiance->p_IrradianceCalculated[1][idx] = (ssc_number_t)df_temp;
+								Irradiance->p_IrradianceCalculated[2][idx] = (ssc_number_t)dn_temp;
+							}
+						}
 
-					if (iyear == 0)
-						Irradiance->p_sunPositionTime[idx] = (ssc_number_t)irr.get_sunpos_calc_hour();
+						// Get Incident angles and irradiances
+						irr.get_sun(&solazi, &solzen, &solalt, 0, 0, 0, &sunup, 0, 0, 0);
+						irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
+						irr.get_poa(&ibeam, &iskydiff, &ignddiff, 0, 0, 0);
+						alb = irr.getAlbedo();
+
+						if (iyear == 0)
+							Irradiance->p_sunPositionTime[idx] = (ssc_number_t)irr.get_sunpos_calc_hour();
+
+						// Calculate rear-side irradiance for bifacial modules
+						if (Subarrays[0]->Module->isBifacial)
+						{
+							double slopeLength = Subarrays[nn]->selfShadingInputs.length * Subarrays[nn]->selfShadingInputs.nmody;
+							if (Subarrays[nn]->selfShadingInputs.mod_orient == 1) {
+								slopeLength = Subarrays[nn]->selfShadingInputs.width * Subarrays[nn]->selfShadingInputs.nmody;
+							}
+							irr.calc_rear_side(Subarrays[0]->Module->bifacialTransmissionFactor, Subarrays[0]->Module->groundClearanceHeight, slopeLength);
+							ipoa_rear[nn] = irr.get_poa_rear();
+						}
+
+						if (use_irradiance_cache)
+							irradianceCache.set(idx, nn, solazi, solzen, solalt, sunup, aoi, stilt, sazi, rot, btd, ibeam, iskydiff, ignddiff, alb, ipoa_rear[nn]);
+					}
 
 					// save weather file beam, diffuse, and global for output and for use later in pvsamv1- year 1 only
 					/*jmf 2016: these calculations are currently redundant with calculations in irrad.calc() because ibeam and idiff in that function are DNI and DHI, **NOT** in the plane of array
@@ -1502,16 +1533,10 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 					ipoa_front[nn] = ibeam + iskydiff + ignddiff;
 					ts_accum_poa_front_shaded_soiled += ipoa_front[nn] * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 					
-					// Calculate rear-side irradiance for bifacial modules
+					// Apply losses to rear-side irradiance for bifacial modules
 					if (Subarrays[0]->Module->isBifacial)
 					{
 						bifaciality = Subarrays[0]->Module->bifaciality;
-						double slopeLength = Subarrays[nn]->selfShadingInputs.length * Subarrays[nn]->selfShadingInputs.nmody;
-						if (Subarrays[nn]->selfShadingInputs.mod_orient == 1) {
-							slopeLength = Subarrays[nn]->selfShadingInputs.width * Subarrays[nn]->selfShadingInputs.nmody;
-						}
-						irr.calc_rear_side(Subarrays[0]->Module->bifacialTransmissionFactor, Subarrays[0]->Module->groundClearanceHeight, slopeLength);
-						ipoa_rear[nn] = irr.get_poa_rear();
 						ipoa_rear_after_losses[nn] = ipoa_rear[nn] * (1 - Subarrays[nn]->rearIrradianceLossPercent);
 					}
 
@@ -2703,4 +2728,4 @@ void cm_pvsamv1::inverter_size_check()
 			SSC_WARNING);
 }
 
-DEFINE_MODULE_ENTRY( pvsamv1, "Photovoltaic performance model, SAM component models V.1", 1 )
+DEFINE_THREAD_SAFE_MODULE_ENTRY( pvsamv1, "Photovoltaic performance model, SAM component models V.1", 1 )
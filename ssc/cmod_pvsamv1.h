@@ -55,6 +55,58 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // comment following define if do not want shading database validation outputs
 //#define SHADE_DB_OUTPUTS
 
+/**
+* Year-invariant irradiance results, used by lifetime simulations to skip the sun position, incidence and transposition models after the first year
+* Sun position and albedo are the same for every subarray and are stored once per weather file record. Surface angles and plane-of-array
+* irradiance are stored per subarray for sun-up records only, since irrad::calc leaves them zero while the sun is down.
+*/
+class pv_irradiance_cache_t
+{
+	struct sun_record { double solazi, solzen, solalt, alb; int sunup; };
+	struct surface_record { double aoi, stilt, sazi, rot, btd, ibeam, iskydiff, ignddiff, poa_rear; };
+
+	std::vector<sun_record> m_sun;							// per record
+	std::vector<int> m_daylight_index;						// per record, position in the surface records, -1 while the sun is down
+	std::vector< std::vector<surface_record> > m_surface;	// per subarray, sun-up records in order
+
+public:
+	void init(size_t nrec, size_t nsubarrays)
+	{
+		m_sun.resize(nrec);
+		m_daylight_index.assign(nrec, -1);
+		m_surface.resize(nsubarrays);
+	}
+
+	/// Stores record i for subarray nn; records must be stored in order, and every enabled subarray stores every record
+	void set(size_t i, size_t nn, double solazi, double solzen, double solalt, int sunup, double aoi, double stilt, double sazi, double rot, double btd,
+		double ibeam, double iskydiff, double ignddiff, double alb, double poa_rear)
+	{
+		sun_record s = { solazi, solzen, solalt, alb, sunup };
+		m_sun[i] = s;
+		if (sunup > 0)
+		{
+			m_daylight_index[i] = (int)m_surface[nn].size();
+			surface_record r = { aoi, stilt, sazi, rot, btd, ibeam, iskydiff, ignddiff, poa_rear };
+			m_surface[nn].push_back(r);
+		}
+	}
+
+	void get(size_t i, size_t nn, double &solazi, double &solzen, double &solalt, int &sunup, double &aoi, double &stilt, double &sazi, double &rot, double &btd,
+		double &ibeam, double &iskydiff, double &ignddiff, double &alb, double &poa_rear) const
+	{
+		const sun_record &s = m_sun[i];
+		solazi = s.solazi; solzen = s.solzen; solalt = s.solalt; alb = s.alb; sunup = s.sunup;
+		if (m_daylight_index[i] >= 0)
+		{
+			const surface_record &r = m_surface[nn][m_daylight_index[i]];
+			aoi = r.aoi; stilt = r.stilt; sazi = r.sazi; rot = r.rot; btd = r.btd;
+			ibeam = r.ibeam; iskydiff = r.iskydiff; ignddiff = r.ignddiff; poa_rear = r.poa_rear;
+		}
+		else
+			aoi = stilt = sazi = rot = btd = ibeam = iskydiff = ignddiff = poa_rear = 0;
+	}
+};
+
 /**
 * Detailed photovoltaic model in SAM, version 1
 * Contains calculations to process a weather file, parse the irradiance, and evaluate PV subarray power production with AC or DC connected batteries
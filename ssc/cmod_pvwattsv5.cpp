@@ -239,6 +239,61 @@ public:
         return code;
     }
 
+    /* computes the sun position and plane-of-array irradiance for every record of the weather data at once,
+       since none of it depends on state carried between time steps. leaves the weather data rewound */
+    void process_irradiance_series(weather_data_provider *wdprov, const weather_header &hdr, size_t nrec, double ts_hour,
+                                   irrad_series &series)
+    {
+        std::vector<int> year(nrec), month(nrec), day(nrec), hour(nrec);
+        std::vector<double> minute(nrec), dn(nrec), df(nrec), alb(nrec);
+        weather_record wf;
+        for (size_t i = 0; i < nrec; i++)
+        {
+            if (!wdprov->read(&wf))
+                throw exec_error("pvwattsv5", util::format("could not read data line %d of %d in weather file", (int)(i + 1), (int)nrec));
+
+            year[i] = wf.year;
+            month[i] = wf.month;
+            day[i] = wf.day;
+            hour[i] = wf.hour;
+            minute[i] = wf.minute;
+            dn[i] = wf.dn;
+            df[i] = wf.df;
+
+            alb[i] = 0.2; // do not increase albedo if snow exists in TMY2
+            if (std::isfinite(wf.alb) && wf.alb > 0 && wf.alb < 1)
+                alb[i] = wf.alb;
+        }
+        wdprov->rewind();
+
+        series.set_location(hdr.lat, hdr.lon, hdr.tz);
+        series.set_sky_model(irrad::PEREZ);
+        series.set_surface(track_mode, tilt, azimuth, 45.0,
+                           shade_mode_1x == 1, // backtracking mode
+                           gcr);
+        series.calc(nrec, &year[0], &month[0], &day[0], &hour[0], &minute[0], ts_hour,
+                    irrad::DN_DF, &dn[0], &df[0], 0, &alb[0]);
+    }
+
+    /* loads the results of process_irradiance_series() for one record, in place of process_irradiance() */
+    int load_irradiance(const irrad_series &series, size_t idx)
+    {
+        solazi = series.solazi[idx];
+        solzen = series.solzen[idx];
+        solalt = series.solelv[idx];
+        sunup = series.sunup[idx];
+        aoi = series.aoi[idx];
+        stilt = series.surftilt[idx];
+        sazi = series.surfazi[idx];
+        rot = series.axisrot[idx];
+        btd = series.btdiff[idx];
+        ibeam = series.poa_beam[idx];
+        iskydiff = series.poa_skydiff[idx];
+        ignddiff = series.poa_gnddiff[idx];
+
+        return series.code[idx];
+    }
+
 	void powerout(double time, double &shad_beam, double shad_diff, double dni, double dhi, double alb, double wspd, double tdry)
 	{
 
@@ -473,6 +528,11 @@ public:
 
         initialize_cell_temp(ts_hour);
 
+        // irradiance is the same every year, so it is computed once for all records up front
+        irrad_series irr_series;
+        process_irradiance_series(wdprov.get(), hdr, nrec,
+                                  instantaneous ? IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET : ts_hour, irr_series);
+
         double annual_kwh = 0;
 
         size_t idx_life = 0;
@@ -509,9 +569,7 @@ public:
                     if (std::isfinite(wf.alb) && wf.alb > 0 && wf.alb < 1)
                         alb = wf.alb;
 
-                    int code = process_irradiance(wf.year, wf.month, wf.day, wf.hour, wf.minute,
-                                                  instantaneous ? IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET : ts_hour,
-                                                  hdr.lat, hdr.lon, hdr.tz, wf.dn, wf.df, alb);
+                    int code = load_irradiance(irr_series, idx);
 
                     if (-1 == code)
                     {
@@ -594,7 +652,7 @@ public:
     }
 };
 
-DEFINE_MODULE_ENTRY( pvwattsv5, "PVWatts V5 - integrated hourly weather reader and PV system simulator.", 3 )
+DEFINE_THREAD_SAFE_MODULE_ENTRY( pvwattsv5, "PVWatts V5 - integrated hourly weather reader and PV system simulator.", 3 )
 
 
 
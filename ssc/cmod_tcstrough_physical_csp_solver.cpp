@@ -325,6 +325,7 @@ static var_info _cm_vtab_trough_physical_csp_solver[] = {
     { SSC_OUTPUT,       SSC_ARRAY,       "disp_presolve_nconstr","Dispatch number of constraints in problem",                    "",             "",            "tou",            ""                       "",            "" }, 
     { SSC_OUTPUT,       SSC_ARRAY,       "disp_presolve_nvar",   "Dispatch number of variables in problem",                      "",             "",            "tou",            ""                       "",            "" }, 
     { SSC_OUTPUT,       SSC_ARRAY,       "disp_solve_time",      "Dispatch solver time",                                         "sec",          "",            "tou",            ""                       "",            "" }, 
+    { SSC_OUTPUT,       SSC_ARRAY,       "disp_build_time",      "Dispatch build time",                                          "sec",          "",            "tou",            ""                       "",            "" }, 
 
 
 			// These outputs correspond to the first csp-solver timestep in the reporting timestep.
@@ -359,6 +360,7 @@ static var_info _cm_vtab_trough_physical_csp_solver[] = {
     { SSC_OUTPUT,       SSC_NUMBER,      "disp_presolve_nconstr_ann",  "Annual sum of dispatch problem constraint count",       "",            "",             "",               "",                       "",           "" },
     { SSC_OUTPUT,       SSC_NUMBER,      "disp_presolve_nvar_ann",  "Annual sum of dispatch problem variable count",            "",            "",             "",               "",                       "",           "" },
     { SSC_OUTPUT,       SSC_NUMBER,      "disp_solve_time_ann",  "Annual sum of dispatch solver time",                          "",            "",             "",               "",                       "",           "" },
+    { SSC_OUTPUT,       SSC_NUMBER,      "disp_build_time_ann",  "Annual sum of dispatch build time",                           "",            "",             "",               "",                       "",           "" },
 
 
 	var_info_invalid };
@@ -925,6 +927,7 @@ public:
 		csp_solver.mc_reported_outputs.assign(C_csp_solver::C_solver_outputs::DISPATCH_PRES_NCONSTR, allocate("disp_presolve_nconstr", n_steps_fixed), n_steps_fixed);
 		csp_solver.mc_reported_outputs.assign(C_csp_solver::C_solver_outputs::DISPATCH_PRES_NVAR, allocate("disp_presolve_nvar", n_steps_fixed), n_steps_fixed);
 		csp_solver.mc_reported_outputs.assign(C_csp_solver::C_solver_outputs::DISPATCH_SOLVE_TIME, allocate("disp_solve_time", n_steps_fixed), n_steps_fixed);
+		csp_solver.mc_reported_outputs.assign(C_csp_solver::C_solver_outputs::DISPATCH_BUILD_TIME, allocate("disp_build_time", n_steps_fixed), n_steps_fixed);
 
 		csp_solver.mc_reported_outputs.assign(C_csp_solver::C_solver_outputs::SOLZEN, allocate("solzen", n_steps_fixed), n_steps_fixed);
 		csp_solver.mc_reported_outputs.assign(C_csp_solver::C_solver_outputs::SOLAZ, allocate("solaz", n_steps_fixed), n_steps_fixed);
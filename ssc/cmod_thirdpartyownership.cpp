@@ -107,7 +107,7 @@ enum {
 class cm_thirdpartyownership : public compute_module
 {
 private:
-	util::matrix_t<double> cf;
+	cashflow_table cf;
 	hourly_energy_calculation hourly_energy_calcs;
 
 public:
@@ -310,17 +310,15 @@ public:
 
 		save_cf( CF_payback_with_expenses, nyears, "cf_payback_with_expenses" );
 		save_cf( CF_cumulative_payback_with_expenses, nyears, "cf_cumulative_payback_with_expenses" );
-	
 
+		cf.export_outputs(this);
 	}
 
 /* These functions can be placed in common financial library with matrix and constants passed? */
 
 	void save_cf(int cf_line, size_t nyears, const std::string &name)
 	{
-		ssc_number_t *arrp = allocate( name, nyears+1 );
-		for (size_t i=0;i<=nyears;i++)
-			arrp[i] = (ssc_number_t)cf.at(cf_line, i);
+		cf.save(cf_line, nyears, name);
 	}
 
 	double npv( size_t cf_line, size_t nyears, double rate ) throw ( general_error )
@@ -38,6 +38,83 @@ void save_cf(compute_module *cm, util::matrix_t<double>& mat, int cf_line, int m
 		arrp[i] = (ssc_number_t)mat.at(cf_line, i);
 }
 
+cashflow_table::cashflow_table()
+	: m_ncols(0), m_fill(0.0)
+{
+}
+
+cashflow_table::~cashflow_table()
+{
+	free_lines();
+}
+
+void cashflow_table::free_lines()
+{
+	for (size_t i = 0; i < m_lines.size(); i++)
+		delete[] m_lines[i];
+	m_lines.clear();
+	m_saved.clear();
+}
+
+void cashflow_table::resize_fill(size_t nlines, size_t ncols, double val)
+{
+	free_lines();
+	m_lines.assign(nlines, (double*)0);
+	m_ncols = ncols;
+	m_fill = val;
+}
+
+double *cashflow_table::allocate_line(size_t line)
+{
+	double *p = new double[m_ncols];
+	for (size_t i = 0; i < m_ncols; i++)
+		p[i] = m_fill;
+	m_lines[line] = p;
+	return p;
+}
+
+void cashflow_table::save(size_t line, size_t nyears, const std::string &name)
+{
+	saved_line sl;
+	sl.line = line;
+	sl.length = nyears + 1;
+	sl.name = name;
+	m_saved.push_back(sl);
+}
+
+void cashflow_table::export_outputs(compute_module *cm)
+{
+	// the last output saved from a line takes over its array, earlier ones (and outputs the caller
+	// asked to have written into its own storage) get a copy
+	std::vector<size_t> last_use(m_lines.size(), m_saved.size());
+	for (size_t k = 0; k < m_saved.size(); k++)
+		last_use[m_saved[k].line] = k;
+
+	for (size_t k = 0; k < m_saved.size(); k++)
+	{
+		const saved_line &sl = m_saved[k];
+		double *p = m_lines[sl.line];
+		if (!p) p = allocate_line(sl.line);
+
+		var_data *v = cm->lookup(sl.name);
+		bool borrowed = (v && v->type == SSC_ARRAY && v->num.is_borrowed() && v->num.ncols() == sl.length);
+		if (last_use[sl.line] == k && sl.length <= m_ncols && !borrowed)
+		{
+			v = cm->assign(sl.name, var_data());
+			v->type = SSC_ARRAY;
+			v->num.adopt(p, 1, sl.length);
+			m_lines[sl.line] = 0;
+		}
+		else
+		{
+			ssc_number_t *arrp = cm->allocate(sl.name, sl.length);
+			for (size_t i = 0; i < sl.length && i < m_ncols; i++)
+				arrp[i] = (ssc_number_t)p[i];
+		}
+	}
+	free_lines();
+}
+
 
 
 enum {
@@ -251,6 +328,39 @@ enum {
 //	var_info_invalid };
 
 
+ppa_linear_solution::ppa_linear_solution()
+	: m_n(0), m_trial(false), m_ppa_resume(0)
+{
+	m_ppa[0] = m_ppa[1] = 0;
+	m_npv[0] = m_npv[1] = 0;
+}
+
+bool ppa_linear_solution::next(double ppa_searched, double npv_target, double &ppa)
+{
+	if (m_n >= 2) return false;
+	m_ppa[m_n] = ppa_searched;
+	m_npv[m_n] = npv_target;
+	if (++m_n < 2) return false;
+
+	// npv = base + slope * ppa, increasing with the price
+	if (m_ppa[1] == m_ppa[0]) return false;
+	double npv_slope = (m_npv[1] - m_npv[0]) / (m_ppa[1] - m_ppa[0]);
+	if (!(npv_slope > 0)) return false;
+	double ppa_linear = m_ppa[1] - m_npv[1] / npv_slope;
+	if (!(ppa_linear >= 0) || !(ppa_linear < DBL_MAX)) return false;
+
+	m_ppa_resume = ppa;
+	ppa = ppa_linear;
+	m_trial = true;
+	return true;
+}
+
+double ppa_linear_solution::resume()
+{
+	m_trial = false;
+	return m_ppa_resume;
+}
+
 dispatch_calculations::dispatch_calculations(compute_module *cm, std::vector<double>& degradation, std::vector<double>& hourly_energy)
 {
 	init(cm, degradation, hourly_energy);
@@ -30,6 +30,87 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 void save_cf(compute_module *cm, util::matrix_t<double>& mat, int cf_line, int nyears, const std::string &name);
 
 
+/**
+*  Yearly cash flow lines of a financial compute module, used like a CF_max by nyears+1 matrix.
+*  Each line is a separate contiguous array allocated the first time it is used, so lines a
+*  configuration never touches cost nothing.  save() only records which lines are outputs and
+*  export_outputs() hands each recorded line's array to the var_table without copying it, so
+*  the table is emptied by the export and should be the last thing done in exec().
+*/
+class cashflow_table
+{
+public:
+	cashflow_table();
+	~cashflow_table();
+
+	void resize_fill(size_t nlines, size_t ncols, double val);
+	size_t nrows() const { return m_lines.size(); }
+	size_t ncols() const { return m_ncols; }
+
+	inline double &at(size_t line, size_t col)
+	{
+		double *p = m_lines[line];
+		if (!p) p = allocate_line(line);
+		return p[col];
+	}
+
+	/// record years 0..nyears of a line as the output array name
+	void save(size_t line, size_t nyears, const std::string &name);
+	/// assign the recorded output arrays to the module's var_table
+	void export_outputs(compute_module *cm);
+
+private:
+	cashflow_table(const cashflow_table &);
+	cashflow_table &operator=(const cashflow_table &);
+
+	double *allocate_line(size_t line);
+	void free_lines();
+
+	struct saved_line
+	{
+		size_t line;
+		size_t length;
+		std::string name;
+	};
+
+	std::vector<double*> m_lines;
+	std::vector<saved_line> m_saved;
+	size_t m_ncols;
+	double m_fill;
+};
+
+
+
+/**
+*  Direct solution for the ppa price.  Revenue is linear in the ppa price, so the cash flow is a ppa
+*  independent base plus a part proportional to the price, as long as the price does not move a piecewise
+*  term such as the flip year, a debt size limit or a tax allocation.  The target year npv is then linear in
+*  the price too, and the price that zeroes it follows from the npv at the first two prices of the interval
+*  search.  That price is evaluated once, out of turn, and the search resumes where it was if it misses.
+*/
+class ppa_linear_solution
+{
+public:
+	ppa_linear_solution();
+
+	/// record the target npv at a price of the interval search; once two are known, replace the next
+	/// price of the search, ppa, with the linear solution and return true
+	bool next(double ppa_searched, double npv_target, double &ppa);
+
+	/// the current iteration evaluates the linear solution
+	bool is_trial() const { return m_trial; }
+
+	/// end a trial that missed the target, returns the next price of the interval search
+	double resume();
+
+private:
+	double m_ppa[2];
+	double m_npv[2];
+	int m_n;
+	bool m_trial;
+	double m_ppa_resume;
+};
+
 
 class dispatch_calculations
 {
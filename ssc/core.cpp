@@ -30,7 +30,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 const var_info var_info_invalid = {	0, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
 
 compute_module::compute_module( )
-	:  m_infomap(NULL), m_handler(NULL), m_vartab(NULL)
+	:  m_infomap(NULL), m_handler(NULL), m_vartab(NULL), m_handle_generation(0)
 {
 	/* nothing to do */
 }
@@ -58,6 +58,7 @@ bool compute_module::compute( handler_interface *handler, var_table *data )
 		return false;
 	}
 	m_vartab = data;
+	reset_handle_data();
 
 	if (m_varlist.size() == 0)
 	{
@@ -81,18 +82,19 @@ bool compute_module::compute( handler_interface *handler, var_table *data )
 
 bool compute_module::verify(const std::string &phase, int check_var_type)
 {
-	std::vector< var_info* >::iterator it;
-	for (it=m_varlist.begin();it!=m_varlist.end();++it)
+	for (size_t i=0;i<m_varlist.size();i++)
 	{
-		var_info *vi = *it;
+		var_info *vi = m_varlist[i];
 		if ( vi->var_type == check_var_type
 			|| vi->var_type == SSC_INOUT )
 		{
-			if ( check_required( vi->name ) )
+			// a name listed in more than one table is checked against its first entry, as info() does
+			const var_info &inf = *m_handle_info[ m_varhandles[i].index ];
+			if ( check_required( inf ) )
 			{
 				// if the variable is required, make sure it exists
 				// and that it is of the correct data type
-				var_data *dat = lookup( vi->name );
+				var_data *dat = lookup( m_varhandles[i] );
 				if (!dat)
 				{
 					log(phase + ": variable '" + std::string(vi->name) + "' required but not assigned");
@@ -106,7 +108,7 @@ bool compute_module::verify(const std::string &phase, int check_var_type)
 
 				// now check constraints on it
 				std::string fail_text;
-				if (!check_constraints( vi->name, fail_text ))
+				if (!check_constraints( inf, *dat, fail_text ))
 				{
 					log(fail_text, SSC_ERROR);
 					return false;
@@ -124,7 +126,10 @@ void compute_module::add_var_info( var_info vi[] )
 	while ( vi[i].data_type != SSC_INVALID
 		&& vi[i].name != NULL )
 	{
+		var_handle h = handle( vi[i].name );
 		m_varlist.push_back( &vi[i] );
+		m_varhandles.push_back( h );
+		if ( !m_handle_info[h.index] ) m_handle_info[h.index] = &vi[i];
 		i++;
 	}
 }
@@ -135,9 +140,21 @@ void compute_module::remove_var_info(var_info vi[])
 	while (vi[i].data_type != SSC_INVALID
 		&& vi[i].name != NULL)
 	{
-		m_varlist.erase(std::remove(m_varlist.begin(), m_varlist.end(), &vi[i]), m_varlist.end());
+		for (size_t k = m_varlist.size(); k > 0; k--)
+		{
+			if (m_varlist[k-1] == &vi[i])
+			{
+				m_varlist.erase(m_varlist.begin() + (k-1));
+				m_varhandles.erase(m_varhandles.begin() + (k-1));
+			}
+		}
 		i++;
 	}
+
+	std::fill( m_handle_info.begin(), m_handle_info.end(), (var_info*)NULL );
+	for (size_t k = 0; k < m_varlist.size(); k++)
+		if ( !m_handle_info[ m_varhandles[k].index ] )
+			m_handle_info[ m_varhandles[k].index ] = m_varlist[k];
 }
 
 void compute_module::build_info_map()
@@ -249,33 +266,127 @@ var_data *compute_module::lookup( const std::string &name )
 	return m_vartab->lookup(name);
 }
 
+var_handle compute_module::handle( const std::string &name )
+{
+	std::string lname = util::lower_case( name );
+	unordered_map< std::string, size_t >::iterator it = m_handle_index.find( lname );
+	if ( it != m_handle_index.end() )
+		return var_handle( it->second );
+
+	size_t index = m_handle_names.size();
+	m_handle_names.push_back( lname );
+	m_handle_data.push_back( NULL );
+	m_handle_info.push_back( NULL );
+	m_handle_index[ lname ] = index;
+	return var_handle( index );
+}
+
+void compute_module::reset_handle_data()
+{
+	std::fill( m_handle_data.begin(), m_handle_data.end(), (var_data*)NULL );
+	m_handle_generation = m_vartab ? m_vartab->generation() : 0;
+}
+
+var_data *compute_module::lookup( var_handle h )
+{
+	if (!m_vartab) throw general_error("invalid data container object reference");
+	if (h.index >= m_handle_names.size()) throw general_error("invalid variable handle");
+
+	// resolved pointers stay valid until data is removed from the table
+	if (m_handle_generation != m_vartab->generation())
+		reset_handle_data();
+
+	var_data *&v = m_handle_data[h.index];
+	if (!v) v = m_vartab->lookup( m_handle_names[h.index] );
+	return v;
+}
+
+var_data &compute_module::value( var_handle h )
+{
+	var_data *v = lookup( h );
+	if (!v){
+		throw general_error("ssc variable does not exist: '" + m_handle_names[h.index] + "'");
+	}
+	return (*v);
+}
+
+bool compute_module::is_assigned( var_handle h )
+{
+	return (lookup(h) != 0);
+}
+
+int compute_module::as_integer( var_handle h )
+{
+	var_data &x = value(h);
+	if (x.type != SSC_NUMBER) throw cast_error("integer", x, m_handle_names[h.index]);
+	return (int) x.num;
+}
+
+bool compute_module::as_boolean( var_handle h )
+{
+	var_data &x = value(h);
+	if (x.type != SSC_NUMBER) throw cast_error("boolean", x, m_handle_names[h.index]);
+	return (bool) ( (int)(x.num!=0) );
+}
+
+ssc_number_t compute_module::as_number( var_handle h )
+{
+	var_data &x = value(h);
+	if (x.type != SSC_NUMBER) throw cast_error("ssc_number_t", x, m_handle_names[h.index]);
+	return x.num;
+}
+
+double compute_module::as_double( var_handle h )
+{
+	var_data &x = value(h);
+	if (x.type != SSC_NUMBER) throw cast_error("double", x, m_handle_names[h.index]);
+	return (double) x.num;
+}
+
+ssc_number_t *compute_module::as_array( var_handle h, size_t *count )
+{
+	var_data &x = value(h);
+	if (x.type != SSC_ARRAY) throw cast_error("array", x, m_handle_names[h.index]);
+	if (count) *count = x.num.length();
+	return x.num.data();
+}
+
 var_data *compute_module::assign( const std::string &name, const var_data &value )
 {
 	if (!m_vartab) throw general_error("invalid data container object reference");
 	return m_vartab->assign( name, value );
 }
 
+var_data *compute_module::assign_output( const std::string &name, unsigned char type, size_t nrows, size_t ncols )
+{
+	// write into caller-provided storage (see ssc_data_set_array_ref) when it already has the
+	// requested shape, otherwise allocate a new value
+	var_data *v = lookup(name);
+	if ( !v || v->type != type || !v->num.is_borrowed()
+		|| v->num.nrows() != nrows || v->num.ncols() != ncols )
+	{
+		v = assign(name, var_data());
+		v->type = type;
+	}
+	v->num.resize_fill(nrows, ncols, 0.0);
+	return v;
+}
+
 ssc_number_t *compute_module::allocate( const std::string &name, size_t length )
 {
-	var_data *v = assign(name, var_data());
-	v->type = SSC_ARRAY;
-	v->num.resize_fill( length, 0.0 );
+	var_data *v = assign_output(name, SSC_ARRAY, 1, length);
 	return v->num.data();
 }
 
 ssc_number_t *compute_module::allocate( const std::string &name, size_t nrows, size_t ncols )
 {
-	var_data *v = assign(name, var_data());
-	v->type = SSC_MATRIX;
-	v->num.resize_fill(nrows, ncols, 0.0);
+	var_data *v = assign_output(name, SSC_MATRIX, nrows, ncols);
 	return v->num.data();
 }
 
 util::matrix_t<ssc_number_t>& compute_module::allocate_matrix( const std::string &name, size_t nrows, size_t ncols )
 {
-	var_data *v = assign(name, var_data());
-	v->type = SSC_MATRIX;
-	v->num.resize_fill(nrows, ncols, 0.0);
+	var_data *v = assign_output(name, SSC_MATRIX, nrows, ncols);
 	return v->num;
 }
 
@@ -510,12 +621,12 @@ ssc_number_t compute_module::get_operand_value( const std::string &input, const
 	}
 }
 
-bool compute_module::check_required( const std::string &name )
+bool compute_module::check_required( const var_info &inf )
 {
 	// only check if the variable is required as input to the simulation context
 	// if it is an input or an inout variable
 
-	const var_info &inf = info(name);
+	std::string name( inf.name );
 	if (inf.required_if == NULL || strlen(inf.required_if)==0)
 		return false;
 
@@ -667,15 +778,13 @@ bool compute_module::check_required( const std::string &name )
 	return false;
 }
 
-bool compute_module::check_constraints( const std::string &name, std::string &fail_text)
+bool compute_module::check_constraints( const var_info &inf, var_data &dat, std::string &fail_text)
 {
 #define fail_constraint( str ) { fail_text = "fail("+name+", "+expr+"): "+std::string(str); return false; }
 
-	const var_info &inf = info(name);
-
 	if (inf.constraints == NULL) return true; // pass if no constraints defined
 
-	var_data &dat = value(name);
+	std::string name( inf.name );
 	
 	std::vector< std::string > exprlist = util::split( inf.constraints, "," );
 	for ( std::vector<std::string>::iterator it=exprlist.begin(); it!=exprlist.end(); ++it )
@@ -113,6 +113,14 @@ struct var_info
 
 extern const var_info var_info_invalid;
 
+/* an interned variable name, returned by compute_module::handle() */
+struct var_handle
+{
+	var_handle() : index(0) { }
+	explicit var_handle( size_t i ) : index(i) { }
+	size_t index;
+};
+
 class handler_interface; // forward decl
 
 class compute_module
@@ -255,6 +263,19 @@ public:
 	util::matrix_t<double> as_matrix_transpose(const std::string & name);
 	bool get_matrix(const std::string &name, util::matrix_t<ssc_number_t> &mat);
 
+	/* interned variable names: resolve a name to a handle once, then use the handle in loops
+	   in place of the name to avoid hashing it on every access.  all names in the var_info
+	   tables are interned when the tables are added */
+	var_handle handle( const std::string &name );
+	var_data *lookup( var_handle h );
+	var_data &value( var_handle h );
+	bool is_assigned( var_handle h );
+	int as_integer( var_handle h );
+	bool as_boolean( var_handle h );
+	ssc_number_t as_number( var_handle h );
+	double as_double( var_handle h );
+	ssc_number_t *as_array( var_handle h, size_t *count );
+
 	size_t check_timestep_seconds( double t_start, double t_end, double t_step ) ;
 	
 	ssc_number_t accumulate_annual(const std::string &hourly_var, const std::string &annual_var, double scale=1.0);
@@ -267,15 +288,19 @@ private:
 	// called by 'compute' as necessary for precheck and postcheck
 	bool verify(const std::string &phase, int var_types);
 	
-	bool check_required( const std::string &name );
-	bool check_constraints( const std::string &name, std::string &fail_text );
+	bool check_required( const var_info &inf );
+	bool check_constraints( const var_info &inf, var_data &dat, std::string &fail_text );
 
 	// helper functions for check_required
 	ssc_number_t get_operand_value( const std::string &input, const std::string &cur_var_name );
 
+	// helper for allocate and allocate_matrix
+	var_data *assign_output( const std::string &name, unsigned char type, size_t nrows, size_t ncols );
+
 	var_data m_null_value;
 	
 	std::vector< var_info* > m_varlist;
+	std::vector< var_handle > m_varhandles; // handle of each entry in m_varlist
 	std::vector< log_item > m_loglist;
 	
 	unordered_map< std::string, var_info* > *m_infomap;
@@ -284,6 +309,14 @@ private:
 	  and are NULL otherwise */
 	handler_interface   *m_handler;
 	var_table           *m_vartab;
+
+	/* interned names, and the data each one resolved to in m_vartab */
+	std::vector< std::string > m_handle_names;
+	unordered_map< std::string, size_t > m_handle_index;
+	std::vector< var_data* > m_handle_data;
+	std::vector< var_info* > m_handle_info; // first var_info entry with each name, if any
+	unsigned int m_handle_generation;
+	void reset_handle_data();
 };
 
 
@@ -311,12 +344,20 @@ public:
 #define DEFINE_MODULE_ENTRY( name, desc, ver ) \
 	static compute_module *_create_ ## name () { return new cm_ ## name; } \
 	module_entry_info cm_entry_ ## name = { \
-		#name, desc, ver, _create_ ## name }; \
+		#name, desc, ver, _create_ ## name, 0 }; \
+
+/* for modules, and the libraries they call, that have been checked for process-wide mutable state
+   and may run concurrently in the same process */
+#define DEFINE_THREAD_SAFE_MODULE_ENTRY( name, desc, ver ) \
+	static compute_module *_create_ ## name () { return new cm_ ## name; } \
+	module_entry_info cm_entry_ ## name = { \
+		#name, desc, ver, _create_ ## name, 1 }; \
 
+/* tcs modules share the global type provider, so they are never run concurrently */
 #define DEFINE_TCS_MODULE_ENTRY( name, desc, ver ) \
 	static compute_module *_create_ ## name() { extern tcstypeprovider sg_tcsTypeProvider; return new cm_ ## name(&sg_tcsTypeProvider); } \
 	module_entry_info cm_entry_ ## name = { \
-		#name, desc, ver, _create_ ## name }; \
+		#name, desc, ver, _create_ ## name, 0 }; \
 
 struct module_entry_info
 {
@@ -324,6 +365,7 @@ struct module_entry_info
 	const char *description;
 	int version;
 	compute_module * (*f_create)();
+	int thread_safe; // 1 if instances may execute concurrently in the same process
 };
 
 
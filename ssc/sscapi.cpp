@@ -50,6 +50,11 @@
 #include <stdio.h>
 #include <cstring>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <system_error>
+#include <thread>
 
 #include "core.h"
 #include "sscapi.h"
@@ -105,6 +110,7 @@ extern module_entry_info
 	cm_entry_saleleaseback,
 	cm_entry_singleowner,
 	cm_entry_host_developer,
+	cm_entry_financial_sweep,
 	cm_entry_swh,
 	cm_entry_geothermal,
 	cm_entry_geothermal_costs,
@@ -193,6 +199,7 @@ static module_entry_info *module_table[] = {
 	&cm_entry_saleleaseback,
 	&cm_entry_singleowner,
 	&cm_entry_host_developer,
+	&cm_entry_financial_sweep,
 	&cm_entry_swh,
 	&cm_entry_geothermal,
 	&cm_entry_geothermal_costs,
@@ -249,7 +256,7 @@ static module_entry_info *module_table[] = {
 	&cm_entry_grid,
 	0 };
 
-SSCEXPORT ssc_module_t ssc_module_create( const char *name )
+static module_entry_info *find_module_entry( const char *name )
 {
 	std::string lname = util::lower_case( name );
 
@@ -258,13 +265,20 @@ SSCEXPORT ssc_module_t ssc_module_create( const char *name )
 		 && module_table[i]->f_create != 0 )
 	{
 		if ( lname == util::lower_case( module_table[i]->name ) )
-			return (*(module_table[i]->f_create))();
+			return module_table[i];
 		i++;
 	}
 
 	return 0;
 }
 
+SSCEXPORT ssc_module_t ssc_module_create( const char *name )
+{
+	module_entry_info *entry = find_module_entry( name );
+	if ( !entry ) return 0;
+	return (*(entry->f_create))();
+}
+
 SSCEXPORT void ssc_module_free( ssc_module_t p_mod )
 {
 	compute_module *cm = static_cast<compute_module*>(p_mod);
@@ -367,6 +381,24 @@ SSCEXPORT void ssc_data_set_table( ssc_data_t p_data, const char *name, ssc_data
 	dat->table = *value;  // invokes operator= for deep copy
 }
 
+SSCEXPORT void ssc_data_set_array_ref( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int length )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt || !pvalues || length < 1) return;
+	var_data *dat = vt->assign( name, var_data() );
+	dat->type = SSC_ARRAY;
+	dat->num.borrow( pvalues, 1, (size_t)length );
+}
+
+SSCEXPORT void ssc_data_set_matrix_ref( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int nrows, int ncols )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt || !pvalues || nrows < 1 || ncols < 1) return;
+	var_data *dat = vt->assign( name, var_data() );
+	dat->type = SSC_MATRIX;
+	dat->num.borrow( pvalues, (size_t)nrows, (size_t)ncols );
+}
+
 SSCEXPORT const char *ssc_data_get_string( ssc_data_t p_data, const char *name )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
@@ -444,6 +476,12 @@ SSCEXPORT int ssc_entry_version( ssc_entry_t p_entry )
 	return p ? p->version : 0;
 }
 
+SSCEXPORT int ssc_entry_thread_safe( ssc_entry_t p_entry )
+{
+	module_entry_info *p = static_cast<module_entry_info*>(p_entry);
+	return p ? p->thread_safe : 0;
+}
+
 
 SSCEXPORT const ssc_info_t ssc_module_var_info( ssc_module_t p_mod, int index )
 {
@@ -608,6 +646,71 @@ static char p_internal_buf[256];
 	return result ? 0 : p_internal_buf;
 }
 
+SSCEXPORT int ssc_module_exec_batch( const char *name, ssc_data_t *p_data, int count, int nthreads,
+	void (*pf_done)( int index, ssc_bool_t result, ssc_module_t p_mod, void *user_data ),
+	void *pf_user_data )
+{
+	module_entry_info *entry = find_module_entry( name );
+	if ( !entry ) return -1;
+	if ( !p_data || count < 1 ) return 0;
+
+	if ( !entry->thread_safe )
+		nthreads = 1;
+	else if ( nthreads < 1 )
+		nthreads = (int)std::max( 1u, std::thread::hardware_concurrency() );
+	if ( nthreads > count )
+		nthreads = count;
+
+	// workers claim the next unstarted case until none are left, so long and
+	// short cases balance out across the pool without any up-front partitioning
+	std::atomic<int> next_case( 0 );
+	std::atomic<int> nsuccess( 0 );
+	std::mutex done_mutex;
+
+	auto worker = [&]()
+	{
+		int i;
+		while ( (i = next_case++) < count )
+		{
+			compute_module *cm = (*(entry->f_create))();
+			ssc_bool_t result = 0;
+			if ( cm )
+			{
+				result = ssc_module_exec_with_handler( static_cast<ssc_module_t>(cm), p_data[i], default_internal_handler_no_print, 0 );
+				if ( result ) nsuccess++;
+			}
+
+			if ( pf_done )
+			{
+				std::lock_guard<std::mutex> lock( done_mutex );
+				(*pf_done)( i, result, static_cast<ssc_module_t>(cm), pf_user_data );
+			}
+
+			if ( cm ) delete cm;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve( nthreads - 1 ); // so that push_back cannot throw with an unjoined thread in hand
+	try
+	{
+		for ( int t = 1; t < nthreads; t++ )
+			pool.push_back( std::thread( worker ) );
+	}
+	catch ( const std::system_error & )
+	{
+		// the system could not start another thread; the threads already running and
+		// the calling thread share the remaining cases
+	}
+
+	worker(); // the calling thread takes part as well
+
+	for ( size_t t = 0; t < pool.size(); t++ )
+		pool[t].join();
+
+	return nsuccess;
+}
+
 static int sg_defaultPrint = 1;
 
 SSCEXPORT void ssc_module_exec_set_print( int print )
@@ -139,6 +139,19 @@ SSCEXPORT void ssc_data_set_matrix( ssc_data_t p_data, const char *name, ssc_num
 SSCEXPORT void ssc_data_set_table( ssc_data_t p_data, const char *name, ssc_data_t table );
 /**@}*/ 
 
+/** @name Assigning variables by reference.
+The following functions do not copy the data: the variable refers to memory owned by the caller, which must remain valid until the variable is unassigned or reassigned, or the data container is freed.
+Compute modules read such inputs in place.  If a compute module produces an output with the same name, type, and dimensions, it writes the results directly into the caller's memory; otherwise the output is allocated internally as usual.
+Copying the data container, for example with ssc_data_set_table( ), makes a deep copy of referenced values.
+*/
+/**@{*/
+/** Assigns value of type @a SSC_ARRAY that refers to the caller's memory. */
+SSCEXPORT void ssc_data_set_array_ref( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int length );
+
+/** Assigns value of type @a SSC_MATRIX that refers to the caller's memory, in row-major order. */
+SSCEXPORT void ssc_data_set_matrix_ref( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int nrows, int ncols );
+/**@}*/
+
 /** @name Retrieving variable values.
 The following functions return internal references to memory, and the returned string, array, matrix, and tables should not be freed by the user.
 */
@@ -186,6 +199,9 @@ SSCEXPORT const char *ssc_entry_description( ssc_entry_t p_entry );
 /** Returns version information about a compute module. */
 SSCEXPORT int ssc_entry_version( ssc_entry_t p_entry );
 
+/** Returns 1 if instances of a compute module can be run concurrently from several threads in the same process, 0 otherwise. Modules that are not thread-safe are run one case at a time by ssc_module_exec_batch. */
+SSCEXPORT int ssc_entry_thread_safe( ssc_entry_t p_entry );
+
 /** An opaque reference to a computation module. A computation module performs a transformation on a ssc_data_t. It usually is used to calculate output variables given a set of input variables, but it can also be used to change the values of variables defined as INOUT. Modules types have unique names, and store information about what input variables are required, what outputs can be expected, along with specific data type, unit, label, and meta information about each variable. */
 typedef void* ssc_module_t;
 
@@ -259,9 +275,14 @@ SSCEXPORT const char *ssc_info_uihint( ssc_info_t p_inf );
 /** Specify whether the built-in execution handler prints messages and progress updates to the command line console. */
 SSCEXPORT void ssc_module_exec_set_print( int print );
 
-/** The simplest way to run a computation module over a data set. Simply specify the name of the module, and a data set.  If the whole process succeeded, the function returns 1, otherwise 0.  No error messages are available. This function can be thread-safe, depending on the computation module used. If the computation module requires the execution of external binary executables, it is not thread-safe. However, simpler implementations that do all calculations internally are probably thread-safe.  Unfortunately there is no standard way to report the thread-safety of a particular computation module. */
+/** The simplest way to run a computation module over a data set. Simply specify the name of the module, and a data set.  If the whole process succeeded, the function returns 1, otherwise 0.  No error messages are available. This function can be thread-safe, depending on the computation module used. If the computation module requires the execution of external binary executables, it is not thread-safe. However, simpler implementations that do all calculations internally are probably thread-safe.  Use ssc_entry_thread_safe to check a particular computation module. */
 SSCEXPORT ssc_bool_t ssc_module_exec_simple( const char *name, ssc_data_t p_data );
 
+/** Runs a computation module over many data sets on an internal thread pool.  'p_data' is an array of 'count' data containers, each of which holds the inputs of one case and receives its outputs.  'nthreads' sets the number of worker threads; a value less than 1 uses one thread per hardware core.  Modules that do not report themselves as thread-safe (see ssc_entry_thread_safe) are run one case at a time regardless of 'nthreads'.  As each case finishes, 'pf_done' (if not NULL) is called with the index of the case, its result, and the module instance that ran it, so that messages can be retrieved with ssc_module_log.  The module instance is freed after the callback returns.  Calls to 'pf_done' are never concurrent.  No messages are printed to the console.  Returns the number of cases that ran successfully, or -1 if the module name is not found. */
+SSCEXPORT int ssc_module_exec_batch( const char *name, ssc_data_t *p_data, int count, int nthreads,
+	void (*pf_done)( int index, ssc_bool_t result, ssc_module_t p_mod, void *user_data ),
+	void *pf_user_data );
+
 /** Another very simple way to run a computation module over a data set. The function returns NULL on success.  If something went wrong, the first error message is returned. Because the returned string references a common internal data container, this function is never thread-safe.  */
 SSCEXPORT const char *ssc_module_exec_simple_nothread( const char *name, ssc_data_t p_data );
 
@@ -185,7 +185,7 @@ bool var_data::parse( unsigned char type, const std::string &buf, var_data &valu
 	return false;
 }
 
-var_table::var_table() : m_iterator(m_hash.begin())
+var_table::var_table() : m_iterator(m_hash.begin()), m_generation(0)
 {
 	/* nothing to do here */
 }
@@ -216,6 +216,7 @@ void var_table::clear()
 		delete it->second; // delete the var_data object
 	}
 	m_hash.clear();
+	m_generation++;
 }
 
 var_data *var_table::assign( const std::string &name, const var_data &val )
@@ -238,6 +239,7 @@ void var_table::unassign( const std::string &name )
 	{
 		delete (*it).second; // delete the associated data
 		m_hash.erase( it );
+		m_generation++;
 	}
 }
 
@@ -251,6 +253,7 @@ bool var_table::rename( const std::string &oldname, const std::string &newname )
 
 		var_data *data = it->second; // save ptr to data
 		m_hash.erase( it );
+		m_generation++;
 
 		// if a variable with 'newname' already exists, 
 		// delete its data, and reassign the name to the new data
@@ -57,9 +57,14 @@ public:
 	unsigned int size() { return (unsigned int)m_hash.size(); }
 	var_table &operator=( const var_table &rhs );
 
+	/* changes whenever existing var_data objects may have been deleted or renamed, 
+	   so that cached pointers to them can be invalidated */
+	unsigned int generation() const { return m_generation; }
+
 private:
 	var_hash m_hash;
 	var_hash::iterator m_iterator;
+	unsigned int m_generation;
 };
 
 
@@ -30,6 +30,8 @@ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMA
 ***************************************************************************************************/
 
 #include <math.h>
+#include <string.h>
+#include <memory>
 #include "CO2_properties.h"
 
 using namespace N_co2_props;
@@ -44552,7 +44554,7 @@ void N_co2_props::get_prop_derivatives(
   return;
 }
 
-int CO2_TP(const double T, const double P, CO2_state *__restrict state) {
+static int CO2_TP_eval(const double T, const double P, CO2_state *__restrict state) {
   const int max_iter = 20;
   const double rel_tol = 1e-10;
   const double P_tol = fmax(rel_tol, P * rel_tol);
@@ -44753,7 +44755,7 @@ int CO2_TP(const double T, const double P, CO2_state *__restrict state) {
   return 0;
 }
 
-int CO2_PH(const double P, const double H, CO2_state *__restrict state) {
+static int CO2_PH_eval(const double P, const double H, CO2_state *__restrict state) {
   const int max_iter = 20;
   const double rel_tol = 1e-10;
   const double P_tol = fmax(rel_tol, P * rel_tol);
@@ -44900,7 +44902,7 @@ int CO2_PH(const double P, const double H, CO2_state *__restrict state) {
   return 0;
 }
 
-int CO2_PS(const double P, const double S, CO2_state *__restrict state) {
+static int CO2_PS_eval(const double P, const double S, CO2_state *__restrict state) {
   const int max_iter = 20;
   const double rel_tol = 1e-10;
   const double P_tol = fmax(rel_tol, P * rel_tol);
@@ -70071,3 +70073,127 @@ double CO2_cond(const double D, const double T) {
   const double px2 = cy[4] * x + cy[5];
   return px0 * x4 + px1 * x2 + px2;
 }
+
+/* Property cache
+
+The sCO2 cycle and heat exchanger models evaluate the same states many times, for example the fixed compressor and
+turbine inlet states at every step of the design optimization. CO2_TP, CO2_PH and CO2_PS keep the most recent results 
+for each thread in a direct-mapped table keyed on the exact input values, so a hit returns the same state and error 
+code that a new evaluation would.
+*/
+
+namespace N_co2_props
+{
+	const int n_cache_bits = 12;
+	const int n_cache = 1 << n_cache_bits;	// entries per property function
+
+	struct S_cache_entry
+	{
+		double a;
+		double b;
+		int code;
+		bool is_set;
+		CO2_state state;
+	};
+
+	struct S_cache
+	{
+		S_cache_entry TP[n_cache];
+		S_cache_entry PH[n_cache];
+		S_cache_entry PS[n_cache];
+		CO2_cache_info info;
+	};
+
+	// allocated on the first call from each thread and released when the thread exits
+	static thread_local std::unique_ptr<S_cache> p_cache;
+
+	static S_cache & get_cache()
+	{
+		if (!p_cache)
+		{
+			p_cache.reset(new S_cache);
+			memset(p_cache.get(), 0, sizeof(S_cache));
+		}
+		return *p_cache;
+	}
+
+	static int cache_slot(double a, double b)
+	{
+		unsigned long long ia, ib;
+		memcpy(&ia, &a, sizeof(ia));
+		memcpy(&ib, &b, sizeof(ib));
+		unsigned long long h = (ia ^ (ib * 0x9E3779B97F4A7C15ULL)) * 0xBF58476D1CE4E5B9ULL;
+		return (int)(h >> (64 - n_cache_bits));		// high bits depend on every input bit
+	}
+
+	static int cached_call(S_cache_entry *table, long long &n_calls, long long &n_hits,
+		int(*eval)(const double, const double, CO2_state *__restrict), double a, double b, CO2_state * state)
+	{
+		n_calls++;
+		S_cache_entry &entry = table[cache_slot(a, b)];
+		if (entry.is_set && entry.a == a && entry.b == b)
+		{
+			n_hits++;
+			*state = entry.state;
+			return entry.code;
+		}
+		entry.code = eval(a, b, state);
+		entry.a = a;
+		entry.b = b;
+		entry.state = *state;
+		entry.is_set = true;
+		return entry.code;
+	}
+};
+
+int CO2_TP(double T, double P, CO2_state * state)
+{
+	S_cache &cache = get_cache();
+	return cached_call(cache.TP, cache.info.TP_calls, cache.info.TP_hits, CO2_TP_eval, T, P, state);
+}
+
+int CO2_PH(double P, double H, CO2_state * state)
+{
+	S_cache &cache = get_cache();
+	return cached_call(cache.PH, cache.info.PH_calls, cache.info.PH_hits, CO2_PH_eval, P, H, state);
+}
+
+int CO2_PS(double P, double S, CO2_state * state)
+{
+	S_cache &cache = get_cache();
+	return cached_call(cache.PS, cache.info.PS_calls, cache.info.PS_hits, CO2_PS_eval, P, S, state);
+}
+
+int CO2_PH_batch(int n, const double * P, const double * H, CO2_state * states, int * codes)
+{
+	int n_fail = 0;
+	for (int i = 0; i < n; i++)
+	{
+		codes[i] = CO2_PH(P[i], H[i], &states[i]);
+		if (codes[i] != 0)
+			n_fail++;
+	}
+	return n_fail;
+}
+
+int CO2_TP_batch(int n, const double * T, const double * P, CO2_state * states, int * codes)
+{
+	int n_fail = 0;
+	for (int i = 0; i < n; i++)
+	{
+		codes[i] = CO2_TP(T[i], P[i], &states[i]);
+		if (codes[i] != 0)
+			n_fail++;
+	}
+	return n_fail;
+}
+
+void get_CO2_cache_info(CO2_cache_info * info)
+{
+	*info = get_cache().info;
+}
+
+void reset_CO2_cache()
+{
+	memset(&get_cache(), 0, sizeof(S_cache));
+}
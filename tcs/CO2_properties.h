@@ -127,6 +127,27 @@ int CO2_PS( double P, double S, CO2_state * state );
 int CO2_HS( double H, double S, CO2_state * state );
 int CO2_TQ( double T, double Q, CO2_state * state );
 
+// Batched property functions. Evaluate n states, set the error code of each state in codes, and return the number of
+// states that failed.
+int CO2_TP_batch( int n, const double * T, const double * P, CO2_state * states, int * codes );
+int CO2_PH_batch( int n, const double * P, const double * H, CO2_state * states, int * codes );
+
+// CO2_TP, CO2_PH and CO2_PS return stored results for inputs that were recently evaluated on the same thread. The
+// counters below are kept for the calling thread.
+typedef struct CO2_cache_info
+    {
+    long long TP_calls;       // calls to CO2_TP
+    long long TP_hits;        // calls to CO2_TP answered from the cache
+    long long PH_calls;
+    long long PH_hits;
+    long long PS_calls;
+    long long PS_hits;
+    }
+    CO2_cache_info;
+
+void get_CO2_cache_info( CO2_cache_info * info );
+void reset_CO2_cache( void );     // clears the cache and counters of the calling thread
+
 // Miscellaneous functions (will return -9.0e99 if the input is not valid).
 double CO2_visc( double D, double T);	//(uPa-s)
 double CO2_cond( double D, double T);	//(W/m-K)
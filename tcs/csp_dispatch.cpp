@@ -24,6 +24,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <sstream>
 #include <stdlib.h>
 #include <algorithm>
+#include <chrono>
 #include "csp_dispatch.h"
 #include "lp_lib.h" 
 #include "lib_util.h"
@@ -91,6 +92,10 @@ csp_dispatch_opt::csp_dispatch_opt()
     price_signal.clear();
     clear_output_arrays();
     m_is_weather_setup = false;
+    m_lp = NULL;
+    m_lp_vars = NULL;
+    m_lp_nstep = 0;
+    m_perf.step = numeric_limits<double>::quiet_NaN();
 
     //parameters
     params.is_pb_operating0 = false;
@@ -130,10 +135,16 @@ csp_dispatch_opt::csp_dispatch_opt()
 
     outputs.presolve_nconstr = 0;
     outputs.solve_time = 0.;
+    outputs.build_time = 0.;
     outputs.presolve_nvar = 0;
 
 }
 
+csp_dispatch_opt::~csp_dispatch_opt()
+{
+    free_lp();
+}
+
 void csp_dispatch_opt::clear_output_arrays()
 {
     m_current_read_step = 0;
@@ -176,9 +187,52 @@ bool csp_dispatch_opt::copy_weather_data(C_csp_weatherreader &weather_source)
     //Copy the weather data
     m_weather = weather_source;
 
+    //estimates from a previous weather source no longer apply
+    m_perf.step = numeric_limits<double>::quiet_NaN();
+
     return m_is_weather_setup = true;
 }
 
+bool csp_dispatch_opt::estimate_performance(int time_step, double step, double &q_inc, double &therm_eff, double &cycle_eff, 
+    double &f_pb_op_lim, double &wcond_f)
+{
+    //create the sim info
+    C_csp_solver_sim_info simloc;
+	simloc.ms_ts.m_step = step;
+
+    //jump to the current step
+    if(! m_weather.read_time_step( time_step, simloc ) )
+        return false;
+
+    //get DNI
+    double dni = m_weather.ms_outputs.m_beam;
+    if( m_weather.ms_outputs.m_solzen > 90. || dni < 0. )
+        dni = 0.;
+
+    //get optical efficiency
+    double opt_eff = params.col_rec->calculate_optical_efficiency(m_weather.ms_outputs, simloc);
+
+    q_inc = params.col_rec->get_collector_area() * opt_eff * dni * 1.e-3; //kW
+
+    //get thermal efficiency
+    therm_eff = params.col_rec->calculate_thermal_efficiency_approx(m_weather.ms_outputs, q_inc*0.001);
+
+    //power cycle efficiency
+    cycle_eff = params.eff_table_Tdb.interpolate( m_weather.ms_outputs.m_tdry );
+    cycle_eff *= params.eta_cycle_ref;  
+
+	f_pb_op_lim = std::numeric_limits<double>::quiet_NaN();
+	double m_dot_htf_max_local = std::numeric_limits<double>::quiet_NaN();
+	params.mpc_pc->get_max_power_output_operation_constraints(m_weather.ms_outputs.m_tdry, m_dot_htf_max_local, f_pb_op_lim);
+
+    //condenser parasitic power fraction
+    wcond_f = params.wcondcoef_table_Tdb.interpolate( m_weather.ms_outputs.m_tdry );
+
+    m_weather.converged();
+
+    return true;
+}
+
 bool csp_dispatch_opt::predict_performance(int step_start, int ntimeints, int divs_per_int)
 {
     //Step number - 1-based index for first hour of the year.
@@ -192,12 +246,20 @@ bool csp_dispatch_opt::predict_performance(int step_start, int ntimeints, int di
     if(! check_setup(m_nstep_opt) )
         throw C_csp_exception("Dispatch optimization precheck failed.");
 
-    //create the sim info
-    C_csp_solver_sim_info simloc;    // = *params.siminfo;
-	simloc.ms_ts.m_step = params.siminfo->ms_ts.m_step;
-
-
-    double Asf = params.col_rec->get_collector_area();
+    //the estimates only depend on the weather and design parameters, so they are kept for the year at the 
+    //resolution of the weather steps
+    double step = params.siminfo->ms_ts.m_step;
+    if( m_perf.step != step )
+    {
+        int nrec = (int)m_weather.m_weather_data_provider->nrecords();
+        m_perf.step = step;
+        m_perf.is_set.assign(nrec, false);
+        m_perf.q_inc.resize(nrec);
+        m_perf.therm_eff.resize(nrec);
+        m_perf.cycle_eff.resize(nrec);
+        m_perf.f_pb_op_lim.resize(nrec);
+        m_perf.wcond_f.resize(nrec);
+    }
 
     double ave_weight = 1./(double)divs_per_int;
 
@@ -212,23 +274,27 @@ bool csp_dispatch_opt::predict_performance(int step_start, int ntimeints, int di
 
         for(int j=0; j<divs_per_int; j++)     //take averages over hour if needed
         {
+            int s = step_start+i*divs_per_int+j;
 
-            //jump to the current step
-            if(! m_weather.read_time_step( step_start+i*divs_per_int+j, simloc ) )
-                return false;
-
-            //get DNI
-            double dni = m_weather.ms_outputs.m_beam;
-            if( m_weather.ms_outputs.m_solzen > 90. || dni < 0. )
-                dni = 0.;
-
-            //get optical efficiency
-            double opt_eff = params.col_rec->calculate_optical_efficiency(m_weather.ms_outputs, simloc);
+            double q_inc, therm_eff, cycle_eff, f_pb_op_lim, wcond_f;
 
-            double q_inc = Asf * opt_eff * dni * 1.e-3; //kW
+            if( s >= 0 && s < (int)m_perf.is_set.size() )
+            {
+                if( !m_perf.is_set[s] )
+                {
+                    if(! estimate_performance(s, step, m_perf.q_inc[s], m_perf.therm_eff[s], m_perf.cycle_eff[s], m_perf.f_pb_op_lim[s], m_perf.wcond_f[s]) )
+                        return false;
+                    m_perf.is_set[s] = true;
+                }
+                q_inc = m_perf.q_inc[s];
+                therm_eff = m_perf.therm_eff[s];
+                cycle_eff = m_perf.cycle_eff[s];
+                f_pb_op_lim = m_perf.f_pb_op_lim[s];
+                wcond_f = m_perf.wcond_f[s];
+            }
+            else if(! estimate_performance(s, step, q_inc, therm_eff, cycle_eff, f_pb_op_lim, wcond_f) )
+                return false;
 
-            //get thermal efficiency
-            double therm_eff = params.col_rec->calculate_thermal_efficiency_approx(m_weather.ms_outputs, q_inc*0.001);
             therm_eff *= params.sf_effadj;
             therm_eff_ave += therm_eff * ave_weight;
 
@@ -236,21 +302,12 @@ bool csp_dispatch_opt::predict_performance(int step_start, int ntimeints, int di
             q_inc_ave += q_inc * therm_eff * ave_weight;
 
             //store the power cycle efficiency
-            double cycle_eff = params.eff_table_Tdb.interpolate( m_weather.ms_outputs.m_tdry );
-            cycle_eff *= params.eta_cycle_ref;  
             cycle_eff_ave += cycle_eff * ave_weight;
 
-			double f_pb_op_lim_local = std::numeric_limits<double>::quiet_NaN();
-			double m_dot_htf_max_local = std::numeric_limits<double>::quiet_NaN();
-			params.mpc_pc->get_max_power_output_operation_constraints(m_weather.ms_outputs.m_tdry, m_dot_htf_max_local, f_pb_op_lim_local);
-			f_pb_op_lim_ave += f_pb_op_lim_local * ave_weight;	//[-]
+			f_pb_op_lim_ave += f_pb_op_lim * ave_weight;	//[-]
 
             //store the condenser parasitic power fraction
-            double wcond_f = params.wcondcoef_table_Tdb.interpolate( m_weather.ms_outputs.m_tdry );
             wcond_ave += wcond_f * ave_weight;
-
-		    simloc.ms_ts.m_time += simloc.ms_ts.m_step;
-            m_weather.converged();
         }
 
         //-----report hourly averages
@@ -266,12 +323,14 @@ bool csp_dispatch_opt::predict_performance(int step_start, int ntimeints, int di
         outputs.w_condf_expected.push_back( wcond_ave );
     }
 
-    //reset the weather data reader
-    //m_weather.jump_to_timestep(step_start, simloc);
-    
     return true;
 }
 
+void csp_dispatch_opt::set_horizon(int nstep)
+{
+    m_nstep_opt = nstep;
+}
+
 static void calculate_parameters(csp_dispatch_opt *optinst, unordered_map<std::string, double> &pars, int nt)
 {
     /* 
@@ -397,876 +456,1031 @@ static void calculate_parameters(csp_dispatch_opt *optinst, unordered_map<std::s
         pars["pen_delta_w"] = optinst->params.pen_delta_w; //0.1;
 };
 
-bool csp_dispatch_opt::optimize()
+static void lp_plant_parameters(csp_dispatch_opt *optinst, unordered_map<std::string, double> &pars, vector<double> &plant)
 {
-
-    //First check to see whether we should call the AMPL engine instead. 
-    if( solver_params.is_ampl_engine )
-    {
-        return optimize_ampl();
-    }
-
     /* 
-    Formulate the optimization problem for dispatch generation. We are trying to maximize revenue subject to inventory
-    constraints.
-    
-    
-    Variables
-    -------------------------------------------------------------
-    Continuous
-    -------------------------------------------------------------
-    xr          kWt     Power delivered by the receiver at time t
-    xrsu        kWt     Power used by the reciever for start up
-    ursu        kWt     Receiver accumulated start-up thermal power at time t
-    x           kWt	    Cycle thermal power consumption at time t 
-    ucsu        kWt     Cycle accumulated start-up thermal power at time t
-    s           kWht    TES reserve quantity at time t (auxiliary variable) 
-    wdot        kWe     Electrical power production at time t
-    delta_w     kWe     Positive change in power production at time t w/r/t t-1
-    -------------------------------------------------------------
-    Binary
-    -------------------------------------------------------------
-    yr              1 if receiver is generating ``usable'' thermal power at time t; 0 otherwise 
-    yrsu            1 if receiver is starting up at time t; 0 otherwise 
-    yrsb            1 if receiver is in standby at time t; 0 otherwise
-    yrsup           1 if reciever startup penalty is enforced at time t; 0 otherwise
-    yrhsp           1 if receiver hot startup penalty is enforced at time t; 0 otherwise
-    y               1 if cycle is generating electric power at time t; 0 otherwise
-    ycsu            1 if cycle is starting up at time t; 0 otherwise
-    ycsb            1 if cycle is in standby mode at time t; 0 otherwise
-    ycsup           1 if cycle startup penalty is enforced at time t; 0 otherwise
-    ychsp           1 if cycle hot startup penalty is enforced at time t; 0 otherwise
-    -------------------------------------------------------------
+    Parameters that appear in the fixed coefficients of the dispatch model. The model structure is rebuilt
+    whenever any of these differ from the values it was built with.
     */
-    lprec *lp;
-    int ret = 0;
+    plant.clear();
+    plant.push_back( pars["delta"] );
+    plant.push_back( pars["Eu"] );
+    plant.push_back( pars["Er"] );
+    plant.push_back( pars["Ec"] );
+    plant.push_back( pars["Qu"] );
+    plant.push_back( pars["Ql"] );
+    plant.push_back( pars["Qru"] );
+    plant.push_back( pars["Qrl"] );
+    plant.push_back( pars["Qc"] );
+    plant.push_back( pars["Qb"] );
+    plant.push_back( pars["M"] );
+    plant.push_back( optinst->params.q_pb_max );
+    plant.push_back( optinst->params.q_pb_standby );
+}
 
+void csp_dispatch_opt::free_lp()
+{
+    if( m_lp != NULL )
+        delete_lp(m_lp);
+    m_lp = NULL;
 
-    try{
+    delete m_lp_vars;
+    m_lp_vars = NULL;
 
-        //Calculate the number of variables
-        int nt = (int)m_nstep_opt;
+    m_lp_nstep = 0;
+    m_lp_plant.clear();
+}
 
-        //set up the variable structure
-        optimization_vars O;
-        O.add_var("xr", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
-        O.add_var("xrsu", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
-        O.add_var("ursu", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
-        O.add_var("yr", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-        O.add_var("yrsu", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-        //O.add_var("yrsb", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-        //O.add_var("yrsd", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-        O.add_var("yrsup", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-        //O.add_var("yrhsp", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-
-        O.add_var("x", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0.);
-        O.add_var("y", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-        O.add_var("s", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
-        O.add_var("ucsu", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
-        O.add_var("ycsu", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-        O.add_var("ycsb", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+void csp_dispatch_opt::build_lp(unordered_map<std::string, double> &P, int nt)
+{
+    /* 
+    Build the structure of the dispatch model for a horizon of nt steps: the variables, their bounds, and every
+    constraint row. Coefficients and right-hand sides that change from one optimization window to the next are 
+    left as placeholders here and set by update_lp.
+    */
+    free_lp();
+
+    double delta = P["delta"];
+    double Eu = P["Eu"];
+    double Er = P["Er"];
+    double Ec = P["Ec"];
+    double Qu = P["Qu"];
+    double Ql = P["Ql"];
+    double Qru = P["Qru"];
+    double Qrl = P["Qrl"];
+    double Qc = P["Qc"];
+    double Qb = P["Qb"];
+    double M = P["M"];
+
+    //set up the variable structure
+    m_lp_vars = new optimization_vars();
+    optimization_vars &O = *m_lp_vars;
+    O.add_var("xr", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
+    O.add_var("xrsu", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
+    O.add_var("ursu", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
+    O.add_var("yr", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    O.add_var("yrsu", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    //O.add_var("yrsb", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    //O.add_var("yrsd", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    O.add_var("yrsup", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    //O.add_var("yrhsp", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+
+    O.add_var("x", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0.);
+    O.add_var("y", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    O.add_var("s", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
+    O.add_var("ucsu", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. );
+    O.add_var("ycsu", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    O.add_var("ycsb", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
 #ifdef MOD_CYCLE_SHUTDOWN
-        O.add_var("ycsd", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    O.add_var("ycsd", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
 #endif
-        O.add_var("ycsup", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-        O.add_var("ychsp", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
-        O.add_var("wdot", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. ); //0 lower bound?
-        O.add_var("delta_w", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. ); 
-        
-        unordered_map<std::string, double> P;
-        calculate_parameters(this, P, nt);
+    O.add_var("ycsup", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    O.add_var("ychsp", optimization_vars::VAR_TYPE::BINARY_T, optimization_vars::VAR_DIM::DIM_T, nt);
+    O.add_var("wdot", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. ); //0 lower bound?
+    O.add_var("delta_w", optimization_vars::VAR_TYPE::REAL_T, optimization_vars::VAR_DIM::DIM_T, nt, 0. ); 
 
-        O.construct();  //allocates memory for data array
+    O.construct();  //allocates memory for data array
 
-        int nvar = O.get_total_var_count(); //total number of variables in the problem
+    int nvar = O.get_total_var_count(); //total number of variables in the problem
 
-        lp = make_lp(0, nvar);  //build the context
+    m_lp = make_lp(0, nvar);  //build the context
 
-        if(lp == NULL)
-            throw C_csp_exception("Failed to create a new CSP dispatch optimization problem context.");
+    if(m_lp == NULL)
+        throw C_csp_exception("Failed to create a new CSP dispatch optimization problem context.");
 
-        //set variable names and types for each column
-        for(int i=0; i<O.get_num_varobjs(); i++)
+    lprec *lp = m_lp;
+
+    m_lp_rows.power_curve.assign(nt, 0);
+    m_lp_rows.rec_su_avail.assign(nt, 0);
+    m_lp_rows.rec_capacity.assign(nt, 0);
+    m_lp_rows.rec_mode.assign(nt, 0);
+    m_lp_rows.rec_avail.assign(nt, 0);
+    m_lp_rows.tes_rec_su.assign(nt, 0);
+    m_lp_rows.w_gross.assign(nt, 0);
+    m_lp_rows.w_net.assign(nt, 0);
+
+    //set the row mode
+    set_add_rowmode(lp, TRUE);
+
+    /* 
+    --------------------------------------------------------------------------------
+    set up the variable properties
+    --------------------------------------------------------------------------------
+    */
+    for(int i=0; i<O.get_num_varobjs(); i++)
+    {
+        optimization_vars::opt_var *v = O.get_var(i);
+        if( v->var_type == optimization_vars::VAR_TYPE::BINARY_T )
         {
-            optimization_vars::opt_var *v = O.get_var(i);
+            for(int i=v->ind_start; i<v->ind_end; i++)
+                set_binary(lp, i+1, TRUE);
+        }
+        //upper and lower variable bounds
+        for(int i=v->ind_start; i<v->ind_end; i++)
+        {
+            set_upbo(lp, i+1, v->upper_bound);
+            set_lowbo(lp, i+1, v->lower_bound);
+        }
+    }
 
-            string name_base = v->name;
 
-            if( v->var_dim == optimization_vars::VAR_DIM::DIM_T )
-            {
-                for(int t=0; t<nt; t++)
-                {
-                    char s[40];
-                    sprintf(s, "%s-%d", name_base.c_str(), t);
-                    set_col_name(lp, O.column(i, t), s);
-                    
-                }
-            }
-            else if( v->var_dim == optimization_vars::VAR_DIM::DIM_NT ) 
+    /* 
+    --------------------------------------------------------------------------------
+    set up the constraints
+    --------------------------------------------------------------------------------
+    */
+    //cycle production change
+    {
+        REAL row[3];
+        int col[3];
+        
+        for(int t=0; t<nt; t++)
+        {
+            col[0] = O.column("delta_w", t);
+            row[0] = 1.;
+
+            col[1] = O.column("wdot", t);
+            row[1] = -1.;
+
+            if(t>0)
             {
-                for(int t1=0; t1<v->var_dim_size; t1++)
-                {
-                    for(int t2=0; t2<v->var_dim_size2; t2++)
-                    {
-                        char s[40];
-                        sprintf(s, "%s-%d-%d", name_base.c_str(), t1, t2);
-                        set_col_name(lp, O.column(i, t1,t2 ), s);
-                    }
-                }
+                col[2] = O.column("wdot", t-1);
+                row[2] = 1.;
+                
+                add_constraintex(lp, 3, row, col, GE, 0.);
             }
             else
             {
-                for(int t1=0; t1<nt; t1++)
-                {
-                    for(int t2=t1; t2<nt; t2++)
-                    {
-                        char s[40];
-                        sprintf(s, "%s-%d-%d", name_base.c_str(), t1, t2);
-                        set_col_name(lp, O.column(i, t1, t2 ), s);
-                    }
-                }
+                add_constraintex(lp, 2, row, col, GE, 0.);
+                m_lp_rows.delta_w0 = get_Nrows(lp);
             }
         }
+    }
 
-        /* 
-        --------------------------------------------------------------------------------
-        set up the objective function first (per lpsolve guidance)
-        --------------------------------------------------------------------------------
-        */
-		{
-            int *col = new int[12 * nt];
-            REAL *row = new REAL[12 * nt];
-            double tadj = P["disp_time_weighting"];
-            int i = 0;
-
-            //calculate the mean price to appropriately weight the receiver production timing derate
-            double pmean =0;
-            for(int t=0; t<(int)price_signal.size(); t++)
-                pmean += price_signal.at(t);
-            pmean /= (double)price_signal.size();
-            //--
-            
-            for(int t=0; t<nt; t++)
-            {
-                i = 0;
-                col[ t + nt*(i  ) ] = O.column("wdot", t);
-                row[ t + nt*(i++) ] = P["delta"] * price_signal.at(t)*tadj*(1.-outputs.w_condf_expected.at(t));
-
-                col[ t + nt*(i  ) ] = O.column("xr", t);
-                row[ t + nt*(i++) ] = -(P["delta"] * price_signal.at(t) * P["Lr"])+tadj*pmean;  // tadj added to prefer receiver production sooner (i.e. delay dumping)
-
-                col[ t + nt*(i  ) ] = O.column("xrsu", t);
-                row[ t + nt*(i++) ] = -P["delta"] * price_signal.at(t) * P["Lr"];
 
-                col[ t + nt*(i  ) ] = O.column("yrsu", t);
-                row[ t + nt*(i++) ] = -price_signal.at(t) * (params.w_rec_ht + params.w_stow);
+    
+    {
+        //Linearization of the implementation of the piecewise efficiency equation 
+        REAL row[3];
+        int col[3];
 
-                col[ t + nt*(i  ) ] = O.column("yr", t);
-                row[ t + nt*(i++) ] = -(P["delta"] * price_signal.at(t) * params.w_track) + tadj;	// tadj added to prefer receiver operation in nearer term to longer term
+        for(int t=0; t<nt; t++)
+        {
+            int i=0;
+            //power production curve
+            row[i  ] = 1.;
+            col[i++] = O.column("wdot", t);
 
-                col[ t + nt*(i  ) ] = O.column("x", t);
-                row[ t + nt*(i++) ] = -P["delta"] * price_signal.at(t) * params.w_cycle_pump;
+            row[i  ] = 1.;
+            col[i++] = O.column("x", t);
 
-                col[ t + nt*(i  ) ] = O.column("ycsb", t);
-                row[ t + nt*(i++) ] = -P["delta"] * price_signal.at(t) * params.w_cycle_standby;
+            row[i  ] = 1.;
+            col[i++] = O.column("y", t);
 
-                //xxcol[ t + nt*(i   ] = O.column("yrsb", t);
-                //xxrow[ t + nt*(i++) ] = -delta * price_signal.at(t) * (Lr * Qrl + (params.w_stow / delta));
+            //row[i  ] = -outputs.eta_pb_expected.at(t);
+            //col[i++] = O.column("x", t);
 
-                //xxcol[ t + nt*(i   ] = O.column("yrsd", t);
-                //xxrow[ t + nt*(i++) ] = -0.5 - (params.w_stow);
+            add_constraintex(lp, i, row, col, EQ, 0.);
+            m_lp_rows.power_curve.at(t) = get_Nrows(lp);
+        }
+    }
 
-                //xxcol[ t + nt*(i   ] = O.column("ycsd", t);
-                //xxrow[ t + nt*(i++) ] = -0.5;
+    // ******************** Receiver constraints *******************
+    //{ //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+    //    REAL row[5];
+    //    int col[5];
 
-                col[ t + nt*(i  ) ] = O.column("yrsup", t);
-                row[ t + nt*(i++) ] = -P["rsu_cost"]*tadj;
+    //    for(int t=0; t<nt; t++)
+    //    {
+    //        int i=0; 
+    //        row[i  ] = qrecmaxobs*1.01;
+    //        col[i++] = O.column("yd", t);
 
-                //xxcol[ t + nt*(i   ] = O.column("yrhsp", t);
-                //xxrow[ t + nt*(i++) ] = -tadj;
+    //        row[i  ] = 1.;
+    //        col[i++] = O.column("xr", t);
 
-                col[ t + nt*(i  ) ] = O.column("ycsup", t);
-                row[ t + nt*(i++) ] = -P["csu_cost"]*tadj;
+    //        row[i  ] = 1.;
+    //        col[i++] = O.column("xrsu", t);
 
-                col[ t + nt*(i  ) ] = O.column("ychsp", t);
-                row[ t + nt*(i++) ] = -P["csu_cost"]*tadj * 0.1;
+    //        add_constraintex(lp, i, row, col, GE, outputs.q_sfavail_expected.at(t)*0.999 );
+    //    }
+    //} //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-                col[ t + nt*(i  ) ] = O.column("delta_w", t);
-                row[ t + nt*(i++) ] = -P["pen_delta_w"]*tadj;
 
-                tadj *= P["disp_time_weighting"];
-            }
+    {
+        REAL row[5];
+        int col[5];
 
-            set_obj_fnex(lp, i*nt, row, col);
+        for(int t=0; t<nt; t++)
+        {
 
-            delete[] col;
-            delete[] row;
-        }
+            //Receiver startup inventory
+            row[0] = 1.;
+            col[0] = O.column("ursu", t);
 
-        //set the row mode
-        set_add_rowmode(lp, TRUE);
+            row[1] = -delta;
+            col[1] = O.column("xrsu", t);
 
-        /* 
-        --------------------------------------------------------------------------------
-        set up the variable properties
-        --------------------------------------------------------------------------------
-        */
-        for(int i=0; i<O.get_num_varobjs(); i++)
-        {
-            optimization_vars::opt_var *v = O.get_var(i);
-            if( v->var_type == optimization_vars::VAR_TYPE::BINARY_T )
+            if(t>0)
             {
-                for(int i=v->ind_start; i<v->ind_end; i++)
-                    set_binary(lp, i+1, TRUE);
+                row[2] = -1.;
+                col[2] = O.column("ursu", t-1);
+
+                add_constraintex(lp, 3, row, col, LE, 0);
             }
-            //upper and lower variable bounds
-            for(int i=v->ind_start; i<v->ind_end; i++)
+            else
             {
-                set_upbo(lp, i+1, v->upper_bound);
-                set_lowbo(lp, i+1, v->lower_bound);
+                add_constraintex(lp, 2, row, col, LE, 0.);
             }
-        }
 
+            //-----
 
-        /* 
-        --------------------------------------------------------------------------------
-        set up the constraints
-        --------------------------------------------------------------------------------
-        */
-        //cycle production change
-        {
-            REAL row[3];
-            int col[3];
-            
-            for(int t=0; t<nt; t++)
-            {
-                col[0] = O.column("delta_w", t);
-                row[0] = 1.;
+            //inventory nonzero
+            row[0] = 1.;
+            col[0] = O.column("ursu", t);
 
-                col[1] = O.column("wdot", t);
-                row[1] = -1.;
-
-                if(t>0)
-                {
-                    col[2] = O.column("wdot", t-1);
-                    row[2] = 1.;
-                    
-                    add_constraintex(lp, 3, row, col, GE, 0.);
-                }
-                else
-                {
-                    add_constraintex(lp, 2, row, col, GE, -P["Wdot0"]);
-                }
-            }
-        }
+            row[1] = -Er;
+            col[1] = O.column("yrsu", t);
 
+            add_constraintex(lp, 2, row, col, LE, 0.);
 
-        
-        {
-            //Linearization of the implementation of the piecewise efficiency equation 
-            REAL row[3];
-            int col[3];
+            //Receiver operation allowed when:
+            row[0] = 1.;
+            col[0] = O.column("yr", t);
+            
+            row[1] = -1.0/Er; 
+            col[1] = O.column("ursu", t);
 
-            for(int t=0; t<nt; t++)
+            if(t>0)
             {
-                int i=0;
-                //power production curve
-                row[i  ] = 1.;
-                col[i++] = O.column("wdot", t);
-
-                row[i  ] = -P["etap"]*outputs.eta_pb_expected.at(t)/params.eta_cycle_ref;
-                col[i++] = O.column("x", t);
+                row[2] = -1.;
+                col[2] = O.column("yr", t-1);
 
-                row[i  ] = -(P["Wdotu"] - P["etap"]*P["Qu"])*outputs.eta_pb_expected.at(t)/params.eta_cycle_ref;
-                col[i++] = O.column("y", t);
+                add_constraintex(lp, 3, row, col, LE, 0.); 
+            }
+            else
+            {
+                add_constraintex(lp, 2, row, col, LE, 0.);
+                m_lp_rows.rec_op0 = get_Nrows(lp);
+            }
 
-                //row[i  ] = -outputs.eta_pb_expected.at(t);
-                //col[i++] = O.column("x", t);
+            //Receiver startup can't be enabled after a time step where the Receiver was operating
+            if(t>0)
+            {
+                row[0] = 1.;
+                col[0] = O.column("yrsu", t);
 
-                add_constraintex(lp, i, row, col, EQ, 0.);
+                row[1] = 1.;
+                col[1] = O.column("yr", t-1);
 
+                add_constraintex(lp, 2, row, col, LE, 1.);
             }
-        }
 
-        // ******************** Receiver constraints *******************
-        //{ //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-        //    REAL row[5];
-        //    int col[5];
+            //Receiver startup energy consumption
+            row[0] = 1.;
+            col[0] = O.column("xrsu", t);
 
-        //    for(int t=0; t<nt; t++)
-        //    {
-        //        int i=0; 
-        //        row[i  ] = qrecmaxobs*1.01;
-        //        col[i++] = O.column("yd", t);
+            row[1] = -Qru;
+            col[1] = O.column("yrsu", t);
 
-        //        row[i  ] = 1.;
-        //        col[i++] = O.column("xr", t);
+            add_constraintex(lp, 2, row, col, LE, 0.);
 
-        //        row[i  ] = 1.;
-        //        col[i++] = O.column("xrsu", t);
+            //Receiver startup only during solar positive periods
+            row[0] = 1.;
+            col[0] = O.column("yrsu", t);
 
-        //        add_constraintex(lp, i, row, col, GE, outputs.q_sfavail_expected.at(t)*0.999 );
-        //    }
-        //} //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+            add_constraintex(lp, 1, row, col, LE, 0.);
+            m_lp_rows.rec_su_avail.at(t) = get_Nrows(lp);
 
+            //Receiver consumption limit
+            row[0] = 1.;
+            col[0] = O.column("xr", t);
 
-        {
-            REAL row[5];
-            int col[5];
+            row[1] = 1.;
+            col[1] = O.column("xrsu", t);
+            
+            add_constraintex(lp, 2, row, col, LE, 0.);
+            m_lp_rows.rec_capacity.at(t) = get_Nrows(lp);
 
-            for(int t=0; t<nt; t++)
-            {
+            //Receiver operation mode requirement
+            row[0] = 1.;
+            col[0] = O.column("xr", t);
 
-                //Receiver startup inventory
-                row[0] = 1.;
-                col[0] = O.column("ursu", t);
+            row[1] = 1.;
+            col[1] = O.column("yr", t);
 
-                row[1] = -P["delta"];
-                col[1] = O.column("xrsu", t);
+            add_constraintex(lp, 2, row, col, LE, 0.);
+            m_lp_rows.rec_mode.at(t) = get_Nrows(lp);
 
-                if(t>0)
-                {
-                    row[2] = -1.;
-                    col[2] = O.column("ursu", t-1);
+            //Receiver minimum operation requirement
+            row[0] = 1.;
+            col[0] = O.column("xr", t);
 
-                    add_constraintex(lp, 3, row, col, LE, 0);
-                }
-                else
-                {
-                    add_constraintex(lp, 2, row, col, LE, 0.);
-                }
+            row[1] = -Qrl;
+            col[1] = O.column("yr", t);
 
-                //-----
+            add_constraintex(lp, 2, row, col, GE, 0.);
 
-                //inventory nonzero
-                row[0] = 1.;
-                col[0] = O.column("ursu", t);
+            //Receiver can't continue operating when no energy is available
+            row[0] = 1.;
+            col[0] = O.column("yr", t);
 
-                row[1] = -P["Er"];
-                col[1] = O.column("yrsu", t);
+            add_constraintex(lp, 1, row, col, LE, 0.);  //if any measurable energy, y^r can be 1
+            m_lp_rows.rec_avail.at(t) = get_Nrows(lp);
 
-                add_constraintex(lp, 2, row, col, LE, 0.);
+            // --- new constraints ---
 
-                //Receiver operation allowed when:
-                row[0] = 1.;
-                col[0] = O.column("yr", t);
-                
-                row[1] = -1.0/P["Er"]; 
-                col[1] = O.column("ursu", t);
+            //receiver startup/standby persist
+            /*row[0] = 1.;
+            col[0] = O.column("yrsu", t);
 
-                if(t>0)
-                {
-                    row[2] = -1.;
-                    col[2] = O.column("yr", t-1);
+            row[1] = 1.;
+            col[1] = O.column("yrsb", t);
 
-                    add_constraintex(lp, 3, row, col, LE, 0.); 
-                }
-                else
-                {
-                    add_constraintex(lp, 2, row, col, LE, (params.is_rec_operating0 ? 1. : 0.) );
-                }
+            add_constraintex(lp, 2, row, col, LE, 1.);*/
 
-                //Receiver startup can't be enabled after a time step where the Receiver was operating
-                if(t>0)
-                {
-                    row[0] = 1.;
-                    col[0] = O.column("yrsu", t);
+            //recever standby partition
+            /*row[0] = 1.;
+            col[0] = O.column("yr", t);
 
-                    row[1] = 1.;
-                    col[1] = O.column("yr", t-1);
+            row[1] = 1.;
+            col[1] = O.column("yrsb", t);
 
-                    add_constraintex(lp, 2, row, col, LE, 1.);
-                }
+            add_constraintex(lp, 2, row, col, LE, 1.);*/
 
-                //Receiver startup energy consumption
-                row[0] = 1.;
-                col[0] = O.column("xrsu", t);
+            if( t > 0 )
+            {
+                //rsb_persist
+                /*row[0] = 1.;
+                col[0] = O.column("yrsb", t);
 
-                row[1] = -P["Qru"];
-                col[1] = O.column("yrsu", t);
+                row[1] = -1.;
+                col[1] = O.column("yr", t-1);
 
-                add_constraintex(lp, 2, row, col, LE, 0.);
+                row[2] = -1.;
+                col[2] = O.column("yrsb", t-1);
 
-                //Receiver startup only during solar positive periods
+                add_constraintex(lp, 3, row, col, LE, 0.);*/
+
+                //receiver startup penalty
                 row[0] = 1.;
-                col[0] = O.column("yrsu", t);
+                col[0] = O.column("yrsup", t);
 
-                add_constraintex(lp, 1, row, col, LE, min(P["M"]*outputs.q_sfavail_expected.at(t), 1.0) );
+                row[1] = -1.;
+                col[1] = O.column("yrsu", t);
 
-                //Receiver consumption limit
-                row[0] = 1.;
-                col[0] = O.column("xr", t);
+                row[2] = 1.;
+                col[2] = O.column("yrsu", t-1);
 
-                row[1] = 1.;
-                col[1] = O.column("xrsu", t);
-                
-                add_constraintex(lp, 2, row, col, LE, outputs.q_sfavail_expected.at(t));
+                add_constraintex(lp, 3, row, col, GE, 0.);
 
-                //Receiver operation mode requirement
-                row[0] = 1.;
-                col[0] = O.column("xr", t);
+                //receiver hot startup penalty
+                /*row[0] = 1.;
+                col[0] = O.column("yrhsp", t);
 
-                row[1] = -outputs.q_sfavail_expected.at(t);
+                row[1] = -1.;
                 col[1] = O.column("yr", t);
 
-                add_constraintex(lp, 2, row, col, LE, 0.);
+                row[2] = -1.;
+                col[2] = O.column("yrsb", t-1);
 
-                //Receiver minimum operation requirement
-                row[0] = 1.;
-                col[0] = O.column("xr", t);
+                add_constraintex(lp, 3, row, col, GE, -1);*/
 
-                row[1] = -P["Qrl"];
-                col[1] = O.column("yr", t);
+                //receiver shutdown energy
+                /*row[0] = 1.;
+                col[0] = O.column("yrsd", t-1);
 
-                add_constraintex(lp, 2, row, col, GE, 0.);
+                row[1] = -1.;
+                col[1] = O.column("yr", t-1);
 
-                //Receiver can't continue operating when no energy is available
-                row[0] = 1.;
-                col[0] = O.column("yr", t);
+                row[2] = 1.;
+                col[2] = O.column("yr", t);
 
-                add_constraintex(lp, 1, row, col, LE, min(P["M"]*outputs.q_sfavail_expected.at(t), 1.0) );  //if any measurable energy, y^r can be 1
+                row[3] = -1.;
+                col[3] = O.column("yrsb", t-1);
 
-                // --- new constraints ---
+                row[4] = 1.;
+                col[4] = O.column("yrsb", t);
 
-                //receiver startup/standby persist
-                /*row[0] = 1.;
-                col[0] = O.column("yrsu", t);
+                add_constraintex(lp, 5, row, col, GE, 0.);*/
 
-                row[1] = 1.;
-                col[1] = O.column("yrsb", t);
+            }
+        }
+    }
 
-                add_constraintex(lp, 2, row, col, LE, 1.);*/
+    
+    // ******************** Power cycle constraints *******************
+    {
+        REAL row[5];
+        int col[5];
 
-                //recever standby partition
-                /*row[0] = 1.;
-                col[0] = O.column("yr", t);
 
-                row[1] = 1.;
-                col[1] = O.column("yrsb", t);
+        for(int t=0; t<nt; t++)
+        {
 
-                add_constraintex(lp, 2, row, col, LE, 1.);*/
+            int i=0;
+            //Startup Inventory balance
+            row[i  ] = 1.;
+            col[i++] = O.column("ucsu", t);
+            
+            row[i  ] = -delta * Qc;
+            col[i++] = O.column("ycsu", t);
 
-                if( t > 0 )
-                {
-                    //rsb_persist
-                    /*row[0] = 1.;
-                    col[0] = O.column("yrsb", t);
+            if(t>0)
+            {
+                row[i  ] = -1.;
+                col[i++] = O.column("ucsu", t-1);
+            }
 
-                    row[1] = -1.;
-                    col[1] = O.column("yr", t-1);
+            add_constraintex(lp, i, row, col, LE, 0.);
 
-                    row[2] = -1.;
-                    col[2] = O.column("yrsb", t-1);
+            //Inventory nonzero
+            row[0] = 1.;
+            col[0] = O.column("ucsu", t);
 
-                    add_constraintex(lp, 3, row, col, LE, 0.);*/
+            row[1] = -M;
+            col[1] = O.column("ycsu", t);
 
-                    //receiver startup penalty
-                    row[0] = 1.;
-                    col[0] = O.column("yrsup", t);
+            add_constraintex(lp, 2, row, col, LE, 0.);
 
-                    row[1] = -1.;
-                    col[1] = O.column("yrsu", t);
+            //Cycle operation allowed when:
+            i=0;
+            row[i  ] = 1.;
+            col[i++] = O.column("y", t);
+            
+            row[i  ] = -1.0/Ec; 
+            col[i++] = O.column("ucsu", t);
 
-                    row[2] = 1.;
-                    col[2] = O.column("yrsu", t-1);
+            if(t>0)
+            {
+                row[i  ] = -1.;
+                col[i++] = O.column("y", t-1);
 
-                    add_constraintex(lp, 3, row, col, GE, 0.);
+                row[i  ] = -1.;
+                col[i++] = O.column("ycsb", t-1);
 
-                    //receiver hot startup penalty
-                    /*row[0] = 1.;
-                    col[0] = O.column("yrhsp", t);
+                add_constraintex(lp, i, row, col, LE, 0.); 
+            }
+            else
+            {
+                add_constraintex(lp, i, row, col, LE, 0.);
+                m_lp_rows.pb_op0 = get_Nrows(lp);
+            }
 
-                    row[1] = -1.;
-                    col[1] = O.column("yr", t);
+            //Cycle consumption limit
+            i=0;
+            row[i  ] = 1.;
+            col[i++] = O.column("x", t);
 
-                    row[2] = -1.;
-                    col[2] = O.column("yrsb", t-1);
+            //mjw 2016.12.2 --> This constraint seems to be problematic in identifying feasible solutions for subhourly runs. Needs attention.
+            row[i  ] = Qc;
+            col[i++] = O.column("ycsu", t);
+            
+            row[i  ] = -Qu;
+            col[i++] = O.column("y", t);
 
-                    add_constraintex(lp, 3, row, col, GE, -1);*/
+            add_constraintex(lp, i, row, col, LE, 0.);
 
-                    //receiver shutdown energy
-                    /*row[0] = 1.;
-                    col[0] = O.column("yrsd", t-1);
+            //cycle operation mode requirement
+            row[0] = 1.;
+            col[0] = O.column("x", t);
 
-                    row[1] = -1.;
-                    col[1] = O.column("yr", t-1);
+            row[1] = -Qu;
+            col[1] = O.column("y", t);
 
-                    row[2] = 1.;
-                    col[2] = O.column("yr", t);
+            add_constraintex(lp, 2, row, col, LE, 0.);
 
-                    row[3] = -1.;
-                    col[3] = O.column("yrsb", t-1);
+            //Minimum cycle energy contribution
+            i=0;
+            row[i  ] = 1.;
+            col[i++] = O.column("x", t);
 
-                    row[4] = 1.;
-                    col[4] = O.column("yrsb", t);
+            row[i  ] = -Ql;
+            col[i++] = O.column("y", t);
 
-                    add_constraintex(lp, 5, row, col, GE, 0.);*/
+            add_constraintex(lp, i, row, col, GE, 0);
 
-                }
+            //cycle startup can't be enabled after a time step where the cycle was operating
+            if(t>0)
+            {
+                row[0] = 1.;
+                col[0] = O.column("ycsu", t);
+
+                row[1] = 1.;
+                col[1] = O.column("y", t-1);
+
+                add_constraintex(lp, 2, row, col, LE, 1.);
             }
-        }
 
-        
-        // ******************** Power cycle constraints *******************
-        {
-            REAL row[5];
-            int col[5];
 
+            //Standby mode entry
+            i=0;
+            row[i  ] = 1.;
+            col[i++] = O.column("ycsb", t);
 
-            for(int t=0; t<nt; t++)
+            if(t>0)
             {
+                row[i  ] = -1.;
+                col[i++] = O.column("y", t-1);
 
-                int i=0;
-                //Startup Inventory balance
-                row[i  ] = 1.;
-                col[i++] = O.column("ucsu", t);
-                
-                row[i  ] = -P["delta"] * P["Qc"];
-                col[i++] = O.column("ycsu", t);
-
-                if(t>0)
-                {
-                    row[i  ] = -1.;
-                    col[i++] = O.column("ucsu", t-1);
-                }
+                row[i  ] = -1.;
+                col[i++] = O.column("ycsb", t-1);
 
+                add_constraintex(lp, i, row, col, LE, 0);
+            }
+            else
+            {
                 add_constraintex(lp, i, row, col, LE, 0.);
+                m_lp_rows.pb_sb0 = get_Nrows(lp);
+            }
 
-                //Inventory nonzero
+            //some modes can't coincide
+            row[0] = 1.;
+            col[0] = O.column("ycsu", t);
+            row[1] = 1.;
+            col[1] = O.column("ycsb", t);    
+
+            add_constraintex(lp, 2, row, col, LE, 1);   
+
+            row[0] = 1.;
+            col[0] = O.column("y", t);
+            row[1] = 1.;
+            col[1] = O.column("ycsb", t);    
+
+            add_constraintex(lp, 2, row, col, LE, 1);   
+
+            if( t > 0 )
+            {
+                //cycle start penalty
                 row[0] = 1.;
-                col[0] = O.column("ucsu", t);
+                col[0] = O.column("ycsup", t);
 
-                row[1] = -P["M"];
+                row[1] = -1.;
                 col[1] = O.column("ycsu", t);
 
-                add_constraintex(lp, 2, row, col, LE, 0.);
+                row[2] = 1.;
+                col[2] = O.column("ycsu", t-1);
 
-                //Cycle operation allowed when:
-                i=0;
-                row[i  ] = 1.;
-                col[i++] = O.column("y", t);
-                
-                row[i  ] = -1.0/P["Ec"]; 
-                col[i++] = O.column("ucsu", t);
+                add_constraintex(lp, 3, row, col, GE, 0.);
 
-                if(t>0)
-                {
-                    row[i  ] = -1.;
-                    col[i++] = O.column("y", t-1);
+                //cycle standby start penalty
+                row[0] = 1.;
+                col[0] = O.column("ychsp", t);
 
-                    row[i  ] = -1.;
-                    col[i++] = O.column("ycsb", t-1);
+                row[1] = -1.;
+                col[1] = O.column("y", t);
 
-                    add_constraintex(lp, i, row, col, LE, 0.); 
-                }
-                else
-                {
-                    add_constraintex(lp, i, row, col, LE, (params.is_pb_operating0 ? 1. : 0.) + (params.is_pb_standby0 ? 1. : 0.) );
-                }
+                row[2] = -1.;
+                col[2] = O.column("ycsb", t-1);
 
-                //Cycle consumption limit
-                i=0;
-                row[i  ] = 1.;
-                col[i++] = O.column("x", t);
+                add_constraintex(lp, 3, row, col, GE, -1.);
+
+#ifdef MOD_CYCLE_SHUTDOWN
+                //cycle shutdown energy penalty
+                row[0] = 1.;
+                col[0] = O.column("ycsd", t-1);
 
-                //mjw 2016.12.2 --> This constraint seems to be problematic in identifying feasible solutions for subhourly runs. Needs attention.
-                row[i  ] = P["Qc"];
-                col[i++] = O.column("ycsu", t);
+                row[1] = -1.;
+                col[1] = O.column("y", t-1);
+                
+                row[2] = 1.;
+                col[2] = O.column("y", t);
+                
+                row[3] = -1.;
+                col[3] = O.column("ycsb", t-1);
                 
-                row[i  ] = -P["Qu"];
-                col[i++] = O.column("y", t);
+                row[4] = 1.;
+                col[4] = O.column("ycsb", t);
 
-                add_constraintex(lp, i, row, col, LE, 0.);
+                add_constraintex(lp, 5, row, col, GE, 0.);
+#endif
 
-                //cycle operation mode requirement
-                row[0] = 1.;
-                col[0] = O.column("x", t);
+            }
+        }
+    }
 
-                row[1] = -P["Qu"];
-                col[1] = O.column("y", t);
 
-                add_constraintex(lp, 2, row, col, LE, 0.);
+    // ******************** Balance constraints *******************
+    //Energy in, out, and stored in the TES system must balance.
+    {
+        REAL row[7];
+        int col[7];
+
+        for(int t=0; t<nt; t++)
+        {
+            int i=0;
 
-                //Minimum cycle energy contribution
-                i=0;
+            row[i  ] = delta;
+            col[i++] = O.column("xr", t);
+            
+            row[i  ] = -delta*Qc;
+            col[i++] = O.column("ycsu", t);
+            
+            row[i  ] = -delta*Qb; 
+            col[i++] = O.column("ycsb", t);
+            
+            row[i  ] = -delta;
+            col[i++] = O.column("x", t);
+#ifdef MOD_REC_STANDBY                
+            row[i  ] = -delta*Qrsb;
+            col[i++] = O.column("yrsb", t);
+#endif
+            
+            row[i  ] = -1.;
+            col[i++] = O.column("s", t);
+            
+            if(t>0)
+            {
                 row[i  ] = 1.;
-                col[i++] = O.column("x", t);
+                col[i++] = O.column("s", t-1);
 
-                row[i  ] = -P["Ql"];
-                col[i++] = O.column("y", t);
+                add_constraintex(lp, i, row, col, EQ, 0.);
+            }
+            else
+            {
+                add_constraintex(lp, i, row, col, EQ, 0.);  //initial storage state (kWh)
+                m_lp_rows.tes0 = get_Nrows(lp);
+            }
+        }
+    }
+    
+    //Energy in storage must be within limits
+    {
+        REAL row[8];
+        int col[8];
 
-                add_constraintex(lp, i, row, col, GE, 0);
+        for(int t=0; t<nt; t++)
+        {
+            
+            row[0] = 1.;
+            col[0] = O.column("s", t);
 
-                //cycle startup can't be enabled after a time step where the cycle was operating
-                if(t>0)
-                {
-                    row[0] = 1.;
-                    col[0] = O.column("ycsu", t);
+            add_constraintex(lp, 1, row, col, LE, Eu);
 
-                    row[1] = 1.;
-                    col[1] = O.column("y", t-1);
+			//max cycle thermal input in time periods where cycle operates and receiver is starting up
+            //outputs.delta_rs.resize(nt);
+			if (t < nt - 1)
+			{
+				double large = 5.0*params.q_pb_max;
+				int i = 0;
 
-                    add_constraintex(lp, 2, row, col, LE, 1.);
-                }
+				row[i] = 1.;
+				col[i++] = O.column("x", t + 1);
 
+				row[i] = params.q_pb_standby + large;
+				col[i++] = O.column("ycsb", t + 1);
 
-                //Standby mode entry
-                i=0;
-                row[i  ] = 1.;
-                col[i++] = O.column("ycsb", t);
+				row[i] = 1.;
+				col[i++] = O.column("s", t);
 
-                if(t>0)
-                {
-                    row[i  ] = -1.;
-                    col[i++] = O.column("y", t-1);
+				row[i] = large;
+				col[i++] = O.column("yrsu", t + 1);
 
-                    row[i  ] = -1.;
-                    col[i++] = O.column("ycsb", t-1);
+				row[i] = large;
+				col[i++] = O.column("y", t + 1);
 
-                    add_constraintex(lp, i, row, col, LE, 0);
-                }
-                else
-                {
-                    add_constraintex(lp, i, row, col, LE, (params.is_pb_standby0 ? 1 : 0) + (params.is_pb_operating0 ? 1 : 0));
-                }
+				row[i] = large;
+				col[i++] = O.column("y", t);
 
-                //some modes can't coincide
-                row[0] = 1.;
-                col[0] = O.column("ycsu", t);
-                row[1] = 1.;
-                col[1] = O.column("ycsb", t);    
+				row[i] = large;
+				col[i++] = O.column("ycsb", t);
 
-                add_constraintex(lp, 2, row, col, LE, 1);   
+				add_constraintex(lp, i, row, col, LE, 3.0*large);
+				m_lp_rows.tes_rec_su.at(t) = get_Nrows(lp);
+			}
 
-                row[0] = 1.;
-                col[0] = O.column("y", t);
-                row[1] = 1.;
-                col[1] = O.column("ycsb", t);    
+        }
+    }
 
-                add_constraintex(lp, 2, row, col, LE, 1);   
+    // Maximum gross electricity production constraint
+    {
+        REAL row[1];
+        int col[1];
 
-                if( t > 0 )
-                {
-                    //cycle start penalty
-                    row[0] = 1.;
-                    col[0] = O.column("ycsup", t);
+        for( int t = 0; t<nt; t++ )
+        {
+            row[0] = 1.;
+            col[0] = O.column("wdot", t);
 
-                    row[1] = -1.;
-                    col[1] = O.column("ycsu", t);
+			add_constraintex(lp, 1, row, col, LE, 0.);
+			m_lp_rows.w_gross.at(t) = get_Nrows(lp);
+        }
+    }
 
-                    row[2] = 1.;
-                    col[2] = O.column("ycsu", t-1);
+	// Maximum net electricity production constraint
+	{
+		REAL row[7];
+		int col[7];
 
-                    add_constraintex(lp, 3, row, col, GE, 0.);
+		for (int t = 0; t<nt; t++)
+		{
+			int i = 0;
 
-                    //cycle standby start penalty
-                    row[0] = 1.;
-                    col[0] = O.column("ychsp", t);
+			row[i] = 1.;
+			col[i++] = O.column("wdot", t);
 
-                    row[1] = -1.;
-                    col[1] = O.column("y", t);
+			row[i] = 1.;
+			col[i++] = O.column("xr", t);
 
-                    row[2] = -1.;
-                    col[2] = O.column("ycsb", t-1);
+			row[i] = 1.;
+			col[i++] = O.column("xrsu", t);
 
-                    add_constraintex(lp, 3, row, col, GE, -1.);
+			row[i] = 1.;
+			col[i++] = O.column("yrsu", t);
 
-#ifdef MOD_CYCLE_SHUTDOWN
-                    //cycle shutdown energy penalty
-                    row[0] = 1.;
-                    col[0] = O.column("ycsd", t-1);
-
-                    row[1] = -1.;
-                    col[1] = O.column("y", t-1);
-                    
-                    row[2] = 1.;
-                    col[2] = O.column("y", t);
-                    
-                    row[3] = -1.;
-                    col[3] = O.column("ycsb", t-1);
-                    
-                    row[4] = 1.;
-                    col[4] = O.column("ycsb", t);
-
-                    add_constraintex(lp, 5, row, col, GE, 0.);
-#endif
+			row[i] = 1.;
+			col[i++] = O.column("yr", t);
 
-                }
-            }
-        }
+			row[i] = 1.;
+			col[i++] = O.column("ycsb", t);
 
+			row[i] = 1.;
+			col[i++] = O.column("x", t);
 
-        // ******************** Balance constraints *******************
-        //Energy in, out, and stored in the TES system must balance.
-        {
-            REAL row[7];
-            int col[7];
+			add_constraintex(lp, 7, row, col, LE, 0.);
+			m_lp_rows.w_net.at(t) = get_Nrows(lp);
+		}
+	}
 
-            for(int t=0; t<nt; t++)
-            {
-                int i=0;
+    //Set problem to maximize
+    set_maxim(lp);
 
-                row[i  ] = P["delta"];
-                col[i++] = O.column("xr", t);
-                
-                row[i  ] = -P["delta"]*P["Qc"];
-                col[i++] = O.column("ycsu", t);
-                
-                row[i  ] = -P["delta"]*P["Qb"]; 
-                col[i++] = O.column("ycsb", t);
-                
-                row[i  ] = -P["delta"];
-                col[i++] = O.column("x", t);
-#ifdef MOD_REC_STANDBY                
-                row[i  ] = -delta*Qrsb;
-                col[i++] = O.column("yrsb", t);
-#endif
-                
-                row[i  ] = -1.;
-                col[i++] = O.column("s", t);
-                
-                if(t>0)
-                {
-                    row[i  ] = 1.;
-                    col[i++] = O.column("s", t-1);
+    //reset the row mode
+    set_add_rowmode(lp, FALSE);
 
-                    add_constraintex(lp, i, row, col, EQ, 0.);
-                }
-                else
-                {
-                    add_constraintex(lp, i, row, col, EQ, -P["s0"]);  //initial storage state (kWh)
-                }
-            }
-        }
+    m_lp_nstep = nt;
+    lp_plant_parameters(this, P, m_lp_plant);
+}
+
+void csp_dispatch_opt::update_lp(unordered_map<std::string, double> &P, int nt)
+{
+    /* 
+    Set the objective function and the coefficients and right-hand sides that depend on the price signal, the 
+    performance forecast, and the initial plant state of the current optimization window.
+    */
+    lprec *lp = m_lp;
+    optimization_vars &O = *m_lp_vars;
+
+    double delta = P["delta"];
+    double Lr = P["Lr"];
+    double M = P["M"];
+    double etap = P["etap"];
+    double Wdotu = P["Wdotu"];
+    double Qu = P["Qu"];
+    double W_dot_cycle = P["W_dot_cycle"];
+    double disp_time_weighting = P["disp_time_weighting"];
+    double rsu_cost = P["rsu_cost"];
+    double csu_cost = P["csu_cost"];
+    double pen_delta_w = P["pen_delta_w"];
+
+    //columns of the first time step. Each variable occupies nt consecutive columns
+    int c_xr = O.column("xr", 0);
+    int c_xrsu = O.column("xrsu", 0);
+    int c_yr = O.column("yr", 0);
+    int c_yrsu = O.column("yrsu", 0);
+    int c_yrsup = O.column("yrsup", 0);
+    int c_x = O.column("x", 0);
+    int c_y = O.column("y", 0);
+    int c_s = O.column("s", 0);
+    int c_ycsb = O.column("ycsb", 0);
+    int c_ycsup = O.column("ycsup", 0);
+    int c_ychsp = O.column("ychsp", 0);
+    int c_wdot = O.column("wdot", 0);
+    int c_delta_w = O.column("delta_w", 0);
+
+    /* 
+    --------------------------------------------------------------------------------
+    objective function
+    --------------------------------------------------------------------------------
+    */
+	{
+        int *col = new int[12 * nt];
+        REAL *row = new REAL[12 * nt];
+        double tadj = disp_time_weighting;
+        int i = 0;
+
+        //calculate the mean price to appropriately weight the receiver production timing derate
+        double pmean =0;
+        for(int t=0; t<(int)price_signal.size(); t++)
+            pmean += price_signal.at(t);
+        pmean /= (double)price_signal.size();
+        //--
         
-        //Energy in storage must be within limits
+        for(int t=0; t<nt; t++)
         {
-            REAL row[8];
-            int col[8];
+            i = 0;
+            col[ t + nt*(i  ) ] = c_wdot + t;
+            row[ t + nt*(i++) ] = delta * price_signal.at(t)*tadj*(1.-outputs.w_condf_expected.at(t));
 
-            for(int t=0; t<nt; t++)
-            {
-                
-                row[0] = 1.;
-                col[0] = O.column("s", t);
+            col[ t + nt*(i  ) ] = c_xr + t;
+            row[ t + nt*(i++) ] = -(delta * price_signal.at(t) * Lr)+tadj*pmean;  // tadj added to prefer receiver production sooner (i.e. delay dumping)
 
-                add_constraintex(lp, 1, row, col, LE, P["Eu"]);
+            col[ t + nt*(i  ) ] = c_xrsu + t;
+            row[ t + nt*(i++) ] = -delta * price_signal.at(t) * Lr;
 
-				//max cycle thermal input in time periods where cycle operates and receiver is starting up
-                //outputs.delta_rs.resize(nt);
-				if (t < nt - 1)
-				{
-					/*double delta_rec_startup = min(1., max(params.e_rec_startup / max(outputs.q_sfavail_expected.at(t + 1)*P["delta"], 1.), params.dt_rec_startup / P["delta"]));
-                    outputs.delta_rs.at(t) = delta_rec_startup;*/
-					double t_rec_startup = outputs.delta_rs.at(t) * P["delta"];
-					double large = 5.0*params.q_pb_max;
-					int i = 0;
+            col[ t + nt*(i  ) ] = c_yrsu + t;
+            row[ t + nt*(i++) ] = -price_signal.at(t) * (params.w_rec_ht + params.w_stow);
 
-					row[i] = 1.;
-					col[i++] = O.column("x", t + 1);
+            col[ t + nt*(i  ) ] = c_yr + t;
+            row[ t + nt*(i++) ] = -(delta * price_signal.at(t) * params.w_track) + tadj;	// tadj added to prefer receiver operation in nearer term to longer term
 
-					row[i] = params.q_pb_standby + large;
-					col[i++] = O.column("ycsb", t + 1);
+            col[ t + nt*(i  ) ] = c_x + t;
+            row[ t + nt*(i++) ] = -delta * price_signal.at(t) * params.w_cycle_pump;
 
-					row[i] = -1. / t_rec_startup;
-					col[i++] = O.column("s", t);
+            col[ t + nt*(i  ) ] = c_ycsb + t;
+            row[ t + nt*(i++) ] = -delta * price_signal.at(t) * params.w_cycle_standby;
 
-					row[i] = large;
-					col[i++] = O.column("yrsu", t + 1);
+            //xxcol[ t + nt*(i   ] = O.column("yrsb", t);
+            //xxrow[ t + nt*(i++) ] = -delta * price_signal.at(t) * (Lr * Qrl + (params.w_stow / delta));
 
-					row[i] = large;
-					col[i++] = O.column("y", t + 1);
+            //xxcol[ t + nt*(i   ] = O.column("yrsd", t);
+            //xxrow[ t + nt*(i++) ] = -0.5 - (params.w_stow);
 
-					row[i] = large;
-					col[i++] = O.column("y", t);
+            //xxcol[ t + nt*(i   ] = O.column("ycsd", t);
+            //xxrow[ t + nt*(i++) ] = -0.5;
 
-					row[i] = large;
-					col[i++] = O.column("ycsb", t);
+            col[ t + nt*(i  ) ] = c_yrsup + t;
+            row[ t + nt*(i++) ] = -rsu_cost*tadj;
 
-					add_constraintex(lp, i, row, col, LE, 3.0*large);
-				}
+            //xxcol[ t + nt*(i   ] = O.column("yrhsp", t);
+            //xxrow[ t + nt*(i++) ] = -tadj;
 
-            }
+            col[ t + nt*(i  ) ] = c_ycsup + t;
+            row[ t + nt*(i++) ] = -csu_cost*tadj;
+
+            col[ t + nt*(i  ) ] = c_ychsp + t;
+            row[ t + nt*(i++) ] = -csu_cost*tadj * 0.1;
+
+            col[ t + nt*(i  ) ] = c_delta_w + t;
+            row[ t + nt*(i++) ] = -pen_delta_w*tadj;
+
+            tadj *= disp_time_weighting;
         }
 
-        // Maximum gross electricity production constraint
+        set_obj_fnex(lp, i*nt, row, col);
+
+        delete[] col;
+        delete[] row;
+    }
+
+    /* 
+    --------------------------------------------------------------------------------
+    initial state
+    --------------------------------------------------------------------------------
+    */
+    set_rh(lp, m_lp_rows.delta_w0, -P["Wdot0"]);
+    set_rh(lp, m_lp_rows.rec_op0, (params.is_rec_operating0 ? 1. : 0.) );
+    set_rh(lp, m_lp_rows.pb_op0, (params.is_pb_operating0 ? 1. : 0.) + (params.is_pb_standby0 ? 1. : 0.) );
+    set_rh(lp, m_lp_rows.pb_sb0, (params.is_pb_standby0 ? 1 : 0) + (params.is_pb_operating0 ? 1 : 0));
+    set_rh(lp, m_lp_rows.tes0, -P["s0"]);  //initial storage state (kWh)
+
+    /* 
+    --------------------------------------------------------------------------------
+    forecast and limits at each time step
+    --------------------------------------------------------------------------------
+    */
+    for(int t=0; t<nt; t++)
+    {
+        //power production curve
+        set_mat(lp, m_lp_rows.power_curve.at(t), c_x + t, -etap*outputs.eta_pb_expected.at(t)/params.eta_cycle_ref);
+        set_mat(lp, m_lp_rows.power_curve.at(t), c_y + t, -(Wdotu - etap*Qu)*outputs.eta_pb_expected.at(t)/params.eta_cycle_ref);
+
+        //Receiver startup only during solar positive periods
+        set_rh(lp, m_lp_rows.rec_su_avail.at(t), min(M*outputs.q_sfavail_expected.at(t), 1.0) );
+
+        //Receiver consumption limit
+        set_rh(lp, m_lp_rows.rec_capacity.at(t), outputs.q_sfavail_expected.at(t));
+
+        //Receiver operation mode requirement
+        set_mat(lp, m_lp_rows.rec_mode.at(t), c_yr + t, -outputs.q_sfavail_expected.at(t));
+
+        //Receiver can't continue operating when no energy is available
+        set_rh(lp, m_lp_rows.rec_avail.at(t), min(M*outputs.q_sfavail_expected.at(t), 1.0) );
+
+        //max cycle thermal input in time periods where cycle operates and receiver is starting up
+        if( t < nt - 1 )
         {
-            REAL row[1];
-            int col[1];
+            double t_rec_startup = outputs.delta_rs.at(t) * delta;
+            set_mat(lp, m_lp_rows.tes_rec_su.at(t), c_s + t, -1. / t_rec_startup);
+        }
 
-            for( int t = 0; t<nt; t++ )
-            {
-                row[0] = 1.;
-                col[0] = O.column("wdot", t);
+        // Maximum gross electricity production constraint
+        set_rh(lp, m_lp_rows.w_gross.at(t), outputs.f_pb_op_limit.at(t) * W_dot_cycle);
 
-				add_constraintex(lp, 1, row, col, LE, outputs.f_pb_op_limit.at(t) * P["W_dot_cycle"]);
-            }
+        // Maximum net electricity production constraint
+        //check if cycle should be able to operate
+        if( outputs.wnet_lim_min.at(t) > w_lim.at(t) )      // power cycle operation is impossible at t
+        {
+            if(w_lim.at(t) > 0)
+                params.messages->add_message(C_csp_messages::NOTICE, "Power cycle operation not possible at time "+ util::to_string(t+1) + ": power limit below minimum operation");                    
+            w_lim.at(t) = 0.;
         }
 
-		// Maximum net electricity production constraint
+        int r = m_lp_rows.w_net.at(t);
+		if (w_lim.at(t) > 0.)	// Power cycle operation is possible
+		{
+            set_mat(lp, r, c_wdot + t, 1.0-outputs.w_condf_expected.at(t));
+            set_mat(lp, r, c_xr + t, -params.w_rec_pump);
+            set_mat(lp, r, c_xrsu + t, -params.w_rec_pump);
+            set_mat(lp, r, c_yrsu + t, -(params.w_rec_ht / params.dt) - (params.w_stow / params.dt));	//kWe
+            set_mat(lp, r, c_yr + t, -params.w_track);
+            set_mat(lp, r, c_ycsb + t, -params.w_cycle_standby);
+            set_mat(lp, r, c_x + t, -params.w_cycle_pump);
+            set_constr_type(lp, r, LE);
+            set_rh(lp, r, w_lim.at(t));
+		}
+		else // Power cycle operation is impossible at current constrained wlim
 		{
-			REAL row[9];
-			int col[9];
+            set_mat(lp, r, c_wdot + t, 1.0);
+            set_mat(lp, r, c_xr + t, 0.);
+            set_mat(lp, r, c_xrsu + t, 0.);
+            set_mat(lp, r, c_yrsu + t, 0.);
+            set_mat(lp, r, c_yr + t, 0.);
+            set_mat(lp, r, c_ycsb + t, 0.);
+            set_mat(lp, r, c_x + t, 0.);
+            set_constr_type(lp, r, EQ);
+            set_rh(lp, r, 0.);
+		}
+    }
+}
 
-			for (int t = 0; t<nt; t++)
-			{
-                
-                //check if cycle should be able to operate
-                if( outputs.wnet_lim_min.at(t) > w_lim.at(t) )      // power cycle operation is impossible at t
-                {
-                    if(w_lim.at(t) > 0)
-                        params.messages->add_message(C_csp_messages::NOTICE, "Power cycle operation not possible at time "+ util::to_string(t+1) + ": power limit below minimum operation");                    
-                    w_lim.at(t) = 0.;
-                    
-                }
+bool csp_dispatch_opt::optimize()
+{
 
-				if (w_lim.at(t) > 0.)	// Power cycle operation is possible
-				{
-					int i = 0;
+    //First check to see whether we should call the AMPL engine instead. 
+    if( solver_params.is_ampl_engine )
+    {
+        return optimize_ampl();
+    }
 
-					row[i] = 1.0-outputs.w_condf_expected.at(t);
-					col[i++] = O.column("wdot", t);
+    /* 
+    Formulate the optimization problem for dispatch generation. We are trying to maximize revenue subject to inventory
+    constraints.
+    
+    
+    Variables
+    -------------------------------------------------------------
+    Continuous
+    -------------------------------------------------------------
+    xr          kWt     Power delivered by the receiver at time t
+    xrsu        kWt     Power used by the reciever for start up
+    ursu        kWt     Receiver accumulated start-up thermal power at time t
+    x           kWt	    Cycle thermal power consumption at time t 
+    ucsu        kWt     Cycle accumulated start-up thermal power at time t
+    s           kWht    TES reserve quantity at time t (auxiliary variable) 
+    wdot        kWe     Electrical power production at time t
+    delta_w     kWe     Positive change in power production at time t w/r/t t-1
+    -------------------------------------------------------------
+    Binary
+    -------------------------------------------------------------
+    yr              1 if receiver is generating ``usable'' thermal power at time t; 0 otherwise 
+    yrsu            1 if receiver is starting up at time t; 0 otherwise 
+    yrsb            1 if receiver is in standby at time t; 0 otherwise
+    yrsup           1 if reciever startup penalty is enforced at time t; 0 otherwise
+    yrhsp           1 if receiver hot startup penalty is enforced at time t; 0 otherwise
+    y               1 if cycle is generating electric power at time t; 0 otherwise
+    ycsu            1 if cycle is starting up at time t; 0 otherwise
+    ycsb            1 if cycle is in standby mode at time t; 0 otherwise
+    ycsup           1 if cycle startup penalty is enforced at time t; 0 otherwise
+    ychsp           1 if cycle hot startup penalty is enforced at time t; 0 otherwise
+    -------------------------------------------------------------
+    */
+    lprec *lp = NULL;
+    int ret = 0;
 
-					row[i] = -params.w_rec_pump;
-					col[i++] = O.column("xr", t);
 
-					row[i] = -params.w_rec_pump;
-					col[i++] = O.column("xrsu", t);
+    try{
 
-					row[i] = -(params.w_rec_ht / params.dt) - (params.w_stow / params.dt);	//kWe
-					col[i++] = O.column("yrsu", t);
+        //Calculate the number of variables
+        int nt = (int)m_nstep_opt;
 
-					row[i] = -params.w_track;
-					col[i++] = O.column("yr", t);
+        std::chrono::steady_clock::time_point clock_start = std::chrono::steady_clock::now();
 
-					row[i] = -params.w_cycle_standby;
-					col[i++] = O.column("ycsb", t);
+        unordered_map<std::string, double> P;
+        calculate_parameters(this, P, nt);
 
-					row[i] = -params.w_cycle_pump;
-					col[i++] = O.column("x", t);
+        //the model structure only depends on the horizon length and plant parameters, so it is built once and 
+        //reused for every window with the same horizon
+        vector<double> plant;
+        lp_plant_parameters(this, P, plant);
+        if( m_lp == NULL || m_lp_nstep != nt || plant != m_lp_plant )
+            build_lp(P, nt);
 
-					//row[i] = -(params.w_rec_pump*params.q_rec_min) - (params.w_stow / params.dt); //kWe
-					//col[i++] = O.column("yrsb", t);
-					//row[i] - params.w_stow / params.dt;	//kWe
-					//col[i++] = O.column("yrsd", t);
+        update_lp(P, nt);
 
-					add_constraintex(lp, 7, row, col, LE, w_lim.at(t));
-				}
-				else // Power cycle operation is impossible at current constrained wlim
-				{
-					row[0] = 1.0;
-					col[0] = O.column("wdot", t);
-					add_constraintex(lp, 1, row, col, EQ, 0.);
-				}
-			}
-		}
+        //presolve removes rows and columns from the model it is applied to, so solve a copy and keep the
+        //persistent model intact for the next window. The copy starts from the default basis: the previous
+        //window's basis belongs to its presolved model and does not map onto this one, so there is no warm start.
+        //Solving the persistent model in place without presolve, from the previous basis, was measured slower and 
+        //less reliable: without a basis it took a third longer over 100 windows of 24 hours, restoring the final
+        //branch and bound basis crashes lp_solve, and a basis guessed from the previous solution leaves a third of
+        //the windows unbounded.
+        lp = copy_lp(m_lp);
 
-        
-        //Set problem to maximize
-        set_maxim(lp);
+        if(lp == NULL)
+            throw C_csp_exception("Failed to create a new CSP dispatch optimization problem context.");
 
-        //reset the row mode
-        set_add_rowmode(lp, FALSE);
+        outputs.build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_start).count();
 
         //set the log function
         solver_params.reset();
@@ -1441,95 +1655,71 @@ bool csp_dispatch_opt::optimize()
             outputs.q_rec_startup.resize(nt, 0.);
             outputs.w_pb_target.resize(nt, 0.);
 
+            int nrows = get_Nrows(lp);
             int ncols = get_Ncolumns(lp);
 
-//            char name[15];
             REAL *vars = new REAL[ncols];
             get_variables(lp, vars);
-//            int col;
 
-
-            for(int c=1; c<ncols; c++)
+            //presolve may have removed columns, so map each remaining column back to its variable and time step
+            optimization_vars &O = *m_lp_vars;
+            for(int c=1; c<=ncols; c++)
             {
-                char *colname = get_col_name(lp, c);
-                if(! colname) continue;
-
-                char root[15];
+                int col = get_orig_index(lp, nrows + c);
 
-                int i;
-                for(i=0; i<15; i++)
+                optimization_vars::opt_var *v = NULL;
+                for(int i=0; i<O.get_num_varobjs(); i++)
                 {
-                    if(colname[i] == '-')
+                    if( col > O.get_var(i)->ind_start && col <= O.get_var(i)->ind_end )
                     {
-                        root[i] = '\0';
+                        v = O.get_var(i);
                         break;
                     }
-                    else
-                        root[i] = colname[i];
-                }
-                int i1=1 + i++;
-                char ind[4];
-                bool not_interested = false;
-                for(i=i1; i<15; i++)
-                {
-                    if(colname[i] == '-')
-                    {
-                        //2D variable. Not interested at the moment..
-                        not_interested = true;
-                        break;
-                    }
-                    else if(colname[i] == 0)
-                    {
-                        ind[i-i1] = '\0';
-                        break;
-                    }
-                    else
-                        ind[i-i1] = colname[i];
                 }
+                if( v == NULL || v->var_dim != optimization_vars::VAR_DIM::DIM_T ) continue;
 
-                if(not_interested) continue;  //a 2D variable
+                const string &root = v->name;
+                int t = col - 1 - v->ind_start;
 
-                int t = atoi(ind);
-
-                if(strcmp(root, "ycsb") == 0)  //Cycle standby
+                if(root == "ycsb")  //Cycle standby
                 {
                     outputs.pb_standby.at(t) = vars[ c-1 ] == 1.;
                 }
-                else if(strcmp(root, "ycsu") == 0)     //Cycle start up
+                else if(root == "ycsu")     //Cycle start up
                 {
                     bool su = (fabs(1 - vars[ c-1 ]) < 0.001);
                     outputs.pb_operation.at(t) = outputs.pb_operation.at(t) || su;
                     outputs.q_pb_startup.at(t) = su ? P["Qc"] : 0.;
                 }
-                else if(strcmp(root, "y") == 0)     //Cycle operation
+                else if(root == "y")     //Cycle operation
                 {
                     outputs.pb_operation.at(t) = outputs.pb_operation.at(t) || ( fabs(1. - vars[ c-1 ]) < 0.001 );
                 }
-                else if(strcmp(root, "x") == 0)     //Cycle thermal energy consumption
+                else if(root == "x")     //Cycle thermal energy consumption
                 {
                     outputs.q_pb_target.at(t) = vars[ c-1 ];
                 }
-                else if(strcmp(root, "yrsu") == 0)     //Receiver start up
+                else if(root == "yrsu")     //Receiver start up
                 {
                     outputs.rec_operation.at(t) = outputs.rec_operation.at(t) || (fabs(1 - vars[ c-1 ]) < 0.001);
                 }
-                else if(strcmp(root, "xrsu") == 0)
+                else if(root == "xrsu")
                 {
                     outputs.q_rec_startup.at(t) = vars[ c-1 ];
                 }
-                else if(strcmp(root, "yr") == 0)
+                else if(root == "yr")
                 {
                     outputs.rec_operation.at(t) = outputs.rec_operation.at(t) || (fabs(1 - vars[ c-1 ]) < 0.001);
                 }
-                else if(strcmp(root, "s") == 0)         //Thermal storage charge state
+                else if(root == "s")         //Thermal storage charge state
                 {
                     outputs.tes_charge_expected.at(t) = vars[ c-1 ];
                 }
-                else if(strcmp(root, "xr") == 0)   //receiver production
+                else if(root == "xr")   //receiver production
                 {
                     outputs.q_sf_expected.at(t) = vars[ c-1 ];
                 }
-                else if(strcmp(root, "wdot") == 0) //electricity production
+                else if(root == "wdot") //electricity production
                 {
                     outputs.w_pb_target.at(t) = vars[ c-1 ];
                 }
@@ -1626,9 +1816,10 @@ bool csp_dispatch_opt::optimize()
     }
     catch(exception &e)
     {
-        //clean up memory and pass on the exception
+        //clean up memory and pass on the exception. The persistent model may be partially updated, so it is rebuilt next time
         if( lp != NULL )
             delete_lp(lp);
+        free_lp();
         
         throw e;
 
@@ -1638,6 +1829,7 @@ bool csp_dispatch_opt::optimize()
         //clean up memory and pass on the exception
         if( lp != NULL )
             delete_lp(lp);
+        free_lp();
 
         return false;
     }
@@ -1891,6 +2083,12 @@ optimization_vars::optimization_vars()
 {
     current_mem_pos = 0;
     alloc_mem_size = 0;
+    data = NULL;
+}
+
+optimization_vars::~optimization_vars()
+{
+    delete [] data;
 }
 void optimization_vars::add_var(const string &vname, int var_type /* VAR_TYPE enum */, int var_dim /* VAR_DIM enum */, int var_dim_size, REAL lobo, REAL upbo)
 {
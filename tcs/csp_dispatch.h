@@ -37,13 +37,64 @@ using namespace std;
 #ifndef _CSP_DISPATCH
 #define _CSP_DISPATCH
 
+class optimization_vars;
+
 class csp_dispatch_opt
 {
     int  m_nstep_opt;              //number of time steps in the optimized array
     bool m_is_weather_setup;  //bool indicating whether the weather has been copied
-    
+
+    //persistent dispatch model. The structure is built once for a horizon length and set of plant parameters,
+    //and only the objective, right-hand sides, and forecast-dependent coefficients are updated for each window
+    lprec *m_lp;
+    optimization_vars *m_lp_vars;   //variable layout of m_lp
+    int m_lp_nstep;                 //horizon length m_lp was built for
+    vector<double> m_lp_plant;      //plant parameters m_lp was built with
+
+    struct s_lp_rows
+    {
+        //rows holding the initial plant state
+        int delta_w0;
+        int rec_op0;
+        int pb_op0;
+        int pb_sb0;
+        int tes0;
+        //rows with window-dependent data at each time step
+        vector<int> power_curve;
+        vector<int> rec_su_avail;
+        vector<int> rec_capacity;
+        vector<int> rec_mode;
+        vector<int> rec_avail;
+        vector<int> tes_rec_su;
+        vector<int> w_gross;
+        vector<int> w_net;
+    } m_lp_rows;
+
+    //performance estimates at each weather step. Each step is evaluated the first time a horizon covers it and is 
+    //reused by every later horizon that overlaps it
+    struct s_perf_table
+    {
+        double step;                //[s] time step the estimates were evaluated with
+        vector<bool> is_set;
+        vector<double> q_inc;       //[kWt] incident power on the receiver
+        vector<double> therm_eff;   //[-] receiver thermal efficiency, before the solar field adjustment
+        vector<double> cycle_eff;   //[-] power cycle efficiency
+        vector<double> f_pb_op_lim; //[-] normalized maximum power cycle output
+        vector<double> wcond_f;     //[-] condenser parasitic fraction
+    } m_perf;
+
     void clear_output_arrays();
 
+    bool estimate_performance(int time_step, double step, double &q_inc, double &therm_eff, double &cycle_eff, 
+        double &f_pb_op_lim, double &wcond_f);
+
+    void build_lp(unordered_map<std::string, double> &P, int nt);
+    void update_lp(unordered_map<std::string, double> &P, int nt);
+    void free_lp();
+
+    csp_dispatch_opt(const csp_dispatch_opt &);
+    csp_dispatch_opt &operator=(const csp_dispatch_opt &);
+
 public:
     bool m_last_opt_successful;   //last optimization run was successful?
     int m_current_read_step;        //current step to read from optimization results
@@ -249,6 +300,7 @@ public:
         int solve_iter;             //Number of iterations required to solve
         int solve_state;
         double solve_time;
+        double build_time;          //[s] Time to build or update the model for the window
         int presolve_nconstr;
         int presolve_nvar;
     } outputs;
@@ -268,6 +320,7 @@ public:
     //----- public member functions ----
 
     csp_dispatch_opt();
+    ~csp_dispatch_opt();
 
     //check parameters and inputs to make sure everything has been set up correctly
     bool check_setup(int nstep);
@@ -281,6 +334,9 @@ public:
     //Predict performance out nstep values. 
     bool predict_performance(int step_start, int ntimeints, int divs_per_int);    
 
+    //Set the horizon length when the expected performance in outputs is provided directly instead of predicted
+    void set_horizon(int nstep);
+
     //declare dispatch function in csp_dispatch.cpp
     bool optimize();
 
@@ -330,7 +386,7 @@ public:
     struct VAR_DIM { enum A {DIM_T, DIM_NT, DIM_T2, DIM_2T_TRI}; };
 
     optimization_vars();
-    //~optimization_vars();
+    ~optimization_vars();
 
     void add_var(const string &vname, int var_type /* VAR_TYPE enum */, int var_dim /* VAR_DIM enum */, int var_dim_size, REAL lowbo=-DEF_INFINITE, REAL upbo=DEF_INFINITE);
     void add_var(const string &vname, int var_type /* VAR_TYPE enum */, int var_dim /* VAR_DIM enum */, int var_dim_size, int var_dim_size2, REAL lowbo=-DEF_INFINITE, REAL upbo=DEF_INFINITE);
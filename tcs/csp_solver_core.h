@@ -797,6 +797,7 @@ public:
 			DISPATCH_PRES_NCONSTR,      //[-] Number of constraint relationships in dispatch model formulation
 			DISPATCH_PRES_NVAR,         //[-] Number of variables in dispatch model formulation
 			DISPATCH_SOLVE_TIME,        //[sec]   Time required to solve the dispatch model at each instance
+			DISPATCH_BUILD_TIME,        //[sec]   Time required to build or update the dispatch model at each instance
 
 			// **************************************************************
 			//      Outputs that are reported as weighted averages if 
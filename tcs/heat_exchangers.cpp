@@ -494,31 +494,55 @@ void NS_HX_counterflow_eqs::calc_req_UA_enth(int hot_fl_code /*-*/, HTFPropertie
 
     bool is_temp_violation = false;
 
+	// Node pressures and enthalpies. Assume pressure varies linearly through heat exchanger
+	std::vector<double> P_c_node(N_nodes), P_h_node(N_nodes), h_c_node(N_nodes), h_h_node(N_nodes);
+	for (int i = 0; i < N_nodes; i++)
+	{
+		P_c_node[i] = P_c_out + i*(P_c_in - P_c_out) / (double)(N_nodes - 1);
+		P_h_node[i] = P_h_in - i*(P_h_in - P_h_out) / (double)(N_nodes - 1);
+		h_c_node[i] = h_c_out + i*(h_c_in - h_c_out) / (double)(N_nodes - 1);
+		h_h_node[i] = h_h_in - i*(h_h_in - h_h_out) / (double)(N_nodes - 1);
+	}
+
+	// Evaluate the CO2 node states together. Errors are reported when the loop reaches the node
+	std::vector<CO2_state> co2_h_node, co2_c_node;
+	std::vector<int> co2_h_err, co2_c_err;
+	if (hot_fl_code == NS_HX_counterflow_eqs::CO2)
+	{
+		co2_h_node.resize(N_nodes);
+		co2_h_err.resize(N_nodes);
+		CO2_PH_batch(N_nodes, P_h_node.data(), h_h_node.data(), co2_h_node.data(), co2_h_err.data());
+	}
+	if (cold_fl_code == NS_HX_counterflow_eqs::CO2)
+	{
+		co2_c_node.resize(N_nodes);
+		co2_c_err.resize(N_nodes);
+		CO2_PH_batch(N_nodes, P_c_node.data(), h_c_node.data(), co2_c_node.data(), co2_c_err.data());
+	}
+
 	// Loop through the sub-heat exchangers
 	UA = 0.0;
 	min_DT = T_h_in;
 	for (int i = 0; i < N_nodes; i++)
 	{
-        // Assume pressure varies linearly through heat exchanger
-		double P_c = P_c_out + i*(P_c_in - P_c_out) / (double)(N_nodes - 1);
-		double P_h = P_h_in - i*(P_h_in - P_h_out) / (double)(N_nodes - 1);
+		double P_c = P_c_node[i];
+		double P_h = P_h_node[i];
 
 		// Calculate the entahlpy at the node
-		double h_c = h_c_out + i*(h_c_in - h_c_out) / (double)(N_nodes - 1);
-		double h_h = h_h_in - i*(h_h_in - h_h_out) / (double)(N_nodes - 1);
+		double h_c = h_c_node[i];
+		double h_h = h_h_node[i];
 
 		// ****************************************************
 		// Calculate the hot and cold temperatures at the node
 		double T_h = std::numeric_limits<double>::quiet_NaN();
 		if (hot_fl_code == NS_HX_counterflow_eqs::CO2)
 		{
-			prop_error_code = CO2_PH(P_h, h_h, &ms_co2_props);
-			if (prop_error_code != 0)
+			if (co2_h_err[i] != 0)
 			{
 				throw(C_csp_exception("C_HX_counterflow::design",
 					"Cold side inlet enthalpy calculations failed", 12));
 			}
-			T_h = ms_co2_props.temp;		//[K]
+			T_h = co2_h_node[i].temp;		//[K]
 		}
 		else if (hot_fl_code == NS_HX_counterflow_eqs::WATER)
 		{
@@ -538,13 +562,12 @@ void NS_HX_counterflow_eqs::calc_req_UA_enth(int hot_fl_code /*-*/, HTFPropertie
 		double T_c = std::numeric_limits<double>::quiet_NaN();
 		if (cold_fl_code == NS_HX_counterflow_eqs::CO2)
 		{
-			prop_error_code = CO2_PH(P_c, h_c, &ms_co2_props);
-			if (prop_error_code != 0)
+			if (co2_c_err[i] != 0)
 			{
 				throw(C_csp_exception("C_HX_counterflow::design",
 					"Cold side inlet enthalpy calculations failed", 13));
 			}
-			T_c = ms_co2_props.temp;	//[K]
+			T_c = co2_c_node[i].temp;	//[K]
 		}
 		else if (cold_fl_code == NS_HX_counterflow_eqs::WATER)
 		{
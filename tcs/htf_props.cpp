@@ -23,6 +23,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "htf_props.h"
 #include "csp_solver_util.h"
 #include <cmath>
+#include <algorithm>
 
 HTFProperties::HTFProperties()
 {
@@ -30,6 +31,131 @@ HTFProperties::HTFProperties()
 	uf_err_msg = "The user-defined htf property table is invalid (rows=%d cols=%d)";
 
 	m_is_temp_enth_avail = false;
+
+	m_is_tabulated = false;
+	m_T_tab_low = m_T_tab_high = m_tab_tol = std::numeric_limits<double>::quiet_NaN();
+}
+
+double HTFProperties::S_uniform_table::interp(double x) const
+{
+	// Interval index, clamped to the end intervals. Written with min/max so the compiler doesn't need branches,
+	//   and so NaN lands on interval 0 (and returns NaN) rather than an invalid index
+	double x_ND = (x - m_x_low)*m_inv_dx;
+	double j_d = std::min(double(mv_y.size() - 2), std::max(0.0, floor(x_ND)));
+	size_t j = (size_t)j_d;
+
+	return mv_y[j] + (x_ND - j_d)*(mv_y[j+1] - mv_y[j]);
+}
+
+void HTFProperties::set_tabulated(double T_low_K, double T_high_K, double tol)
+{
+	if( !(T_low_K > 0.0 && T_high_K > T_low_K && std::isfinite(T_high_K)) )
+	{
+		throw(C_csp_exception("The tabulated property temperature range must be positive and increasing",
+			"HTFProperties::set_tabulated"));
+	}
+	if( !(tol > 0.0) )
+	{
+		throw(C_csp_exception("The tabulated property tolerance must be greater than 0.0",
+			"HTFProperties::set_tabulated"));
+	}
+
+	m_is_tabulated = true;
+	m_T_tab_low = T_low_K;		//[K]
+	m_T_tab_high = T_high_K;	//[K]
+	m_tab_tol = tol;			//[-]
+
+	// If the fluid is already set, build the tables now; otherwise, they're built when it is
+	if( m_fluid != 0 )
+	{
+		set_prop_tables();
+	}
+}
+
+double HTFProperties::eval_prop(int prop, double T_K)
+{
+	switch(prop)
+	{
+	case E_TAB_CP:
+		return Cp(T_K);
+	case E_TAB_DENS:
+		return dens(T_K, 101325.0);		// Only tabulated for fluids where density doesn't depend on pressure
+	case E_TAB_VISC:
+		return visc(T_K);
+	case E_TAB_COND:
+		return cond(T_K);
+	default:
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+}
+
+void HTFProperties::set_prop_tables()
+{
+	// Clear all tables first so the samples below come from the correlations
+	for(int prop = 0; prop < E_TAB_N; prop++)
+	{
+		mc_prop_tables[prop].clear();
+	}
+
+	if( !m_is_tabulated )
+	{
+		return;
+	}
+
+	S_uniform_table tables[E_TAB_N];
+
+	for(int prop = 0; prop < E_TAB_N; prop++)
+	{
+		// Ideal gas density depends on pressure
+		if( prop == E_TAB_DENS && (m_fluid == Air || m_fluid == Argon_ideal || m_fluid == Hydrogen_ideal) )
+		{
+			continue;
+		}
+
+		// Start from ~1 K spacing, and halve the spacing until the interval midpoints are within tolerance
+		int n_intervals = std::max(2, (int)ceil(m_T_tab_high - m_T_tab_low));
+		int n_intervals_max = 65536;
+		bool is_defined = true;
+		for( ; n_intervals <= n_intervals_max && is_defined; n_intervals *= 2)
+		{
+			S_uniform_table & table = tables[prop];
+			table.m_x_low = m_T_tab_low;		//[K]
+			table.m_x_high = m_T_tab_high;		//[K]
+			table.m_dx = (m_T_tab_high - m_T_tab_low)/double(n_intervals);		//[K]
+			table.m_inv_dx = double(n_intervals)/(m_T_tab_high - m_T_tab_low);	//[1/K]
+			table.mv_y.resize(n_intervals + 1);
+
+			for(int i = 0; i <= n_intervals && is_defined; i++)
+			{
+				table.mv_y[i] = eval_prop(prop, m_T_tab_low + table.m_dx*i);
+				is_defined = std::isfinite(table.mv_y[i]);
+			}
+
+			bool is_converged = is_defined;
+			for(int i = 0; i < n_intervals && is_converged; i++)
+			{
+				double T_mid = m_T_tab_low + table.m_dx*(i + 0.5);	//[K]
+				double y_mid = eval_prop(prop, T_mid);
+				is_converged = fabs(table.interp(T_mid) - y_mid) <= m_tab_tol*fabs(y_mid);
+			}
+
+			if( is_converged )
+			{
+				break;
+			}
+
+			table.clear();
+		}
+	}
+
+	for(int prop = 0; prop < E_TAB_N; prop++)
+	{
+		mc_prop_tables[prop].m_x_low = tables[prop].m_x_low;
+		mc_prop_tables[prop].m_x_high = tables[prop].m_x_high;
+		mc_prop_tables[prop].m_dx = tables[prop].m_dx;
+		mc_prop_tables[prop].m_inv_dx = tables[prop].m_inv_dx;
+		mc_prop_tables[prop].mv_y.swap(tables[prop].mv_y);
+	}
 }
 
 bool HTFProperties::SetUserDefinedFluid(const util::matrix_t<double> &table, bool calc_temp_enth_table)
@@ -65,6 +191,8 @@ bool HTFProperties::SetUserDefinedFluid( const util::matrix_t<double> &table )
 		return false;
 	}
 
+	set_prop_tables();
+
 	if(m_is_temp_enth_avail)
 	{
 		set_temp_enth_lookup();
@@ -105,6 +233,20 @@ void HTFProperties::set_temp_enth_lookup()
 		table(i+1,1) = h_next;		//[kJ/kg-K]
 	}
 
+	// The temperatures are uniformly spaced, so in tabulated mode enth_lookup finds the interval by index.
+	//   The index grid is T_low + i*delta_T rather than the accumulated temperatures above, so it can differ from
+	//   the table that temp_lookup inverts in the last bits
+	mc_enth_table.clear();
+	mc_enth_table.m_x_low = T_low;		//[K]
+	mc_enth_table.m_x_high = T_high;	//[K]
+	mc_enth_table.m_dx = delta_T;		//[K]
+	mc_enth_table.m_inv_dx = 1.0/delta_T;	//[1/K]
+	mc_enth_table.mv_y.resize(n_rows);
+	for(int i = 0; i < n_rows; i++)
+	{
+		mc_enth_table.mv_y[i] = table(i, 1);	//[kJ/kg]
+	}
+
 	// Specific which columns are used as the independent variable; these must be monotonically increasing
 	int ind_var_index[2] = {0, 1};
 	int n_ind_var = 2;
@@ -151,6 +293,9 @@ double HTFProperties::enth_lookup( double temp /*K*/)
 		throw(C_csp_exception("This enth-temp-lookup method is only available if fluid is set with optional Boolean to enable it"));
 	}
 
+	if( m_is_tabulated )
+		return mc_enth_table.interp(temp);	//[kJ/kg]
+
 	return mc_temp_enth_lookup.linear_1D_interp(0, 1, temp);	//[kJ/kg]
 }
 
@@ -166,6 +311,8 @@ bool HTFProperties::SetFluid( int fluid )
 	// If using stored fluid properties, set member fluid number
 	m_fluid = fluid;
 
+	set_prop_tables();
+
 	if( m_is_temp_enth_avail )
 	{
 		set_temp_enth_lookup();
@@ -224,6 +371,9 @@ double HTFProperties::Cp( double T_K )
 	Converted to c++ from Fortran code Type 229 in November 2012 by Ty Neises
 	Original author: Michael J. Wagner */
 
+	if( mc_prop_tables[E_TAB_CP].is_in_range(T_K) )
+		return mc_prop_tables[E_TAB_CP].interp(T_K);
+
 	double T_C = T_K - 273.15;		// Also provide temperature in C
 
 	switch(m_fluid)
@@ -303,6 +453,9 @@ double HTFProperties::dens(double T_K, double P)
 	Converted to c++ from Fortran code Type 229 in November 2012 by Ty Neises
 	Original author: Michael J. Wagner */
 
+	if( mc_prop_tables[E_TAB_DENS].is_in_range(T_K) )
+		return mc_prop_tables[E_TAB_DENS].interp(T_K);
+
 	double T_C = T_K - 273.15;		// This function accepts as inputs temperature[K]. Convert to [C] for correlations
 
 	switch(m_fluid)
@@ -381,6 +534,9 @@ double HTFProperties::visc(double T_K)
 	Converted to c++ from Fortran code Type 229 in November 2012 by Ty Neises
 	Original author: Michael J. Wagner */
 
+	if( mc_prop_tables[E_TAB_VISC].is_in_range(T_K) )
+		return mc_prop_tables[E_TAB_VISC].interp(T_K);
+
 	double T_C = T_K - 273.15;		// This function accepts as inputs temperature[K]. Convert to [C] for correlations
 
 	switch(m_fluid)
@@ -468,6 +624,9 @@ double HTFProperties::cond(double T_K)
 	Converted to c++ from Fortran code Type 229 in November 2012 by Ty Neises
 	Original author: Michael J. Wagner */
 
+	if( mc_prop_tables[E_TAB_COND].is_in_range(T_K) )
+		return mc_prop_tables[E_TAB_COND].interp(T_K);
+
 	double T_C = T_K - 273.15;
 
 	switch(m_fluid)
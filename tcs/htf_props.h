@@ -26,6 +26,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "interpolation_routines.h"
 #include <limits>
+#include <vector>
 
 class HTFProperties
 {
@@ -104,6 +105,14 @@ public:
 	//               rather than at the range's midpoint
 	double Cp_ave(double T_cold_K, double T_hot_K, int n_points);
 
+	// Optional tabulated mode: when the fluid is set, Cp, dens, visc, and cond are sampled on uniform temperature grids
+	//   between T_low_K and T_high_K. Each grid is refined until linear interpolation is within the relative tolerance
+	//   of the correlation at every interval midpoint. Properties that can't meet the tolerance (e.g. discontinuous
+	//   correlations), pressure-dependent densities, and temperatures outside the range use the correlations.
+	//   enth_lookup also finds its interval by index instead of searching
+	void set_tabulated(double T_low_K, double T_high_K, double tol = 1.E-6);
+	bool is_tabulated() { return m_is_tabulated; }
+
 	const util::matrix_t<double> *get_prop_table();
 	//bool equals(const util::matrix_t<double> *comp_table);
 	bool equals(HTFProperties *comp_class);
@@ -111,6 +120,57 @@ public:
 private:
 	static const int m_m = 2;		// Integer for interpolation routine
 
+	// Property values on a uniform grid, interpolated by index rather than by searching
+	struct S_uniform_table
+	{
+		double m_x_low;		// First grid point
+		double m_x_high;	// Last grid point
+		double m_dx;		// Grid spacing
+		double m_inv_dx;	// 1 / grid spacing
+		std::vector<double> mv_y;
+
+		S_uniform_table()
+		{
+			clear();
+		}
+
+		void clear()
+		{
+			// Empty range, so 'is_in_range' is always false
+			m_x_low = std::numeric_limits<double>::infinity();
+			m_x_high = -std::numeric_limits<double>::infinity();
+			m_dx = m_inv_dx = std::numeric_limits<double>::quiet_NaN();
+			mv_y.clear();
+		}
+
+		bool is_in_range(double x) const
+		{
+			return x >= m_x_low && x <= m_x_high;
+		}
+
+		// Linear interpolation; outside the grid, extrapolates from the end intervals
+		double interp(double x) const;
+	};
+
+	enum
+	{
+		E_TAB_CP,
+		E_TAB_DENS,
+		E_TAB_VISC,
+		E_TAB_COND,
+		E_TAB_N
+	};
+
+	bool m_is_tabulated;
+	double m_T_tab_low;		//[K]
+	double m_T_tab_high;	//[K]
+	double m_tab_tol;		//[-]
+	S_uniform_table mc_prop_tables[E_TAB_N];
+	void set_prop_tables();
+	double eval_prop(int prop, double T_K);
+
+	S_uniform_table mc_enth_table;		// Same data as 'mc_temp_enth_lookup', for enth_lookup in tabulated mode
+
 	Linear_Interp User_Defined_Props;		// Define interpolation class in case user defined propeties are required
 
 	Linear_Interp mc_temp_enth_lookup;		// Enthalpy-temperature relationship, populated by pre-processor: 'set_temp_enth_lookup' 
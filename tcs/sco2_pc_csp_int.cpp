@@ -57,6 +57,10 @@ C_sco2_phx_air_cooler::C_sco2_phx_air_cooler()
 
 	mf_callback_update = 0;		// NULL
 	mp_mf_update = 0;			// NULL
+
+	mpc_sco2_cycle = 0;			// NULL until designed
+
+	m_od_mc_dens_in_guess = std::numeric_limits<double>::quiet_NaN();
 }
 
 void C_sco2_phx_air_cooler::design(S_des_par des_par)
@@ -66,6 +70,27 @@ void C_sco2_phx_air_cooler::design(S_des_par des_par)
 	design_core();
 }
 
+C_sco2_phx_air_cooler * C_sco2_phx_air_cooler::clone() const
+{
+	C_sco2_phx_air_cooler *p_clone = new C_sco2_phx_air_cooler(*this);
+
+	// Point the copy at its own cycle model
+	if (mpc_sco2_cycle == &mc_partialcooling_cycle)
+		p_clone->mpc_sco2_cycle = &p_clone->mc_partialcooling_cycle;
+	else if (mpc_sco2_cycle == &mc_rc_cycle)
+		p_clone->mpc_sco2_cycle = &p_clone->mc_rc_cycle;
+
+	p_clone->mf_callback_update = 0;	// NULL
+	p_clone->mp_mf_update = 0;			// NULL
+
+	return p_clone;
+}
+
+void C_sco2_phx_air_cooler::set_od_mc_dens_in_guess(double mc_dens_in /*kg/m3*/)
+{
+	m_od_mc_dens_in_guess = mc_dens_in;		//[kg/m3]
+}
+
 void C_sco2_phx_air_cooler::C_iter_tracker::reset_vectors()
 {
     mv_P_LP_in.resize(0);
@@ -1897,6 +1922,18 @@ int C_sco2_phx_air_cooler::solve_P_LP_in__target_W_dot()
     double mc_pres_dens_des_od = co2_props.pres;	//[kPa]
     double P_LP_in_guess = mc_pres_dens_des_od;	    //[kPa]
 
+    // If a neighboring point has been solved, start from its compressor inlet density instead
+    bool is_warm_guess = false;
+    if (std::isfinite(m_od_mc_dens_in_guess))
+    {
+        if (CO2_TD(ms_cycle_od_par.m_T_mc_in, m_od_mc_dens_in_guess, &co2_props) == 0
+            && co2_props.pres > P_lower_limit_global && co2_props.pres < P_upper_limit_global)
+        {
+            P_LP_in_guess = co2_props.pres;     //[kPa]
+            is_warm_guess = true;
+        }
+    }
+
     // Try guess value and check that OD model *converged* (can have constraint limits)
     mc_iter_tracker.reset_vectors();
     C_monotonic_eq_solver::S_xy_pair xy_1;
@@ -1904,6 +1941,13 @@ int C_sco2_phx_air_cooler::solve_P_LP_in__target_W_dot()
     double y_W_dot_guess = std::numeric_limits<double>::quiet_NaN();
     int W_dot_err_code = c_P_LP_in_solver.test_member_function(P_LP_in_guess, &y_W_dot_guess);
 
+    if (W_dot_err_code != 0 && is_warm_guess)
+    {
+        // Fall back to the design density guess
+        P_LP_in_guess = mc_pres_dens_des_od;    //[kPa]
+        W_dot_err_code = c_P_LP_in_solver.test_member_function(P_LP_in_guess, &y_W_dot_guess);
+    }
+
     while (W_dot_err_code != 0 && P_LP_in_guess > P_lower_limit_global)
     {
         P_LP_in_guess -= 500;  //[kpa]
@@ -3074,6 +3118,24 @@ int C_sco2_phx_air_cooler::C_MEQ__P_LP_in__max_no_err_code::operator()(double P_
     return 0;
 }
 
+C_sco2_phx_air_cooler::C_sco2_csp_od::~C_sco2_csp_od()
+{
+}
+
+C_od_pc_function * C_sco2_phx_air_cooler::C_sco2_csp_od::clone() const
+{
+	C_sco2_csp_od *p_clone = new C_sco2_csp_od(mpc_sco2_rc);
+	p_clone->mpc_sco2_rc_clone.reset(mpc_sco2_rc->clone());
+	p_clone->mpc_sco2_rc = p_clone->mpc_sco2_rc_clone.get();
+
+	return p_clone;
+}
+
+void C_sco2_phx_air_cooler::C_sco2_csp_od::reset_warm_start()
+{
+	m_mc_dens_in_prev = std::numeric_limits<double>::quiet_NaN();
+}
+
 int C_sco2_phx_air_cooler::C_sco2_csp_od::operator()(S_f_inputs inputs, S_f_outputs & outputs)
 {
 	S_od_par sco2_od_par;
@@ -3086,6 +3148,9 @@ int C_sco2_phx_air_cooler::C_sco2_csp_od::operator()(S_f_inputs inputs, S_f_outp
 
 	int off_design_code = -1;	//[-]
 
+	// Warm start from the previous point, if there is one
+	mpc_sco2_rc->set_od_mc_dens_in_guess(m_mc_dens_in_prev);
+
 	try
 	{
 		off_design_code = mpc_sco2_rc->optimize_off_design(sco2_od_par, 
@@ -3096,8 +3161,20 @@ int C_sco2_phx_air_cooler::C_sco2_csp_od::operator()(S_f_inputs inputs, S_f_outp
 	}
 	catch (C_csp_exception &)
 	{
+		mpc_sco2_rc->set_od_mc_dens_in_guess(std::numeric_limits<double>::quiet_NaN());
 		return -1;
 	}
+
+	mpc_sco2_rc->set_od_mc_dens_in_guess(std::numeric_limits<double>::quiet_NaN());
+
+	if (off_design_code == 0)
+	{
+		int i_comp_in = C_sco2_cycle_core::MC_IN;
+		if (mpc_sco2_rc->get_design_par()->m_cycle_config == 2)
+			i_comp_in = C_sco2_cycle_core::PC_IN;
+
+		m_mc_dens_in_prev = mpc_sco2_rc->get_od_solved()->ms_rc_cycle_od_solved.m_dens[i_comp_in];	//[kg/m3]
+	}
 	// Cycle off-design may want to operate below this value, so ND value could be < 1 everywhere
 	double W_dot_gross_design = mpc_sco2_rc->get_design_solved()->ms_rc_cycle_solved.m_W_dot_net;	//[kWe]
 	double Q_dot_in_design = mpc_sco2_rc->get_design_solved()->ms_rc_cycle_solved.m_W_dot_net
@@ -3123,13 +3200,15 @@ int C_sco2_phx_air_cooler::C_sco2_csp_od::operator()(S_f_inputs inputs, S_f_outp
 int C_sco2_phx_air_cooler::generate_ud_pc_tables(double T_htf_low /*C*/, double T_htf_high /*C*/, int n_T_htf /*-*/,
 	double T_amb_low /*C*/, double T_amb_high /*C*/, int n_T_amb /*-*/,
 	double m_dot_htf_ND_low /*-*/, double m_dot_htf_ND_high /*-*/, int n_m_dot_htf_ND,
-	util::matrix_t<double> & T_htf_ind, util::matrix_t<double> & T_amb_ind, util::matrix_t<double> & m_dot_htf_ND_ind)
+	util::matrix_t<double> & T_htf_ind, util::matrix_t<double> & T_amb_ind, util::matrix_t<double> & m_dot_htf_ND_ind,
+	int n_threads)
 {
 	C_sco2_csp_od c_sco2_csp(this);
 	C_ud_pc_table_generator c_sco2_ud_pc(c_sco2_csp);
 
 	c_sco2_ud_pc.mf_callback = mf_callback_update;
 	c_sco2_ud_pc.mp_mf_active = mp_mf_update;
+	c_sco2_ud_pc.m_n_threads = n_threads;
 
 	double T_htf_ref = ms_des_par.m_T_htf_hot_in - 273.15;	//[C] convert from K
 	double T_amb_ref = ms_des_par.m_T_amb_des - 273.15;		//[C] convert from K
@@ -36,6 +36,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ud_power_cycle.h"
 
 #include <iosfwd>
+#include <memory>
 
 class C_sco2_phx_air_cooler
 {
@@ -283,6 +284,12 @@ private:
 	double m_T_co2_crit;		//[K]
 	double m_P_co2_crit;		//[kPa]
 
+	double m_od_mc_dens_in_guess;	//[kg/m3] Compressor inlet density for the first off-design pressure guess. NaN = use design density
+
+	// Only used by clone(), which re-points the copy at its own cycle model
+	C_sco2_phx_air_cooler(const C_sco2_phx_air_cooler &) = default;
+	C_sco2_phx_air_cooler & operator=(const C_sco2_phx_air_cooler &) = delete;
+
 	void design_core();
 
 	double adjust_P_mc_in_away_2phase(double T_co2 /*K*/, double P_mc_in /*kPa*/);
@@ -400,22 +407,42 @@ public:
 	private:
 		C_sco2_phx_air_cooler *mpc_sco2_rc;
 
+		std::unique_ptr<C_sco2_phx_air_cooler> mpc_sco2_rc_clone;	// Set if this function owns its copy of the cycle
+
+		double m_mc_dens_in_prev;	//[kg/m3] Solved compressor inlet density at the previous point
+
 	public:
 		C_sco2_csp_od(C_sco2_phx_air_cooler *pc_sco2_rc)
 		{
 			mpc_sco2_rc = pc_sco2_rc;
+			m_mc_dens_in_prev = std::numeric_limits<double>::quiet_NaN();
 		}
+
+		virtual ~C_sco2_csp_od();
 	
 		virtual int operator()(S_f_inputs inputs, S_f_outputs & outputs);
+
+		virtual C_od_pc_function * clone() const;
+
+		virtual void reset_warm_start();
 	};
 
 	int generate_ud_pc_tables(double T_htf_low /*C*/, double T_htf_high /*C*/, int n_T_htf /*-*/,
 		double T_amb_low /*C*/, double T_amb_high /*C*/, int n_T_amb /*-*/,
 		double m_dot_htf_ND_low /*-*/, double m_dot_htf_ND_high /*-*/, int n_m_dot_htf_ND,
-		util::matrix_t<double> & T_htf_ind, util::matrix_t<double> & T_amb_ind, util::matrix_t<double> & m_dot_htf_ND_ind);
+		util::matrix_t<double> & T_htf_ind, util::matrix_t<double> & T_amb_ind, util::matrix_t<double> & m_dot_htf_ND_ind,
+		int n_threads = 1);
 
 	void design(S_des_par des_par);
 
+	// Independent copy of the designed cycle that can run off-design on another thread.
+	// The copy doesn't send progress callbacks. The caller owns the copy
+	C_sco2_phx_air_cooler * clone() const;
+
+	// Compressor inlet density used for the first pressure guess in off-design, e.g. from a neighboring solved point.
+	// NaN reverts to the design point density
+	void set_od_mc_dens_in_guess(double mc_dens_in /*kg/m3*/);
+
 	int optimize_off_design(C_sco2_phx_air_cooler::S_od_par od_par, 
         bool is_rc_N_od_at_design, double rc_N_od_f_des /*-*/,
         bool is_mc_N_od_at_design, double mc_N_od_f_des /*-*/,
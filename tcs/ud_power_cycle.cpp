@@ -23,6 +23,14 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ud_power_cycle.h"
 #include "csp_solver_util.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 void C_ud_power_cycle::init(const util::matrix_t<double> & T_htf_ind, double T_htf_ref /*C*/, double T_htf_low /*C*/, double T_htf_high /*C*/,
 	const util::matrix_t<double> & T_amb_ind, double T_amb_ref /*C*/, double T_amb_low /*C*/, double T_amb_high /*C*/,
 	const util::matrix_t<double> & m_dot_htf_ind, double m_dot_htf_ref /*-*/, double m_dot_htf_low /*-*/, double m_dot_htf_high /*-*/)
@@ -351,6 +359,7 @@ C_ud_pc_table_generator::C_ud_pc_table_generator(C_od_pc_function & f_pc_eq) : m
 {
 	mf_callback = 0;		// = NULL
 	mp_mf_active = 0;			// = NULL
+	m_n_threads = 1;
 	m_progress_msg = "Power cycle preprocessing...";
 	m_log_msg = "Log message";
 
@@ -433,9 +442,6 @@ int C_ud_pc_table_generator::generate_tables(double T_htf_ref /*C*/, double T_ht
 		throw(C_csp_exception(msg, "User defined power cycle, generate tables"));
 	}
 
-	C_od_pc_function::S_f_inputs pc_inputs;
-	C_od_pc_function::S_f_outputs pc_outputs;
-
 	// ******************************************
 	// Setup T_HTF parameteric runs
 	if(n_T_htf < 3)
@@ -450,63 +456,6 @@ int C_ud_pc_table_generator::generate_tables(double T_htf_ref /*C*/, double T_ht
 	T_htf_ind.resize(n_T_htf, 13);		// Set matrix size
 	double delta_T_htf = (T_htf_high - T_htf_low)/double(n_T_htf-1);
 
-	double n_runs_total = 3.0*(n_T_htf + n_T_amb + n_m_dot_htf_ND);
-
-	// Set ambient temperature because it is constant for the HTF temperature parametrics
-	pc_inputs.m_T_amb = T_amb_ref;	//[C]
-	for(int i = 0; i < n_T_htf; i++)
-	{
-		T_htf_ind(i,0) = T_htf_low + delta_T_htf*i;	//[C]
-		pc_inputs.m_T_htf_hot = T_htf_ind(i,0);
-
-		// Call at low, ref, and high ND mass flow rate levels
-		std::vector<double> m_dot_htf_ND_levels(3);
-		m_dot_htf_ND_levels[0] = m_dot_htf_ND_low;
-		m_dot_htf_ND_levels[1] = m_dot_htf_ND_ref;
-		m_dot_htf_ND_levels[2] = m_dot_htf_ND_high;
-		for(int j = 0; j < 3; j++)
-		{
-			bool is_od_model_error = false;
-
-			pc_inputs.m_m_dot_htf_ND = m_dot_htf_ND_levels[j];
-			int off_design_code = mf_pc_eq(pc_inputs,pc_outputs);
-
-			if( off_design_code == 0 )
-			{
-				// Save outputs
-				T_htf_ind(i,1+j) = pc_outputs.m_W_dot_gross_ND;		//[-]
-				T_htf_ind(i,4+j) = pc_outputs.m_Q_dot_in_ND;		//[-]
-				T_htf_ind(i,7+j) = pc_outputs.m_W_dot_cooling_ND;	//[-]
-				T_htf_ind(i,10+j) = pc_outputs.m_m_dot_water_ND;	//[-]
-			}
-			else if (off_design_code == -1)
-			{
-				// Save 'generic' off design model response
-				T_htf_ind(i, 1 + j) = pc_inputs.m_m_dot_htf_ND;		//[-]
-				T_htf_ind(i, 4 + j) = pc_inputs.m_m_dot_htf_ND;		//[-]
-				T_htf_ind(i, 7 + j) = pc_inputs.m_m_dot_htf_ND;		//[-]
-				T_htf_ind(i, 10 + j) = pc_inputs.m_m_dot_htf_ND;	//[-]
-
-				is_od_model_error = true;
-			}
-			else
-			{
-				std::string err_msg = util::format("The 1st UDPC table (primary: T_htf, interaction: m_dot_htf_ND) generation failed at T_htf = %lg [C] and m_dot_htf = %lg [-]", pc_inputs.m_T_htf_hot, pc_inputs.m_m_dot_htf_ND);
-				throw(C_csp_exception(err_msg, "UDPC"));
-			}
-
-			double run_number = i*3 + j;
-
-			send_callback(is_od_model_error, (int)run_number + 1, (int)n_runs_total,
-				pc_inputs.m_T_htf_hot, pc_inputs.m_m_dot_htf_ND, pc_inputs.m_T_amb,
-				T_htf_ind(i, 1 + j), T_htf_ind(i, 4 + j),
-				T_htf_ind(i, 7 + j), T_htf_ind(i, 10 + j));
-
-		}
-
-	}
-	// ******************************************
-
 	// ******************************************
 	// Setup T_amb parametric runs
 	if(n_T_amb < 3)
@@ -521,59 +470,6 @@ int C_ud_pc_table_generator::generate_tables(double T_htf_ref /*C*/, double T_ht
 	T_amb_ind.resize(n_T_amb, 13);		// Set matrix size
 	double delta_T_amb = (T_amb_high - T_amb_low)/double(n_T_amb-1);
 
-	// Set ND htf mass flow rate because it is constant for the ambient temperature parametrics
-	pc_inputs.m_m_dot_htf_ND = m_dot_htf_ND_ref;
-	for(int i = 0; i < n_T_amb; i++)
-	{
-		T_amb_ind(i,0) = T_amb_low + delta_T_amb*i;		//[C]
-		pc_inputs.m_T_amb = T_amb_ind(i,0);				//[C]
-
-		// Call at low, ref, and high HTF temperature levels
-		std::vector<double> T_htf_levels(3);
-		T_htf_levels[0] = T_htf_low;   //[C]
-		T_htf_levels[1] = T_htf_ref;   //[C]
-		T_htf_levels[2] = T_htf_high;  //[C]
-		for(int j = 0; j < 3; j++)
-		{
-			bool is_od_model_error = false;
-
-			pc_inputs.m_T_htf_hot = T_htf_levels[j];
-			int off_design_code = mf_pc_eq(pc_inputs,pc_outputs);
-
-			if( off_design_code == 0 )
-			{
-				// Save outputs
-				T_amb_ind(i,1+j) = pc_outputs.m_W_dot_gross_ND;		//[-]
-				T_amb_ind(i,4+j) = pc_outputs.m_Q_dot_in_ND;		//[-]
-				T_amb_ind(i,7+j) = pc_outputs.m_W_dot_cooling_ND;	//[-]
-				T_amb_ind(i,10+j) = pc_outputs.m_m_dot_water_ND;	//[-]
-			}
-			else if (off_design_code == -1)
-			{
-				// Save 'generic' off design model response
-				T_amb_ind(i, 1 + j) = pc_inputs.m_m_dot_htf_ND;		//[-]
-				T_amb_ind(i, 4 + j) = pc_inputs.m_m_dot_htf_ND;		//[-]
-				T_amb_ind(i, 7 + j) = pc_inputs.m_m_dot_htf_ND;		//[-]
-				T_amb_ind(i, 10 + j) = pc_inputs.m_m_dot_htf_ND;	//[-]
-
-				is_od_model_error = true;
-			}
-			else
-			{
-				std::string err_msg = util::format("The 2nd UDPC table (primary: T_amb, interaction: T_htf) generation failed at T_amb = %lg [C] and T_htf = %lg [C]", pc_inputs.m_T_amb, pc_inputs.m_T_htf_hot);
-				throw(C_csp_exception(err_msg, "UDPC"));
-			}
-
-			double run_number = 3.0*n_T_htf + i*3 + j;
-
-			send_callback(is_od_model_error, (int)run_number + 1, (int)n_runs_total,
-				pc_inputs.m_T_htf_hot, pc_inputs.m_m_dot_htf_ND, pc_inputs.m_T_amb,
-				T_amb_ind(i, 1 + j), T_amb_ind(i, 4 + j),
-				T_amb_ind(i, 7 + j), T_amb_ind(i, 10 + j));
-		}
-	}
-	// ******************************************
-
 	// ******************************************
 	// Setup ND m_dot parametric runs
 	if(n_m_dot_htf_ND < 3)
@@ -588,58 +484,262 @@ int C_ud_pc_table_generator::generate_tables(double T_htf_ref /*C*/, double T_ht
 	m_dot_htf_ind.resize(n_m_dot_htf_ND,13);		// Set matrix size
 	double delta_m_dot = (m_dot_htf_ND_high-m_dot_htf_ND_low)/double(n_m_dot_htf_ND-1);
 
-	// Set HTF temperature because it is constant for the ambient temperature parametrics
-	pc_inputs.m_T_htf_hot = T_htf_ref;
+	// ******************************************
+	// Each level of each table is a sweep of neighboring points along the table's independent variable.
+	// Points in a sweep are solved in order so each one can warm start from the last, and the sweeps are
+	// ... independent of each other, so they can be solved on separate threads
+	int n_runs_total = 3*(n_T_htf + n_T_amb + n_m_dot_htf_ND);
+	std::vector<S_ud_pc_point> v_points(n_runs_total);
+	std::vector<std::vector<int> > v_sweeps(9);
+
+	int i_run = 0;
+
+	// 1st table: T_amb at design; low, ref, and high ND mass flow rate levels
+	double m_dot_htf_ND_levels[3] = {m_dot_htf_ND_low, m_dot_htf_ND_ref, m_dot_htf_ND_high};
+	for(int i = 0; i < n_T_htf; i++)
+	{
+		T_htf_ind(i,0) = T_htf_low + delta_T_htf*i;	//[C]
+		for(int j = 0; j < 3; j++)
+		{
+			S_ud_pc_point & point = v_points[i_run];
+			point.ms_inputs.m_T_htf_hot = T_htf_ind(i,0);
+			point.ms_inputs.m_T_amb = T_amb_ref;
+			point.ms_inputs.m_m_dot_htf_ND = m_dot_htf_ND_levels[j];
+			point.mp_table = &T_htf_ind;
+			point.m_table = 1;
+			point.m_row = i;
+			point.m_level = j;
+			v_sweeps[j].push_back(i_run++);
+		}
+	}
+
+	// 2nd table: ND mass flow rate at design; low, ref, and high HTF temperature levels
+	double T_htf_levels[3] = {T_htf_low, T_htf_ref, T_htf_high};
+	for(int i = 0; i < n_T_amb; i++)
+	{
+		T_amb_ind(i,0) = T_amb_low + delta_T_amb*i;		//[C]
+		for(int j = 0; j < 3; j++)
+		{
+			S_ud_pc_point & point = v_points[i_run];
+			point.ms_inputs.m_T_htf_hot = T_htf_levels[j];
+			point.ms_inputs.m_T_amb = T_amb_ind(i,0);
+			point.ms_inputs.m_m_dot_htf_ND = m_dot_htf_ND_ref;
+			point.mp_table = &T_amb_ind;
+			point.m_table = 2;
+			point.m_row = i;
+			point.m_level = j;
+			v_sweeps[3 + j].push_back(i_run++);
+		}
+	}
+
+	// 3rd table: HTF temperature at design; low, ref, and high ambient temperature levels
+	double T_amb_levels[3] = {T_amb_low, T_amb_ref, T_amb_high};
 	for(int i = 0; i < n_m_dot_htf_ND; i++)
 	{
 		m_dot_htf_ind(i,0) = m_dot_htf_ND_low + delta_m_dot*i;		//[-]
-		pc_inputs.m_m_dot_htf_ND = m_dot_htf_ind(i,0);				//[-]
-
-		// Call at low, ref, and high ambient temperatures
-		std::vector<double> T_amb_levels(3);
-		T_amb_levels[0] = T_amb_low;    //[C]
-		T_amb_levels[1] = T_amb_ref;	//[C]
-		T_amb_levels[2] = T_amb_high;	//[C]
 		for(int j = 0; j < 3; j++)
 		{
-			bool is_od_model_error = false;
+			S_ud_pc_point & point = v_points[i_run];
+			point.ms_inputs.m_T_htf_hot = T_htf_ref;
+			point.ms_inputs.m_T_amb = T_amb_levels[j];
+			point.ms_inputs.m_m_dot_htf_ND = m_dot_htf_ind(i,0);
+			point.mp_table = &m_dot_htf_ind;
+			point.m_table = 3;
+			point.m_row = i;
+			point.m_level = j;
+			v_sweeps[6 + j].push_back(i_run++);
+		}
+	}
 
-			pc_inputs.m_T_amb = T_amb_levels[j];
-			int off_design_code = mf_pc_eq(pc_inputs, pc_outputs);
-		
-			if( off_design_code == 0 )
-			{
-				// Save outputs
-				m_dot_htf_ind(i,1+j) = pc_outputs.m_W_dot_gross_ND;		//[-]
-				m_dot_htf_ind(i,4+j) = pc_outputs.m_Q_dot_in_ND;		//[-]
-				m_dot_htf_ind(i,7+j) = pc_outputs.m_W_dot_cooling_ND;	//[-]
-				m_dot_htf_ind(i,10+j) = pc_outputs.m_m_dot_water_ND;	//[-]
-			}
-			else if (off_design_code == -1)
-			{
-				// Save 'generic' off design model response
-				m_dot_htf_ind(i, 1 + j) = pc_inputs.m_m_dot_htf_ND;		//[-]
-				m_dot_htf_ind(i, 4 + j) = pc_inputs.m_m_dot_htf_ND;		//[-]
-				m_dot_htf_ind(i, 7 + j) = pc_inputs.m_m_dot_htf_ND;		//[-]
-				m_dot_htf_ind(i, 10 + j) = pc_inputs.m_m_dot_htf_ND;	//[-]
+	int n_sweeps = (int)v_sweeps.size();
 
-				is_od_model_error = true;
-			}
-			else
+	int n_threads = m_n_threads;
+	if(n_threads < 1)
+		n_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+	n_threads = std::min(n_threads, n_sweeps);
+
+	if(n_threads > 1)
+	{
+		// Threads need their own copy of the power cycle function
+		std::unique_ptr<C_od_pc_function> p_f_test(mf_pc_eq.clone());
+		if(!p_f_test)
+			n_threads = 1;
+	}
+
+	if(n_threads == 1)
+	{
+		solve_sweeps_serial(v_sweeps, v_points);
+		return 0;
+	}
+
+	// Workers take the next unsolved sweep. The calling thread sends the callbacks as points finish,
+	// ... so progress and user cancellation go through the same thread as in serial runs
+	std::atomic<int> next_sweep(0);
+	std::atomic<bool> is_abort(false);
+	std::mutex done_mutex;
+	std::condition_variable done_cv;
+	std::vector<int> v_done;
+	int n_workers_running = n_threads;
+	std::exception_ptr p_worker_exception;
+
+	auto worker = [&]()
+	{
+		try
+		{
+			int k;
+			while(!is_abort && (k = next_sweep++) < n_sweeps)
 			{
-				std::string err_msg = util::format("The 3rd UDPC table (primary: m_dot_htf_ND, interaction: T_amb) generation failed at T_amb = %lg [C] and m_dot_htf = %lg [-]", pc_inputs.m_T_amb, pc_inputs.m_m_dot_htf_ND);
-				throw(C_csp_exception(err_msg, "UDPC"));
+				std::unique_ptr<C_od_pc_function> p_f_sweep(mf_pc_eq.clone());
+				p_f_sweep->reset_warm_start();
+
+				for(size_t i = 0; i < v_sweeps[k].size() && !is_abort; i++)
+				{
+					solve_point(*p_f_sweep, v_points[v_sweeps[k][i]]);
+
+					std::lock_guard<std::mutex> lock(done_mutex);
+					v_done.push_back(v_sweeps[k][i]);
+					done_cv.notify_one();
+				}
 			}
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> lock(done_mutex);
+			if(!p_worker_exception)
+				p_worker_exception = std::current_exception();
+			is_abort = true;
+		}
 
-			double run_number = 3.0*n_T_htf + 3.0*n_T_amb  + i*3 + j;
+		std::lock_guard<std::mutex> lock(done_mutex);
+		n_workers_running--;
+		done_cv.notify_one();
+	};
+
+	std::vector<std::thread> pool;
+	try
+	{
+		for(int t = 0; t < n_threads; t++)
+			pool.push_back(std::thread(worker));
+	}
+	catch(...)
+	{
+		// The system couldn't start all the workers. Stop the ones that did and solve every point in serial,
+		// ... which doesn't depend on the partial results because each sweep starts from a copy of the design
+		is_abort = true;
+		for(size_t t = 0; t < pool.size(); t++)
+			pool[t].join();
 
-			send_callback(is_od_model_error, (int)run_number + 1, (int)n_runs_total,
-				pc_inputs.m_T_htf_hot, pc_inputs.m_m_dot_htf_ND, pc_inputs.m_T_amb,
-				m_dot_htf_ind(i, 1 + j), m_dot_htf_ind(i, 4 + j),
-				m_dot_htf_ind(i, 7 + j), m_dot_htf_ind(i, 10 + j));
+		solve_sweeps_serial(v_sweeps, v_points);
+		return 0;
+	}
+
+	std::exception_ptr p_report_exception;
+	try
+	{
+		int n_reported = 0;
+		std::unique_lock<std::mutex> lock(done_mutex);
+		while(n_reported < n_runs_total)
+		{
+			done_cv.wait(lock, [&]() { return !v_done.empty() || n_workers_running == 0; });
+			if(v_done.empty())
+				break;
+
+			std::vector<int> v_report;
+			v_report.swap(v_done);
+			lock.unlock();
+
+			for(size_t i = 0; i < v_report.size(); i++)
+				report_point(v_points[v_report[i]], ++n_reported, n_runs_total);
+
+			lock.lock();
 		}
 	}
-	// ******************************************
-	
+	catch(...)
+	{
+		p_report_exception = std::current_exception();
+		is_abort = true;
+	}
+
+	for(size_t t = 0; t < pool.size(); t++)
+		pool[t].join();
+
+	if(p_report_exception)
+		std::rethrow_exception(p_report_exception);
+	if(p_worker_exception)
+		std::rethrow_exception(p_worker_exception);
+
 	return 0;
+}
+
+void C_ud_pc_table_generator::solve_sweeps_serial(const std::vector<std::vector<int> > & v_sweeps, std::vector<S_ud_pc_point> & v_points)
+{
+	int n_runs_total = (int)v_points.size();
+	int n_reported = 0;
+	for(size_t k = 0; k < v_sweeps.size(); k++)
+	{
+		// Start each sweep from a copy of the design so the results don't depend on the sweep order
+		std::unique_ptr<C_od_pc_function> p_f_sweep(mf_pc_eq.clone());
+		C_od_pc_function & f_sweep = p_f_sweep ? *p_f_sweep : mf_pc_eq;
+		f_sweep.reset_warm_start();
+
+		for(size_t i = 0; i < v_sweeps[k].size(); i++)
+		{
+			S_ud_pc_point & point = v_points[v_sweeps[k][i]];
+			solve_point(f_sweep, point);
+			report_point(point, ++n_reported, n_runs_total);
+		}
+	}
+}
+
+void C_ud_pc_table_generator::solve_point(C_od_pc_function & f_pc_eq, S_ud_pc_point & point)
+{
+	C_od_pc_function::S_f_outputs pc_outputs;
+	point.m_off_design_code = f_pc_eq(point.ms_inputs, pc_outputs);
+
+	util::matrix_t<double> & table = *point.mp_table;
+	int i = point.m_row;
+	int j = point.m_level;
+
+	if( point.m_off_design_code == 0 )
+	{
+		// Save outputs
+		table(i,1+j) = pc_outputs.m_W_dot_gross_ND;		//[-]
+		table(i,4+j) = pc_outputs.m_Q_dot_in_ND;		//[-]
+		table(i,7+j) = pc_outputs.m_W_dot_cooling_ND;	//[-]
+		table(i,10+j) = pc_outputs.m_m_dot_water_ND;	//[-]
+	}
+	else if (point.m_off_design_code == -1)
+	{
+		// Save 'generic' off design model response
+		table(i, 1 + j) = point.ms_inputs.m_m_dot_htf_ND;		//[-]
+		table(i, 4 + j) = point.ms_inputs.m_m_dot_htf_ND;		//[-]
+		table(i, 7 + j) = point.ms_inputs.m_m_dot_htf_ND;		//[-]
+		table(i, 10 + j) = point.ms_inputs.m_m_dot_htf_ND;		//[-]
+	}
+}
+
+void C_ud_pc_table_generator::report_point(const S_ud_pc_point & point, int run_number, int n_runs_total)
+{
+	const C_od_pc_function::S_f_inputs & pc_inputs = point.ms_inputs;
+
+	if( point.m_off_design_code != 0 && point.m_off_design_code != -1 )
+	{
+		std::string err_msg;
+		if( point.m_table == 1 )
+			err_msg = util::format("The 1st UDPC table (primary: T_htf, interaction: m_dot_htf_ND) generation failed at T_htf = %lg [C] and m_dot_htf = %lg [-]", pc_inputs.m_T_htf_hot, pc_inputs.m_m_dot_htf_ND);
+		else if( point.m_table == 2 )
+			err_msg = util::format("The 2nd UDPC table (primary: T_amb, interaction: T_htf) generation failed at T_amb = %lg [C] and T_htf = %lg [C]", pc_inputs.m_T_amb, pc_inputs.m_T_htf_hot);
+		else
+			err_msg = util::format("The 3rd UDPC table (primary: m_dot_htf_ND, interaction: T_amb) generation failed at T_amb = %lg [C] and m_dot_htf = %lg [-]", pc_inputs.m_T_amb, pc_inputs.m_m_dot_htf_ND);
+		throw(C_csp_exception(err_msg, "UDPC"));
+	}
+
+	const util::matrix_t<double> & table = *point.mp_table;
+	int i = point.m_row;
+	int j = point.m_level;
+
+	send_callback(point.m_off_design_code == -1, run_number, n_runs_total,
+		pc_inputs.m_T_htf_hot, pc_inputs.m_m_dot_htf_ND, pc_inputs.m_T_amb,
+		table(i, 1 + j), table(i, 4 + j),
+		table(i, 7 + j), table(i, 10 + j));
 }
\ No newline at end of file
@@ -148,11 +148,23 @@ public:
 	C_od_pc_function()
 	{
 	}
-	~C_od_pc_function()
+	virtual ~C_od_pc_function()
 	{
 	}
 
 	virtual int operator()(S_f_inputs inputs, S_f_outputs & outputs) = 0;
+
+	// Return an independent copy that can be called concurrently with this one, or NULL if the function
+	// ... doesn't support it. The caller owns the copy
+	virtual C_od_pc_function * clone() const
+	{
+		return 0;	// = NULL
+	}
+
+	// Forget any solution carried over from previous calls. Called at the start of each sweep of neighboring points
+	virtual void reset_warm_start()
+	{
+	}
 };
 
 class C_ud_pc_table_generator
@@ -163,6 +175,22 @@ private:
 	std::string m_log_msg;
 	std::string m_progress_msg;	
 
+	struct S_ud_pc_point
+	{
+		C_od_pc_function::S_f_inputs ms_inputs;
+		util::matrix_t<double> *mp_table;	// Table and row/level where the outputs are saved
+		int m_table;		//[-] 1, 2, or 3
+		int m_row;
+		int m_level;
+		int m_off_design_code;
+	};
+
+	void solve_sweeps_serial(const std::vector<std::vector<int> > & v_sweeps, std::vector<S_ud_pc_point> & v_points);
+
+	void solve_point(C_od_pc_function & f_pc_eq, S_ud_pc_point & point);
+
+	void report_point(const S_ud_pc_point & point, int run_number, int n_runs_total);
+
 	void send_callback(bool is_od_model_error, int run_number, int n_runs_total,
 		double T_htf_hot, double m_dot_htf_ND, double T_amb,
 		double W_dot_gross_ND, double Q_dot_in_ND,
@@ -172,6 +200,10 @@ public:
 
 	C_csp_messages mc_messages;
 
+	// Number of threads used to solve the table points. < 1 uses one thread per hardware core, which oversubscribes
+	// ... the machine if several models run at once. Only applies if the power cycle function can be cloned
+	int m_n_threads;
+
 	C_ud_pc_table_generator(C_od_pc_function & f_pc_eq);
 
 	~C_ud_pc_table_generator(){}
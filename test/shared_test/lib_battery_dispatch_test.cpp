@@ -1,4 +1,6 @@
 #include <math.h>
+#include <algorithm>
+#include <type_traits>
 #include <gtest/gtest.h>
 
 #include "lib_battery_dispatch_test.h"
@@ -76,3 +78,202 @@ TEST_F(BatteryDispatchTest, LossesModel_lib_battery_dispatch)
 {
 
 }
+
+TEST(ForecastWindowTest, MatchesDirectScan_lib_battery_dispatch)
+{
+	// a price-like series with repeated values and plateaus
+	std::vector<double> series;
+	for (size_t i = 0; i != 500; i++)
+		series.push_back(std::floor(10 * sin(0.07 * i) + 5 * cos(0.31 * i)));
+
+	size_t widths[] = { 1, 7, 24, 96 };
+	size_t strides[] = { 1, 4 };
+	for (size_t width : widths) {
+		for (size_t stride : strides) {
+			forecast_window_t window;
+			window.compute_extrema(series, width, stride);
+			window.compute_sum(series, width, stride);
+			for (size_t start = 0; start + width <= series.size(); start += stride) {
+				ASSERT_TRUE(window.has_extrema(start));
+				ASSERT_TRUE(window.has_sum(start));
+				double max = series[start], min = series[start], sum = 0;
+				for (size_t i = start; i != start + width; i++) {
+					max = std::fmax(max, series[i]);
+					min = std::fmin(min, series[i]);
+					sum += series[i];
+				}
+				EXPECT_EQ(window.max(start), max) << "width " << width << " start " << start;
+				EXPECT_EQ(window.min(start), min) << "width " << width << " start " << start;
+				EXPECT_NEAR(window.sum(start), sum, 1e-9) << "width " << width << " start " << start;
+			}
+			EXPECT_FALSE(window.has_sum(series.size() - width + stride));
+		}
+	}
+}
+
+TEST(DispatchOptTest, PriceArbitrage_lib_battery_dispatch)
+{
+	dispatch_opt_t opt(dispatch_opt_t::MAXIMIZE_REVENUE);
+	opt.params.P_charge_max = opt.params.P_discharge_max = 10;
+	opt.params.E_min = 2;
+	opt.params.E_max = 20;
+	opt.params.E_init = 10;
+	opt.params.eta_pv_charge = opt.params.eta_grid_charge = opt.params.eta_discharge = 0.95;
+	opt.params.can_grid_charge = true;
+	for (size_t h = 0; h != 24; h++)
+		opt.forecast.price_sell.push_back(h >= 16 && h < 20 ? 0.30 : (h < 6 ? 0.02 : 0.05));
+
+	// resolving the same window from the warm start gives the same plan
+	for (size_t i = 0; i != 2; i++) {
+		ASSERT_TRUE(opt.optimize(24));
+		ASSERT_EQ(opt.outputs.P_battery.size(), 24);
+
+		// fill at the cheapest price, empty over the high price period
+		double E = opt.params.E_init, charge_cheap = 0, discharge_high = 0;
+		for (size_t h = 0; h != 24; h++) {
+			double P = opt.outputs.P_battery[h];
+			EXPECT_LE(P, opt.params.P_discharge_max + 1e-6);
+			EXPECT_GE(P, -opt.params.P_charge_max - 1e-6);
+			E -= P;
+			EXPECT_GE(E, opt.params.E_min - 1e-6);
+			EXPECT_LE(E, opt.params.E_max + 1e-6);
+			if (h < 6)
+				charge_cheap -= P;
+			else if (h >= 16 && h < 20)
+				discharge_high += P;
+			else
+				EXPECT_NEAR(P, 0, 1e-6) << "hour " << h;
+		}
+		EXPECT_NEAR(charge_cheap, opt.params.E_max - opt.params.E_init, 1e-6);
+		EXPECT_NEAR(discharge_high, opt.params.E_max - opt.params.E_min, 1e-6);
+	}
+}
+
+TEST(DispatchOptTest, NegativePrices_lib_battery_dispatch)
+{
+	dispatch_opt_t opt(dispatch_opt_t::MAXIMIZE_REVENUE);
+	opt.params.P_charge_max = opt.params.P_discharge_max = 10;
+	opt.params.E_min = 2;
+	opt.params.E_max = 20;
+	opt.params.E_init = 10;
+	opt.params.eta_pv_charge = opt.params.eta_discharge = 0.9;
+	opt.params.cycle_cost = 0.001;
+	opt.params.can_pv_charge = true;
+	for (size_t h = 0; h != 12; h++) {
+		opt.forecast.P_pv.push_back(h >= 2 && h < 10 ? 8 : 0);
+		opt.forecast.price_sell.push_back(h >= 3 && h < 8 ? -0.05 : 0.04);
+	}
+
+	// round trip losses are worth paying for at negative prices, but the battery can't charge and discharge at once,
+	// ... so the optimal cost follows from the net battery power at each step
+	ASSERT_TRUE(opt.optimize(12));
+	double E = opt.params.E_init, cost = 0;
+	for (size_t h = 0; h != 12; h++) {
+		double P = opt.outputs.P_battery[h];
+		double sell = opt.forecast.price_sell[h];
+		if (P < 0) {
+			EXPECT_LE(-P, opt.params.eta_pv_charge * opt.forecast.P_pv[h] + 1e-6) << "hour " << h;
+			cost += -P * sell / opt.params.eta_pv_charge;
+		}
+		else
+			cost -= P * (sell * opt.params.eta_discharge - opt.params.cycle_cost);
+		E -= P;
+		EXPECT_GE(E, opt.params.E_min - 1e-6) << "hour " << h;
+		EXPECT_LE(E, opt.params.E_max + 1e-6) << "hour " << h;
+	}
+	EXPECT_NEAR(opt.outputs.objective, cost, 1e-6);
+
+	// PV is stored rather than exported at a negative price
+	double stored = 0;
+	for (size_t h = 3; h != 8; h++)
+		stored -= opt.outputs.P_battery[h];
+	EXPECT_GT(stored, 0);
+}
+
+TEST(DispatchOptTest, PeakShaving_lib_battery_dispatch)
+{
+	dispatch_opt_t opt(dispatch_opt_t::MINIMIZE_PEAK);
+	opt.params.P_charge_max = opt.params.P_discharge_max = 10;
+	opt.params.E_min = 2;
+	opt.params.E_max = 20;
+	opt.params.E_init = 20;
+	opt.params.cycle_cost = 1e-4;
+	opt.params.value_end = 1e-5;
+	for (size_t h = 0; h != 24; h++)
+		opt.forecast.P_load.push_back(h >= 17 && h < 20 ? 50 : 20);
+
+	// 18 kWh over three hours shaves the 50 kW peak by 6 kW
+	ASSERT_TRUE(opt.optimize(24));
+	for (size_t h = 0; h != 24; h++)
+		EXPECT_LE(opt.outputs.P_grid[h], 44 + 1e-6) << "hour " << h;
+	EXPECT_NEAR(opt.outputs.P_grid[18], 44, 1e-6);
+
+	// no benefit to shaving below the peak already set, and a fractional time limit rounds up rather than disabling the limit
+	static_assert(!std::is_copy_assignable<dispatch_opt_t>::value, "the solver context is owned, copies must be constructed");
+	dispatch_opt_t copy(opt);
+	copy.params.peak_min = 47;
+	copy.solver_params.timeout = 0.2;
+	ASSERT_TRUE(copy.optimize(24));
+	EXPECT_NEAR(*std::max_element(copy.outputs.P_grid.begin(), copy.outputs.P_grid.end()), 47, 1e-6);
+}
+
+TEST_F(BatteryDispatchTest, DispatchAutoBTMOptimized_lib_battery_dispatch)
+{
+	dispatch_automatic_behind_the_meter_t dispatchOpt(batteryModel, dtHour, SOC_min, SOC_max, currentChoice, currentChargeMax,
+		currentDischargeMax, powerChargeMax, powerDischargeMax, 0, dispatch_t::OPTIMIZED_LOOK_AHEAD, 0, 1, 24, 1, true, true, false, false);
+
+	for (size_t d = 0; d < 365; d++) {
+		for (size_t h = 0; h < 24; h++) {
+			pv_prediction.push_back(0);
+			load_prediction.push_back(h >= 17 && h < 20 ? 800 : 600);
+		}
+	}
+	dispatchOpt.update_load_data(load_prediction);
+	dispatchOpt.update_pv_data(pv_prediction);
+
+	batteryPower = dispatchOpt.getBatteryPower();
+	batteryPower->connectionMode = ChargeController::AC_CONNECTED;
+	batteryPower->powerLoad = 600;
+
+	// plan is made at the start of the day, battery idles until the peak
+	dispatchOpt.dispatch(0, 0, 0);
+	EXPECT_NEAR(dispatchOpt.power_batt_target(), 0, 1e-6);
+
+	batteryPower->powerLoad = 800;
+	dispatchOpt.dispatch(0, 18, 0);
+	EXPECT_GT(dispatchOpt.power_batt_target(), 0);
+	EXPECT_LT(dispatchOpt.power_grid_target(), 800);
+}
+
+TEST(ForecastWindowTest, EndOfSeries_lib_battery_dispatch)
+{
+	std::vector<double> series;
+	for (size_t i = 0; i != 10; i++)
+		series.push_back((double)i);
+
+	// the last window ends exactly at the end of the series
+	forecast_window_t window;
+	window.compute_extrema(series, 4);
+	window.compute_sum(series, 4);
+	ASSERT_TRUE(window.has_sum(6));
+	ASSERT_TRUE(window.has_extrema(6));
+	EXPECT_EQ(window.sum(6), 6 + 7 + 8 + 9);
+	EXPECT_EQ(window.max(6), 9);
+	EXPECT_EQ(window.min(6), 6);
+	EXPECT_FALSE(window.has_sum(7));
+	EXPECT_FALSE(window.has_extrema(7));
+
+	// with a stride, the last window is the last multiple of the stride which still fits
+	window.compute_sum(series, 4, 4);
+	ASSERT_TRUE(window.has_sum(4));
+	EXPECT_EQ(window.sum(4), 4 + 5 + 6 + 7);
+	EXPECT_FALSE(window.has_sum(8));
+
+	// a window as long as the series, and one longer
+	window.compute_sum(series, 10);
+	ASSERT_TRUE(window.has_sum(0));
+	EXPECT_EQ(window.sum(0), 45);
+	EXPECT_FALSE(window.has_sum(1));
+	window.compute_sum(series, 11);
+	EXPECT_FALSE(window.has_sum(0));
+}
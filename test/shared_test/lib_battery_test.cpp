@@ -70,4 +70,57 @@ TEST_F(BatteryTest, LossesModel_lib_battery)
 	lossModel->run_losses(idx);
 	EXPECT_EQ(lossModel->getLoss(idx), 1);
 
-}
\ No newline at end of file
+}
+TEST_F(BatteryTest, SaveRestoreState_lib_battery)
+{
+	// cycle the battery so the rainflow residue and lifetime state are not trivial
+	size_t idx = 0;
+	for (; idx < 200; idx++)
+		batteryModel->run(idx, (idx % 7 < 3) ? 20. : -15.);
+
+	battery_state state;
+	batteryModel->save_state(state);
+
+	std::vector<double> soc, voltage, T, q;
+	std::vector<int> cycles;
+	for (size_t i = 0; i < 100; i++) {
+		batteryModel->run(idx + i, (i % 3 == 0) ? 10. : -5.);
+		soc.push_back(batteryModel->battery_soc());
+		voltage.push_back(batteryModel->battery_voltage());
+		T.push_back(batteryModel->thermal_model()->T_battery());
+		q.push_back(batteryModel->lifetime_model()->capacity_percent());
+		cycles.push_back(batteryModel->lifetime_model()->cycleModel()->cycles_elapsed());
+	}
+
+	// take the battery somewhere else, then return to the checkpoint
+	batteryModel->restore_state(state);
+	for (size_t i = 0; i < 50; i++)
+		batteryModel->run(idx + i, (i % 5 < 2) ? -30. : 25.);
+	batteryModel->restore_state(state);
+
+	// restored battery repeats the trajectory exactly
+	for (size_t i = 0; i < 100; i++) {
+		batteryModel->run(idx + i, (i % 3 == 0) ? 10. : -5.);
+		EXPECT_DOUBLE_EQ(batteryModel->battery_soc(), soc[i]) << "step " << i;
+		EXPECT_DOUBLE_EQ(batteryModel->battery_voltage(), voltage[i]) << "step " << i;
+		EXPECT_DOUBLE_EQ(batteryModel->thermal_model()->T_battery(), T[i]) << "step " << i;
+		EXPECT_DOUBLE_EQ(batteryModel->lifetime_model()->capacity_percent(), q[i]) << "step " << i;
+		EXPECT_EQ(batteryModel->lifetime_model()->cycleModel()->cycles_elapsed(), cycles[i]) << "step " << i;
+	}
+}
+
+TEST_F(BatteryTest, CycleLifetimeRainflow_lib_battery)
+{
+	// repeated 50% DOD cycles, each counted once the following trough arrives
+	size_t nCycles = 500;
+	cycleModel->runCycleLifetime(0);
+	for (size_t i = 0; i < nCycles; i++) {
+		cycleModel->runCycleLifetime(50);
+		cycleModel->runCycleLifetime(0);
+	}
+	EXPECT_EQ(cycleModel->cycles_elapsed(), (int)nCycles);
+	EXPECT_DOUBLE_EQ(cycleModel->average_range(), 50);
+
+	// halfway between the 20% and 80% DOD curves: 100 - (0.004 + 0.02) / 2 * n
+	EXPECT_NEAR(cycleModel->capacity_percent(), 100 - 0.012 * nCycles, 1e-9);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "lib_financial.h"
+
+static double npv_at(double rate, const std::vector<double> &cf, int count) {
+	double result = 0;
+	for (int i = count; i >= 0; i--)
+		result = result / (1 + rate) + cf[i];
+	return result;
+}
+
+TEST(lib_financial_test, IrrSimpleCashFlows_lib_financial) {
+	std::vector<double> cf = { -100, 110 };
+	EXPECT_NEAR(libfin::irr_from(&cf[0], 1), 0.1, 1e-9);
+
+	// annuity of 10 years at 8%
+	std::vector<double> annuity(11, 14.902949);
+	annuity[0] = -100;
+	EXPECT_NEAR(libfin::irr_from(&annuity[0], 10), 0.08, 1e-6);
+
+	// first year return of -90% is found from the default estimate and from a poor guess
+	std::vector<double> loss = { -100, 10 };
+	EXPECT_NEAR(libfin::irr_from(&loss[0], 1), -0.9, 1e-9);
+	EXPECT_NEAR(libfin::irr_from(&loss[0], 1, 5.0), -0.9, 1e-6);
+}
+
+TEST(lib_financial_test, IrrUndefined_lib_financial) {
+	// positive first cash flow, no returns at all, all returns negative and a zero investment
+	std::vector<double> positive = { 100, -50, -60 };
+	std::vector<double> no_return = { -100, 0, 0 };
+	std::vector<double> all_negative = { -100, -10, -10 };
+	std::vector<double> no_investment = { 0, 37e6, 5e6, 5e6 };
+	EXPECT_TRUE(std::isnan(libfin::irr_from(&positive[0], 2)));
+	EXPECT_TRUE(std::isnan(libfin::irr_from(&no_return[0], 2)));
+	EXPECT_TRUE(std::isnan(libfin::irr_from(&all_negative[0], 2)));
+	EXPECT_TRUE(std::isnan(libfin::irr_from(&no_investment[0], 3)));
+	EXPECT_TRUE(std::isnan(libfin::irr_from(&positive[0], 0)));
+}
+
+TEST(lib_financial_test, IrrNonConventional_lib_financial) {
+	// npv rises through the root: returns early and pays back later, i.e. borrowing at 10%
+	std::vector<double> borrow = { 0, 100, -110 };
+	EXPECT_NEAR(libfin::irr_from(&borrow[0], 2), 0.1, 1e-6);
+
+	// two sign changes in the cash flow give roots at 10% and 20%, the one where the npv falls with the rate is preferred
+	std::vector<double> two_roots = { -100, 230, -132 };
+	EXPECT_NEAR(libfin::irr_from(&two_roots[0], 2), 0.2, 1e-4);
+
+	// npv touches zero at 0% without changing sign
+	std::vector<double> touching = { -100, 200, -100 };
+	EXPECT_NEAR(libfin::irr_from(&touching[0], 2), 0, 1e-3);
+}
+
+TEST(lib_financial_test, IrrSeriesMatchesSingleYears_lib_financial) {
+	// project style cash flow with a late negative stretch and a positive final year
+	std::vector<double> cf = { -1.67e9, 6.5e7, 1.0e8, 6.2e7, 3.7e7, 3.7e7, 1.8e7 };
+	for (int i = 0; i < 15; i++) cf.push_back(2.5e8 * (1 + 0.01 * i));
+	for (int i = 0; i < 6; i++) cf.push_back(-1.5e7);
+	cf.push_back(2.2e7);
+	int nyears = (int)cf.size() - 1;
+
+	std::vector<double> irrs(cf.size());
+	libfin::irr_series(&cf[0], nyears, &irrs[0]);
+	EXPECT_TRUE(std::isnan(irrs[0]));
+	for (int i = 1; i <= nyears; i++) {
+		double single = libfin::irr_from(&cf[0], i);
+		if (std::isnan(single)) {
+			EXPECT_TRUE(std::isnan(irrs[i])) << "year " << i;
+			continue;
+		}
+		EXPECT_NEAR(irrs[i], single, 1e-6) << "year " << i;
+		EXPECT_NEAR(npv_at(irrs[i], cf, i) / 1.67e9, 0, 1e-6) << "year " << i;
+		EXPECT_GT(npv_at(irrs[i] - 0.001, cf, i), npv_at(irrs[i] + 0.001, cf, i)) << "year " << i;
+	}
+	// returns go from large losses in the first years to positive once the investment is recovered
+	EXPECT_LT(irrs[1], -0.9);
+	EXPECT_GT(irrs[20], 0.05);
+}
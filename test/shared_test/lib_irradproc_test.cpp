@@ -479,6 +479,79 @@ TEST_F(SunsetCaseIrradProc, CalcTestRadMode0_lib_irradproc){
 	*/
 }
 
+/**
+*   The series processor must reproduce irrad::calc() for every time step of a year, including sunrise and sunset
+*   steps, steps where the beam exceeds the extraterrestrial limit, and high latitude days without sunrise or sunset
+*/
+TEST(IrradSeriesTest, MatchesScalarProcessor_lib_irradproc)
+{
+	const int nday[12] = { 31,28,31,30,31,30,31,31,30,31,30,31 };
+	vector<int> year, month, day, hour;
+	vector<double> minute, dn, df, gh, alb;
+	for (int m = 0; m < 12; m++)
+		for (int d = 0; d < nday[m]; d++)
+			for (int h = 0; h < 24; h++)
+				for (int mi = 0; mi < 60; mi += 20) {
+					year.push_back(2017); month.push_back(m + 1); day.push_back(d + 1); hour.push_back(h); minute.push_back(mi + 10);
+					dn.push_back(400 + 300 * sin(0.1 * h + d)); df.push_back(80 + 10 * (h % 5)); gh.push_back(500 + 200 * cos(0.3 * d));
+					alb.push_back(0.2);
+				}
+	size_t n = year.size();
+
+	struct { double lat, lon, tz; int track, sky, radmode; bool backtrack; double delt; } cases[] = {
+		{ 33.45, -111.98, -7, 0, 2, irrad::DN_DF, false, 1.0 / 3.0 },
+		{ 33.45, -111.98, -7, 1, 2, irrad::DN_GH, true, 1.0 / 3.0 },
+		{ 69.65, 18.96, 1, 2, 1, irrad::GH_DF, false, 1.0 / 3.0 },
+		{ -17.7, 178.4, 12, 3, 0, irrad::DN_DF, false, IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET },
+	};
+
+	for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+		irrad_series series;
+		series.set_location(cases[c].lat, cases[c].lon, cases[c].tz);
+		series.set_sky_model(cases[c].sky);
+		series.set_surface(cases[c].track, 30, 180, 45, cases[c].backtrack, 0.4);
+		series.calc(n, &year[0], &month[0], &day[0], &hour[0], &minute[0], cases[c].delt, cases[c].radmode, &dn[0], &df[0], &gh[0], &alb[0]);
+
+		for (size_t i = 0; i < n; i++) {
+			irrad x;
+			x.set_time(year[i], month[i], day[i], hour[i], minute[i], cases[c].delt);
+			x.set_location(cases[c].lat, cases[c].lon, cases[c].tz);
+			x.set_sky_model(cases[c].sky, alb[i]);
+			if (cases[c].radmode == irrad::DN_DF) x.set_beam_diffuse(dn[i], df[i]);
+			else if (cases[c].radmode == irrad::DN_GH) x.set_global_beam(gh[i], dn[i]);
+			else x.set_global_diffuse(gh[i], df[i]);
+			x.set_surface(cases[c].track, 30, 180, 45, cases[c].backtrack, 0.4);
+			int code = x.calc();
+
+			double sun[6], ang[5], poa[6];
+			int sunup;
+			x.get_sun(&sun[0], &sun[1], &sun[2], &sun[3], &sun[4], &sun[5], &sunup, 0, 0, 0);
+			x.get_angles(&ang[0], &ang[1], &ang[2], &ang[3], &ang[4]);
+			x.get_poa(&poa[0], &poa[1], &poa[2], &poa[3], &poa[4], &poa[5]);
+
+			ASSERT_EQ(series.code[i], code) << "case " << c << " step " << i;
+			ASSERT_EQ(series.sunup[i], sunup) << "case " << c << " step " << i;
+			ASSERT_EQ(series.sunpos_hour[i], x.get_sunpos_calc_hour()) << "case " << c << " step " << i;
+			ASSERT_EQ(series.solazi[i], sun[0]) << "case " << c << " step " << i;
+			ASSERT_EQ(series.solzen[i], sun[1]) << "case " << c << " step " << i;
+			ASSERT_EQ(series.sunset[i], sun[5]) << "case " << c << " step " << i;
+			ASSERT_EQ(series.aoi[i], ang[0]) << "case " << c << " step " << i;
+			ASSERT_EQ(series.axisrot[i], ang[3]) << "case " << c << " step " << i;
+			ASSERT_EQ(series.poa_beam[i], poa[0]) << "case " << c << " step " << i;
+			ASSERT_EQ(series.poa_skydiff[i], poa[1]) << "case " << c << " step " << i;
+			ASSERT_EQ(series.poa_gnddiff[i], poa[2]) << "case " << c << " step " << i;
+			ASSERT_EQ(series.poa_cir[i], poa[4]) << "case " << c << " step " << i;
+		}
+	}
+
+	// an empty series has nothing to index
+	irrad_series empty;
+	empty.set_location(33.45, -111.98, -7);
+	ASSERT_EQ(empty.calc(0, 0, 0, 0, 0, 0, 1.0, irrad::DN_DF, 0, 0, 0, 0), 0);
+	ASSERT_TRUE(empty.code.empty());
+	ASSERT_TRUE(empty.poa_beam.empty());
+}
+
 /**
 *   Test Sky Configuration factors.  These factors do not change with time, just system geometry
 */
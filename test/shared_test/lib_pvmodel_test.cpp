@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "lib_pvmodel.h"
+#include "lib_cec6par.h"
+#include "lib_iec61853.h"
+
+/**
+ * Compares the explicit Lambert W single diode solutions against the iterative
+ * golden section / Newton solutions over a range of irradiance and cell temperature.
+ */
+
+TEST(lib_pvmodel_test, LambertW_lib_pvmodel) {
+	// W(x) exp(W(x)) = x, including arguments too large to represent directly
+	double lnx[] = { -40, -5, -1, 0, 0.5, 1, 2, 3, 10, 50, 700, 5000 };
+	for (size_t i = 0; i < sizeof(lnx) / sizeof(lnx[0]); i++) {
+		double w = lambertw_exp(lnx[i]);
+		EXPECT_NEAR(w + log(w), lnx[i], 1e-12 * fmax(1.0, fabs(lnx[i]))) << "ln(x) = " << lnx[i];
+	}
+	EXPECT_NEAR(lambertw_exp(0), 0.5671432904097838, 1e-15);
+	EXPECT_NEAR(lambertw_exp(1), 1.0, 1e-15);
+}
+
+TEST(lib_pvmodel_test, MaxPowerLambertWMatchesGolden_lib_pvmodel) {
+	// 60 cell mono-Si module at reference conditions
+	double a_ref = 1.5, Il_ref = 9.2, Io_ref = 2.5e-10, Rs = 0.32, Rsh_ref = 380;
+
+	for (double G = 10; G <= 1200; G += 50) {
+		for (double T = -20; T <= 80; T += 10) {
+			double Tk = T + 273.15;
+			double a = a_ref * Tk / 298.15;
+			double Il = G / 1000 * (Il_ref + 0.004 * (Tk - 298.15));
+			double EG = 1.121 * (1 - 0.0002677 * (Tk - 298.15));
+			double Io = Io_ref * pow(Tk / 298.15, 3) * exp(1 / 8.618e-5 * (1.121 / 298.15 - EG / Tk));
+			double Rsh = Rsh_ref * 1000 / G;
+
+			double Voc = openvoltage_5par(40, a, Il, Io, Rsh);
+			double Voc_lw = openvoltage_5par_lambertw(a, Il, Io, Rsh);
+			EXPECT_NEAR(Voc_lw, Voc, 1e-3) << "G=" << G << " T=" << T;
+
+			double V, I, V_lw, I_lw;
+			double P = maxpower_5par(Voc, a, Il, Io, Rs, Rsh, &V, &I);
+			double P_lw = maxpower_5par_lambertw(Voc_lw, a, Il, Io, Rs, Rsh, &V_lw, &I_lw);
+			EXPECT_NEAR(P_lw, P, 1e-5 * P + 1e-6) << "G=" << G << " T=" << T;
+			EXPECT_NEAR(V_lw, V, 1e-3 * V) << "G=" << G << " T=" << T;
+			EXPECT_NEAR(I_lw, I, 1e-3 * I) << "G=" << G << " T=" << T;
+
+			double Ic = current_5par(0.5 * V, 0.9 * Il, a, Il, Io, Rs, Rsh);
+			EXPECT_NEAR(current_5par_lambertw(0.5 * V, a, Il, Io, Rs, Rsh), Ic, 2e-4) << "G=" << G << " T=" << T;
+		}
+	}
+}
+
+TEST(lib_pvmodel_test, ModuleLambertWMatchesGolden_lib_pvmodel) {
+	cec6par_module_t cec;
+	cec.Area = 1.63; cec.Vmp = 31.4; cec.Imp = 8.6; cec.Voc = 38.6; cec.Isc = 9.2;
+	cec.alpha_isc = 0.004; cec.beta_voc = -0.12; cec.a = 1.5; cec.Il = 9.2; cec.Io = 2.5e-10;
+	cec.Rs = 0.32; cec.Rsh = 380; cec.Adj = 5;
+
+	iec61853_module_t iec;
+	iec.alphaIsc = 0.004; iec.n = 1.05; iec.Il = 9.2; iec.Io = 2.5e-10;
+	iec.C1 = 380; iec.C2 = 1000; iec.C3 = 1.2; iec.D1 = 0.32; iec.D2 = 0; iec.D3 = 0.1;
+	iec.Egref = 1.121; iec.Vmp0 = 31.4; iec.Imp0 = 8.6; iec.Voc0 = 38.6; iec.Isc0 = 9.2;
+	iec.NcellSer = 60; iec.Area = 1.63; iec.GlassAR = false;
+	for (int i = 0; i < 5; i++) iec.AMA[i] = (i == 0) ? 1.0 : 0.0;
+
+	for (double G = 50; G <= 1100; G += 150) {
+		pvinput_t in(G * 0.8, G * 0.15, G * 0.05, 0, G, 20, 10, 2, 180, 1013, 30, 20, 100, 25, 180, 12, 0, false);
+		for (double Tc = 0; Tc <= 70; Tc += 35) {
+			pvoutput_t gold, lw;
+			cec.UseLambertW = false;
+			ASSERT_TRUE(cec(in, Tc, -1, gold));
+			cec.UseLambertW = true;
+			ASSERT_TRUE(cec(in, Tc, -1, lw));
+			EXPECT_GT(gold.Power, 0) << "cec G=" << G << " Tc=" << Tc;
+			EXPECT_NEAR(lw.Power, gold.Power, 1e-5 * gold.Power) << "cec G=" << G << " Tc=" << Tc;
+			EXPECT_NEAR(lw.Voc_oper, gold.Voc_oper, 1e-3) << "cec G=" << G << " Tc=" << Tc;
+
+			iec.UseLambertW = false;
+			iec(in, Tc, -1, gold);
+			iec.UseLambertW = true;
+			iec(in, Tc, -1, lw);
+			EXPECT_GT(gold.Power, 0) << "iec G=" << G << " Tc=" << Tc;
+			EXPECT_NEAR(lw.Power, gold.Power, 1e-5 * gold.Power + 1e-6) << "iec G=" << G << " Tc=" << Tc;
+			EXPECT_NEAR(lw.Voltage, gold.Voltage, 1e-3 * gold.Voltage + 1e-6) << "iec G=" << G << " Tc=" << Tc;
+		}
+	}
+}
+
+TEST(lib_pvmodel_test, MaxPowerLambertWBatchMatchesScalar_lib_pvmodel) {
+	double a_ref = 1.5, Il_ref = 9.2, Io_ref = 2.5e-10, Rs = 0.32, Rsh_ref = 380;
+
+	// includes a dark state that has no maximum power point
+	std::vector<double> Voc, a, Il, Io, Rsh;
+	for (double G = 0; G <= 1200; G += 50) {
+		for (double T = -20; T <= 80; T += 20) {
+			double Tk = T + 273.15;
+			a.push_back(a_ref * Tk / 298.15);
+			Il.push_back(G / 1000 * (Il_ref + 0.004 * (Tk - 298.15)));
+			double EG = 1.121 * (1 - 0.0002677 * (Tk - 298.15));
+			Io.push_back(Io_ref * pow(Tk / 298.15, 3) * exp(1 / 8.618e-5 * (1.121 / 298.15 - EG / Tk)));
+			Rsh.push_back(Rsh_ref * 1000 / fmax(G, 1));
+			Voc.push_back(openvoltage_5par_lambertw(a.back(), Il.back(), Io.back(), Rsh.back()));
+		}
+	}
+	size_t n = Voc.size();
+	std::vector<double> P(n), V(n), I(n);
+	maxpower_5par_lambertw_batch(n, Voc.data(), a.data(), Il.data(), Io.data(), Rs, Rsh.data(), P.data(), V.data(), I.data());
+
+	// every state takes the same steps as in the scalar solver
+	for (size_t i = 0; i < n; i++) {
+		double Vs, Is;
+		double Ps = maxpower_5par_lambertw(Voc[i], a[i], Il[i], Io[i], Rs, Rsh[i], &Vs, &Is);
+		EXPECT_EQ(P[i], Ps) << "i=" << i;
+		EXPECT_EQ(V[i], Vs) << "i=" << i;
+		EXPECT_EQ(I[i], Is) << "i=" << i;
+	}
+}
+
+TEST(lib_pvmodel_test, BatchedEvaluateMatchesScalar_lib_pvmodel) {
+	cec6par_module_t cec;
+	cec.Area = 1.63; cec.Vmp = 31.4; cec.Imp = 8.6; cec.Voc = 38.6; cec.Isc = 9.2;
+	cec.alpha_isc = 0.004; cec.beta_voc = -0.12; cec.a = 1.5; cec.Il = 9.2; cec.Io = 2.5e-10;
+	cec.Rs = 0.32; cec.Rsh = 380; cec.Adj = 5;
+
+	// includes night time and low light states that skip the electrical solution
+	std::vector<pvinput_t> in;
+	std::vector<double> tcell, opv;
+	for (double G = 0; G <= 1100; G += 25) {
+		in.push_back(pvinput_t(G * 0.8, G * 0.15, G * 0.05, 0, G, 20, 10, 2, 180, 1013, 30 + G / 50, 20, 100, 25, 180, 12, 0, false));
+		tcell.push_back(10 + G / 20);
+		opv.push_back(G < 500 ? -1 : 25 + G / 200);
+	}
+	size_t n = in.size();
+
+	for (int lw = 0; lw < 2; lw++) {
+		cec.UseLambertW = (lw == 1);
+		for (int fixed = 0; fixed < 2; fixed++) {
+			std::vector<pvoutput_t> batch(n);
+			ASSERT_TRUE(cec.evaluate(n, in.data(), tcell.data(), fixed ? opv.data() : 0, batch.data()));
+			for (size_t i = 0; i < n; i++) {
+				pvoutput_t scalar;
+				ASSERT_TRUE(cec(in[i], tcell[i], fixed ? opv[i] : -1, scalar));
+				EXPECT_EQ(batch[i].Power, scalar.Power) << "i=" << i;
+				EXPECT_EQ(batch[i].Voltage, scalar.Voltage) << "i=" << i;
+				EXPECT_EQ(batch[i].Current, scalar.Current) << "i=" << i;
+				EXPECT_EQ(batch[i].Efficiency, scalar.Efficiency) << "i=" << i;
+				EXPECT_EQ(batch[i].Voc_oper, scalar.Voc_oper) << "i=" << i;
+				EXPECT_EQ(batch[i].Isc_oper, scalar.Isc_oper) << "i=" << i;
+				EXPECT_EQ(batch[i].AOIModifier, scalar.AOIModifier) << "i=" << i;
+				if (scalar.Power > 0)
+					EXPECT_EQ(batch[i].CellTemp, scalar.CellTemp) << "i=" << i;
+			}
+		}
+	}
+}
@@ -13,4 +13,72 @@ TEST(libUtilTests, testFormat_lib_util)
 	str = "query point (301.3, 10.4) is too far out of convex hull of data (dist=4.3)... estimating value from 5 parameter modele at (2.2, 2.1)=2.4";
 	ASSERT_EQ(util::format("query point (%lg, %lg) is too far out of convex hull of data (dist=%lg)... estimating value from 5 parameter modele at (%lg, %lg)=%lg",
 		301.3, 10.4, 4.3, 2.2, 2.1, 2.4), str);
-}
\ No newline at end of file
+}
+
+TEST(libUtilTests, testMatrixBorrow_lib_util)
+{
+	double values[6] = { 5, 2, 3, 9, 1, 4 };
+	util::matrix_t<double> mat;
+	mat.borrow(values, 2, 3);
+	ASSERT_TRUE(mat.is_borrowed());
+	ASSERT_EQ(mat.data(), values);
+	ASSERT_EQ(mat.at(1, 0), 9);
+
+	// writes at the same shape go to the caller's memory
+	mat.resize_fill(2, 3, 0.0);
+	ASSERT_EQ(values[3], 0);
+
+	// copies are owned, and assigning a new value detaches from the caller's memory
+	util::matrix_t<double> cp(mat);
+	ASSERT_FALSE(cp.is_borrowed());
+	ASSERT_NE(cp.data(), values);
+
+	util::matrix_t<double> other(2, 3, 7.0);
+	mat = other;
+	ASSERT_FALSE(mat.is_borrowed());
+	ASSERT_EQ(values[0], 0);
+	ASSERT_EQ(mat.at(0, 0), 7);
+}
+
+TEST(libUtilTests, testMatrixAdopt_lib_util)
+{
+	double *owned = new double[4];
+	for (int i = 0; i < 4; i++) owned[i] = i + 1;
+	util::matrix_t<double> mat(3, 3, 0.0);
+	mat.adopt(owned, 2, 2);
+	ASSERT_FALSE(mat.is_borrowed());
+	ASSERT_EQ(mat.data(), owned);
+	ASSERT_EQ(mat.nrows(), (size_t)2);
+	ASSERT_EQ(mat.ncols(), (size_t)2);
+	ASSERT_EQ(mat.at(1, 1), 4);
+
+	// invalid arguments leave the matrix as it was
+	mat.adopt(0, 2, 2);
+	double *unused = new double[1];
+	mat.adopt(unused, 0, 1);
+	delete[] unused;
+	ASSERT_EQ(mat.data(), owned);
+
+	// copies get their own storage
+	util::matrix_t<double> cp(mat);
+	ASSERT_NE(cp.data(), owned);
+	ASSERT_EQ(cp.at(1, 0), 3);
+
+	// adopting in place of borrowed memory leaves the caller's memory alone
+	double values[2] = { 5, 6 };
+	util::matrix_t<double> borrowed;
+	borrowed.borrow(values, 1, 2);
+	double *more = new double[2];
+	more[0] = 7;
+	more[1] = 8;
+	borrowed.adopt(more, 1, 2);
+	ASSERT_FALSE(borrowed.is_borrowed());
+	ASSERT_EQ(borrowed.data(), more);
+	ASSERT_EQ(values[0], 5);
+
+	// the adopted memory is released on resize to another shape, and the matrix owns what replaces it
+	mat.resize_fill(3, 1, 9.0);
+	ASSERT_NE(mat.data(), owned);
+	ASSERT_FALSE(mat.is_borrowed());
+	ASSERT_EQ(mat.at(2, 0), 9);
+}
@@ -1,6 +1,8 @@
 #include <string>
 #include <vector>
 #include <cmath>
+#include <chrono>
+#include <iostream>
  
 #include <gtest/gtest.h>
 #include "lib_weatherfile.h"
@@ -147,6 +149,204 @@ TEST_F(weatherfileTest, EPWNoLineEndingsTest_lib_weatherfile) {
 	EXPECT_TRUE(wf.nrecords() == 8760 );
 }
 
+/**
+* \class weatherfileTempTest
+*
+* For tests that write weather files. Files go in the system temporary directory and are removed in TearDown(),
+* whether or not the test passed.
+*/
+class weatherfileTempTest : public weatherfileTest{
+protected:
+	std::string tmp_prefix;
+	std::vector<std::string> tmp_files;
+
+	void SetUp(){
+		const char *dir = std::getenv("TMPDIR");
+		if (!dir) dir = std::getenv("TEMP");
+		if (!dir) dir = std::getenv("TMP");
+		std::string tmp_dir = dir ? dir : "/tmp";
+		tmp_prefix = tmp_dir + "/ssc_weatherfile_test_" +
+			std::to_string((long long)std::chrono::steady_clock::now().time_since_epoch().count()) + "_";
+	}
+	void TearDown(){
+		for (size_t i = 0; i < tmp_files.size(); i++)
+			remove(tmp_files[i].c_str());
+	}
+
+	std::string temp_file(const std::string &name){
+		tmp_files.push_back(tmp_prefix + name);
+		return tmp_files.back();
+	}
+
+	/// Hourly SAM CSV with one year of records; 'row' can replace the text of any data line
+	std::string write_csv(const std::string &name, const char *eol, bool final_eol, std::string (*row)(int) = 0){
+		std::string path = temp_file(name);
+		FILE *fp = fopen(path.c_str(), "wb");
+		if (!fp) return path;
+		fprintf(fp, "Source,Location ID,City,State,Country,Latitude,Longitude,Time Zone,Elevation%s", eol);
+		fprintf(fp, "Synthetic,0,Golden,CO,USA,39.74,-105.17,-7,1829%s", eol);
+		fprintf(fp, "Year,Month,Day,Hour,Minute,GHI,DNI,DHI,Tdry,Tdew,RH,Pres,Wspd,Wdir,Albedo%s", eol);
+		static const int ndays[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+		int n = 0;
+		for (int m = 0; m < 12; m++)
+			for (int d = 0; d < ndays[m]; d++)
+				for (int h = 0; h < 24; h++, n++){
+					std::string line = row ? row(n) : std::string();
+					if (line.empty())
+						line = util::format("2019,%d,%d,%d,0,%d,%d,%d,%.1lf,5,50,1000,2.5,%d,0.2", m + 1, d + 1, h,
+							n % 1000, n % 900, n % 300, 20.0 + (n % 17) * 0.5, n % 360);
+					fprintf(fp, "%s%s", line.c_str(), (n < 8759 || final_eol) ? eol : "");
+				}
+		fclose(fp);
+		return path;
+	}
+};
+
+TEST_F(weatherfileTempTest, BinaryRoundTripTest_lib_weatherfile) {
+	char filepath[256];
+	sprintf(filepath, "%s/test/input_docs/weather_30m.epw", std::getenv("SSCDIR"));
+	file = std::string(filepath);
+	std::string binfile = temp_file("weather_30m.wfb");
+	ASSERT_TRUE(weatherfile::convert_to_binary(file, binfile));
+
+	weatherfile text(file);
+	weatherfile bin(binfile);
+	ASSERT_TRUE(bin.ok()) << bin.message();
+	EXPECT_EQ(bin.type(), text.type());
+	EXPECT_EQ(bin.nrecords(), text.nrecords());
+	EXPECT_EQ(bin.start_sec(), text.start_sec());
+	EXPECT_EQ(bin.step_sec(), text.step_sec());
+	EXPECT_EQ(bin.header().city, text.header().city);
+	EXPECT_DOUBLE_EQ(bin.lat(), text.lat());
+	for (size_t i = 0; i < weather_data_provider::_MAXCOL_; i++)
+		EXPECT_EQ(bin.has_data_column(i), text.has_data_column(i));
+
+	weather_record rt, rb;
+	for (size_t i = 0; i < text.nrecords(); i++) {
+		ASSERT_TRUE(text.read(&rt));
+		ASSERT_TRUE(bin.read(&rb));
+		EXPECT_EQ(rb.hour, rt.hour);
+		EXPECT_EQ(rb.minute, rt.minute);
+		EXPECT_EQ(rb.gh, rt.gh);
+		EXPECT_EQ(rb.dn, rt.dn);
+		EXPECT_EQ(rb.tdry, rt.tdry);
+		EXPECT_EQ(rb.twet, rt.twet);
+	}
+	EXPECT_FALSE(bin.read(&rb));
+}
+
+static void expect_default_row(weatherfile &wf, int n)
+{
+	weather_record r;
+	wf.set_counter_to(n);
+	ASSERT_TRUE(wf.read(&r));
+	EXPECT_EQ(r.hour, n % 24);
+	EXPECT_EQ(r.gh, (float)(n % 1000));
+	EXPECT_EQ(r.df, (float)(n % 300));
+	EXPECT_EQ(r.tdry, (float)(20.0 + (n % 17) * 0.5));
+	EXPECT_EQ(r.wdir, (float)(n % 360));
+	EXPECT_EQ(r.alb, 0.2f);
+}
+
+TEST_F(weatherfileTempTest, CSVLineEndingsTest_lib_weatherfile) {
+	// CRLF line endings: the last field of each line must not pick up the carriage return
+	ASSERT_TRUE(wf.open(write_csv("crlf.csv", "\r\n", true))) << wf.message();
+	EXPECT_EQ(wf.nrecords(), 8760);
+	EXPECT_EQ(wf.header().city, "Golden");
+	expect_default_row(wf, 0);
+	expect_default_row(wf, 4321);
+	expect_default_row(wf, 8759);
+
+	// no line ending after the last record
+	weatherfile wf_lf, wf_noeol;
+	ASSERT_TRUE(wf_lf.open(write_csv("lf.csv", "\n", true))) << wf_lf.message();
+	ASSERT_TRUE(wf_noeol.open(write_csv("noeol.csv", "\n", false))) << wf_noeol.message();
+	EXPECT_EQ(wf_noeol.nrecords(), 8760);
+	expect_default_row(wf_noeol, 8759);
+	expect_default_row(wf_lf, 8759);
+
+	// CRLF without a final line ending
+	weatherfile wf_crlf_noeol;
+	ASSERT_TRUE(wf_crlf_noeol.open(write_csv("crlf_noeol.csv", "\r\n", false))) << wf_crlf_noeol.message();
+	expect_default_row(wf_crlf_noeol, 8759);
+}
+
+static std::string edge_case_row(int n)
+{
+	switch (n)
+	{
+	case 10: return "2019,1,1,10,0,,,,\"21.5\",5,50,1000,2.5,10,0.2";	// empty and quoted fields
+	case 11: return "2019,1,1,11,0, 11 ,\t11\t,-,21,5,50,1000,2.5,11,0.2,";	// padded fields, no digits, trailing delimiter
+	case 12: return "2019,1,1,12,0,1.2e2,+7,-0.5,-3.25,5,50,1000,2.5,12,0.2";	// exponent and signs
+	default: return std::string();
+	}
+}
+
+TEST_F(weatherfileTempTest, CSVFieldEdgeCasesTest_lib_weatherfile) {
+	ASSERT_TRUE(wf.open(write_csv("fields.csv", "\n", true, edge_case_row))) << wf.message();
+	EXPECT_EQ(wf.nrecords(), 8760);
+	weather_record r;
+
+	// fields with no digits are missing values, quotes around a number are ignored
+	wf.set_counter_to(10);
+	ASSERT_TRUE(wf.read(&r));
+	EXPECT_TRUE(std::isnan(r.gh));
+	EXPECT_TRUE(std::isnan(r.dn));
+	EXPECT_TRUE(std::isnan(r.df));
+	EXPECT_EQ(r.tdry, 21.5f);
+	EXPECT_EQ(r.wdir, 10.0f);
+
+	ASSERT_TRUE(wf.read(&r));
+	EXPECT_EQ(r.gh, 11.0f);
+	EXPECT_EQ(r.dn, 11.0f);
+	EXPECT_TRUE(std::isnan(r.df));
+	EXPECT_EQ(r.alb, 0.2f);
+
+	ASSERT_TRUE(wf.read(&r));
+	EXPECT_EQ(r.gh, 120.0f);
+	EXPECT_EQ(r.dn, 7.0f);
+	EXPECT_EQ(r.df, -0.5f);
+	EXPECT_EQ(r.tdry, -3.25f);
+
+	expect_default_row(wf, 13);
+}
+
+/// Ingest timing for a one-minute, single-year CSV (525,600 records), run with --gtest_also_run_disabled_tests
+TEST_F(weatherfileTempTest, DISABLED_CSV1MinuteBenchmark_lib_weatherfile) {
+	file = temp_file("weather_1min_benchmark.csv");
+
+	FILE *fp = fopen(file.c_str(), "w");
+	ASSERT_TRUE(fp != 0);
+	fprintf(fp, "Source,Location ID,City,State,Country,Latitude,Longitude,Time Zone,Elevation\n");
+	fprintf(fp, "Synthetic,0,Golden,CO,USA,39.74,-105.17,-7,1829\n");
+	fprintf(fp, "Year,Month,Day,Hour,Minute,GHI,DNI,DHI,Tdry,Tdew,RH,Pres,Wspd,Wdir,Albedo\n");
+	static const int ndays[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	size_t n = 0;
+	for (int m = 0; m < 12; m++)
+		for (int d = 0; d < ndays[m]; d++)
+			for (int h = 0; h < 24; h++)
+				for (int mi = 0; mi < 60; mi++, n++)
+					fprintf(fp, "2019,%d,%d,%d,%d,%.1f,%.1f,%.1f,%.2f,%.2f,%.1f,%d,%.1f,%d,0.2\n", m + 1, d + 1, h, mi,
+						(double)(n % 1000), (double)(n % 900), (double)(n % 300), 20.0 + (n % 17) * 0.25, 5.0 - (n % 13) * 0.5,
+						(double)(5 + n % 95), 800 + (int)(n % 200), (n % 150) * 0.1, (int)(n % 360));
+	fclose(fp);
+
+	auto start = std::chrono::steady_clock::now();
+	ASSERT_TRUE(wf.open(file)) << wf.message();
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "weatherfile::open on " << wf.nrecords() << " records: " << elapsed << " ms\n";
+
+	EXPECT_EQ(wf.nrecords(), 525600);
+	EXPECT_EQ(wf.step_sec(), 60);
+	weather_record r;
+	wf.set_counter_to(1000);
+	ASSERT_TRUE(wf.read(&r));
+	EXPECT_EQ(r.minute, 40);
+	EXPECT_NEAR(r.gh, 0, 1e-4);
+	EXPECT_NEAR(r.tdry, 20.0 + (1000 % 17) * 0.25, 1e-4);
+	EXPECT_NEAR(r.pres, 800 + 1000 % 200, 1e-4);
+}
+
 /**
 * \class weatherdataTest
 *
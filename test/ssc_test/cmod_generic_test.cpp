@@ -2,13 +2,14 @@
 
 #include "cmod_generic_test.h"
 
+
 /// Test Generic System with Battery for SingleOwner PPA
 TEST_F(CMGeneric, SingleOwnerWithBattery_cmod_generic) {
 
 	generic_singleowner_battery_60min(data);
 
 	// Test different dispatch strategies
-	std::vector<size_t> dispatch_options{ 0,1,3,4 };
+	std::vector<size_t> dispatch_options{ 0,1,3,4,5 };
 
 	// Run with hourly data
 	for (size_t i = 0; i < dispatch_options.size(); i++) {
@@ -42,7 +43,7 @@ TEST_F(CMGeneric, CommercialWithBattery_cmod_generic) {
 	generic_commerical_battery_60min(data);
 	
 	// Test different dispatch strategies
-	std::vector<size_t> dispatch_options{ 0,3,4 };
+	std::vector<size_t> dispatch_options{ 0,3,4,5 };
 
 	// Run with hourly data, with and without lifetime
 	for (size_t l = 0; l < 2; l++) {
@@ -88,6 +89,377 @@ TEST_F(CMGeneric, CommercialWithBattery_cmod_generic) {
 	}
 }
 
+/// Monthly bills from utilityrate5 on a tariff with energy tiers, TOU and flat demand charges
+TEST_F(CMGeneric, UtilityRateTieredDemandBills_cmod_generic) {
+
+	generic_commerical_battery_60min(data);
+	ssc_data_set_number(data, "system_use_lifetime_output", 0);
+	EXPECT_FALSE(run_module(data, "generic_system"));
+
+	// demand period 2 on weekday afternoons, tiered demand charges in both periods and in the flat charge
+	std::vector<ssc_number_t> dc_weekday(288), dc_weekend(288, 1);
+	for (int m = 0; m < 12; m++)
+		for (int h = 0; h < 24; h++)
+			dc_weekday[m * 24 + h] = (h >= 12 && h < 19) ? 2 : 1;
+	ssc_data_set_matrix(data, "ur_dc_sched_weekday", &dc_weekday[0], 12, 24);
+	ssc_data_set_matrix(data, "ur_dc_sched_weekend", &dc_weekend[0], 12, 24);
+	ssc_number_t dc_tou[16] = { 1, 1, 100, 2.5,  1, 2, 1e38, 4.0,  2, 1, 50, 8.0,  2, 2, 1e38, 12.0 };
+	ssc_data_set_matrix(data, "ur_dc_tou_mat", dc_tou, 4, 4);
+	std::vector<ssc_number_t> dc_flat;
+	for (int m = 0; m < 12; m++) {
+		ssc_number_t row1[4] = { (ssc_number_t)m, 1, 75, 3.0 }, row2[4] = { (ssc_number_t)m, 2, 1e38, (m >= 5 && m <= 8) ? (ssc_number_t)6.0 : (ssc_number_t)4.5 };
+		dc_flat.insert(dc_flat.end(), row1, row1 + 4);
+		dc_flat.insert(dc_flat.end(), row2, row2 + 4);
+	}
+	ssc_data_set_matrix(data, "ur_dc_flat_mat", &dc_flat[0], 24, 4);
+	ssc_data_set_number(data, "ur_monthly_min_charge", 20);
+
+	// bills from before the tariff schedules were compiled in setup, for a monthly rollover (ur_calc) and
+	// a net billing (ur_calc_timestep) metering option; December of the first includes the year-end credit sale
+	const int metering[2] = { 0, 2 };
+	const ssc_number_t w_sys[2][12] = {
+		{ 2491.022, 2751.784, 2754.569, 3878.390, 3965.480, 4905.022, 5001.696, 20.000, 4835.912, 3535.402, 2686.527, -12300677.4 },
+		{ 2707.685, 3677.132, 2963.504, 5977.848, 5900.941, 7403.310, 10276.832, 20.000, 7889.797, 4899.423, 3098.107, 3481.568 } };
+	const ssc_number_t wo_sys[2][12] = {
+		{ 8284.569, 8285.462, 8937.609, 9714.831, 16311.907, 19565.598, 19848.955, 20046.384, 17256.456, 15294.246, 8160.980, 8502.895 },
+		{ 8284.569, 8285.462, 8937.609, 9714.831, 16318.062, 19569.751, 19852.653, 20054.772, 17259.380, 15297.779, 8160.980, 8502.895 } };
+	for (int k = 0; k < 2; k++) {
+		ssc_data_set_number(data, "ur_metering_option", (ssc_number_t)metering[k]);
+		EXPECT_FALSE(run_module(data, "utilityrate5"));
+
+		SetCalculatedArray("year1_monthly_utility_bill_w_sys");
+		for (int m = 0; m < 12; m++)
+			EXPECT_NEAR(calculated_array[m], w_sys[k][m], 0.01 + 1e-6 * fabs(w_sys[k][m])) << "metering " << metering[k] << " month " << m;
+		SetCalculatedArray("year1_monthly_utility_bill_wo_sys");
+		for (int m = 0; m < 12; m++)
+			EXPECT_NEAR(calculated_array[m], wo_sys[k][m], 0.01 + 1e-6 * fabs(wo_sys[k][m])) << "metering " << metering[k] << " month " << m;
+	}
+}
+
+/// Fleet bills from utilityrate5 match single profile runs of the same tariff
+TEST_F(CMGeneric, UtilityRateFleetMatchesSingleProfile_cmod_generic) {
+
+	generic_commerical_battery_60min(data);
+	ssc_data_set_number(data, "system_use_lifetime_output", 0);
+	EXPECT_FALSE(run_module(data, "generic_system"));
+
+	int n = 0;
+	ssc_number_t *p = ssc_data_get_array(data, "load", &n);
+	std::vector<ssc_number_t> load(p, p + n);
+	p = ssc_data_get_array(data, "gen", &n);
+	std::vector<ssc_number_t> gen(p, p + n);
+	ASSERT_EQ(load.size(), gen.size());
+
+	// profile k has the load scaled by load_mult[k] and the generation scaled by gen_mult[k];
+	// profiles are priced in blocks of 32, so the fleet fills one block and part of a second
+	const int nprof = 35;
+	std::vector<ssc_number_t> load_mult(nprof), gen_mult(nprof);
+	for (int k = 0; k < nprof; k++) {
+		load_mult[k] = 0.5 + 0.05 * k;
+		gen_mult[k] = 2.0 - 0.05 * k;
+	}
+	std::vector<ssc_number_t> fleet_load(n * nprof), fleet_gen(n * nprof);
+	for (int r = 0; r < n; r++) {
+		for (int k = 0; k < nprof; k++) {
+			fleet_load[r * nprof + k] = load[r] * load_mult[k];
+			fleet_gen[r * nprof + k] = gen[r] * gen_mult[k];
+		}
+	}
+	const int check[4] = { 0, 17, 31, 34 };
+
+	for (int tariff = 0; tariff < 2; tariff++) {
+		if (tariff == 1) {
+			// kWh/kW energy bands with separate sell rates, tiered TOU demand charges billed at the monthly peak,
+			// and minimum charges
+			std::vector<ssc_number_t> ec;
+			for (int per = 1; per <= 2; per++) {
+				ssc_number_t rows[30] = { (ssc_number_t)per, 1, 200, 1, 9, 9,
+					(ssc_number_t)per, 2, 20000, 0, 0.10 * per, 0.04,
+					(ssc_number_t)per, 3, 1e38, 0, 0.12 * per, 0.03,
+					(ssc_number_t)per, 4, 1e38, 1, 9, 9,
+					(ssc_number_t)per, 5, 1e38, 0, 0.20 * per, 0.05 };
+				ec.insert(ec.end(), rows, rows + 30);
+			}
+			ssc_data_set_matrix(data, "ur_ec_tou_mat", &ec[0], 10, 6);
+			ssc_data_set_number(data, "ur_sell_eq_buy", 0);
+			std::vector<ssc_number_t> dc_weekday(288), dc_weekend(288, 1);
+			for (int m = 0; m < 12; m++)
+				for (int h = 0; h < 24; h++)
+					dc_weekday[m * 24 + h] = (h >= 12 && h < 19) ? 2 : 1;
+			ssc_data_set_matrix(data, "ur_dc_sched_weekday", &dc_weekday[0], 12, 24);
+			ssc_data_set_matrix(data, "ur_dc_sched_weekend", &dc_weekend[0], 12, 24);
+			ssc_number_t dc_tou[16] = { 1, 1, 100, 2.5,  1, 2, 1e38, 4.0,  2, 1, 50, 8.0,  2, 2, 1e38, 12.0 };
+			ssc_data_set_matrix(data, "ur_dc_tou_mat", dc_tou, 4, 4);
+			ssc_data_set_number(data, "TOU_demand_single_peak", 1);
+			ssc_data_set_number(data, "ur_monthly_min_charge", 20);
+			ssc_data_set_number(data, "ur_annual_min_charge", 5000);
+		}
+
+		for (int metering = 0; metering <= 4; metering++) {
+			ssc_data_set_number(data, "ur_metering_option", (ssc_number_t)metering);
+			ssc_data_set_matrix(data, "ur_fleet_load", &fleet_load[0], n, nprof);
+			ssc_data_set_matrix(data, "ur_fleet_gen", &fleet_gen[0], n, nprof);
+			ssc_data_unassign(data, "year1_monthly_utility_bill_w_sys");
+			EXPECT_FALSE(run_module(data, "utilityrate5"));
+
+			// fleet runs do not compute the single profile results
+			EXPECT_EQ(ssc_data_query(data, "year1_monthly_utility_bill_w_sys"), SSC_INVALID);
+
+			int nrows = 0, ncols = 0;
+			ssc_number_t *w_sys = ssc_data_get_matrix(data, "ur_fleet_bill_w_sys", &nrows, &ncols);
+			ssc_number_t *wo_sys = ssc_data_get_matrix(data, "ur_fleet_bill_wo_sys", &nrows, &ncols);
+			ASSERT_EQ(nrows, nprof);
+			ASSERT_EQ(ncols, 12);
+			std::vector<ssc_number_t> fleet_w_sys(w_sys, w_sys + nprof * 12), fleet_wo_sys(wo_sys, wo_sys + nprof * 12);
+			SetCalculatedArray("ur_fleet_savings_year1");
+			std::vector<ssc_number_t> fleet_savings(calculated_array, calculated_array + nprof);
+
+			ssc_data_unassign(data, "ur_fleet_load");
+			ssc_data_unassign(data, "ur_fleet_gen");
+			for (int i = 0; i < 4; i++) {
+				int k = check[i];
+				std::vector<ssc_number_t> load_k(n), gen_k(n);
+				for (int r = 0; r < n; r++) {
+					load_k[r] = load[r] * load_mult[k];
+					gen_k[r] = gen[r] * gen_mult[k];
+				}
+				ssc_data_set_array(data, "load", &load_k[0], n);
+				ssc_data_set_array(data, "gen", &gen_k[0], n);
+				EXPECT_FALSE(run_module(data, "utilityrate5"));
+
+				// fleet savings are the monthly bill savings, savings_year1 comes from the hourly revenue, which books the metering 3 dollar credits differently
+				ssc_number_t savings = 0;
+				SetCalculatedArray("year1_monthly_utility_bill_w_sys");
+				for (int m = 0; m < 12; m++) {
+					EXPECT_NEAR(fleet_w_sys[k * 12 + m], calculated_array[m], 1e-6 * fabs(calculated_array[m]) + 1e-4) << "tariff " << tariff << " metering " << metering << " profile " << k << " month " << m;
+					savings -= calculated_array[m];
+				}
+				SetCalculatedArray("year1_monthly_utility_bill_wo_sys");
+				for (int m = 0; m < 12; m++) {
+					EXPECT_NEAR(fleet_wo_sys[k * 12 + m], calculated_array[m], 1e-6 * fabs(calculated_array[m]) + 1e-4) << "tariff " << tariff << " metering " << metering << " profile " << k << " month " << m;
+					savings += calculated_array[m];
+				}
+				EXPECT_NEAR(fleet_savings[k], savings, 1e-6 * fabs(savings) + 1e-3) << "tariff " << tariff << " metering " << metering << " profile " << k;
+			}
+			ssc_data_set_array(data, "load", &load[0], n);
+			ssc_data_set_array(data, "gen", &gen[0], n);
+		}
+	}
+}
+
+/// kWh/kW energy tiers bill the tiers of the band selected by the monthly energy per peak kW, in every TOU period
+TEST_F(CMGeneric, UtilityRateKwhPerKwTiers_cmod_generic) {
+
+	generic_commerical_battery_60min(data);
+	ssc_data_set_number(data, "system_use_lifetime_output", 0);
+	EXPECT_FALSE(run_module(data, "generic_system"));
+
+	// energy period 2 on weekday afternoons
+	std::vector<ssc_number_t> ec_weekday(288), ec_weekend(288, 1);
+	for (int m = 0; m < 12; m++)
+		for (int h = 0; h < 24; h++)
+			ec_weekday[m * 24 + h] = (h >= 12 && h < 19) ? 2 : 1;
+	ssc_data_set_matrix(data, "ur_ec_sched_weekday", &ec_weekday[0], 12, 24);
+	ssc_data_set_matrix(data, "ur_ec_sched_weekend", &ec_weekend[0], 12, 24);
+	ssc_data_set_number(data, "ur_sell_eq_buy", 0);
+
+	// two kWh/kW bands: tiers 2-3 below band_ub kWh/kW, tier 5 above it; tiers 1 and 4 are the band limits
+	const ssc_number_t buy[2][3] = { { 0.10, 0.12, 0.20 }, { 0.15, 0.18, 0.30 } };
+	const ssc_number_t band_ub[2] = { 1e38, -1e38 };
+	for (int metering = 0; metering <= 2; metering += 2) {
+		ssc_data_set_number(data, "ur_metering_option", (ssc_number_t)metering);
+		for (int b = 0; b < 2; b++) {
+			std::vector<ssc_number_t> ec;
+			for (int p = 0; p < 2; p++) {
+				ssc_number_t rows[30] = { (ssc_number_t)(p + 1), 1, band_ub[b], 1, 9, 9,
+					(ssc_number_t)(p + 1), 2, 20000, 0, buy[p][0], buy[p][0] / 2,
+					(ssc_number_t)(p + 1), 3, 1e38, 0, buy[p][1], buy[p][1] / 2,
+					(ssc_number_t)(p + 1), 4, 1e38, 1, 9, 9,
+					(ssc_number_t)(p + 1), 5, 1e38, 0, buy[p][2], buy[p][2] / 2 };
+				ec.insert(ec.end(), rows, rows + 30);
+			}
+			ssc_data_set_matrix(data, "ur_ec_tou_mat", &ec[0], 10, 6);
+			EXPECT_FALSE(run_module(data, "utilityrate5"));
+			SetCalculatedArray("year1_monthly_utility_bill_w_sys");
+			std::vector<ssc_number_t> band_w_sys(calculated_array, calculated_array + 12);
+			SetCalculatedArray("year1_monthly_utility_bill_wo_sys");
+			std::vector<ssc_number_t> band_wo_sys(calculated_array, calculated_array + 12);
+
+			// the same tariff with the band's tiers only
+			ec.clear();
+			for (int p = 0; p < 2; p++) {
+				if (b == 0) {
+					ssc_number_t rows[12] = { (ssc_number_t)(p + 1), 1, 20000, 0, buy[p][0], buy[p][0] / 2,
+						(ssc_number_t)(p + 1), 2, 1e38, 0, buy[p][1], buy[p][1] / 2 };
+					ec.insert(ec.end(), rows, rows + 12);
+				}
+				else {
+					ssc_number_t rows[6] = { (ssc_number_t)(p + 1), 1, 1e38, 0, buy[p][2], buy[p][2] / 2 };
+					ec.insert(ec.end(), rows, rows + 6);
+				}
+			}
+			ssc_data_set_matrix(data, "ur_ec_tou_mat", &ec[0], ec.size() / 6, 6);
+			EXPECT_FALSE(run_module(data, "utilityrate5"));
+			SetCalculatedArray("year1_monthly_utility_bill_w_sys");
+			for (int m = 0; m < 12; m++)
+				EXPECT_NEAR(band_w_sys[m], calculated_array[m], 1e-6 * fabs(calculated_array[m]) + 1e-4) << "metering " << metering << " band " << b << " month " << m;
+			SetCalculatedArray("year1_monthly_utility_bill_wo_sys");
+			for (int m = 0; m < 12; m++)
+				EXPECT_NEAR(band_wo_sys[m], calculated_array[m], 1e-6 * fabs(calculated_array[m]) + 1e-4) << "metering " << metering << " band " << b << " month " << m;
+		}
+	}
+}
+
+TEST_F(CMGeneric, FinancialSweepMatchesSingleRuns_cmod_generic) {
+
+	generic_singleowner_battery_60min(data);
+	EXPECT_FALSE(run_module(data, "generic_system"));
+	EXPECT_FALSE(run_module(data, "battery"));
+
+	// singleowner adds the battery's grid charging to gen in place, so each single run starts from a copy
+	int n = 0;
+	ssc_number_t *p = ssc_data_get_array(data, "gen", &n);
+	std::vector<ssc_number_t> gen(p, p + n);
+
+	const int nsamples = 4, nparams = 3;
+	ssc_number_t samples[nsamples * nparams] = {
+		5.5, 60, 0,
+		6.4, 40, 1.5,
+		4.0, 75, 3,
+		8.0, 0, 2.5 };
+	ssc_data_set_string(data, "sweep_module", "singleowner");
+	ssc_data_set_string(data, "sweep_parameters", "real_discount_rate, debt_percent, om_fixed_escal");
+	ssc_data_set_matrix(data, "sweep_samples", samples, nsamples, nparams);
+	ssc_data_set_string(data, "sweep_outputs", "npv_ppa_revenue,size_of_debt");
+	ssc_data_set_number(data, "sweep_nthreads", 2);
+	EXPECT_FALSE(run_module(data, "financial_sweep"));
+
+	const char *outputs[] = { "sweep_success", "sweep_ppa", "sweep_lcoe_nom", "sweep_lcoe_real", "sweep_npv", "sweep_irr" };
+	std::vector<std::vector<ssc_number_t>> sweep;
+	for (size_t k = 0; k < 6; k++) {
+		SetCalculatedArray(outputs[k]);
+		sweep.push_back(std::vector<ssc_number_t>(calculated_array, calculated_array + nsamples));
+	}
+	int nrows = 0, ncols = 0;
+	p = ssc_data_get_matrix(data, "sweep_results", &nrows, &ncols);
+	ASSERT_EQ(nrows, nsamples);
+	ASSERT_EQ(ncols, 2);
+	std::vector<ssc_number_t> results(p, p + nsamples * 2);
+
+	const char *single[] = { "ppa", "lcoe_nom", "lcoe_real", "project_return_aftertax_npv", "project_return_aftertax_irr", "npv_ppa_revenue", "size_of_debt" };
+	for (int s = 0; s < nsamples; s++) {
+		ssc_data_set_array(data, "gen", &gen[0], n);
+		ssc_data_set_number(data, "real_discount_rate", samples[s * nparams]);
+		ssc_data_set_number(data, "debt_percent", samples[s * nparams + 1]);
+		ssc_data_set_number(data, "om_fixed_escal", samples[s * nparams + 2]);
+		EXPECT_FALSE(run_module(data, "singleowner"));
+
+		EXPECT_EQ(sweep[0][s], 1) << "sample " << s;
+		for (size_t k = 0; k < 7; k++) {
+			SetCalculated(single[k]);
+			ssc_number_t swept = (k < 5) ? sweep[k + 1][s] : results[s * 2 + k - 5];
+			EXPECT_NEAR(swept, calculated_value, 1e-9 * fabs(calculated_value) + 1e-9) << single[k] << " sample " << s;
+		}
+	}
+
+	// every swept input has to be a number input of the financial model
+	ssc_data_set_array(data, "gen", &gen[0], n);
+	ssc_data_set_string(data, "sweep_parameters", "real_discount_rate, debt_percent, not_an_input");
+	EXPECT_TRUE(run_module(data, "financial_sweep"));
+}
+
+/// Generic system output for the single owner case without a battery, with the host inputs host_developer needs
+static void generic_ppa_solution_setup(ssc_data_t data)
+{
+	generic_singleowner_battery_60min(data);
+	ssc_data_set_number(data, "en_batt", 0);
+	ssc_module_t module = ssc_module_create("generic_system");
+	ssc_module_exec(module, data);
+	ssc_module_free(module);
+
+	std::vector<ssc_number_t> zeros(26, 0);
+	ssc_data_set_array(data, "annual_energy_value", &zeros[0], 26);
+	ssc_data_set_array(data, "elec_cost_with_system", &zeros[0], 26);
+	ssc_data_set_array(data, "elec_cost_without_system", &zeros[0], 26);
+	ssc_data_set_number(data, "host_real_discount_rate", 6.4);
+}
+
+/// Solved PPA prices match the ones found with fixed 10 cent/kWh bracketing steps, within each model's default ppa_soln_tolerance
+TEST_F(CMGeneric, SingleOwnerPpaSolution_cmod_generic) {
+	generic_ppa_solution_setup(data);
+	EXPECT_FALSE(run_module(data, "singleowner"));
+	SetCalculated("ppa_price");
+	EXPECT_NEAR(calculated_value, 66.1155777, 1e-5 * 66.1155777);
+}
+
+TEST_F(CMGeneric, HostDeveloperPpaSolution_cmod_generic) {
+	generic_ppa_solution_setup(data);
+	EXPECT_FALSE(run_module(data, "host_developer"));
+	SetCalculated("ppa_price");
+	EXPECT_NEAR(calculated_value, 66.1155777, 1e-5 * 66.1155777);
+}
+
+TEST_F(CMGeneric, LevPartFlipPpaSolution_cmod_generic) {
+	generic_ppa_solution_setup(data);
+	EXPECT_FALSE(run_module(data, "levpartflip"));
+	SetCalculated("ppa_price");
+	EXPECT_NEAR(calculated_value, 67.8028998, 1e-3 * 67.8028998);
+}
+
+TEST_F(CMGeneric, EquPartFlipPpaSolution_cmod_generic) {
+	generic_ppa_solution_setup(data);
+	EXPECT_FALSE(run_module(data, "equpartflip"));
+	SetCalculated("ppa_price");
+	EXPECT_NEAR(calculated_value, 69.074058, 1e-3 * 69.074058);
+}
+
+TEST_F(CMGeneric, SaleLeasebackPpaSolution_cmod_generic) {
+	generic_ppa_solution_setup(data);
+	EXPECT_FALSE(run_module(data, "saleleaseback"));
+	SetCalculated("ppa_price");
+	EXPECT_NEAR(calculated_value, 68.9179669, 1e-3 * 68.9179669);
+}
+
+/// Cash flow outputs of singleowner, summed over every cf_ array, match the ones from before the cash flow table.
+/// Year 0 IRRs are NaN.
+TEST_F(CMGeneric, SingleOwnerCashFlowOutputs_cmod_generic) {
+	generic_ppa_solution_setup(data);
+	ssc_number_t dscr[26];
+	for (int i = 0; i < 26; i++) dscr[i] = -1;
+	ssc_data_set_array_ref(data, "cf_debt_payment_total", dscr, 26);
+	EXPECT_FALSE(run_module(data, "singleowner"));
+
+	int n_arrays = 0, n_values = 0, n_nan = 0;
+	double sum = 0, sum_by_year = 0;
+	const char *name = ssc_data_first(data);
+	while (name) {
+		int n = 0;
+		if (std::string(name).compare(0, 3, "cf_") == 0 && ssc_data_query(data, name) == SSC_ARRAY) {
+			ssc_number_t *p = ssc_data_get_array(data, name, &n);
+			n_arrays++;
+			n_values += n;
+			for (int i = 0; i < n; i++) {
+				if (std::isnan(p[i])) n_nan++;
+				else {
+					sum += fabs(p[i]);
+					sum_by_year += fabs(p[i]) * (i + 1);
+				}
+			}
+		}
+		name = ssc_data_next(data);
+	}
+	EXPECT_EQ(n_arrays, 187);
+	EXPECT_EQ(n_values, 4610);
+	EXPECT_EQ(n_nan, 3);
+	EXPECT_NEAR(sum, 237058032430.689, 1e-9 * 237058032430.689);
+	EXPECT_NEAR(sum_by_year, 3194364053158.27, 1e-9 * 3194364053158.27);
+
+	// an output bound to caller storage is written there
+	int n = 0;
+	ASSERT_EQ(ssc_data_get_array(data, "cf_debt_payment_total", &n), dscr);
+	EXPECT_NE(dscr[1], -1);
+}
+
 /*
 Doesn't work to to outdated exeception handling methods in SSC which can not be 
 handled robustly in a cross-platform environment
@@ -68,6 +68,105 @@ TEST_F(CMPvsamv1PowerIntegration, DefaultLifetimeNoFinancialModel_cmod_pvsamv1)
 }
 
 
+/// Lifetime runs reuse the first year's irradiance results; without degradation every year must match a single-year run
+TEST_F(CMPvsamv1PowerIntegration, LifetimeIrradianceCacheMatchesSingleYear_cmod_pvsamv1) {
+
+	std::map<std::string, double> pairs;
+	pairs["subarray1_modules_per_string"] = 6;
+	pairs["subarray2_modules_per_string"] = 6;
+	pairs["subarray1_nstrings"] = 14;
+	pairs["subarray2_enable"] = 1;
+	pairs["subarray2_nstrings"] = 15;
+	pairs["subarray2_track_mode"] = 1;
+	pairs["inverter_count"] = 22;
+
+	int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	ASSERT_FALSE(pvsam_errors);
+	int n_single = 0;
+	ssc_number_t *p_gen = ssc_data_get_array(data, "gen", &n_single);
+	ASSERT_EQ(n_single, 8760);
+	std::vector<ssc_number_t> gen_single(p_gen, p_gen + n_single);
+	ssc_number_t *p_dc = ssc_data_get_array(data, "dc_net", &n_single);
+	std::vector<ssc_number_t> dc_single(p_dc, p_dc + n_single);
+
+	size_t nyears = 3;
+	pairs["system_use_lifetime_output"] = 1;
+	pairs["analysis_period"] = (double)nyears;
+	std::vector<ssc_number_t> no_degradation(nyears, 0.0);
+	ssc_data_set_array(data, "dc_degradation", &no_degradation[0], (int)nyears);
+
+	pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	ASSERT_FALSE(pvsam_errors);
+	int n_lifetime = 0;
+	p_gen = ssc_data_get_array(data, "gen", &n_lifetime);
+	ASSERT_EQ(n_lifetime, 8760 * (int)nyears);
+	p_dc = ssc_data_get_array(data, "dc_net", &n_lifetime);
+
+	for (size_t iyear = 0; iyear < nyears; iyear++)
+	{
+		for (size_t i = 0; i < 8760; i++)
+		{
+			ASSERT_EQ(p_gen[iyear * 8760 + i], gen_single[i]) << "year " << iyear << " hour " << i;
+			ASSERT_EQ(p_dc[iyear * 8760 + i], dc_single[i]) << "year " << iyear << " hour " << i;
+		}
+	}
+}
+
+
+static void batch_case_done(int index, ssc_bool_t result, ssc_module_t, void *user_data)
+{
+	std::vector<int> *n_done = static_cast<std::vector<int>*>(user_data);
+	(*n_done)[index] += result ? 1 : 100;
+}
+
+/// Cases run together by ssc_module_exec_batch on several threads give the same results as running each one alone
+TEST_F(CMPvsamv1PowerIntegration, ModuleExecBatchMatchesSingleRuns_cmod_pvsamv1) {
+
+	ssc_entry_t p_entry;
+	int k = 0;
+	while ((p_entry = ssc_module_entry(k++)) && std::string(ssc_entry_name(p_entry)) != "pvsamv1") {}
+	ASSERT_TRUE(p_entry != NULL);
+	EXPECT_EQ(ssc_entry_thread_safe(p_entry), 1);
+
+	const int n_cases = 6;
+	std::vector<ssc_data_t> cases(n_cases);
+	for (int i = 0; i < n_cases; i++)
+	{
+		cases[i] = ssc_data_create();
+		pvsamv_nofinancial_default(cases[i]);
+		ssc_data_set_number(cases[i], "subarray1_tilt", (ssc_number_t)(5 * i + 10));
+	}
+
+	std::vector<int> n_done(n_cases, 0);
+	EXPECT_EQ(ssc_module_exec_batch("pvsamv1", &cases[0], n_cases, 3, batch_case_done, &n_done), n_cases);
+
+	for (int i = 0; i < n_cases; i++)
+	{
+		EXPECT_EQ(n_done[i], 1) << "case " << i;
+
+		ssc_data_t single = ssc_data_create();
+		pvsamv_nofinancial_default(single);
+		ssc_data_set_number(single, "subarray1_tilt", (ssc_number_t)(5 * i + 10));
+		ASSERT_TRUE(ssc_module_exec_simple("pvsamv1", single));
+
+		ssc_number_t energy_batch = 0, energy_single = 0;
+		ssc_data_get_number(cases[i], "annual_energy", &energy_batch);
+		ssc_data_get_number(single, "annual_energy", &energy_single);
+		EXPECT_EQ(energy_batch, energy_single) << "case " << i;
+
+		int n_batch = 0, n_single = 0;
+		ssc_number_t *gen_batch = ssc_data_get_array(cases[i], "gen", &n_batch);
+		ssc_number_t *gen_single = ssc_data_get_array(single, "gen", &n_single);
+		ASSERT_EQ(n_batch, n_single);
+		for (int j = 0; j < n_single; j++)
+			ASSERT_EQ(gen_batch[j], gen_single[j]) << "case " << i << " step " << j;
+
+		ssc_data_free(single);
+		ssc_data_free(cases[i]);
+	}
+}
+
+
 /// Test PVSAMv1 with all defaults and residential financial model
 TEST_F(CMPvsamv1PowerIntegration, DefaultResidentialModel_cmod_pvsamv1)
 {
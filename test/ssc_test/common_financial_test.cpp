@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include "../ssc/core.h"
+#include "../ssc/common_financial.h"
+#include "../ssc/sscapi.h"
+
+static var_info _cm_vtab_cashflow_test[] = {
+/*   VARTYPE           DATATYPE         NAME                 LABEL                  UNITS     META     GROUP      REQUIRED_IF    CONSTRAINTS   UI_HINTS*/
+	{ SSC_OUTPUT,      SSC_ARRAY,       "first",             "Line 0",              "",       "",      "Test",    "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "short",             "Line 0 years 0-1",    "",       "",      "Test",    "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "second",            "Line 0 again",        "",       "",      "Test",    "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "untouched",         "Line 1",              "",       "",      "Test",    "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "late",              "Line 2",              "",       "",      "Test",    "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "bound",             "Line 2 again",        "",       "",      "Test",    "*",           "",           "" },
+var_info_invalid };
+
+/**
+* Fills a cash flow table in exec and exports it, so that the test can check the var_table afterwards
+*/
+class cm_cashflow_test : public compute_module
+{
+public:
+	cashflow_table cf;
+	double *line0;
+	size_t rows_after_export;
+
+	cm_cashflow_test()
+	{
+		add_var_info( _cm_vtab_cashflow_test );
+		line0 = 0;
+		rows_after_export = 0;
+	}
+
+	void exec( )
+	{
+		cf.resize_fill( 3, 4, 0.5 );
+		for (size_t i = 0; i < 4; i++)
+			cf.at( 0, i ) = (double)(i + 1);
+		line0 = &cf.at( 0, 0 );
+
+		// line 0 is saved twice and once shorter, line 1 is never written, line 2 is written after it is saved
+		cf.save( 0, 3, "first" );
+		cf.save( 0, 1, "short" );
+		cf.save( 0, 3, "second" );
+		cf.save( 1, 3, "untouched" );
+		cf.save( 2, 3, "late" );
+		cf.save( 2, 3, "bound" );
+		for (size_t i = 0; i < 4; i++)
+			cf.at( 2, i ) = 10.0 * (i + 1);
+
+		cf.export_outputs( this );
+		rows_after_export = cf.nrows();
+	}
+};
+
+class cashflow_test_handler : public handler_interface
+{
+public:
+	cashflow_test_handler( compute_module *cm ) : handler_interface(cm) { }
+	virtual void on_log( const std::string &, int, float ) { }
+	virtual bool on_update( const std::string &, float, float ) { return true; }
+};
+
+TEST(cashflowTableTests, testExportOutputs_common_financial)
+{
+	ssc_number_t bound[4] = { -1, -1, -1, -1 };
+	ssc_data_t data = ssc_data_create();
+	ssc_data_set_array_ref( data, "bound", bound, 4 );
+
+	cm_cashflow_test cm;
+	cashflow_test_handler handler( &cm );
+	ASSERT_TRUE( cm.compute( &handler, static_cast<var_table*>(data) ) );
+	ASSERT_EQ( cm.rows_after_export, (size_t)0 );
+
+	// the last output saved from a line takes over its array, earlier ones get a copy
+	int n = 0;
+	ssc_number_t *first = ssc_data_get_array( data, "first", &n );
+	ASSERT_EQ( n, 4 );
+	ssc_number_t *second = ssc_data_get_array( data, "second", &n );
+	ASSERT_EQ( n, 4 );
+	ASSERT_EQ( second, cm.line0 );
+	ASSERT_NE( first, cm.line0 );
+	for (int i = 0; i < 4; i++)
+	{
+		ASSERT_EQ( first[i], i + 1 );
+		ASSERT_EQ( second[i], i + 1 );
+	}
+	ssc_number_t *shorter = ssc_data_get_array( data, "short", &n );
+	ASSERT_EQ( n, 2 );
+	ASSERT_EQ( shorter[1], 2 );
+
+	// a line that is never written exports the fill value
+	ssc_number_t *untouched = ssc_data_get_array( data, "untouched", &n );
+	ASSERT_EQ( n, 4 );
+	ASSERT_EQ( untouched[3], 0.5 );
+
+	// outputs hold the line values at export time, not at save time
+	ssc_number_t *late = ssc_data_get_array( data, "late", &n );
+	ASSERT_EQ( late[0], 10 );
+	ASSERT_EQ( late[3], 40 );
+
+	// an output bound to the caller's storage is written there
+	ASSERT_EQ( ssc_data_get_array( data, "bound", &n ), bound );
+	ASSERT_EQ( bound[0], 10 );
+	ASSERT_EQ( bound[3], 40 );
+
+	// adopted arrays are released with the data container
+	ssc_data_free( data );
+}
+
+TEST(cashflowTableTests, testResizeFill_common_financial)
+{
+	cashflow_table cf;
+	cf.resize_fill( 2, 3, 1.0 );
+	cf.at( 0, 2 ) = 5;
+	cf.save( 0, 2, "a" );
+
+	// resizing drops the lines and the recorded outputs
+	cf.resize_fill( 4, 2, 0.0 );
+	ASSERT_EQ( cf.nrows(), (size_t)4 );
+	ASSERT_EQ( cf.ncols(), (size_t)2 );
+	ASSERT_EQ( cf.at( 0, 1 ), 0 );
+	ASSERT_EQ( cf.at( 3, 0 ), 0 );
+}
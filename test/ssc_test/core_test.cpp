@@ -0,0 +1,299 @@
+#include <gtest/gtest.h>
+
+#include "../ssc/core.h"
+#include "../ssc/vartab.h"
+#include "../ssc/sscapi.h"
+
+static var_info _cm_vtab_core_test[] = {
+/*   VARTYPE           DATATYPE         NAME                 LABEL                  UNITS     META     GROUP      REQUIRED_IF    CONSTRAINTS   UI_HINTS*/
+	{ SSC_INPUT,       SSC_ARRAY,       "input_array",       "Input array",         "",       "",      "Test",    "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_ARRAY,       "doubled",           "Input array x 2",     "",       "",      "Test",    "*",           "",           "" },
+	{ SSC_OUTPUT,      SSC_MATRIX,      "outer",             "Outer product",       "",       "",      "Test",    "*",           "",           "" },
+var_info_invalid };
+
+/**
+* Minimal compute module that reads one array and writes an array and a matrix sized from it
+*/
+class cm_core_test : public compute_module
+{
+public:
+	ssc_number_t *p_input_seen;
+
+	cm_core_test()
+	{
+		add_var_info( _cm_vtab_core_test );
+		p_input_seen = 0;
+	}
+
+	void exec( )
+	{
+		size_t n = 0;
+		p_input_seen = as_array( "input_array", &n );
+
+		ssc_number_t *doubled = allocate( "doubled", n );
+		for (size_t i = 0; i < n; i++)
+			doubled[i] = 2 * p_input_seen[i];
+
+		util::matrix_t<ssc_number_t> &outer = allocate_matrix( "outer", n, n );
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++)
+				outer(i, j) = p_input_seen[i] * p_input_seen[j];
+	}
+};
+
+class core_test_handler : public handler_interface
+{
+public:
+	core_test_handler( compute_module *cm ) : handler_interface(cm) { }
+	virtual void on_log( const std::string &, int, float ) { }
+	virtual bool on_update( const std::string &, float, float ) { return true; }
+};
+
+static bool run_core_test( compute_module &cm, ssc_data_t data )
+{
+	core_test_handler handler( &cm );
+	return cm.compute( &handler, static_cast<var_table*>(data) );
+}
+
+TEST(computeModuleTests, testArrayRefInput_core)
+{
+	ssc_number_t input[3] = { 1, 2, 3 };
+	ssc_data_t data = ssc_data_create();
+	ssc_data_set_array_ref( data, "input_array", input, 3 );
+
+	// the variable refers to the caller's memory rather than a copy of it
+	int n = 0;
+	ASSERT_EQ( ssc_data_get_array( data, "input_array", &n ), input );
+	ASSERT_EQ( n, 3 );
+
+	cm_core_test cm;
+	ASSERT_TRUE( run_core_test( cm, data ) );
+	ASSERT_EQ( cm.p_input_seen, input );
+
+	ssc_number_t *doubled = ssc_data_get_array( data, "doubled", &n );
+	ASSERT_EQ( n, 3 );
+	ASSERT_EQ( doubled[2], 6 );
+
+	// copying the container copies referenced values
+	ssc_data_t copy = ssc_data_create();
+	ssc_data_set_table( copy, "inputs", data );
+	ssc_data_t inner = ssc_data_get_table( copy, "inputs" );
+	ASSERT_NE( ssc_data_get_array( inner, "input_array", &n ), input );
+	input[0] = 10;
+	ASSERT_EQ( ssc_data_get_array( inner, "input_array", &n )[0], 1 );
+
+	ssc_data_free( copy );
+	ssc_data_free( data );
+}
+
+TEST(computeModuleTests, testAllocateIntoCallerBuffer_core)
+{
+	ssc_number_t input[2] = { 3, 4 };
+	ssc_number_t doubled[2] = { -1, -1 };
+	ssc_number_t outer[4] = { -1, -1, -1, -1 };
+	ssc_data_t data = ssc_data_create();
+	ssc_data_set_array( data, "input_array", input, 2 );
+	ssc_data_set_array_ref( data, "doubled", doubled, 2 );
+	ssc_data_set_matrix_ref( data, "outer", outer, 2, 2 );
+
+	cm_core_test cm;
+	ASSERT_TRUE( run_core_test( cm, data ) );
+
+	// outputs of the same type and shape are written straight into the caller's buffers
+	int n = 0, nr = 0, nc = 0;
+	ASSERT_EQ( ssc_data_get_array( data, "doubled", &n ), doubled );
+	ASSERT_EQ( doubled[0], 6 );
+	ASSERT_EQ( doubled[1], 8 );
+	ASSERT_EQ( ssc_data_get_matrix( data, "outer", &nr, &nc ), outer );
+	ASSERT_EQ( outer[1], 12 );
+	ASSERT_EQ( outer[3], 16 );
+
+	ssc_data_free( data );
+}
+
+TEST(computeModuleTests, testAllocateShapeMismatch_core)
+{
+	ssc_number_t input[3] = { 1, 2, 3 };
+	ssc_number_t doubled[2] = { -1, -1 };
+	ssc_number_t outer[3] = { -1, -1, -1 };
+	ssc_data_t data = ssc_data_create();
+	ssc_data_set_array( data, "input_array", input, 3 );
+	ssc_data_set_array_ref( data, "doubled", doubled, 2 );
+	ssc_data_set_array_ref( data, "outer", outer, 3 );
+
+	cm_core_test cm;
+	ASSERT_TRUE( run_core_test( cm, data ) );
+
+	// a buffer of the wrong length or type is replaced by internal storage and left untouched
+	int n = 0, nr = 0, nc = 0;
+	ssc_number_t *p = ssc_data_get_array( data, "doubled", &n );
+	ASSERT_NE( p, doubled );
+	ASSERT_EQ( n, 3 );
+	ASSERT_EQ( p[2], 6 );
+	ASSERT_EQ( doubled[0], -1 );
+	ASSERT_EQ( doubled[1], -1 );
+
+	ASSERT_EQ( ssc_data_query( data, "outer" ), SSC_MATRIX );
+	ASSERT_NE( ssc_data_get_matrix( data, "outer", &nr, &nc ), outer );
+	ASSERT_EQ( nr, 3 );
+	ASSERT_EQ( outer[0], -1 );
+
+	ssc_data_free( data );
+}
+
+TEST(computeModuleTests, testVarTableGeneration_core)
+{
+	var_table vt;
+	unsigned int gen = vt.generation();
+
+	// assigning never invalidates existing entries
+	vt.assign( "a", var_data( 1.0 ) );
+	vt.assign( "a", var_data( 2.0 ) );
+	vt.assign( "b", var_data( 3.0 ) );
+	ASSERT_EQ( vt.generation(), gen );
+
+	vt.unassign( "not_there" );
+	ASSERT_EQ( vt.generation(), gen );
+	vt.unassign( "a" );
+	ASSERT_NE( vt.generation(), gen );
+
+	gen = vt.generation();
+	vt.rename( "b", "c" );
+	ASSERT_NE( vt.generation(), gen );
+
+	gen = vt.generation();
+	vt.clear();
+	ASSERT_NE( vt.generation(), gen );
+}
+
+static var_info _cm_vtab_handle_test[] = {
+/*   VARTYPE           DATATYPE         NAME                 LABEL                  UNITS     META     GROUP      REQUIRED_IF    CONSTRAINTS   UI_HINTS*/
+	{ SSC_INPUT,       SSC_NUMBER,      "x",                 "Number input",        "",       "",      "Test",    "*",           "",           "" },
+	{ SSC_INPUT,       SSC_ARRAY,       "y",                 "Array input",         "",       "",      "Test",    "?",           "",           "" },
+var_info_invalid };
+
+/**
+* Checks handle lookups against name lookups while the test changes the data container from inside exec
+*/
+class cm_handle_test : public compute_module
+{
+public:
+	var_table *p_vt;
+	bool ok;
+
+	cm_handle_test()
+	{
+		add_var_info( _cm_vtab_handle_test );
+		p_vt = 0;
+		ok = false;
+	}
+
+	void exec( )
+	{
+		// names are interned without case, and table entries already have handles
+		var_handle hx = handle( "X" );
+		EXPECT_EQ( hx.index, handle( "x" ).index );
+		var_handle hz = handle( "z" );
+		EXPECT_NE( hz.index, hx.index );
+
+		EXPECT_EQ( lookup( hx ), lookup( "x" ) );
+		EXPECT_EQ( as_number( hx ), 4 );
+		EXPECT_EQ( as_integer( hx ), 4 );
+		EXPECT_TRUE( as_boolean( hx ) );
+		EXPECT_FALSE( is_assigned( hz ) );
+		EXPECT_THROW( value( hz ), general_error );
+
+		// an unresolved handle sees a variable assigned later
+		p_vt->assign( "z", var_data( 5.0 ) );
+		EXPECT_EQ( as_double( hz ), 5 );
+
+		// a resolved handle sees a changed value in place
+		p_vt->assign( "x", var_data( 6.0 ) );
+		EXPECT_EQ( as_number( hx ), 6 );
+
+		// removing or renaming entries invalidates the resolved pointers
+		p_vt->unassign( "x" );
+		EXPECT_FALSE( is_assigned( hx ) );
+		p_vt->rename( "z", "x" );
+		EXPECT_EQ( as_number( hx ), 5 );
+		EXPECT_FALSE( is_assigned( hz ) );
+
+		ssc_number_t y[2] = { 1, 2 };
+		p_vt->assign( "y", var_data( y, 2 ) );
+		size_t n = 0;
+		ssc_number_t *py = as_array( handle( "y" ), &n );
+		EXPECT_EQ( n, 2 );
+		EXPECT_EQ( py, lookup( "y" )->num.data() );
+		EXPECT_THROW( as_array( hx, &n ), cast_error );
+
+		ok = true;
+	}
+};
+
+TEST(computeModuleTests, testVarHandles_core)
+{
+	ssc_data_t data = ssc_data_create();
+	ssc_data_set_number( data, "x", 4 );
+
+	cm_handle_test cm;
+	cm.p_vt = static_cast<var_table*>(data);
+	ASSERT_TRUE( run_core_test( cm, data ) );
+	ASSERT_TRUE( cm.ok );
+
+	ssc_data_free( data );
+}
+
+static var_info _cm_vtab_dup_first[] = {
+/*   VARTYPE           DATATYPE         NAME                 LABEL                  UNITS     META     GROUP      REQUIRED_IF    CONSTRAINTS   UI_HINTS*/
+	{ SSC_INPUT,       SSC_NUMBER,      "analysis_period",   "Analysis period",     "years",  "",      "Test",    "?=30",        "INTEGER,MIN=0,MAX=50", "" },
+var_info_invalid };
+
+static var_info _cm_vtab_dup_second[] = {
+/*   VARTYPE           DATATYPE         NAME                 LABEL                  UNITS     META     GROUP      REQUIRED_IF    CONSTRAINTS   UI_HINTS*/
+	{ SSC_INPUT,       SSC_NUMBER,      "analysis_period",   "Analysis period",     "years",  "",      "Test",    "*",           "MAX=10",     "" },
+	{ SSC_INPUT,       SSC_NUMBER,      "other",             "Other input",         "",       "",      "Test",    "analysis_period>20", "",    "" },
+var_info_invalid };
+
+/**
+* Lists a name in two var_info tables, as pvsamv1 does with the battery table
+*/
+class cm_duplicate_info_test : public compute_module
+{
+public:
+	cm_duplicate_info_test()
+	{
+		add_var_info( _cm_vtab_dup_first );
+		add_var_info( _cm_vtab_dup_second );
+	}
+
+	void exec( ) { }
+};
+
+TEST(computeModuleTests, testVerifyDuplicateInfo_core)
+{
+	// every entry with a name is checked against the first one: the default of 30 is assigned,
+	// and neither the second entry's '*' nor its MAX=10 apply
+	ssc_data_t data = ssc_data_create();
+	ssc_data_set_number( data, "other", 1 );
+	cm_duplicate_info_test cm;
+	ASSERT_TRUE( run_core_test( cm, data ) );
+	ssc_number_t period = 0;
+	ASSERT_TRUE( ssc_data_get_number( data, "analysis_period", &period ) );
+	ASSERT_EQ( period, 30 );
+
+	// the first entry's constraints still apply
+	ssc_data_set_number( data, "analysis_period", 60 );
+	cm_duplicate_info_test cm_max;
+	ASSERT_FALSE( run_core_test( cm_max, data ) );
+
+	// required_if expressions of other entries are evaluated as before
+	ssc_data_set_number( data, "analysis_period", 25 );
+	ssc_data_unassign( data, "other" );
+	cm_duplicate_info_test cm_req;
+	ASSERT_FALSE( run_core_test( cm_req, data ) );
+	ssc_data_set_number( data, "analysis_period", 15 );
+	cm_duplicate_info_test cm_not_req;
+	ASSERT_TRUE( run_core_test( cm_not_req, data ) );
+
+	ssc_data_free( data );
+}
@@ -0,0 +1,76 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../tcs/CO2_properties.h"
+
+static void expect_same_state(const CO2_state &a, const CO2_state &b)
+{
+	EXPECT_EQ(a.temp, b.temp);
+	EXPECT_EQ(a.pres, b.pres);
+	EXPECT_EQ(a.dens, b.dens);
+	EXPECT_EQ(a.enth, b.enth);
+	EXPECT_EQ(a.entr, b.entr);
+	EXPECT_EQ(a.cp, b.cp);
+	EXPECT_EQ(a.ssnd, b.ssnd);
+}
+
+TEST(CO2PropertiesTest, CacheReturnsSameState_CO2_properties) {
+	reset_CO2_cache();
+
+	CO2_state first, second;
+	ASSERT_EQ(CO2_TP(550.0, 20000.0, &first), 0);
+	ASSERT_EQ(CO2_TP(550.0, 20000.0, &second), 0);
+	expect_same_state(first, second);
+
+	ASSERT_EQ(CO2_PH(20000.0, first.enth, &second), 0);
+	EXPECT_NEAR(second.temp, 550.0, 1.e-6);
+	ASSERT_EQ(CO2_PS(20000.0, first.entr, &second), 0);
+	EXPECT_NEAR(second.temp, 550.0, 1.e-6);
+
+	// errors are returned again from the cache
+	EXPECT_EQ(CO2_TP(550.0, 0.5, &second), 203);
+	EXPECT_EQ(CO2_TP(550.0, 0.5, &second), 203);
+
+	CO2_cache_info info;
+	get_CO2_cache_info(&info);
+	EXPECT_EQ(info.TP_calls, 4);
+	EXPECT_EQ(info.TP_hits, 2);
+	EXPECT_EQ(info.PH_calls, 1);
+	EXPECT_EQ(info.PH_hits, 0);
+	EXPECT_EQ(info.PS_calls, 1);
+	EXPECT_EQ(info.PS_hits, 0);
+
+	reset_CO2_cache();
+	get_CO2_cache_info(&info);
+	EXPECT_EQ(info.TP_calls, 0);
+}
+
+TEST(CO2PropertiesTest, BatchMatchesSingleStates_CO2_properties) {
+	// nodes through a recuperator, with a last node below the pressure limit
+	int n = 12;
+	std::vector<double> P(n), H(n);
+	for (int i = 0; i < n; i++)
+	{
+		P[i] = 8000.0 + 100.0 * i;
+		H[i] = 400.0 + 50.0 * i;
+	}
+	P[n - 1] = 0.5;
+
+	std::vector<CO2_state> states(n);
+	std::vector<int> codes(n);
+	EXPECT_EQ(CO2_PH_batch(n, P.data(), H.data(), states.data(), codes.data()), 1);
+
+	for (int i = 0; i < n; i++)
+	{
+		CO2_state single;
+		EXPECT_EQ(codes[i], CO2_PH(P[i], H[i], &single));
+		if (codes[i] == 0)
+			expect_same_state(states[i], single);
+	}
+	EXPECT_EQ(codes[n - 1], 303);
+
+	std::vector<double> T(n, 600.0);
+	EXPECT_EQ(CO2_TP_batch(n - 1, T.data(), P.data(), states.data(), codes.data()), 0);
+	EXPECT_NEAR(states[0].temp, 600.0, 1.e-9);
+}
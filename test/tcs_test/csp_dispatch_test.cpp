@@ -0,0 +1,134 @@
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../tcs/csp_dispatch.h"
+#include "../tcs/csp_solver_util.h"
+
+/**
+ * Dispatch inputs for one 24 hour window of a 100 MWe tower with 10 hours of storage. The expected performance
+ * is filled in directly, so the windows differ in forecast, prices, initial state, and net power limits without
+ * a weather file or collector model.
+ */
+static void set_dispatch_window(csp_dispatch_opt &dispatch, C_csp_messages &messages, int window)
+{
+	int nt = 24;
+	double q_pb_des = 250000.;		//[kWt]
+
+	dispatch.params.messages = &messages;
+	dispatch.params.dt = 1.;
+	dispatch.params.dt_pb_startup_cold = 0.5;
+	dispatch.params.dt_pb_startup_hot = 0.25;
+	dispatch.params.q_pb_standby = 0.2 * q_pb_des;
+	dispatch.params.e_pb_startup_cold = 0.5 * q_pb_des;
+	dispatch.params.e_pb_startup_hot = 0.25 * q_pb_des;
+	dispatch.params.dt_rec_startup = 0.2;
+	dispatch.params.e_rec_startup = 0.25 * 0.2 * q_pb_des;
+	dispatch.params.q_rec_min = 0.25 * 2.4 * q_pb_des;
+	dispatch.params.w_rec_pump = 0.0125;
+	dispatch.params.e_tes_min = 0.;
+	dispatch.params.e_tes_max = 10. * q_pb_des;
+	dispatch.params.tes_degrade_rate = 0.;
+	dispatch.params.q_pb_max = 1.05 * q_pb_des;
+	dispatch.params.q_pb_min = 0.25 * q_pb_des;
+	dispatch.params.q_pb_des = q_pb_des;
+	dispatch.params.eta_cycle_ref = 0.412;
+	dispatch.params.disp_time_weighting = 0.99;
+	dispatch.params.rsu_cost = 952.;
+	dispatch.params.csu_cost = 10000.;
+	dispatch.params.pen_delta_w = 0.1;
+	dispatch.params.q_rec_standby = 0.05 * q_pb_des;
+	dispatch.params.w_rec_ht = 0.;
+	dispatch.params.w_track = 550.;
+	dispatch.params.w_stow = 550.;
+	dispatch.params.w_cycle_pump = 0.00055;
+	dispatch.params.w_cycle_standby = dispatch.params.q_pb_standby * dispatch.params.w_cycle_pump;
+
+	dispatch.params.eff_table_load.clear();
+	dispatch.params.eff_table_load.add_point(0., 0.);
+	dispatch.params.eff_table_load.add_point(dispatch.params.q_pb_min, 0.85 * dispatch.params.eta_cycle_ref);
+	dispatch.params.eff_table_load.add_point(dispatch.params.q_pb_max, 1.01 * dispatch.params.eta_cycle_ref);
+
+	dispatch.solver_params.max_bb_iter = 10000;
+	dispatch.solver_params.mip_gap = 0.001;
+	dispatch.solver_params.solution_timeout = 5.;
+	dispatch.solver_params.is_write_ampl_dat = false;
+	dispatch.solver_params.is_ampl_engine = false;
+
+	// the second window starts with the cycle running on a partly charged tank, under a cloudier sky and a midday limit
+	dispatch.params.is_rec_operating0 = false;
+	dispatch.params.is_pb_operating0 = window > 0;
+	dispatch.params.is_pb_standby0 = false;
+	dispatch.params.q_pb0 = window > 0 ? 0.8 * q_pb_des : 0.;
+	dispatch.params.e_tes_init = window > 0 ? 3. * q_pb_des : 0.5 * q_pb_des;
+	dispatch.params.info_time = window * nt * 3600.;
+
+	dispatch.price_signal.assign(nt, 1.);
+	dispatch.w_lim.assign(nt, 1.e99);
+	dispatch.outputs.q_sfavail_expected.assign(nt, 0.);
+	dispatch.outputs.eta_sf_expected.assign(nt, 0.);
+	dispatch.outputs.eta_pb_expected.assign(nt, 1.);
+	dispatch.outputs.f_pb_op_limit.assign(nt, 1.);
+	dispatch.outputs.w_condf_expected.assign(nt, 0.01);
+	for (int t = 0; t < nt; t++)
+	{
+		double hour = (double)t + 0.5;
+		double sun = hour > 6. && hour < 18. ? sin(3.14159265358979 * (hour - 6.) / 12.) : 0.;
+		double clear = window > 0 && t >= 10 && t <= 13 ? 0.3 : 1.;
+		dispatch.outputs.q_sfavail_expected.at(t) = 2.4 * q_pb_des * sun * clear;
+		dispatch.outputs.eta_sf_expected.at(t) = sun > 0. ? 0.55 * clear : 0.;
+		dispatch.outputs.eta_pb_expected.at(t) = 1.02 - 0.04 * sun;
+		dispatch.price_signal.at(t) = t >= 16 && t <= 20 ? 2.06 : (t >= 6 && t < 16 ? 0.98 : 0.7);
+	}
+	if (window > 0)
+	{
+		dispatch.price_signal.at(8) = 1.5;
+		for (int t = 11; t <= 12; t++)
+			dispatch.w_lim.at(t) = 50000.;
+	}
+
+	dispatch.set_horizon(nt);
+}
+
+static void expect_same_dispatch(csp_dispatch_opt &a, csp_dispatch_opt &b)
+{
+	EXPECT_EQ(a.outputs.solve_state, b.outputs.solve_state);
+	EXPECT_NEAR(a.outputs.objective, b.outputs.objective, 1.e-6 * std::fabs(b.outputs.objective));
+	ASSERT_EQ(a.outputs.q_pb_target.size(), b.outputs.q_pb_target.size());
+	for (size_t t = 0; t < b.outputs.q_pb_target.size(); t++)
+	{
+		EXPECT_EQ(a.outputs.rec_operation.at(t), b.outputs.rec_operation.at(t)) << "t = " << t;
+		EXPECT_EQ(a.outputs.pb_operation.at(t), b.outputs.pb_operation.at(t)) << "t = " << t;
+		EXPECT_EQ(a.outputs.pb_standby.at(t), b.outputs.pb_standby.at(t)) << "t = " << t;
+		EXPECT_NEAR(a.outputs.q_pb_target.at(t), b.outputs.q_pb_target.at(t), 1.e-3) << "t = " << t;
+		EXPECT_NEAR(a.outputs.w_pb_target.at(t), b.outputs.w_pb_target.at(t), 1.e-3) << "t = " << t;
+		EXPECT_NEAR(a.outputs.q_sf_expected.at(t), b.outputs.q_sf_expected.at(t), 1.e-3) << "t = " << t;
+		EXPECT_NEAR(a.outputs.tes_charge_expected.at(t), b.outputs.tes_charge_expected.at(t), 1.e-3) << "t = " << t;
+	}
+}
+
+TEST(CspDispatchTest, PersistentModelMatchesRebuilt_csp_dispatch)
+{
+	C_csp_messages messages;
+
+	// one instance keeps its model between the two windows, the others build a model for a single window
+	csp_dispatch_opt persistent;
+	csp_dispatch_opt rebuilt[2];
+
+	for (int window = 0; window < 2; window++)
+	{
+		set_dispatch_window(persistent, messages, window);
+		ASSERT_TRUE(persistent.optimize());
+
+		set_dispatch_window(rebuilt[window], messages, window);
+		ASSERT_TRUE(rebuilt[window].optimize());
+
+		expect_same_dispatch(persistent, rebuilt[window]);
+	}
+
+	// the windows have to lead to different dispatch for the comparison to cover the update of the model
+	EXPECT_GT(std::fabs(rebuilt[0].outputs.objective - rebuilt[1].outputs.objective), 1.);
+	EXPECT_TRUE(rebuilt[1].outputs.pb_operation.at(0));
+	EXPECT_FALSE(rebuilt[0].outputs.pb_operation.at(0));
+}
@@ -0,0 +1,205 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include <gtest/gtest.h>
+
+#include "../tcs/htf_props.h"
+
+static void expect_within_tol(HTFProperties & c_exact, HTFProperties & c_tab, double T_low, double T_high, double tol)
+{
+	// Sample off the grid points, where interpolation error is largest
+	for (double T = T_low + 0.37; T < T_high; T += 0.71)
+	{
+		EXPECT_NEAR(c_tab.Cp(T), c_exact.Cp(T), tol * fabs(c_exact.Cp(T))) << "T = " << T;
+		EXPECT_NEAR(c_tab.dens(T, 1.E5), c_exact.dens(T, 1.E5), tol * fabs(c_exact.dens(T, 1.E5))) << "T = " << T;
+		EXPECT_NEAR(c_tab.visc(T), c_exact.visc(T), tol * fabs(c_exact.visc(T))) << "T = " << T;
+		EXPECT_NEAR(c_tab.cond(T), c_exact.cond(T), tol * fabs(c_exact.cond(T))) << "T = " << T;
+	}
+}
+
+TEST(HTFPropertiesTest, TabulatedLibraryFluids_htf_props) {
+	int fluids[] = {HTFProperties::Nitrate_Salt, HTFProperties::Hitec_XL, HTFProperties::Therminol_VP1,
+		HTFProperties::Caloria_HT_43, HTFProperties::Dowtherm_Q, HTFProperties::Salt_68_KCl_32_MgCl2};
+
+	for (int fluid : fluids)
+	{
+		HTFProperties c_exact, c_tab;
+		c_exact.SetFluid(fluid);
+		c_tab.set_tabulated(290.0 + 273.15, 600.0 + 273.15);
+		c_tab.SetFluid(fluid);
+		EXPECT_TRUE(c_tab.is_tabulated());
+
+		expect_within_tol(c_exact, c_tab, 290.0 + 273.15, 600.0 + 273.15, 2.E-6);
+
+		// Outside the tabulated range the correlations are used
+		EXPECT_EQ(c_tab.Cp(250.0 + 273.15), c_exact.Cp(250.0 + 273.15));
+		EXPECT_EQ(c_tab.visc(650.0 + 273.15), c_exact.visc(650.0 + 273.15));
+	}
+}
+
+TEST(HTFPropertiesTest, TabulatedFallbacks_htf_props) {
+	HTFProperties c_exact, c_tab;
+
+	// Air density depends on pressure and stays on the correlation
+	c_exact.SetFluid(HTFProperties::Air);
+	c_tab.SetFluid(HTFProperties::Air);
+	c_tab.set_tabulated(300.0, 1200.0);
+	EXPECT_EQ(c_tab.dens(700.0, 2.E5), c_exact.dens(700.0, 2.E5));
+	EXPECT_NEAR(c_tab.Cp(700.1), c_exact.Cp(700.1), 1.E-6 * c_exact.Cp(700.1));
+
+	// Therminol 66 viscosity correlation is discontinuous at 80 C, so can't be tabulated to tolerance
+	c_exact.SetFluid(HTFProperties::Therminol_66);
+	c_tab.SetFluid(HTFProperties::Therminol_66);
+	for (double T_C = 60.0; T_C < 100.0; T_C += 0.5)
+	{
+		EXPECT_EQ(c_tab.visc(T_C + 273.15), c_exact.visc(T_C + 273.15));
+	}
+
+	EXPECT_ANY_THROW(c_tab.set_tabulated(500.0, 400.0));
+}
+
+TEST(HTFPropertiesTest, TabulatedUserDefinedFluid_htf_props) {
+	util::matrix_t<double> table(4, 7);
+	double rows[4][7] = {
+		{200.0, 1.50, 1900.0, 3.0E-3, 1.6E-6, 0.50, 3.0E5},
+		{300.0, 1.52, 1850.0, 2.0E-3, 1.1E-6, 0.51, 4.5E5},
+		{400.0, 1.55, 1790.0, 1.5E-3, 0.8E-6, 0.52, 6.1E5},
+		{600.0, 1.60, 1700.0, 1.0E-3, 0.6E-6, 0.53, 9.3E5} };
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 7; j++)
+			table(i, j) = rows[i][j];
+
+	HTFProperties c_exact, c_tab;
+	ASSERT_TRUE(c_exact.SetUserDefinedFluid(table));
+	c_tab.set_tabulated(200.0 + 273.15, 600.0 + 273.15);
+	ASSERT_TRUE(c_tab.SetUserDefinedFluid(table));
+
+	expect_within_tol(c_exact, c_tab, 200.0 + 273.15, 600.0 + 273.15, 2.E-6);
+}
+
+TEST(HTFPropertiesTest, EnthLookup_htf_props) {
+	HTFProperties c_htf;
+	c_htf.SetFluid(HTFProperties::Nitrate_Salt, true);
+	HTFProperties c_tab;
+	c_tab.set_tabulated(270.0 + 273.15, 600.0 + 273.15);
+	c_tab.SetFluid(HTFProperties::Nitrate_Salt, true);
+
+	HTFProperties *htfs[] = {&c_htf, &c_tab};
+	for (int k = 0; k < 2; k++)
+	{
+		HTFProperties &c = *htfs[k];
+
+		// Enthalpy is 0 at 270 C, and the integral of Cp above it
+		double T_low = 270.0 + 273.15;
+		EXPECT_NEAR(c.enth_lookup(T_low), 0.0, 1.E-9);
+
+		double T_C = 432.6;
+		double h_expected = (1.443*(T_C - 270.0) + 0.086E-3*(T_C*T_C - 270.0*270.0));	//[kJ/kg]
+		// Linear interpolation on the 1 K grid: error up to dT^2/8 * dCp/dT
+		EXPECT_NEAR(c.enth_lookup(T_C + 273.15), h_expected, 0.125*0.172E-3);
+		EXPECT_NEAR(c.temp_lookup(h_expected), T_C + 273.15, 1.E-3);
+
+		// Extrapolates from the end intervals
+		double h_high = c.enth_lookup(600.0 + 273.15);
+		double cp_high = c.enth_lookup(600.0 + 273.15) - c.enth_lookup(599.0 + 273.15);
+		EXPECT_NEAR(c.enth_lookup(605.0 + 273.15), h_high + 5.0*cp_high, 1.E-9);
+	}
+
+	// The indexed lookup interpolates the same grid, from a tabulated Cp
+	for (double T = 270.0 + 273.15 + 0.37; T < 600.0 + 273.15; T += 0.71)
+	{
+		double h = c_htf.enth_lookup(T);
+		EXPECT_NEAR(c_tab.enth_lookup(T), h, 1.E-6*fabs(h) + 1.E-9) << "T = " << T;
+	}
+
+	EXPECT_TRUE(std::isnan(c_tab.enth_lookup(std::numeric_limits<double>::quiet_NaN())));
+}
+
+/// Property evaluation timing, correlations vs. tabulated mode, run with --gtest_also_run_disabled_tests
+TEST(HTFPropertiesTest, DISABLED_TabulatedBenchmark_htf_props) {
+	int fluids[] = {HTFProperties::Nitrate_Salt, HTFProperties::Therminol_VP1, HTFProperties::Caloria_HT_43};
+	const char *names[] = {"Nitrate_Salt", "Therminol_VP1", "Caloria_HT_43"};
+	int n_calls = 4000000;
+
+	for (int k = 0; k < 3; k++)
+	{
+		double ns_per_call[2];
+		for (int is_tab = 0; is_tab < 2; is_tab++)
+		{
+			HTFProperties c_htf;
+			if (is_tab)
+				c_htf.set_tabulated(290.0 + 273.15, 600.0 + 273.15);
+			c_htf.SetFluid(fluids[k]);
+
+			double sum = 0.0;
+			auto t0 = std::chrono::steady_clock::now();
+			for (int i = 0; i < n_calls; i++)
+			{
+				// Walk back and forth through the range like a field of nodes would
+				double T_K = 563.15 + 310.0 * (((i % 10007) * 7919) % 10007) / 10007.0;
+				sum += c_htf.Cp(T_K) + c_htf.dens(T_K, 1.E5) + c_htf.visc(T_K) + c_htf.cond(T_K);
+			}
+			double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+			ns_per_call[is_tab] = 1.E9 * s / (4.0 * n_calls);
+			EXPECT_TRUE(std::isfinite(sum));
+		}
+		std::cout << names[k] << ": correlations " << ns_per_call[0] << " ns/property, tabulated "
+			<< ns_per_call[1] << " ns/property\n";
+	}
+
+	// User-defined fluid: hunt/locate search vs. indexed lookup
+	util::matrix_t<double> table(32, 7);
+	for (int i = 0; i < 32; i++)
+	{
+		double T_C = 290.0 + 10.0 * i;
+		table(i, 0) = T_C;
+		table(i, 1) = 1.5 + 1.E-4 * T_C;
+		table(i, 2) = 2000.0 - 0.6 * T_C;
+		table(i, 3) = 3.E-3 * exp(-T_C / 300.0);
+		table(i, 4) = table(i, 3) / table(i, 2);
+		table(i, 5) = 0.5 + 1.E-4 * T_C;
+		table(i, 6) = 1500.0 * T_C;
+	}
+	double ns_per_call[2];
+	for (int is_tab = 0; is_tab < 2; is_tab++)
+	{
+		HTFProperties c_htf;
+		if (is_tab)
+			c_htf.set_tabulated(290.0 + 273.15, 600.0 + 273.15);
+		ASSERT_TRUE(c_htf.SetUserDefinedFluid(table));
+
+		double sum = 0.0;
+		auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < n_calls; i++)
+		{
+			double T_K = 563.15 + 310.0 * (((i % 10007) * 7919) % 10007) / 10007.0;
+			sum += c_htf.Cp(T_K) + c_htf.dens(T_K, 1.E5) + c_htf.visc(T_K) + c_htf.cond(T_K);
+		}
+		double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		ns_per_call[is_tab] = 1.E9 * s / (4.0 * n_calls);
+		EXPECT_TRUE(std::isfinite(sum));
+	}
+	std::cout << "User_defined: correlations " << ns_per_call[0] << " ns/property, tabulated "
+		<< ns_per_call[1] << " ns/property\n";
+
+	// enth_lookup on the 1 K grid: hunt/locate search vs. indexed lookup
+	for (int is_tab = 0; is_tab < 2; is_tab++)
+	{
+		HTFProperties c_htf;
+		if (is_tab)
+			c_htf.set_tabulated(290.0 + 273.15, 600.0 + 273.15);
+		c_htf.SetFluid(HTFProperties::Nitrate_Salt, true);
+		double sum = 0.0;
+		auto t0 = std::chrono::steady_clock::now();
+		for (int i = 0; i < n_calls; i++)
+		{
+			sum += c_htf.enth_lookup(563.15 + 310.0 * (((i % 10007) * 7919) % 10007) / 10007.0);
+		}
+		double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		ns_per_call[is_tab] = 1.E9 * s / n_calls;
+		EXPECT_TRUE(std::isfinite(sum));
+	}
+	std::cout << "enth_lookup: correlations " << ns_per_call[0] << " ns/call, tabulated "
+		<< ns_per_call[1] << " ns/call\n";
+}
@@ -0,0 +1,155 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../tcs/ud_power_cycle.h"
+#include "../tcs/csp_solver_util.h"
+
+/**
+ * Analytic stand-in for a power cycle model. Outputs depend on the number of calls since the last warm start
+ * reset, so the tables only match between runs if every sweep is solved in order from a fresh start.
+ */
+class C_test_pc_function : public C_od_pc_function
+{
+public:
+	int m_n_calls;
+	int m_fail_code;		// Returned at T_htf_hot == m_T_htf_fail
+	double m_T_htf_fail;	//[C]
+
+	C_test_pc_function()
+	{
+		m_n_calls = 0;
+		m_fail_code = 0;
+		m_T_htf_fail = -1.0;
+	}
+
+	virtual int operator()(S_f_inputs inputs, S_f_outputs & outputs)
+	{
+		if (inputs.m_T_htf_hot == m_T_htf_fail)
+			return m_fail_code;
+
+		outputs.m_W_dot_gross_ND = inputs.m_m_dot_htf_ND * (1.0 + 0.002*(inputs.m_T_htf_hot - 570.0) - 0.004*(inputs.m_T_amb - 35.0))
+			+ 1.E-6*m_n_calls;
+		outputs.m_Q_dot_in_ND = inputs.m_m_dot_htf_ND * (1.0 + 0.001*(inputs.m_T_htf_hot - 570.0));
+		outputs.m_W_dot_cooling_ND = inputs.m_m_dot_htf_ND;
+		outputs.m_m_dot_water_ND = 1.0;
+		m_n_calls++;
+
+		return 0;
+	}
+
+	virtual C_od_pc_function * clone() const
+	{
+		return new C_test_pc_function(*this);
+	}
+
+	virtual void reset_warm_start()
+	{
+		m_n_calls = 0;
+	}
+};
+
+struct S_test_progress
+{
+	int m_n_calls;
+	double m_progress_last;
+	bool m_is_monotonic;
+	int m_cancel_after;		// Return false on this call, if > 0
+};
+
+static bool test_progress_callback(std::string &log_msg, std::string &progress_msg, void *data, double progress, int out_type)
+{
+	S_test_progress *p = static_cast<S_test_progress*>(data);
+	p->m_n_calls++;
+	if (progress < p->m_progress_last)
+		p->m_is_monotonic = false;
+	p->m_progress_last = progress;
+
+	return p->m_cancel_after <= 0 || p->m_n_calls < p->m_cancel_after;
+}
+
+static int generate_test_tables(C_od_pc_function & f_pc, int n_threads, S_test_progress & progress,
+	util::matrix_t<double> & T_htf_ind, util::matrix_t<double> & T_amb_ind, util::matrix_t<double> & m_dot_htf_ind)
+{
+	progress.m_n_calls = 0;
+	progress.m_progress_last = 0.0;
+	progress.m_is_monotonic = true;
+
+	C_ud_pc_table_generator c_gen(f_pc);
+	c_gen.mf_callback = test_progress_callback;
+	c_gen.mp_mf_active = &progress;
+	c_gen.m_n_threads = n_threads;
+
+	return c_gen.generate_tables(570.0, 550.0, 590.0, 5,
+		35.0, 0.0, 45.0, 7,
+		1.0, 0.5, 1.05, 6,
+		T_htf_ind, T_amb_ind, m_dot_htf_ind);
+}
+
+TEST(UDPCTableGenerator, ThreadedTablesMatchSerial_ud_power_cycle) {
+	C_test_pc_function c_pc;
+	S_test_progress progress = {0, 0.0, true, 0};
+
+	util::matrix_t<double> T_htf_1, T_amb_1, m_dot_1;
+	ASSERT_EQ(generate_test_tables(c_pc, 1, progress, T_htf_1, T_amb_1, m_dot_1), 0);
+	EXPECT_EQ(progress.m_n_calls, 3 * (5 + 7 + 6));
+	EXPECT_DOUBLE_EQ(progress.m_progress_last, 100.0);
+
+	util::matrix_t<double> T_htf_4, T_amb_4, m_dot_4;
+	ASSERT_EQ(generate_test_tables(c_pc, 4, progress, T_htf_4, T_amb_4, m_dot_4), 0);
+	EXPECT_EQ(progress.m_n_calls, 3 * (5 + 7 + 6));
+	EXPECT_TRUE(progress.m_is_monotonic);
+	EXPECT_DOUBLE_EQ(progress.m_progress_last, 100.0);
+
+	// The original function is left alone; sweeps run on copies
+	EXPECT_EQ(c_pc.m_n_calls, 0);
+
+	const util::matrix_t<double> *tables_1[3] = {&T_htf_1, &T_amb_1, &m_dot_1};
+	const util::matrix_t<double> *tables_4[3] = {&T_htf_4, &T_amb_4, &m_dot_4};
+	for (int t = 0; t < 3; t++)
+	{
+		ASSERT_EQ(tables_1[t]->nrows(), tables_4[t]->nrows());
+		ASSERT_EQ(tables_1[t]->ncols(), 13);
+		for (size_t i = 0; i < tables_1[t]->nrows(); i++)
+		{
+			for (size_t j = 0; j < 13; j++)
+			{
+				EXPECT_EQ(tables_1[t]->at(i, j), tables_4[t]->at(i, j)) << "table " << t << " row " << i << " col " << j;
+			}
+		}
+	}
+
+	// Independent variables and a point at the 2nd level of the 1st table (design ND mass flow rate)
+	EXPECT_DOUBLE_EQ(T_htf_1(4, 0), 590.0);
+	EXPECT_NEAR(T_htf_1(4, 2), 1.04 + 1.E-6*4, 1.E-12);
+	EXPECT_DOUBLE_EQ(m_dot_1(5, 0), 1.05);
+}
+
+TEST(UDPCTableGenerator, FailedPoints_ud_power_cycle) {
+	C_test_pc_function c_pc;
+	S_test_progress progress = {0, 0.0, true, 0};
+	util::matrix_t<double> T_htf_ind, T_amb_ind, m_dot_htf_ind;
+
+	// Model failures fall back to the generic response
+	c_pc.m_T_htf_fail = 560.0;
+	c_pc.m_fail_code = -1;
+	ASSERT_EQ(generate_test_tables(c_pc, 3, progress, T_htf_ind, T_amb_ind, m_dot_htf_ind), 0);
+	EXPECT_DOUBLE_EQ(T_htf_ind(1, 0), 560.0);
+	EXPECT_DOUBLE_EQ(T_htf_ind(1, 1), 0.5);
+	EXPECT_DOUBLE_EQ(T_htf_ind(1, 4), 0.5);
+
+	// Other error codes stop table generation
+	c_pc.m_fail_code = 3;
+	EXPECT_THROW(generate_test_tables(c_pc, 3, progress, T_htf_ind, T_amb_ind, m_dot_htf_ind), C_csp_exception);
+	EXPECT_THROW(generate_test_tables(c_pc, 1, progress, T_htf_ind, T_amb_ind, m_dot_htf_ind), C_csp_exception);
+}
+
+TEST(UDPCTableGenerator, UserCancel_ud_power_cycle) {
+	C_test_pc_function c_pc;
+	S_test_progress progress = {0, 0.0, true, 10};
+	util::matrix_t<double> T_htf_ind, T_amb_ind, m_dot_htf_ind;
+
+	EXPECT_THROW(generate_test_tables(c_pc, 4, progress, T_htf_ind, T_amb_ind, m_dot_htf_ind), C_csp_exception);
+	EXPECT_EQ(progress.m_n_calls, 10);
+}